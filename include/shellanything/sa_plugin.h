@@ -88,10 +88,18 @@ const char* sa_plugin_action_get_name();
 
 /// <summary>
 /// Get the xml definition of an action in a Configuration of a custom action.
+/// The xml is only available while the action is created. Prefer sa_plugin_action_get_attributes() if the action only needs the attributes of its element.
 /// </summary>
 /// <returns>Returns the xml definition of an action. Returns NULL if no xml is defined.</returns>
 const char* sa_plugin_action_get_xml();
 
+/// <summary>
+/// Get the attributes of the xml element of a custom action, as they appear in the Configuration.
+/// The attributes are only available while the action is created.
+/// </summary>
+/// <returns>Returns a valid pointer to a sa_property_store_immutable_t. Returns NULL otherwise.</returns>
+sa_property_store_immutable_t* sa_plugin_action_get_attributes();
+
 /// <summary>
 /// Get a custom data pointer from the action. This same pointer is used while creating, executing and destroying the action.
 /// </summary>
@@ -87,6 +87,10 @@ sa_error_t sa_properties_get_string(const char* name, sa_string_t* str);
 /// Get the value of the given property name.
 /// </summary>
 /// <param name="name">The name of the property to get.</param>
+/// <remarks>
+/// The returned string is a copy owned by the calling thread.
+/// It is valid until the next call to sa_properties_get_cstr() from the same thread.
+/// </remarks>
 /// <returns>Returns a valid string value. Returns NULL if no value is defined.</returns>
 const char* sa_properties_get_cstr(const char* name);
 
@@ -97,6 +97,17 @@ sa_error_t sa_xml_parse_attr_store(const char* xml, XML_ATTR* attr, sa_property_
 /// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
 sa_error_t sa_xml_parse_attr_list_store(const char* xml, XML_ATTR* attrs, size_t count, sa_property_store_t* store);
 
+/// <summary>
+/// Copies a list of XML_ATTR from the attributes of an xml element. The attribute's values are saved into a property store.
+/// See sa_plugin_action_get_attributes().
+/// </summary>
+/// <param name="attributes">The attributes of the xml element.</param>
+/// <param name="attrs">The an array of XML_ATTR to copy.</param>
+/// <param name="count">The number of elements in the attrs array.</param>
+/// <param name="store">The property store to save the value of the arribute.</param>
+/// <returns>Returns 0 on success. Returns non-zero otherwise.</returns>
+sa_error_t sa_xml_copy_attr_list_store(sa_property_store_immutable_t* attributes, XML_ATTR* attrs, size_t count, sa_property_store_t* store);
+
 /// <summary>
 /// Initialize temporary fields of an XML_ATTR array.
 /// </summary>
@@ -32,18 +32,25 @@
 
 #include "rapidassist/strings.h"
 
+#include "tinyxml2.h"
+
 using namespace shellanything;
+using namespace tinyxml2;
 
 #define SA_API_LOG_IDDENTIFIER "PLUGIN API"
 
-sa_selection_context_immutable_t g_update_selection_context;
-sa_selection_context_immutable_t g_validation_selection_context;
-sa_property_store_immutable_t g_validation_property_store;
-sa_property_store_t g_action_property_store;
-sa_selection_context_immutable_t g_action_selection_context;
-const char* g_action_name;
-const char* g_action_xml;
-void* g_action_data;
+// Each thread has its own objects for the plugin callbacks. See shellanything::EvaluationContext.
+thread_local sa_selection_context_immutable_t g_update_selection_context;
+thread_local sa_selection_context_immutable_t g_validation_selection_context;
+thread_local sa_property_store_immutable_t g_validation_property_store;
+thread_local sa_property_store_t g_action_property_store;
+thread_local sa_selection_context_immutable_t g_action_selection_context;
+thread_local const char* g_action_name;
+thread_local const char* g_action_xml;
+thread_local const XMLElement* g_action_element;
+thread_local std::string g_action_xml_buffer;
+thread_local sa_property_store_immutable_t g_action_attributes;
+thread_local void* g_action_data;
 
 void ToCStringArray(std::vector<const char*>& destination, const std::vector<std::string>& values)
 {
@@ -386,7 +393,7 @@ public:
     mActionEventFunc = func;
   }
 
-  virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
+  virtual IAction* ParseFromElement(const XMLElement* element, std::string& error) const
   {
     // check callback
     if (mActionEventFunc == NULL)
@@ -395,13 +402,23 @@ public:
       return NULL;
     }
 
+    // copy the attributes of the element. The xml text is only built if the plugin asks for it.
+    PropertyStore attributes;
+    for (const XMLAttribute* attr = element->FirstAttribute(); attr != NULL; attr = attr->Next())
+    {
+      attributes.SetProperty(attr->Name(), attr->Value());
+    }
+
     void* data = NULL;
     PropertyStore* store = new PropertyStore();
 
     // initialize the global objects for the CREATE event
     g_action_property_store = AS_TYPE_PROPERTY_STORE(store);
     g_action_name = mName.c_str();
-    g_action_xml = xml.c_str();
+    g_action_xml = NULL;
+    g_action_element = element;
+    const PropertyStore* attributes_ptr = &attributes;
+    g_action_attributes = AS_TYPE_PROPERTY_STORE(attributes_ptr);
     g_action_data = data;
 
     // call the action event function of the plugin
@@ -413,8 +430,11 @@ public:
 
     // invalidate global update objects
     memset(&g_action_property_store, 0, sizeof(g_action_property_store));
+    memset(&g_action_attributes, 0, sizeof(g_action_attributes));
     g_action_name = NULL;
     g_action_xml = NULL;
+    g_action_element = NULL;
+    g_action_xml_buffer.clear();
     g_action_data = NULL;
 
     // if a parsing is succesful
@@ -464,9 +484,24 @@ const char* sa_plugin_action_get_name()
 
 const char* sa_plugin_action_get_xml()
 {
+  // build the xml text of the element on the first call
+  if (g_action_xml == NULL && g_action_element != NULL)
+  {
+    XMLPrinter printer;
+    g_action_element->Accept(&printer);
+    g_action_xml_buffer = printer.CStr();
+    g_action_xml = g_action_xml_buffer.c_str();
+  }
   return g_action_xml;
 }
 
+sa_property_store_immutable_t* sa_plugin_action_get_attributes()
+{
+  if (g_action_element == NULL)
+    return NULL;
+  return &g_action_attributes;
+}
+
 void* sa_plugin_action_get_data()
 {
   return g_action_data;
@@ -28,6 +28,10 @@
 
 using namespace shellanything;
 
+// Copy of the last value returned by sa_properties_get_cstr() for the calling thread.
+// Property values are published as snapshots which may be released when another thread sets a property.
+thread_local std::string g_properties_cstr_buffer;
+
 void sa_properties_clear()
 {
   PropertyManager& pmgr = PropertyManager::GetInstance();
@@ -93,8 +97,8 @@ const char* sa_properties_get_cstr(const char* name)
   PropertyManager& pmgr = PropertyManager::GetInstance();
   if (!pmgr.HasProperty(name))
     return NULL;
-  const std::string& property_value = pmgr.GetProperty(name);
-  const char* output = property_value.c_str();
+  g_properties_cstr_buffer = pmgr.GetProperty(name);
+  const char* output = g_properties_cstr_buffer.c_str();
   return output;
 }
 
@@ -181,6 +181,32 @@ sa_error_t sa_xml_parse_attr_list_store(const char* xml, XML_ATTR* attrs, size_t
   return result;
 }
 
+sa_error_t sa_xml_copy_attr_list_store(sa_property_store_immutable_t* attributes, XML_ATTR* attrs, size_t count, sa_property_store_t* store)
+{
+  if (attributes == NULL || attrs == NULL || count == 0 || store == NULL)
+    return SA_ERROR_INVALID_ARGUMENTS;
+  const PropertyStore* source = AS_CLASS_PROPERTY_STORE(attributes);
+  PropertyStore* psptr = AS_CLASS_PROPERTY_STORE(store);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    XML_ATTR& attr = attrs[i];
+
+    bool found = source->HasProperty(attr.name);
+    if (found)
+      psptr->SetProperty(attr.name, source->GetProperty(attr.name));
+
+    //Check mandatory attributes
+    if (attr.mandatory == SA_XML_ATTR_MANDATORY && !found)
+    {
+      sa_logging_print_format(SA_LOG_LEVEL_INFO, SA_API_LOG_IDDENTIFIER, "Unable to find mandatory attribute '%s'.", attr.name);
+      return SA_ERROR_NOT_FOUND;
+    }
+  }
+
+  return SA_ERROR_SUCCESS;
+}
+
 void sa_xml_attr_list_init(XML_ATTR* attrs, size_t count)
 {
   for (size_t i = 0; i < count; i++)
@@ -32,9 +32,16 @@ namespace shellanything
 {
 
   bool ActionManager::Execute(const Menu* menu, const SelectionContext& context)
+  {
+    EvaluationContext evaluation_context(context);
+    return Execute(menu, evaluation_context);
+  }
+
+  bool ActionManager::Execute(const Menu* menu, const EvaluationContext& context)
   {
     //compute the visual menu title
-    shellanything::PropertyManager& pmgr = shellanything::PropertyManager::GetInstance();
+    shellanything::PropertyManager& pmgr = context.GetPropertyManager();
+    pmgr.BeginRead();
     std::string title = pmgr.Expand(menu->GetName());
 
     bool success = true;
@@ -50,7 +57,7 @@ namespace shellanything
       if (action)
       {
         ra::errors::ResetLastErrorCode(); //reset win32 error code in case the action fails.
-        success = success && action->Execute(context);
+        success = success && action->ExecuteInContext(context);
 
         if (!success)
         {
@@ -78,6 +85,8 @@ namespace shellanything
     else
       SA_LOG(WARNING) << "Executing action(s) for menu '" << title.c_str() << "' completed with errors.";
 
+    pmgr.EndRead();
+
     return success;
   }
 
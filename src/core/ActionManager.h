@@ -47,6 +47,14 @@ namespace shellanything
     /// <returns>Returns true if the execution is successful. Returns false otherwise.</returns>
     static bool Execute(const Menu* menu, const SelectionContext& context);
 
+    /// <summary>
+    /// Execute all actions of the given menu with the given evaluation context.
+    /// </summary>
+    /// <param name="menu">The menu which contains the actions to execute.</param>
+    /// <param name="context">The current context of evaluation.</param>
+    /// <returns>Returns true if the execution is successful. Returns false otherwise.</returns>
+    static bool Execute(const Menu* menu, const EvaluationContext& context);
+
   };
 
 } //namespace shellanything
@@ -53,25 +53,8 @@ namespace shellanything
       return ActionMessage::XML_ELEMENT_NAME;
     }
 
-    virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const
+    virtual IAction* ParseFromElement(const XMLElement* element, std::string& error) const
     {
-      tinyxml2::XMLDocument doc;
-      XMLError result = doc.Parse(xml.c_str());
-      if (result != XML_SUCCESS)
-      {
-        if (doc.ErrorStr())
-        {
-          error = doc.ErrorStr();
-          return NULL;
-        }
-        else
-        {
-          error = "Unknown error reported by XML library.";
-          return NULL;
-        }
-      }
-      XMLElement* element = doc.FirstChildElement(GetName().c_str());
-
       ActionMessage* action = new ActionMessage();
       std::string tmp_str;
 
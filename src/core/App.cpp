@@ -48,7 +48,9 @@ namespace shellanything
 
 
   App::App() :
-    mLogger(NULL)
+    mLogger(NULL),
+    mRegistry(NULL),
+    mDirectoryWatchService(NULL)
   {
   }
 
@@ -96,6 +98,16 @@ namespace shellanything
     return mRegistry;
   }
 
+  void App::SetDirectoryWatchService(IDirectoryWatchService* instance)
+  {
+    mDirectoryWatchService = instance;
+  }
+
+  IDirectoryWatchService* App::GetDirectoryWatchService()
+  {
+    return mDirectoryWatchService;
+  }
+
   bool App::IsTestingEnvironment()
   {
     std::string process_path = ra::process::GetCurrentProcessPath();
@@ -162,6 +174,14 @@ namespace shellanything
     return config_dir;
   }
 
+  std::string App::GetCacheDirectory()
+  {
+    //compiled configurations are not kept with the user's Configuration Files
+    std::string temp_dir = ra::filesystem::GetTemporaryDirectoryUtf8();
+    std::string cache_dir = temp_dir + "\\" + app_name + "\\cache";
+    return cache_dir;
+  }
+
   bool App::Start()
   {
     SetupGlobalProperties();
@@ -240,10 +260,20 @@ namespace shellanything
       InstallDefaultConfigurations(config_dir);
     }
 
+    //compile configurations to skip xml parsing on the next launches
+    cmgr.GetCache().SetDirectory(GetCacheDirectory());
+
+    //App::Start() is called from DllMain(). Threads cannot start while the loader lock is held.
+    //Load the configurations files serially.
+    cmgr.SetLoadThreadCount(1);
+
     //setup ConfigManager to read files from config_dir
     cmgr.ClearSearchPath();
     cmgr.AddSearchPath(config_dir);
     cmgr.Refresh();
+
+    //the next refreshes are called from the shell. parse the new configurations files on all processors.
+    cmgr.SetLoadThreadCount(0);
   }
 
   void App::SetupGlobalProperties()
@@ -263,6 +293,9 @@ namespace shellanything
     pmgr.SetProperty("home.directory", home_dir);
     pmgr.SetProperty("config.directory", config_dir);
     pmgr.SetProperty("log.directory", log_dir);
+    pmgr.SetStableProperty("home.directory", true);
+    pmgr.SetStableProperty("config.directory", true);
+    pmgr.SetStableProperty("log.directory", true);
   }
 
 } //namespace shellanything
@@ -27,6 +27,7 @@
 
 #include "ILogger.h"
 #include "IRegistryService.h"
+#include "IDirectoryWatchService.h"
 
 #include <string>
 
@@ -91,6 +92,22 @@ namespace shellanything
     /// <returns>Returns a pointer of the instance that is currently set. Returns NULL if no service is set.</returns>
     IRegistryService* GetRegistry();
 
+    /// <summary>
+    /// Set the current application directory watch service.
+    /// The service tells the Configuration Manager which configuration files have changed. See ConfigManager::Refresh().
+    /// </summary>
+    /// <remarks>
+    /// If a service instance is already set, the caller must properly destroy the old instance.
+    /// </remarks>
+    /// <param name="instance">A valid instance of a the service. Set to NULL to search all configuration files on each refresh.</param>
+    void SetDirectoryWatchService(IDirectoryWatchService* instance);
+
+    /// <summary>
+    /// Get the current application directory watch service.
+    /// </summary>
+    /// <returns>Returns a pointer of the instance that is currently set. Returns NULL if no service is set.</returns>
+    IDirectoryWatchService* GetDirectoryWatchService();
+
     /// <summary>
     /// Test if application is loaded in a test environment (main's tests executable).
     /// </summary>
@@ -109,6 +126,12 @@ namespace shellanything
     /// <returns>Returns the path of the directory of the user's Configuration Files.</returns>
     std::string GetConfigurationsDirectory();
 
+    /// <summary>
+    /// Get the application's cache directory.
+    /// </summary>
+    /// <returns>Returns the path of the directory of the compiled Configuration Files.</returns>
+    std::string GetCacheDirectory();
+
     /// <summary>
     /// Test if the given directory is valid for logging.
     /// </summary>
@@ -143,6 +166,7 @@ namespace shellanything
 
     ILogger * mLogger;
     IRegistryService* mRegistry;
+    IDirectoryWatchService* mDirectoryWatchService;
   };
 
 
@@ -0,0 +1,201 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "CaseFolding.h"
+
+namespace shellanything
+{
+  static const uint64_t ASCII_HIGH_BITS = 0x8080808080808080ull;
+
+  /// <summary>
+  /// Fold the case of 8 ASCII characters at once. All bytes of the given word must be lower than 0x80.
+  /// </summary>
+  inline uint64_t FoldCaseAscii8(uint64_t word)
+  {
+    // For each byte, the high bit is set if the character is >= 'a' or > 'z'.
+    // Bytes are lower than 0x80 which means that the additions never overflow to the next byte.
+    uint64_t ge_a = word + 0x1f1f1f1f1f1f1f1full; // 0x80 - 'a'
+    uint64_t gt_z = word + 0x0505050505050505ull; // 0x80 - ('z' + 1)
+    uint64_t lowercase = (ge_a & ~gt_z) & ASCII_HIGH_BITS;
+
+    // Convert to uppercase by removing 0x20 from each lowercase character
+    return word - (lowercase >> 2);
+  }
+
+  uint32_t FoldCaseCodePoint(uint32_t code_point)
+  {
+    // Basic Latin
+    if (code_point < 0x80)
+      return (uint32_t)FoldCaseAscii((char)code_point);
+
+    // Latin-1 Supplement
+    if (code_point < 0x100)
+    {
+      if (code_point >= 0xE0 && code_point <= 0xFE && code_point != 0xF7)
+        return code_point - 0x20;
+      if (code_point == 0xFF)
+        return 0x178;
+      return code_point;
+    }
+
+    // Latin Extended-A
+    if (code_point < 0x180)
+    {
+      if (code_point == 0x130 || code_point == 0x131)
+        return code_point; // dotted and dotless i have their own rules
+      if ((code_point >= 0x100 && code_point <= 0x137) || (code_point >= 0x14A && code_point <= 0x177))
+        return code_point & ~1u; // uppercase letters are even
+      if ((code_point >= 0x139 && code_point <= 0x148) || (code_point >= 0x179 && code_point <= 0x17E))
+        return ((code_point & 1u) == 0 ? code_point - 1 : code_point); // uppercase letters are odd
+      return code_point;
+    }
+
+    // Greek
+    if (code_point >= 0x3AC && code_point <= 0x3CE)
+    {
+      if (code_point == 0x3AC)
+        return 0x386;
+      if (code_point <= 0x3AF)
+        return code_point - 0x25;
+      if (code_point == 0x3B0)
+        return code_point;
+      if (code_point == 0x3C2)
+        return 0x3A3; // final sigma
+      if (code_point <= 0x3CB)
+        return code_point - 0x20;
+      if (code_point == 0x3CC)
+        return 0x38C;
+      return code_point - 0x3F;
+    }
+
+    // Cyrillic
+    if (code_point >= 0x430 && code_point <= 0x44F)
+      return code_point - 0x20;
+    if (code_point >= 0x450 && code_point <= 0x45F)
+      return code_point - 0x50;
+
+    return code_point;
+  }
+
+  std::string FoldCase(const std::string& value)
+  {
+    std::string folded = value;
+    size_t length = folded.size();
+    size_t offset = 0;
+    while (offset < length)
+    {
+      unsigned char c0 = (unsigned char)folded[offset];
+
+      // ASCII characters
+      if (c0 < 0x80)
+      {
+        folded[offset] = FoldCaseAscii(folded[offset]);
+        offset++;
+        continue;
+      }
+
+      // All characters with a case mapping are encoded on 2 bytes: 110xxxxx 10xxxxxx
+      if (offset + 1 < length && (c0 & 0xE0) == 0xC0 && (folded[offset + 1] & 0xC0) == 0x80)
+      {
+        uint32_t code_point = ((c0 & 0x1Fu) << 6) | (folded[offset + 1] & 0x3Fu);
+        code_point = FoldCaseCodePoint(code_point);
+        folded[offset + 0] = (char)(0xC0 | (code_point >> 6));
+        folded[offset + 1] = (char)(0x80 | (code_point & 0x3F));
+        offset += 2;
+        continue;
+      }
+
+      // Other characters are left unchanged
+      offset++;
+    }
+    return folded;
+  }
+
+  size_t MatchCharacterCaseInsensitive(const char* a, const char* b, size_t max_length)
+  {
+    if (max_length == 0)
+      return 0;
+
+    unsigned char a0 = (unsigned char)a[0];
+    unsigned char b0 = (unsigned char)b[0];
+
+    // ASCII characters
+    if (a0 < 0x80 && b0 < 0x80)
+      return (FoldCaseAscii(a[0]) == FoldCaseAscii(b[0]) ? 1 : 0);
+
+    // All characters with a case mapping are encoded on 2 bytes: 110xxxxx 10xxxxxx
+    bool a_2_bytes = (max_length >= 2 && (a0 & 0xE0) == 0xC0 && (a[1] & 0xC0) == 0x80);
+    bool b_2_bytes = (max_length >= 2 && (b0 & 0xE0) == 0xC0 && (b[1] & 0xC0) == 0x80);
+    if (a_2_bytes && b_2_bytes)
+    {
+      uint32_t a_code_point = ((a0 & 0x1Fu) << 6) | (a[1] & 0x3Fu);
+      uint32_t b_code_point = ((b0 & 0x1Fu) << 6) | (b[1] & 0x3Fu);
+      return (FoldCaseCodePoint(a_code_point) == FoldCaseCodePoint(b_code_point) ? 2 : 0);
+    }
+
+    // Other characters are compared byte per byte
+    return (a0 == b0 ? 1 : 0);
+  }
+
+  bool EqualsCaseInsensitive(const char* a, const char* b, size_t length)
+  {
+    if (a == NULL || b == NULL)
+      return false;
+
+    // Fast path for ASCII strings. Compare 8 characters at a time.
+    size_t offset = 0;
+    while (offset + sizeof(uint64_t) <= length)
+    {
+      uint64_t a_word;
+      uint64_t b_word;
+      memcpy(&a_word, &a[offset], sizeof(a_word));
+      memcpy(&b_word, &b[offset], sizeof(b_word));
+      if (a_word != b_word)
+      {
+        // Non-ASCII characters must be compared one by one
+        if ((a_word | b_word) & ASCII_HIGH_BITS)
+          break;
+        if (FoldCaseAscii8(a_word) != FoldCaseAscii8(b_word))
+          return false;
+      }
+      offset += sizeof(uint64_t);
+    }
+
+    // Make sure to resume on the first byte of an utf-8 character.
+    // Previous bytes are identical in both strings.
+    while (offset > 0 && offset < length && (a[offset] & 0xC0) == 0x80)
+      offset--;
+
+    while (offset < length)
+    {
+      size_t character_length = MatchCharacterCaseInsensitive(&a[offset], &b[offset], length - offset);
+      if (character_length == 0)
+        return false;
+      offset += character_length;
+    }
+
+    return true;
+  }
+
+} //namespace shellanything
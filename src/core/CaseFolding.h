@@ -0,0 +1,121 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_CASE_FOLDING_H
+#define SA_CASE_FOLDING_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include <stdint.h>
+#include <string>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Fold the case of an ASCII character. Lowercase letters are converted to uppercase.
+  /// </summary>
+  /// <param name="c">The character to fold.</param>
+  /// <returns>Returns the folded character. Characters that are not lowercase ASCII letters are returned unchanged.</returns>
+  inline char FoldCaseAscii(char c)
+  {
+    if (c >= 'a' && c <= 'z')
+      return (char)(c - ('a' - 'A'));
+    return c;
+  }
+
+  /// <summary>
+  /// Fold the case of an unicode code point. Lowercase letters are converted to uppercase.
+  /// Supports ASCII, Latin-1 Supplement, Latin Extended-A, Greek and Cyrillic letters.
+  /// Only letters where both cases have the same utf-8 encoded length are folded.
+  /// </summary>
+  /// <param name="code_point">The code point to fold.</param>
+  /// <returns>Returns the folded code point. Code points without a case mapping are returned unchanged.</returns>
+  SHELLANYTHING_EXPORT uint32_t FoldCaseCodePoint(uint32_t code_point);
+
+  /// <summary>
+  /// Fold the case of an utf-8 encoded string.
+  /// Two strings are equal ignoring case if their folded strings are equal (see EqualsCaseInsensitive()).
+  /// </summary>
+  /// <param name="value">The utf-8 encoded string to fold.</param>
+  /// <returns>Returns the folded string. The folded string have the same length as the given string.</returns>
+  SHELLANYTHING_EXPORT std::string FoldCase(const std::string& value);
+
+  /// <summary>
+  /// Compare the first utf-8 character of two strings, ignoring case.
+  /// </summary>
+  /// <remarks>
+  /// Case folding never changes the length of an utf-8 character (see FoldCaseCodePoint()).
+  /// If the characters are equal, both have the same length in bytes.
+  /// Invalid utf-8 sequences are compared byte per byte.
+  /// </remarks>
+  /// <param name="a">The first utf-8 encoded string.</param>
+  /// <param name="b">The second utf-8 encoded string.</param>
+  /// <param name="max_length">The maximum number of bytes that can be read from both strings.</param>
+  /// <returns>Returns the length in bytes of the matching character. Returns 0 if the characters are different.</returns>
+  SHELLANYTHING_EXPORT size_t MatchCharacterCaseInsensitive(const char* a, const char* b, size_t max_length);
+
+  /// <summary>
+  /// Compare two utf-8 encoded strings of the same length, ignoring case.
+  /// The function does not allocate memory.
+  /// </summary>
+  /// <param name="a">The first utf-8 encoded string.</param>
+  /// <param name="b">The second utf-8 encoded string.</param>
+  /// <param name="length">The length in bytes of both strings.</param>
+  /// <returns>Returns true if both strings are equal, ignoring case. Returns false otherwise.</returns>
+  SHELLANYTHING_EXPORT bool EqualsCaseInsensitive(const char* a, const char* b, size_t length);
+
+  /// <summary>
+  /// Compare two utf-8 encoded strings, ignoring case.
+  /// The function does not allocate memory.
+  /// </summary>
+  /// <param name="a">The first utf-8 encoded string.</param>
+  /// <param name="b">The second utf-8 encoded string.</param>
+  /// <returns>Returns true if both strings are equal, ignoring case. Returns false otherwise.</returns>
+  inline bool EqualsCaseInsensitive(const std::string& a, const std::string& b)
+  {
+    if (a.size() != b.size())
+      return false;
+    return EqualsCaseInsensitive(a.c_str(), b.c_str(), a.size());
+  }
+
+  /// <summary>
+  /// Compare two utf-8 encoded strings, ignoring case.
+  /// The function does not allocate memory.
+  /// </summary>
+  /// <param name="a">The first utf-8 encoded string.</param>
+  /// <param name="b">The second utf-8 encoded string.</param>
+  /// <returns>Returns true if both strings are equal, ignoring case. Returns false otherwise.</returns>
+  inline bool EqualsCaseInsensitive(const std::string& a, const char* b)
+  {
+    if (b == NULL)
+      return false;
+    size_t length = strlen(b);
+    if (a.size() != length)
+      return false;
+    return EqualsCaseInsensitive(a.c_str(), b, length);
+  }
+
+} //namespace shellanything
+
+#endif //SA_CASE_FOLDING_H
@@ -0,0 +1,980 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "ConfigCache.h"
+#include "ObjectFactory.h"
+#include "DefaultSettings.h"
+#include "LoggerHelper.h"
+#include "SharedMemory.h"
+
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/strings.h"
+
+#include <limits>
+#include <string.h>
+
+namespace shellanything
+{
+  const uint32_t ConfigCache::FORMAT_VERSION = 2;
+
+  static const std::string CACHE_FILE_MAGIC = "SACACHE";
+  static const std::string CACHE_FILE_EXTENSION = ".sacache";
+  static const char SHARED_MEMORY_MAGIC[8] = { 'S', 'A', 'S', 'H', 'A', 'R', 'E', 'D' };
+
+  // The header of the shared memory segment which identifies the last compiled image of a configuration file.
+  // The segment is shared by all processes. It only contains values that are independent of the address of the mapping.
+  struct SHARED_CONFIG_HEADER
+  {
+    char magic[8];
+    uint32_t version;                       // the FORMAT_VERSION of the images
+    std::atomic<uint32_t> generation;       // the generation of the last published image. 0 if no image is published.
+    std::atomic<uint32_t> next_generation;  // the last generation reserved by a process
+  };
+
+  // The counters are shared by processes. They must not be implemented with a lock which is local to a process.
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "std::atomic<uint32_t> must be lock free to be shared between processes");
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "std::atomic<uint32_t> must have the layout of uint32_t to be shared between processes");
+
+  // The header of the shared memory segment of a compiled image. The segment is never modified once the image is published.
+  struct SHARED_IMAGE_HEADER
+  {
+    char magic[8];
+    uint64_t size;  // the size in bytes of the image which follows the header
+  };
+
+  // Compute a 64 bit FNV-1a hash of the given data.
+  uint64_t GetContentHash(const char* data, size_t size)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+      hash ^= (unsigned char)data[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  uint64_t GetContentHash(const std::string& data)
+  {
+    return GetContentHash(data.c_str(), data.size());
+  }
+
+  // Write values to a compiled file. Integers are written in little endian.
+  class CacheWriter
+  {
+  public:
+    void WriteUInt32(uint32_t value)
+    {
+      for (size_t i = 0; i < 4; i++)
+        mBuffer.push_back((char)((value >> (i * 8)) & 0xFF));
+    }
+
+    void WriteUInt64(uint64_t value)
+    {
+      for (size_t i = 0; i < 8; i++)
+        mBuffer.push_back((char)((value >> (i * 8)) & 0xFF));
+    }
+
+    void WriteInt(int value)
+    {
+      WriteUInt32((uint32_t)value);
+    }
+
+    void WriteBool(bool value)
+    {
+      mBuffer.push_back(value ? 1 : 0);
+    }
+
+    void WriteString(const std::string& value)
+    {
+      WriteUInt32((uint32_t)value.size());
+      mBuffer.append(value);
+    }
+
+    const std::string& GetBuffer() const
+    {
+      return mBuffer;
+    }
+
+  private:
+    std::string mBuffer;
+  };
+
+  // Read values from a compiled file. Reading past the end of the file fails all following reads.
+  class CacheReader
+  {
+  public:
+    CacheReader(const char* buffer, size_t size) :
+      mBuffer(buffer),
+      mSize(size),
+      mOffset(0),
+      mFailed(false)
+    {
+    }
+
+    uint32_t ReadUInt32()
+    {
+      uint32_t value = 0;
+      if (!Require(4))
+        return value;
+      for (size_t i = 0; i < 4; i++)
+        value |= ((uint32_t)(unsigned char)mBuffer[mOffset + i]) << (i * 8);
+      mOffset += 4;
+      return value;
+    }
+
+    uint64_t ReadUInt64()
+    {
+      uint64_t value = 0;
+      if (!Require(8))
+        return value;
+      for (size_t i = 0; i < 8; i++)
+        value |= ((uint64_t)(unsigned char)mBuffer[mOffset + i]) << (i * 8);
+      mOffset += 8;
+      return value;
+    }
+
+    int ReadInt()
+    {
+      return (int)ReadUInt32();
+    }
+
+    bool ReadBool()
+    {
+      if (!Require(1))
+        return false;
+      bool value = (mBuffer[mOffset] != 0);
+      mOffset++;
+      return value;
+    }
+
+    std::string ReadString()
+    {
+      size_t length = ReadUInt32();
+      if (!Require(length))
+        return std::string();
+      std::string value(mBuffer + mOffset, length);
+      mOffset += length;
+      return value;
+    }
+
+    // Read the number of elements of a list. Each element uses at least one byte.
+    size_t ReadCount()
+    {
+      size_t count = ReadUInt32();
+      if (!Require(count))
+        return 0;
+      return count;
+    }
+
+    bool IsFailed() const
+    {
+      return mFailed;
+    }
+
+  private:
+    bool Require(size_t length)
+    {
+      if (mFailed || length > mSize - mOffset)
+        mFailed = true;
+      return !mFailed;
+    }
+
+    const char* mBuffer;
+    size_t mSize;
+    size_t mOffset;
+    bool mFailed;
+  };
+
+  bool WriteActions(CacheWriter& writer, const IAction::ActionPtrList& actions, const ObjectFactory::ActionSourceMap& sources)
+  {
+    writer.WriteUInt32((uint32_t)actions.size());
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+      ObjectFactory::ActionSourceMap::const_iterator it = sources.find(actions[i]);
+      if (it == sources.end())
+        return false; //this action was not parsed from xml
+
+      const ObjectFactory::ACTION_SOURCE& source = it->second;
+      writer.WriteString(source.name);
+      writer.WriteString(source.xml);
+    }
+    return true;
+  }
+
+  void WriteValidator(CacheWriter& writer, const Validator* validator)
+  {
+    writer.WriteInt(validator->GetMaxFiles());
+    writer.WriteInt(validator->GetMaxDirectories());
+    writer.WriteString(validator->GetClass());
+    writer.WriteString(validator->GetPattern());
+    writer.WriteString(validator->GetExprtk());
+    writer.WriteString(validator->GetFileExtensions());
+    writer.WriteString(validator->GetFileExists());
+    writer.WriteString(validator->GetProperties());
+    writer.WriteString(validator->GetInserve());
+    writer.WriteString(validator->GetIsTrue());
+    writer.WriteString(validator->GetIsFalse());
+    writer.WriteString(validator->GetIsEmpty());
+
+    //plugin's custom conditions attributes
+    const PropertyStore& custom_attributes = validator->GetCustomAttributes();
+    StringList names;
+    custom_attributes.GetProperties(names);
+    writer.WriteUInt32((uint32_t)names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      const std::string& name = names[i];
+      writer.WriteString(name);
+      writer.WriteString(custom_attributes.GetProperty(name));
+    }
+  }
+
+  bool WriteMenu(CacheWriter& writer, const Menu* menu, const ObjectFactory::ActionSourceMap& sources)
+  {
+    writer.WriteUInt64(menu->GetSourceHash());
+    writer.WriteBool(menu->IsSeparator());
+    writer.WriteBool(menu->IsColumnSeparator());
+    writer.WriteString(menu->GetName());
+    writer.WriteString(menu->GetDescription());
+    writer.WriteInt(menu->GetNameMaxLength());
+
+    const Icon& icon = menu->GetIcon();
+    writer.WriteString(icon.GetPath());
+    writer.WriteString(icon.GetFileExtension());
+    writer.WriteInt(icon.GetIndex());
+
+    writer.WriteUInt32((uint32_t)menu->GetValidityCount());
+    for (size_t i = 0; i < menu->GetValidityCount(); i++)
+    {
+      WriteValidator(writer, menu->GetValidity(i));
+    }
+
+    writer.WriteUInt32((uint32_t)menu->GetVisibilityCount());
+    for (size_t i = 0; i < menu->GetVisibilityCount(); i++)
+    {
+      WriteValidator(writer, menu->GetVisibility(i));
+    }
+
+    if (!WriteActions(writer, menu->GetActions(), sources))
+      return false;
+
+    const Menu::MenuPtrList& submenus = menu->GetSubMenus();
+    writer.WriteUInt32((uint32_t)submenus.size());
+    for (size_t i = 0; i < submenus.size(); i++)
+    {
+      if (!WriteMenu(writer, submenus[i], sources))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool WriteConfigFile(CacheWriter& writer, const ConfigFile& config, const ObjectFactory::ActionSourceMap& sources)
+  {
+    //write the <default> actions
+    const DefaultSettings* defaults = config.GetDefaultSettings();
+    IAction::ActionPtrList default_actions;
+    if (defaults)
+      default_actions = defaults->GetActions();
+    if (!WriteActions(writer, default_actions, sources))
+      return false;
+    writer.WriteUInt64(defaults ? defaults->GetSourceHash() : 0);
+
+    //write the <plugin> declarations
+    const Plugin::PluginPtrList& plugins = config.GetPlugins();
+    writer.WriteUInt32((uint32_t)plugins.size());
+    for (size_t i = 0; i < plugins.size(); i++)
+    {
+      const Plugin* plugin = plugins[i];
+      writer.WriteString(plugin->GetPath());
+      writer.WriteString(plugin->GetDescription());
+      writer.WriteString(plugin->GetConditions());
+      writer.WriteString(plugin->GetActions());
+    }
+
+    //write the <menu> trees
+    const Menu::MenuPtrList& menus = config.GetMenus();
+    writer.WriteUInt32((uint32_t)menus.size());
+    for (size_t i = 0; i < menus.size(); i++)
+    {
+      if (!WriteMenu(writer, menus[i], sources))
+        return false;
+    }
+
+    return true;
+  }
+
+  bool ReadActions(CacheReader& reader, IAction::ActionPtrList& actions)
+  {
+    size_t count = reader.ReadCount();
+    for (size_t i = 0; i < count && !reader.IsFailed(); i++)
+    {
+      std::string name = reader.ReadString();
+      std::string xml = reader.ReadString();
+      if (reader.IsFailed())
+        break;
+
+      std::string error;
+      IAction* action = ObjectFactory::GetInstance().ParseAction(name, xml, error);
+      if (action == NULL)
+      {
+        SA_LOG(WARNING) << "Failed to read compiled action '" << name << "'. Error=" << error << ".";
+        break;
+      }
+      actions.push_back(action);
+    }
+
+    if (reader.IsFailed() || actions.size() != count)
+    {
+      for (size_t i = 0; i < actions.size(); i++)
+        delete actions[i];
+      actions.clear();
+      return false;
+    }
+    return true;
+  }
+
+  Validator* ReadValidator(CacheReader& reader, const Plugin::PluginPtrList& plugins)
+  {
+    int max_files = reader.ReadInt();
+    int max_directories = reader.ReadInt();
+    std::string classes = reader.ReadString();
+    std::string pattern = reader.ReadString();
+    std::string exprtk = reader.ReadString();
+    std::string file_extensions = reader.ReadString();
+    std::string file_exists = reader.ReadString();
+    std::string properties = reader.ReadString();
+    std::string inserve = reader.ReadString();
+    std::string istrue = reader.ReadString();
+    std::string isfalse = reader.ReadString();
+    std::string isempty = reader.ReadString();
+
+    PropertyStore custom_attributes;
+    size_t count = reader.ReadCount();
+    for (size_t i = 0; i < count && !reader.IsFailed(); i++)
+    {
+      std::string name = reader.ReadString();
+      std::string value = reader.ReadString();
+      custom_attributes.SetProperty(name, value);
+    }
+
+    if (reader.IsFailed())
+      return NULL;
+
+    //only set the attributes that were specified, like ObjectFactory::ParseValidator()
+    Validator* validator = new Validator();
+    if (max_files != std::numeric_limits<int>::max())
+      validator->SetMaxFiles(max_files);
+    if (max_directories != std::numeric_limits<int>::max())
+      validator->SetMaxDirectories(max_directories);
+    if (!classes.empty())
+      validator->SetClass(classes);
+    if (!pattern.empty())
+      validator->SetPattern(pattern);
+    if (!exprtk.empty())
+      validator->SetExprtk(exprtk);
+    if (!file_extensions.empty())
+      validator->SetFileExtensions(file_extensions);
+    if (!file_exists.empty())
+      validator->SetFileExists(file_exists);
+    if (!properties.empty())
+      validator->SetProperties(properties);
+    if (!inserve.empty())
+      validator->SetInserve(inserve);
+    if (!istrue.empty())
+      validator->SetIsTrue(istrue);
+    if (!isfalse.empty())
+      validator->SetIsFalse(isfalse);
+    if (!isempty.empty())
+      validator->SetIsEmpty(isempty);
+    validator->SetCustomAttributes(custom_attributes);
+
+    //resolve which plugin's attribute validators are required by the custom attributes
+    validator->ResolvePluginValidators(plugins);
+
+    return validator;
+  }
+
+  Menu* ReadMenu(CacheReader& reader, const Plugin::PluginPtrList& plugins)
+  {
+    Menu* menu = new Menu();
+    menu->SetSourceHash(reader.ReadUInt64());
+    menu->SetSeparator(reader.ReadBool());
+    menu->SetColumnSeparator(reader.ReadBool());
+    menu->SetName(reader.ReadString());
+    menu->SetDescription(reader.ReadString());
+    menu->SetNameMaxLength(reader.ReadInt());
+
+    Icon icon;
+    icon.SetPath(reader.ReadString());
+    icon.SetFileExtension(reader.ReadString());
+    icon.SetIndex(reader.ReadInt());
+    menu->SetIcon(icon);
+
+    size_t count = reader.ReadCount();
+    for (size_t i = 0; i < count; i++)
+    {
+      Validator* validator = ReadValidator(reader, plugins);
+      if (validator == NULL)
+      {
+        delete menu;
+        return NULL;
+      }
+      menu->AddValidity(validator);
+    }
+
+    count = reader.ReadCount();
+    for (size_t i = 0; i < count; i++)
+    {
+      Validator* validator = ReadValidator(reader, plugins);
+      if (validator == NULL)
+      {
+        delete menu;
+        return NULL;
+      }
+      menu->AddVisibility(validator);
+    }
+
+    IAction::ActionPtrList actions;
+    if (!ReadActions(reader, actions))
+    {
+      delete menu;
+      return NULL;
+    }
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+      menu->AddAction(actions[i]);
+    }
+
+    count = reader.ReadCount();
+    for (size_t i = 0; i < count; i++)
+    {
+      Menu* submenu = ReadMenu(reader, plugins);
+      if (submenu == NULL)
+      {
+        delete menu;
+        return NULL;
+      }
+      menu->AddMenu(submenu);
+    }
+
+    if (reader.IsFailed())
+    {
+      delete menu;
+      return NULL;
+    }
+
+    return menu;
+  }
+
+  bool ReadConfigFile(CacheReader& reader, ConfigFile* config)
+  {
+    //read the <default> actions
+    IAction::ActionPtrList default_actions;
+    if (!ReadActions(reader, default_actions))
+      return false;
+    uint64_t defaults_hash = reader.ReadUInt64();
+    if (!default_actions.empty())
+    {
+      DefaultSettings* defaults = new DefaultSettings();
+      defaults->SetSourceHash(defaults_hash);
+      for (size_t i = 0; i < default_actions.size(); i++)
+      {
+        defaults->AddAction(default_actions[i]);
+      }
+      config->SetDefaultSettings(defaults);
+    }
+
+    //read the <plugin> declarations
+    size_t count = reader.ReadCount();
+    for (size_t i = 0; i < count; i++)
+    {
+      std::string path = reader.ReadString();
+      std::string description = reader.ReadString();
+      std::string conditions = reader.ReadString();
+      std::string actions = reader.ReadString();
+      if (reader.IsFailed())
+        return false;
+
+      Plugin* plugin = new Plugin();
+      plugin->SetPath(path);
+      plugin->SetDescription(description);
+      plugin->SetConditions(conditions);
+      plugin->SetActions(actions);
+
+      // try to load the plugin.
+      bool loaded = plugin->Load();
+      if (!loaded)
+      {
+        SA_LOG(WARNING) << "The plugin file '" << plugin->GetPath() << "' has failed to load, the plugin is disabled.";
+      }
+
+      //add the new plugin to the current configuration (even if loading failed)
+      config->AddPlugin(plugin);
+    }
+
+    //set active plugins for reading the actions of the menus
+    const Plugin::PluginPtrList& active_plugins = config->GetPlugins();
+    ObjectFactory::GetInstance().SetActivePlugins(active_plugins);
+
+    //read the <menu> trees
+    bool success = true;
+    count = reader.ReadCount();
+    for (size_t i = 0; i < count && success; i++)
+    {
+      Menu* menu = ReadMenu(reader, active_plugins);
+      if (menu == NULL)
+        success = false;
+      else
+        config->AddMenu(menu);
+    }
+
+    //cleanup ObjectFactory plugins.
+    ObjectFactory::GetInstance().ClearActivePlugins();
+
+    return success && !reader.IsFailed();
+  }
+
+  ConfigCache::ConfigCache() :
+    mHits(0),
+    mSharedHits(0),
+    mMisses(0)
+  {
+  }
+
+  ConfigCache::~ConfigCache()
+  {
+    for (SharedConfigMap::iterator it = mSharedConfigs.begin(); it != mSharedConfigs.end(); it++)
+    {
+      SHARED_CONFIG& shared = it->second;
+
+      //remove the segments published by this process unless a newer image was published since.
+      //processes which have mapped the segments can still use them.
+      const SHARED_CONFIG_HEADER* header = static_cast<const SHARED_CONFIG_HEADER*>(shared.control->GetData());
+      if (shared.published && header->generation.load(std::memory_order_acquire) == shared.generation)
+      {
+        SharedMemory::Remove(shared.image->GetName());
+        SharedMemory::Remove(shared.control->GetName());
+      }
+
+      delete shared.control;
+      delete shared.image;
+    }
+    mSharedConfigs.clear();
+  }
+
+  const std::string& ConfigCache::GetDirectory() const
+  {
+    return mDirectory;
+  }
+
+  void ConfigCache::SetDirectory(const std::string& directory)
+  {
+    mDirectory = directory;
+  }
+
+  std::string ConfigCache::GetCacheFilePath(const std::string& path) const
+  {
+    if (mDirectory.empty())
+      return std::string();
+
+    //name the compiled file after the path of the configuration file
+    std::string file_name = ra::strings::ToString(GetContentHash(path)) + CACHE_FILE_EXTENSION;
+    std::string cache_path = mDirectory + ra::filesystem::GetPathSeparatorStr() + file_name;
+    return cache_path;
+  }
+
+  const std::string& ConfigCache::GetSharedMemoryName() const
+  {
+    return mSharedMemoryName;
+  }
+
+  void ConfigCache::SetSharedMemoryName(const std::string& name)
+  {
+    mSharedMemoryName = name;
+  }
+
+  std::string ConfigCache::GetSharedMemoryName(const std::string& path) const
+  {
+    if (mSharedMemoryName.empty())
+      return std::string();
+
+    //name the segment after the path of the configuration file
+    std::string segment_name = mSharedMemoryName + "." + ra::strings::ToString(GetContentHash(path));
+    return segment_name;
+  }
+
+  void ConfigCache::ReleaseSharedMemory(const std::string& path)
+  {
+    std::string control_name = GetSharedMemoryName(path);
+    if (control_name.empty())
+      return;
+
+    std::lock_guard<std::mutex> lock(mSharedConfigsMutex);
+    SharedConfigMap::iterator it = mSharedConfigs.find(control_name);
+    if (it == mSharedConfigs.end())
+      return;
+
+    SHARED_CONFIG& shared = it->second;
+    delete shared.control;
+    delete shared.image;
+    mSharedConfigs.erase(it);
+  }
+
+  void ConfigCache::RemoveSharedMemory(const std::string& path)
+  {
+    std::string control_name = GetSharedMemoryName(path);
+    if (control_name.empty())
+      return;
+
+    ReleaseSharedMemory(path);
+
+    //remove the segment of the last published image and the segment of its generation
+    SharedMemory control;
+    if (control.Open(control_name, true) && control.GetSize() >= sizeof(SHARED_CONFIG_HEADER))
+    {
+      const SHARED_CONFIG_HEADER* header = static_cast<const SHARED_CONFIG_HEADER*>(control.GetData());
+      uint32_t generation = header->generation.load(std::memory_order_acquire);
+      if (generation != 0)
+        SharedMemory::Remove(control_name + "." + ra::strings::ToString(generation));
+    }
+    SharedMemory::Remove(control_name);
+  }
+
+  ConfigFile* ConfigCache::LoadFile(const std::string& path, std::string& error)
+  {
+    if (mDirectory.empty() && mSharedMemoryName.empty())
+      return ConfigFile::LoadFile(path, error);
+
+    //read the xml file once to identify its compiled image
+    std::string content;
+    if (!ra::filesystem::ReadFileUtf8(path, content))
+      return ConfigFile::LoadFile(path, error); //reports the error
+
+    //an image published by another process is read without reading any compiled file
+    ConfigFile* config = LoadSharedImage(path, content);
+    if (config)
+    {
+      error = "";
+      mSharedHits++;
+      return config;
+    }
+
+    std::string image;
+    config = LoadCacheFile(path, content, image);
+    if (config)
+    {
+      SaveSharedImage(path, image);
+      error = "";
+      mHits++;
+      return config;
+    }
+    mMisses++;
+
+    //parse the xml file while remembering the source of each action
+    ObjectFactory& factory = ObjectFactory::GetInstance();
+    ObjectFactory::ActionSourceMap sources;
+    ObjectFactory::ActionSourceMap* previous_sources = factory.SetActionSources(&sources);
+    config = ConfigFile::LoadFile(path, content, error);
+    factory.SetActionSources(previous_sources);
+
+    if (config)
+    {
+      if (!BuildCacheImage(*config, content, sources, image))
+      {
+        SA_LOG(WARNING) << "Failed to compile configuration file '" << path << "'.";
+      }
+      else
+      {
+        if (!mDirectory.empty() && !SaveCacheFile(path, image))
+          SA_LOG(WARNING) << "Failed to save compiled configuration file '" << path << "' in directory '" << mDirectory << "'.";
+        SaveSharedImage(path, image);
+      }
+    }
+
+    return config;
+  }
+
+  size_t ConfigCache::GetHitCount() const
+  {
+    return mHits;
+  }
+
+  size_t ConfigCache::GetSharedHitCount() const
+  {
+    return mSharedHits;
+  }
+
+  size_t ConfigCache::GetMissCount() const
+  {
+    return mMisses;
+  }
+
+  ConfigFile* ConfigCache::LoadCacheFile(const std::string& path, const std::string& content, std::string& image)
+  {
+    std::string cache_path = GetCacheFilePath(path);
+    if (cache_path.empty() || !ra::filesystem::FileExistsUtf8(cache_path.c_str()))
+      return NULL;
+
+    //read the whole compiled file at once
+    if (!ra::filesystem::ReadFileUtf8(cache_path, image))
+      return NULL;
+
+    ConfigFile* config = ReadCacheImage(path, content, image.c_str(), image.size(), cache_path);
+    return config;
+  }
+
+  ConfigFile* ConfigCache::ReadCacheImage(const std::string& path, const std::string& content, const char* image, size_t size, const std::string& source) const
+  {
+    if (size < sizeof(uint64_t))
+      return NULL;
+
+    //the image ends with the hash of its data. A partially written image is ignored.
+    size_t data_size = size - sizeof(uint64_t);
+    CacheReader hash_reader(image + data_size, sizeof(uint64_t));
+    if (hash_reader.ReadUInt64() != GetContentHash(image, data_size))
+    {
+      SA_LOG(WARNING) << "Compiled configuration '" << source << "' is corrupted.";
+      return NULL;
+    }
+
+    //validate the key of the image
+    CacheReader reader(image, data_size);
+    std::string magic = reader.ReadString();
+    uint32_t version = reader.ReadUInt32();
+    std::string file_path = reader.ReadString();
+    uint64_t file_size = reader.ReadUInt64();
+    uint64_t file_modified_date = reader.ReadUInt64();
+    uint64_t file_hash = reader.ReadUInt64();
+    if (reader.IsFailed() ||
+        magic != CACHE_FILE_MAGIC ||
+        version != FORMAT_VERSION ||
+        file_path != path ||
+        file_size != content.size() ||
+        file_modified_date != ra::filesystem::GetFileModifiedDateUtf8(path) ||
+        file_hash != GetContentHash(content))
+    {
+      SA_LOG(INFO) << "Compiled configuration '" << source << "' is not up to date.";
+      return NULL;
+    }
+
+    ConfigFile* config = new ConfigFile();
+    config->SetFilePath(path);
+    config->SetFileModifiedDate(file_modified_date);
+
+    //allocate the menus, validators and actions of the configuration from its arena
+    MemoryArena* previous_arena = MemoryArena::SetCurrentArena(&config->GetArena());
+    bool read = ReadConfigFile(reader, config);
+    MemoryArena::SetCurrentArena(previous_arena);
+
+    if (!read)
+    {
+      SA_LOG(WARNING) << "Failed to read compiled configuration '" << source << "'.";
+      delete config;
+      return NULL;
+    }
+
+    SA_LOG(INFO) << "Configuration file '" << path << "' loaded from compiled configuration '" << source << "'.";
+    return config;
+  }
+
+  bool ConfigCache::BuildCacheImage(const ConfigFile& config, const std::string& content, const ObjectFactory::ActionSourceMap& sources, std::string& image) const
+  {
+    CacheWriter writer;
+    writer.WriteString(CACHE_FILE_MAGIC);
+    writer.WriteUInt32(FORMAT_VERSION);
+    writer.WriteString(config.GetFilePath());
+    writer.WriteUInt64(content.size());
+    writer.WriteUInt64(config.GetFileModifiedDate());
+    writer.WriteUInt64(GetContentHash(content));
+    if (!WriteConfigFile(writer, config, sources))
+      return false;
+
+    //end the image with the hash of its data
+    const std::string& data = writer.GetBuffer();
+    writer.WriteUInt64(GetContentHash(data));
+
+    image = writer.GetBuffer();
+    return true;
+  }
+
+  bool ConfigCache::SaveCacheFile(const std::string& path, const std::string& image)
+  {
+    //the directory may be created by another thread at the same time
+    if (!ra::filesystem::DirectoryExistsUtf8(mDirectory.c_str()) &&
+        !ra::filesystem::CreateDirectoryUtf8(mDirectory.c_str()) &&
+        !ra::filesystem::DirectoryExistsUtf8(mDirectory.c_str()))
+      return false;
+
+    std::string cache_path = GetCacheFilePath(path);
+    bool saved = ra::filesystem::WriteFileUtf8(cache_path, image);
+    return saved;
+  }
+
+  ConfigFile* ConfigCache::LoadSharedImage(const std::string& path, const std::string& content)
+  {
+    std::string control_name = GetSharedMemoryName(path);
+    if (control_name.empty())
+      return NULL;
+
+    //get the generation of the last published image
+    SharedMemory* control = new SharedMemory();
+    if (!control->Open(control_name, true) || control->GetSize() < sizeof(SHARED_CONFIG_HEADER))
+    {
+      delete control;
+      return NULL;
+    }
+    const SHARED_CONFIG_HEADER* header = static_cast<const SHARED_CONFIG_HEADER*>(control->GetData());
+    uint32_t generation = header->generation.load(std::memory_order_acquire);
+    if (memcmp(header->magic, SHARED_MEMORY_MAGIC, sizeof(SHARED_MEMORY_MAGIC)) != 0 || header->version != FORMAT_VERSION || generation == 0)
+    {
+      delete control;
+      return NULL;
+    }
+
+    //map the image read-only. The image may have been replaced by a newer generation since.
+    SharedMemory* segment = new SharedMemory();
+    std::string image_name = control_name + "." + ra::strings::ToString(generation);
+    if (!segment->Open(image_name, true) || segment->GetSize() < sizeof(SHARED_IMAGE_HEADER))
+    {
+      delete control;
+      delete segment;
+      return NULL;
+    }
+    const SHARED_IMAGE_HEADER* image_header = static_cast<const SHARED_IMAGE_HEADER*>(segment->GetData());
+    const char* image = static_cast<const char*>(segment->GetData()) + sizeof(SHARED_IMAGE_HEADER);
+    ConfigFile* config = NULL;
+    if (memcmp(image_header->magic, SHARED_MEMORY_MAGIC, sizeof(SHARED_MEMORY_MAGIC)) == 0 &&
+        image_header->size <= segment->GetSize() - sizeof(SHARED_IMAGE_HEADER))
+      config = ReadCacheImage(path, content, image, (size_t)image_header->size, image_name);
+
+    if (config == NULL)
+    {
+      delete control;
+      delete segment;
+      return NULL;
+    }
+
+    //keep the segments mapped while they are used by other processes
+    SHARED_CONFIG shared;
+    shared.control = control;
+    shared.image = segment;
+    shared.generation = generation;
+    shared.published = false;
+    KeepSharedMemory(control_name, shared);
+    return config;
+  }
+
+  bool ConfigCache::SaveSharedImage(const std::string& path, const std::string& image)
+  {
+    std::string control_name = GetSharedMemoryName(path);
+    if (control_name.empty())
+      return false;
+
+    //the first process creates the segment of the generations
+    SharedMemory* control = new SharedMemory();
+    if (control->Create(control_name, sizeof(SHARED_CONFIG_HEADER)))
+    {
+      SHARED_CONFIG_HEADER* header = static_cast<SHARED_CONFIG_HEADER*>(control->GetData());
+      header->version = FORMAT_VERSION;
+      std::atomic_thread_fence(std::memory_order_release);
+      memcpy(header->magic, SHARED_MEMORY_MAGIC, sizeof(SHARED_MEMORY_MAGIC));
+    }
+    else if (!control->Open(control_name, false) || control->GetSize() < sizeof(SHARED_CONFIG_HEADER))
+    {
+      SA_LOG(WARNING) << "Failed to open shared memory '" << control_name << "'.";
+      delete control;
+      return false;
+    }
+    SHARED_CONFIG_HEADER* header = static_cast<SHARED_CONFIG_HEADER*>(control->GetData());
+    if (memcmp(header->magic, SHARED_MEMORY_MAGIC, sizeof(SHARED_MEMORY_MAGIC)) != 0 || header->version != FORMAT_VERSION)
+    {
+      //the segment is being created by another process or belongs to another version
+      delete control;
+      return false;
+    }
+
+    //write the image in the segment of a new generation
+    uint32_t generation = header->next_generation.fetch_add(1) + 1;
+    std::string image_name = control_name + "." + ra::strings::ToString(generation);
+    SharedMemory* segment = new SharedMemory();
+    if (!segment->Create(image_name, sizeof(SHARED_IMAGE_HEADER) + image.size()))
+    {
+      SA_LOG(WARNING) << "Failed to create shared memory '" << image_name << "'.";
+      delete control;
+      delete segment;
+      return false;
+    }
+    SHARED_IMAGE_HEADER* image_header = static_cast<SHARED_IMAGE_HEADER*>(segment->GetData());
+    image_header->size = image.size();
+    memcpy(static_cast<char*>(segment->GetData()) + sizeof(SHARED_IMAGE_HEADER), image.c_str(), image.size());
+    memcpy(image_header->magic, SHARED_MEMORY_MAGIC, sizeof(SHARED_MEMORY_MAGIC));
+
+    //publish the new generation unless a newer one was published by another process
+    uint32_t previous = header->generation.load(std::memory_order_acquire);
+    while (previous < generation && !header->generation.compare_exchange_weak(previous, generation, std::memory_order_acq_rel))
+    {
+    }
+
+    if (previous > generation)
+    {
+      //the image is already older than the published one
+      SharedMemory::Remove(image_name);
+      delete control;
+      delete segment;
+      return false;
+    }
+
+    //processes which have mapped the previous image can still read it
+    if (previous != 0)
+      SharedMemory::Remove(control_name + "." + ra::strings::ToString(previous));
+
+    SA_LOG(INFO) << "Configuration file '" << path << "' published in shared memory '" << image_name << "'.";
+    SHARED_CONFIG shared;
+    shared.control = control;
+    shared.image = segment;
+    shared.generation = generation;
+    shared.published = true;
+    KeepSharedMemory(control_name, shared);
+    return true;
+  }
+
+  void ConfigCache::KeepSharedMemory(const std::string& name, const SHARED_CONFIG& shared)
+  {
+    std::lock_guard<std::mutex> lock(mSharedConfigsMutex);
+
+    //the segments of a previous generation are released
+    SharedConfigMap::iterator it = mSharedConfigs.find(name);
+    if (it != mSharedConfigs.end())
+    {
+      SHARED_CONFIG& previous = it->second;
+      delete previous.control;
+      delete previous.image;
+    }
+
+    mSharedConfigs[name] = shared;
+  }
+
+} //namespace shellanything
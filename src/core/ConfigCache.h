@@ -0,0 +1,179 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_CONFIGCACHE_H
+#define SA_CONFIGCACHE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "ConfigFile.h"
+#include "ObjectFactory.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <map>
+
+namespace shellanything
+{
+  class SharedMemory;
+
+  /// <summary>
+  /// A cache of compiled configuration files.
+  /// When a configuration file is loaded from xml, its menus, validators, icons, actions and plugin declarations
+  /// are compiled into a binary file in the cache directory. The next loads of the same configuration file
+  /// read the compiled file instead of parsing the xml file.
+  /// A compiled file is identified by the path, the size, the modified date and the content hash of its xml file.
+  /// The xml file is parsed again when it is modified.
+  /// Compiled configurations can also be shared with other processes in shared memory. See SetSharedMemoryName().
+  /// </summary>
+  class SHELLANYTHING_EXPORT ConfigCache
+  {
+  public:
+    ConfigCache();
+    virtual ~ConfigCache();
+
+  private:
+    // Disable copy constructor and copy operator
+    ConfigCache(const ConfigCache&);
+    ConfigCache& operator=(const ConfigCache&);
+  public:
+
+    /// <summary>
+    /// The version of the compiled file format. Compiled files of other versions are ignored.
+    /// </summary>
+    static const uint32_t FORMAT_VERSION;
+
+    /// <summary>
+    /// Get the directory of the compiled files.
+    /// </summary>
+    const std::string& GetDirectory() const;
+
+    /// <summary>
+    /// Set the directory of the compiled files. The directory is created when the first file is compiled.
+    /// </summary>
+    /// <param name="directory">The path of the directory. Set to an empty string to disable the cache.</param>
+    void SetDirectory(const std::string& directory);
+
+    /// <summary>
+    /// Get the path of the compiled file of a configuration file.
+    /// </summary>
+    /// <param name="path">The path of the configuration file.</param>
+    /// <returns>Returns the path of the compiled file. Returns an empty string if the cache is disabled.</returns>
+    std::string GetCacheFilePath(const std::string& path) const;
+
+    /// <summary>
+    /// Get the name prefix of the shared memory segments of the compiled configurations.
+    /// </summary>
+    const std::string& GetSharedMemoryName() const;
+
+    /// <summary>
+    /// Set the name prefix of the shared memory segments of the compiled configurations.
+    /// The first process which compiles a configuration file publishes the compiled configuration in a shared memory segment.
+    /// The other processes map the segment read-only and read the configuration from it instead of parsing the xml file or reading the compiled file.
+    /// Each configuration file has a generation counter. A newer compiled configuration is published under the next generation.
+    /// On Linux, the segments exist until they are removed. The segments published by a process are removed when its cache is destroyed, unless a newer generation was published since.
+    /// On Windows, the segments cannot be removed. A segment is destroyed when the last process which maps it unmaps it.
+    /// A process keeps the segments of a configuration mapped until the configuration is unloaded. See ReleaseSharedMemory().
+    /// </summary>
+    /// <param name="name">The name prefix of the segments. Set to an empty string to disable the shared memory.</param>
+    void SetSharedMemoryName(const std::string& name);
+
+    /// <summary>
+    /// Get the name of the shared memory segment which identifies the generation of the compiled configuration of a configuration file.
+    /// </summary>
+    /// <param name="path">The path of the configuration file.</param>
+    /// <returns>Returns the name of the segment. Returns an empty string if the shared memory is disabled.</returns>
+    std::string GetSharedMemoryName(const std::string& path) const;
+
+    /// <summary>
+    /// Unmap the shared memory segments of a configuration file which are kept mapped by this process.
+    /// The segments are not removed. On Windows, the segments are destroyed if no other process maps them.
+    /// </summary>
+    /// <param name="path">The path of the configuration file.</param>
+    void ReleaseSharedMemory(const std::string& path);
+
+    /// <summary>
+    /// Unmap and remove the shared memory segments of a configuration file. Processes which have mapped the segments can still use them.
+    /// </summary>
+    /// <param name="path">The path of the configuration file.</param>
+    void RemoveSharedMemory(const std::string& path);
+
+    /// <summary>
+    /// Load a configuration file.
+    /// The configuration is read from shared memory or from its compiled file if the compiled configuration is up to date.
+    /// Otherwise, the configuration is parsed from xml and compiled for the next loads. See ConfigFile::LoadFile().
+    /// Different configuration files can be loaded by multiple threads at the same time.
+    /// </summary>
+    /// <param name="path">The path of the configuration file.</param>
+    /// <param name="error">The error description if the loading failed.</param>
+    /// <returns>Returns a valid ConfigFile pointer if the file was properly loaded. Returns NULL otherwise.</returns>
+    ConfigFile* LoadFile(const std::string& path, std::string& error);
+
+    /// <summary>
+    /// Get the number of configurations that were read from their compiled file.
+    /// </summary>
+    size_t GetHitCount() const;
+
+    /// <summary>
+    /// Get the number of configurations that were read from shared memory.
+    /// </summary>
+    size_t GetSharedHitCount() const;
+
+    /// <summary>
+    /// Get the number of configurations that were parsed from xml.
+    /// </summary>
+    size_t GetMissCount() const;
+
+  private:
+    ConfigFile* LoadCacheFile(const std::string& path, const std::string& content, std::string& image);
+    ConfigFile* ReadCacheImage(const std::string& path, const std::string& content, const char* image, size_t size, const std::string& source) const;
+    bool BuildCacheImage(const ConfigFile& config, const std::string& content, const ObjectFactory::ActionSourceMap& sources, std::string& image) const;
+    bool SaveCacheFile(const std::string& path, const std::string& image);
+    ConfigFile* LoadSharedImage(const std::string& path, const std::string& content);
+    bool SaveSharedImage(const std::string& path, const std::string& image);
+
+    // The shared memory segments of a configuration file which are kept mapped.
+    struct SHARED_CONFIG
+    {
+      SharedMemory* control;  // the generation of the last published image
+      SharedMemory* image;    // the compiled image
+      uint32_t generation;    // the generation of the image
+      bool published;         // true if the image was published by this process
+    };
+    void KeepSharedMemory(const std::string& name, const SHARED_CONFIG& shared);
+    typedef std::map<std::string /*segment name*/, SHARED_CONFIG> SharedConfigMap;
+
+    std::string mDirectory;
+    std::string mSharedMemoryName;
+    std::atomic<size_t> mHits;
+    std::atomic<size_t> mSharedHits;
+    std::atomic<size_t> mMisses;
+    SharedConfigMap mSharedConfigs; // on Windows, a segment is destroyed when the last process closes it. See ReleaseSharedMemory().
+    std::mutex mSharedConfigsMutex;
+  };
+
+} //namespace shellanything
+
+#endif //SA_CONFIGCACHE_H
@@ -25,14 +25,18 @@
 #include "ConfigFile.h"
 #include "SelectionContext.h"
 #include "ActionProperty.h"
+#include "PropertyManager.h"
 #include "ObjectFactory.h"
 #include "LoggerHelper.h"
+#include "CaseFolding.h"
+#include "XmlScanner.h"
 
 #include "rapidassist/filesystem_utf8.h"
-#include "rapidassist/random.h"
 
 #include "tinyxml2.h"
 
+#include <algorithm>
+
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN 1
 #endif
@@ -47,33 +51,20 @@ using namespace tinyxml2;
 
 namespace shellanything
 {
-  static ConfigFile* gUpdatingConfigFile = NULL;
+  // Each thread updates its own configuration. See ConfigManager::SetUpdateThreadCount().
+  static thread_local ConfigFile* gUpdatingConfigFile = NULL;
 
-  std::string GetXmlEncoding(XMLDocument& doc, std::string& error)
+  std::string GetXmlEncoding(const std::string& declaration, std::string& error)
   {
-    XMLNode* first = doc.FirstChild();
-    if (!first)
-    {
-      error = "XML declaration not found.";
-      return "";
-    }
-
-    XMLDeclaration* declaration = first->ToDeclaration();
-    if (!declaration)
+    if (declaration.empty())
     {
       error = "XML declaration not found.";
       return "";
     }
 
-    if (declaration->Value() == NULL)
-    {
-      error = "XML declaration is empty.";
-      return "";
-    }
-
     //expecting: xml version="1.0" encoding="utf-8"
     static const std::string ENCODING_IDENTIFIER = "ENCODING=\"";
-    const std::string str = declaration->Value();
+    const std::string& str = declaration;
     size_t pos_start = ra::strings::Uppercase(str).find(ENCODING_IDENTIFIER);
     if (pos_start == std::string::npos)
     {
@@ -96,91 +87,45 @@ namespace shellanything
     return encoding;
   }
 
-  ConfigFile::ConfigFile() :
-    mFileModifiedDate(0),
-    mDefaults(NULL)
+  // Parse a scanned element alone.
+  const XMLElement* ParseElement(XMLDocument& doc, const std::string& content, const XmlScanner::ELEMENT& element, std::string& error)
   {
-  }
-
-  ConfigFile::~ConfigFile()
-  {
-    DeleteChildren();
-  }
-
-  ConfigFile* ConfigFile::GetUpdatingConfigFile()
-  {
-    return gUpdatingConfigFile;
-  }
-
-  void ConfigFile::SetUpdatingConfigFile(ConfigFile* config_file)
-  {
-    gUpdatingConfigFile = config_file;
-  }
-
-  ConfigFile* ConfigFile::LoadFile(const std::string& path, std::string& error)
-  {
-    error = "";
-
-    if (!ra::filesystem::FileExistsUtf8(path.c_str()))
+    XMLError result = doc.Parse(content.c_str() + element.offset, element.length);
+    const int line_offset = (int)element.line - 1;
+    if (result != XML_SUCCESS)
     {
-      error = "File '" + path + "' not found.";
+      error = std::string(doc.ErrorName()) + " at line " + ra::strings::ToString(line_offset + doc.ErrorLineNum()) + ".";
       return NULL;
     }
 
-    uint64_t file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(path.c_str());
-
-    //Parse the xml file
-    //http://leethomason.github.io/tinyxml2/
-
-    XMLDocument doc;
-    XMLError result = doc.LoadFile(path.c_str());
-    if (result == XML_ERROR_FILE_NOT_FOUND)
-    {
-      //We already validated that file exists. This is probably because the file path is utf-8 encoded.
-      //This is not supported by TinyXML.
-
-      //As a workaround, copy the file to a temp directory with a non utf-8 path
-      std::string temp_filename;
-      ra::random::GetRandomString(temp_filename, 10);
-      temp_filename.append(".xml");
-      std::string temp_path = ra::filesystem::GetTemporaryDirectory() + ra::filesystem::GetPathSeparatorStr() + temp_filename;
-      bool copied = ra::filesystem::CopyFileUtf8(path, temp_path);
-      if (!copied)
-      {
-        error.clear();
-        error << "Failed to copy file '" << path << "' to '" << temp_path << "'.";
-        return NULL;
-      }
-
-      //and load the new temp file
-      result = doc.LoadFile(temp_path.c_str());
+    //report the line numbers of the element in the file
+    ObjectFactory::GetInstance().SetLineOffset(line_offset);
 
-      //cleanup
-      ra::filesystem::DeleteFile(temp_path.c_str());
-    }
+    const XMLElement* xml_element = doc.FirstChildElement();
+    return xml_element;
+  }
 
-    if (result != XML_SUCCESS)
+  // Scan a configuration file and find its <root> and <shell> elements.
+  bool ScanConfigFile(const std::string& content, XmlScanner::ElementList& elements, size_t& root_index, size_t& shell_index, std::string& error)
+  {
+    //Scan the xml file. The scanner validates the whole file without building a document.
+    //The elements under <shell> are then parsed one at a time.
+    //http://leethomason.github.io/tinyxml2/
+    XmlScanner scanner;
+    if (!scanner.Scan(content.c_str(), content.size(), 2, elements))
     {
-      if (doc.ErrorStr())
-      {
-        error = doc.ErrorStr();
-        return NULL;
-      }
-      else
-      {
-        error = "Unknown error reported by XML library.";
-        return NULL;
-      }
+      error = scanner.GetError();
+      return false;
     }
 
     //get xml encoding
-    std::string encoding = GetXmlEncoding(doc, error);
+    std::string encoding = GetXmlEncoding(scanner.GetDeclaration(), error);
     if (encoding.empty())
     {
       //Not an utf-8 encoded file.
       error.clear();
       error << "File is not encoded in UTF-8.";
-      return NULL;
+      return false;
     }
 
     //validate utf-8 encoding
@@ -191,53 +136,143 @@ namespace shellanything
       //Not an utf-8 encoded file.
       error.clear();
       error << "File is not encoded in UTF-8. Encoding found is '" << encoding << "'.";
-      return NULL;
+      return false;
     }
 
-    const XMLElement* xml_root = XMLHandle(&doc).FirstChildElement("root").ToElement();
-    if (!xml_root)
+    root_index = XmlScanner::FindChild(elements, XmlScanner::INVALID_INDEX, "root");
+    if (root_index == XmlScanner::INVALID_INDEX)
     {
       error = "Node <root> not found";
-      return NULL;
+      return false;
     }
 
-    const XMLElement* xml_shell = XMLHandle(&doc).FirstChildElement("root").FirstChildElement("shell").ToElement();
-    if (!xml_shell)
+    shell_index = XmlScanner::FindChild(elements, root_index, "shell");
+    if (shell_index == XmlScanner::INVALID_INDEX)
     {
       error = "Node <shell> not found";
-      return NULL;
+      return false;
     }
 
-    ConfigFile* config = new ConfigFile();
-    config->SetFilePath(path);
-    config->SetFileModifiedDate(file_modified_date);
+    return true;
+  }
+
+  // Parse the <default> elements of a scanned configuration file. The last <default> element wins.
+  bool ParseDefaultElements(XMLDocument& doc, const std::string& content, const XmlScanner::ElementList& elements, size_t shell_index, DefaultSettings*& defaults, std::string& error)
+  {
+    ObjectFactory& factory = ObjectFactory::GetInstance();
+    defaults = NULL;
 
     //find <default> nodes under <shell>
-    const XMLElement* xml_defaults = xml_shell->FirstChildElement("default");
-    while (xml_defaults)
+    size_t defaults_index = XmlScanner::FindChild(elements, shell_index, "default");
+    while (defaults_index != XmlScanner::INVALID_INDEX)
     {
+      const XMLElement* xml_defaults = ParseElement(doc, content, elements[defaults_index], error);
+      if (xml_defaults == NULL)
+      {
+        delete defaults;
+        defaults = NULL;
+        return false;
+      }
+
       //found a new defaults node
-      DefaultSettings* defaults = ObjectFactory::GetInstance().ParseDefaults(xml_defaults, error);
-      if (defaults != NULL)
+      DefaultSettings* parsed = factory.ParseDefaults(xml_defaults, error);
+      if (parsed != NULL)
       {
-        //add the new menu to the current configuration
-        config->SetDefaultSettings(defaults);
+        parsed->SetSourceHash(XmlScanner::GetHash(content.c_str(), elements[defaults_index]));
+        delete defaults;
+        defaults = parsed;
       }
 
       //next defaults node
-      xml_defaults = xml_defaults->NextSiblingElement("default");
+      defaults_index = XmlScanner::FindNextSibling(elements, defaults_index, "default");
+    }
+
+    return true;
+  }
+
+  // Get the hash of the source of the last <default> element of a scanned configuration file.
+  uint64_t GetDefaultElementsHash(const std::string& content, const XmlScanner::ElementList& elements, size_t shell_index)
+  {
+    uint64_t hash = 0;
+    size_t defaults_index = XmlScanner::FindChild(elements, shell_index, "default");
+    while (defaults_index != XmlScanner::INVALID_INDEX)
+    {
+      hash = XmlScanner::GetHash(content.c_str(), elements[defaults_index]);
+      defaults_index = XmlScanner::FindNextSibling(elements, defaults_index, "default");
     }
+    return hash;
+  }
+
+  // Find an unused menu with the given source hash. Returns the size of the list if no menu is found.
+  size_t FindMenuBySourceHash(const Menu::MenuPtrList& menus, const std::vector<bool>& used, const uint64_t& hash)
+  {
+    if (hash == 0)
+      return menus.size();
+    for (size_t i = 0; i < menus.size(); i++)
+    {
+      if (!used[i] && menus[i]->GetSourceHash() == hash)
+        return i;
+    }
+    return menus.size();
+  }
+
+  size_t GetMenuCount(const Menu* menu)
+  {
+    size_t count = 1;
+    const Menu::MenuPtrList& submenus = menu->GetSubMenus();
+    for (size_t i = 0; i < submenus.size(); i++)
+    {
+      count += GetMenuCount(submenus[i]);
+    }
+    return count;
+  }
+
+  // Deletes an object shared by configurations. The object keeps the arena it was allocated from alive. See ConfigFile::Clone().
+  template <typename T>
+  struct ARENA_OBJECT_DELETER
+  {
+    std::shared_ptr<MemoryArena> arena;
+    void operator()(T* object) const
+    {
+      delete object;
+    }
+  };
+
+  template <typename T>
+  std::shared_ptr<T> MakeSharedObject(T* object, const std::shared_ptr<MemoryArena>& arena)
+  {
+    ARENA_OBJECT_DELETER<T> deleter;
+    deleter.arena = arena;
+    return std::shared_ptr<T>(object, deleter);
+  }
+
+  // Parse the <default>, <plugin> and <menu> elements of a scanned configuration file.
+  bool ParseConfigElements(ConfigFile* config, const std::string& content, const XmlScanner::ElementList& elements, size_t root_index, size_t shell_index, std::string& error)
+  {
+    ObjectFactory& factory = ObjectFactory::GetInstance();
+    XMLDocument doc;
+
+    //parse the <default> nodes under <shell>
+    DefaultSettings* defaults = NULL;
+    if (!ParseDefaultElements(doc, content, elements, shell_index, defaults, error))
+      return false;
+    if (defaults != NULL)
+      config->SetDefaultSettings(defaults);
 
     //find <plugins> nodes under <root>
-    const XMLElement* xml_plugins = xml_root->FirstChildElement("plugins");
-    while (xml_plugins)
+    size_t plugins_index = XmlScanner::FindChild(elements, root_index, "plugins");
+    while (plugins_index != XmlScanner::INVALID_INDEX)
     {
       //find <plugin> nodes under <plugins>
-      const XMLElement* xml_plugin = xml_plugins->FirstChildElement("plugin");
-      while (xml_plugin)
+      size_t plugin_index = XmlScanner::FindChild(elements, plugins_index, "plugin");
+      while (plugin_index != XmlScanner::INVALID_INDEX)
       {
+        const XMLElement* xml_plugin = ParseElement(doc, content, elements[plugin_index], error);
+        if (xml_plugin == NULL)
+          return false;
+
         //found a new plugin node
-        Plugin* plugin = ObjectFactory::GetInstance().ParsePlugin(xml_plugin, error);
+        Plugin* plugin = factory.ParsePlugin(xml_plugin, error);
         if (plugin != NULL)
         {
           // try to load the plugin.
@@ -252,46 +287,285 @@ namespace shellanything
         }
 
         //next xml_plugin node
-        xml_plugin = xml_plugin->NextSiblingElement("plugin");
+        plugin_index = XmlScanner::FindNextSibling(elements, plugin_index, "plugin");
       }
 
       //next plugins node
-      xml_plugins = xml_plugins->NextSiblingElement("plugins");
+      plugins_index = XmlScanner::FindNextSibling(elements, plugins_index, "plugins");
     }
 
     //set active plugins for parsing child elements
     //notify the ObjectParser about this configuration's plugins.
     const Plugin::PluginPtrList& active_plugins = config->GetPlugins();
-    ObjectFactory::GetInstance().SetActivePlugins(active_plugins);
+    factory.SetActivePlugins(active_plugins);
 
     //find <menu> nodes under <shell>
-    const XMLElement* xml_menu = xml_shell->FirstChildElement("menu");
-    while (xml_menu)
+    size_t menu_index = XmlScanner::FindChild(elements, shell_index, "menu");
+    while (menu_index != XmlScanner::INVALID_INDEX)
     {
+      //each menu is parsed alone. Its document is released before the next menu is parsed.
+      const XMLElement* xml_menu = ParseElement(doc, content, elements[menu_index], error);
+      if (xml_menu == NULL)
+        return false;
+
       //found a new menu node
-      Menu* menu = ObjectFactory::GetInstance().ParseMenu(xml_menu, error);
+      Menu* menu = factory.ParseMenu(xml_menu, error);
       if (menu == NULL)
-      {
-        delete config;
-        ObjectFactory::GetInstance().ClearActivePlugins();
-        return NULL;
-      }
+        return false;
+
+      //remember the source of the menu. See ConfigFile::Reload().
+      menu->SetSourceHash(XmlScanner::GetHash(content.c_str(), elements[menu_index]));
 
       //add the new menu to the current configuration
       config->AddMenu(menu);
 
       //next menu node
-      xml_menu = xml_menu->NextSiblingElement("menu");
+      menu_index = XmlScanner::FindNextSibling(elements, menu_index, "menu");
     }
 
+    return true;
+  }
+
+  const size_t ConfigFile::INVALID_NODE_INDEX = (size_t)-1;
+
+  ConfigFile::ConfigFile() :
+    mArena(std::make_shared<MemoryArena>()),
+    mFileModifiedDate(0),
+    mMenuNodesValid(false),
+    mExpandedNamesValid(false),
+    mEvaluation(std::make_shared<EVALUATION_STATE>()),
+    mEvaluatedMenuCount(0),
+    mReplacedMenuCount(0)
+  {
+  }
+
+  ConfigFile::~ConfigFile()
+  {
+    //the menus shared with a clone must not refer to this configuration
+    DetachMenus();
+    DeleteChildren();
+  }
+
+  ConfigFile* ConfigFile::GetUpdatingConfigFile()
+  {
+    return gUpdatingConfigFile;
+  }
+
+  void ConfigFile::SetUpdatingConfigFile(ConfigFile* config_file)
+  {
+    gUpdatingConfigFile = config_file;
+  }
+
+  ConfigFile* ConfigFile::LoadFile(const std::string& path, std::string& error)
+  {
+    error = "";
+
+    if (!ra::filesystem::FileExistsUtf8(path.c_str()))
+    {
+      error = "File '" + path + "' not found.";
+      return NULL;
+    }
+
+    //read the file in memory. This also supports utf-8 file paths.
+    std::string content;
+    if (!ra::filesystem::ReadFileUtf8(path, content))
+    {
+      error = "Failed to read file '" + path + "'.";
+      return NULL;
+    }
+
+    ConfigFile* config = LoadFile(path, content, error);
+    return config;
+  }
+
+  ConfigFile* ConfigFile::LoadFile(const std::string& path, const std::string& content, std::string& error)
+  {
+    error = "";
+
+    uint64_t file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(path.c_str());
+
+    XmlScanner::ElementList elements;
+    size_t root_index = XmlScanner::INVALID_INDEX;
+    size_t shell_index = XmlScanner::INVALID_INDEX;
+    if (!ScanConfigFile(content, elements, root_index, shell_index, error))
+      return NULL;
+
+    ConfigFile* config = new ConfigFile();
+    config->SetFilePath(path);
+    config->SetFileModifiedDate(file_modified_date);
+
+    //allocate the menus, validators and actions of the configuration from its arena
+    MemoryArena* previous_arena = MemoryArena::SetCurrentArena(config->mArena.get());
+    bool parsed = ParseConfigElements(config, content, elements, root_index, shell_index, error);
+    MemoryArena::SetCurrentArena(previous_arena);
+
     //cleanup ObjectFactory plugins.
     ObjectFactory::GetInstance().ClearActivePlugins();
+    ObjectFactory::GetInstance().SetLineOffset(0);
+
+    if (!parsed)
+    {
+      delete config;
+      return NULL;
+    }
 
     return config;
   }
 
+  ConfigFile* ConfigFile::Clone() const
+  {
+    //the plugins of the configuration cannot be shared
+    if (!mPlugins.empty())
+      return NULL;
+
+    ConfigFile* clone = new ConfigFile();
+    clone->mArena = mArena;
+    clone->mDefaults = mDefaults;
+    clone->mFilePath = mFilePath;
+    clone->mFileModifiedDate = mFileModifiedDate;
+    clone->mMenus = mMenus;
+    clone->mSharedMenus = mSharedMenus;
+    clone->mEvaluation = mEvaluation;
+    return clone;
+  }
+
+  bool ConfigFile::Reload(std::string& error, bool& defaults_changed)
+  {
+    error = "";
+    defaults_changed = false;
+    mReplacedMenuCount = 0;
+
+    //the plugins of the configuration may be referenced by the menus
+    if (!mPlugins.empty())
+    {
+      error = "Configuration file declares plugins.";
+      return false;
+    }
+
+    std::string content;
+    if (!ra::filesystem::ReadFileUtf8(mFilePath, content))
+    {
+      error = "Failed to read file '" + mFilePath + "'.";
+      return false;
+    }
+    uint64_t file_modified_date = ra::filesystem::GetFileModifiedDateUtf8(mFilePath.c_str());
+
+    XmlScanner::ElementList elements;
+    size_t root_index = XmlScanner::INVALID_INDEX;
+    size_t shell_index = XmlScanner::INVALID_INDEX;
+    if (!ScanConfigFile(content, elements, root_index, shell_index, error))
+      return false;
+
+    if (XmlScanner::FindChild(elements, root_index, "plugins") != XmlScanner::INVALID_INDEX)
+    {
+      error = "Configuration file declares plugins.";
+      return false;
+    }
+
+    //the changed objects are allocated from a new arena.
+    //The arena of the unchanged objects is released with the last of them.
+    std::shared_ptr<MemoryArena> arena = std::make_shared<MemoryArena>();
+    ObjectFactory& factory = ObjectFactory::GetInstance();
+    XMLDocument doc;
+    factory.SetActivePlugins(mPlugins);
+    MemoryArena* previous_arena = MemoryArena::SetCurrentArena(arena.get());
+
+    //parse the <default> nodes only if they changed
+    bool parsed = true;
+    DefaultSettings* defaults = NULL;
+    uint64_t previous_defaults_hash = (mDefaults ? mDefaults->GetSourceHash() : 0);
+    if (GetDefaultElementsHash(content, elements, shell_index) != previous_defaults_hash)
+    {
+      defaults_changed = true;
+      parsed = ParseDefaultElements(doc, content, elements, shell_index, defaults, error);
+    }
+
+    //parse the <menu> nodes whose source changed
+    MenuSharedPtrList menus;
+    std::vector<bool> kept(mMenus.size(), false);
+    size_t menu_index = XmlScanner::FindChild(elements, shell_index, "menu");
+    while (parsed && menu_index != XmlScanner::INVALID_INDEX)
+    {
+      uint64_t hash = XmlScanner::GetHash(content.c_str(), elements[menu_index]);
+      size_t match = FindMenuBySourceHash(mMenus, kept, hash);
+      if (match < mMenus.size())
+      {
+        //this menu is unchanged
+        kept[match] = true;
+        menus.push_back(mSharedMenus[match]);
+      }
+      else
+      {
+        const XMLElement* xml_menu = ParseElement(doc, content, elements[menu_index], error);
+        Menu* menu = (xml_menu ? factory.ParseMenu(xml_menu, error) : NULL);
+        if (menu == NULL)
+        {
+          parsed = false;
+          break;
+        }
+        menu->SetSourceHash(hash);
+        menu->SetParentConfigFile(this);
+        menus.push_back(MakeSharedObject(menu, arena));
+        mReplacedMenuCount += GetMenuCount(menu);
+      }
+
+      //next menu node
+      menu_index = XmlScanner::FindNextSibling(elements, menu_index, "menu");
+    }
+
+    MemoryArena::SetCurrentArena(previous_arena);
+    factory.ClearActivePlugins();
+    factory.SetLineOffset(0);
+
+    if (!parsed)
+    {
+      //the configuration is unchanged. The parsed menus are deleted with the list.
+      delete defaults;
+      defaults_changed = false;
+      mReplacedMenuCount = 0;
+      return false;
+    }
+
+    //the menus of a clone are replaced while its evaluation lock is held
+    std::lock_guard<std::shared_timed_mutex> lock(mEvaluation->mutex);
+
+    //the previous menus are deleted with the last configuration that uses them.
+    //the unchanged menus are shared with the previous configuration. their parent is not modified.
+    mMenus.clear();
+    mSharedMenus.clear();
+    for (size_t i = 0; i < menus.size(); i++)
+    {
+      AddSharedMenu(menus[i]);
+    }
+
+    if (defaults_changed)
+    {
+      mDefaults.reset();
+      if (defaults != NULL)
+        mDefaults = MakeSharedObject(defaults, arena);
+    }
+
+    mFileModifiedDate = file_modified_date;
+    mEvaluation->last_selection_valid = false;
+
+    return true;
+  }
+
+  const size_t& ConfigFile::GetReplacedMenuCount() const
+  {
+    return mReplacedMenuCount;
+  }
+
   bool ConfigFile::IsValidConfigFile(const std::string& path)
   {
+    bool has_plugins = false;
+    return IsValidConfigFile(path, has_plugins);
+  }
+
+  bool ConfigFile::IsValidConfigFile(const std::string& path, bool& has_plugins)
+  {
+    has_plugins = false;
+
     std::string file_extension = ra::filesystem::GetFileExtention(path);
     file_extension = ra::strings::Uppercase(file_extension);
 
@@ -300,7 +574,8 @@ namespace shellanything
 
     // Peek at the file for known xml elements
     std::string data;
-    bool peeked = ra::filesystem::PeekFileUtf8(path, 1024 * 1024, data);
+    static const size_t MAX_PEEK_SIZE = 1024 * 1024;
+    bool peeked = ra::filesystem::PeekFileUtf8(path, MAX_PEEK_SIZE, data);
     if (!peeked)
       return false;
 
@@ -314,6 +589,9 @@ namespace shellanything
     if (root_element_pos == std::string::npos)
       return false;
 
+    // Search for element <plugins>. The element may be after the peeked data.
+    has_plugins = (data.find("<plugins") != std::string::npos || data.size() >= MAX_PEEK_SIZE);
+
     return true;
   }
 
@@ -337,8 +615,37 @@ namespace shellanything
     mFileModifiedDate = file_modified_date;
   }
 
+  MemoryArena& ConfigFile::GetArena()
+  {
+    return *mArena;
+  }
+
+  const MemoryArena& ConfigFile::GetArena() const
+  {
+    return *mArena;
+  }
+
   void ConfigFile::Update(const SelectionContext& context)
   {
+    EvaluationContext evaluation_context(context);
+    Update(evaluation_context);
+  }
+
+  void ConfigFile::Update(const EvaluationContext& context)
+  {
+    //the state of the menus is written by a single thread at a time
+    std::lock_guard<std::shared_timed_mutex> lock(mEvaluation->mutex);
+
+    //the validators of this configuration evaluate with this configuration
+    EvaluationContext config_context = context;
+    config_context.SetConfigFile(this);
+    const EvaluationContext* previous_context = EvaluationContext::SetCurrent(&config_context);
+    const SelectionContext& selection = config_context.GetSelectionContext();
+
+    //the menus are evaluated with a consistent view of the properties
+    PropertyManager& pmgr = config_context.GetPropertyManager();
+    pmgr.BeginRead();
+
     SetUpdatingConfigFile(this);
 
     //run callbacks of each plugins
@@ -351,21 +658,73 @@ namespace shellanything
       for (size_t j = 0; j < count; j++)
       {
         IUpdateCallback* callback = registry.GetUpdateCallbackFromIndex(j);
-        callback->SetSelectionContext(&context);
+        callback->SetSelectionContext(&selection);
         callback->OnNewSelection();
         callback->SetSelectionContext(NULL);
       }
     }
 
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+
+    //menus that depends on the selection must be evaluated again if the selected elements changed
+    const StringList& elements = selection.GetElements();
+    bool selection_changed = (!mEvaluation->last_selection_valid || mEvaluation->last_selection != elements);
+    mEvaluation->last_selection = elements;
+    mEvaluation->last_selection_valid = true;
+
+    //update each menu. parents are updated before their children.
+    mEvaluatedMenuCount = 0;
+    for (size_t i = 0; i < mMenuNodes.size(); i++)
     {
-      Menu* child = children[i];
-      child->Update(context);
+      MENU_NODE& node = mMenuNodes[i];
+      if (node.menu->UpdateStateIfChanged(config_context, selection_changed))
+        mEvaluatedMenuCount++;
+      node.visible = node.menu->IsVisible();
+      node.enabled = node.menu->IsEnabled();
+    }
+
+    //Issue #4 - Parent menu with no children.
+    //scan in reverse order to resolve the visibility of all children before their parent.
+    for (size_t i = mMenuNodes.size(); i > 0; i--)
+    {
+      MENU_NODE& node = mMenuNodes[i - 1];
+      if (node.first_child == INVALID_NODE_INDEX || !node.visible)
+        continue;
+
+      bool all_invisible_children = true;
+      for (size_t child = node.first_child; child != INVALID_NODE_INDEX && all_invisible_children; child = mMenuNodes[child].next_sibling)
+      {
+        all_invisible_children = !mMenuNodes[child].visible;
+      }
+
+      //if all the direct children of this menu are invisible
+      if (all_invisible_children)
+      {
+        //force this node as invisible.
+        node.visible = false;
+        node.menu->SetVisible(false);
+      }
     }
 
     SetUpdatingConfigFile(NULL);
+    pmgr.EndRead();
+    EvaluationContext::SetCurrent(previous_context);
+  }
+
+  size_t ConfigFile::GetEvaluatedMenuCount() const
+  {
+    return mEvaluatedMenuCount;
+  }
+
+  void ConfigFile::BeginRead() const
+  {
+    mEvaluation->mutex.lock_shared();
+  }
+
+  void ConfigFile::EndRead() const
+  {
+    mEvaluation->mutex.unlock_shared();
   }
 
   void ConfigFile::ApplyDefaultSettings()
@@ -389,6 +748,9 @@ namespace shellanything
       }
 
       //apply all ActionProperty
+      //the default properties are published all at once
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.BeginBatch();
       SelectionContext empty_context;
       for (size_t i = 0; i < properties.size(); i++)
       {
@@ -398,23 +760,42 @@ namespace shellanything
         {
           //no need to look for failures. ActionProperty never fails.
           action_property->Execute(empty_context);
+
+          //default properties do not change between selections
+          std::string name = pmgr.Expand(action_property->GetName());
+          pmgr.SetStableProperty(name, true);
         }
       }
+      pmgr.EndBatch();
 
       SA_LOG(INFO) << __FUNCTION__ << "(), execution of default properties of configuration file '" << mFilePath.c_str() << "' completed.";
     }
   }
 
-  Menu* ConfigFile::FindMenuByCommandId(const uint32_t& command_id)
+  void ConfigFile::FoldConstants()
   {
+    std::lock_guard<std::shared_timed_mutex> lock(mEvaluation->mutex);
+
     //for each child
-    Menu::MenuPtrList children = GetMenus();
+    const Menu::MenuPtrList& children = mMenus;
     for (size_t i = 0; i < children.size(); i++)
     {
       Menu* child = children[i];
-      Menu* match = child->FindMenuByCommandId(command_id);
-      if (match)
-        return match;
+      child->FoldConstants();
+    }
+  }
+
+  Menu* ConfigFile::FindMenuByCommandId(const uint32_t& command_id)
+  {
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+
+    //for each menu
+    for (size_t i = 0; i < mMenuNodes.size(); i++)
+    {
+      const MENU_NODE& node = mMenuNodes[i];
+      if (node.command_id == command_id)
+        return node.menu;
     }
 
     return NULL;
@@ -422,29 +803,93 @@ namespace shellanything
 
   Menu* ConfigFile::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
   {
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+
+    // Select the index matching the search flags.
+    bool case_insensitive = ((flags & FIND_BY_NAME_CASE_INSENSITIVE) != 0);
+    if ((flags & FIND_BY_NAME_EXPANDS) == 0 && !case_insensitive)
     {
-      Menu* child = children[i];
-      Menu* match = child->FindMenuByName(name, flags);
-      if (match)
-        return match;
+      //a name that is not in the string pool is not the name of any menu
+      InternedString interned_name;
+      if (!InternedString::Find(name, interned_name))
+        return NULL;
+
+      InternedNameIndex::const_iterator it = mNames.find(interned_name);
+      if (it == mNames.end())
+        return NULL;
+
+      size_t node_index = it->second;
+      return mMenuNodes[node_index].menu;
     }
+    else if (flags & FIND_BY_NAME_EXPANDS)
+    {
+      //the expanded names are shared by the readers of the configuration
+      std::lock_guard<std::mutex> lock(mExpandedNamesMutex);
 
-    return NULL;
+      //expanded names are out of date if a property referenced by a name has changed
+      if (!mExpandedNamesValid || mExpandedNamesDependencies.IsChanged())
+      {
+        PropertyManager& pmgr = PropertyManager::GetInstance();
+        mExpandedNamesDependencies.Clear();
+        PropertyDependencies* previous_recorder = pmgr.SetDependencyRecorder(&mExpandedNamesDependencies);
+        BuildNameIndex(mExpandedNames, mFoldedExpandedNames, true);
+        pmgr.SetDependencyRecorder(previous_recorder);
+        mExpandedNamesValid = true;
+      }
+
+      const MenuNameIndex& expanded_names = (case_insensitive ? mFoldedExpandedNames : mExpandedNames);
+      MenuNameIndex::const_iterator it = expanded_names.find(case_insensitive ? FoldCase(name) : name);
+      if (it == expanded_names.end())
+        return NULL;
+
+      size_t node_index = it->second;
+      return mMenuNodes[node_index].menu;
+    }
+
+    //case insensitive names are compared by their folded value
+    MenuNameIndex::const_iterator it = mFoldedNames.find(FoldCase(name));
+    if (it == mFoldedNames.end())
+      return NULL;
+
+    size_t node_index = it->second;
+    return mMenuNodes[node_index].menu;
   }
 
   uint32_t ConfigFile::AssignCommandIds(const uint32_t& first_command_id)
   {
+    std::lock_guard<std::shared_timed_mutex> lock(mEvaluation->mutex);
+
     uint32_t nextCommandId = first_command_id;
 
-    //for each child
-    Menu::MenuPtrList children = GetMenus();
-    for (size_t i = 0; i < children.size(); i++)
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+
+    //for each menu. parents are assigned before their children.
+    for (size_t i = 0; i < mMenuNodes.size(); i++)
     {
-      Menu* child = children[i];
-      nextCommandId = child->AssignCommandIds(nextCommandId);
+      MENU_NODE& node = mMenuNodes[i];
+
+      //the menu may have been modified since the last update
+      node.visible = node.menu->IsVisible();
+      node.separator = node.menu->IsSeparator();
+
+      //Issue #5 - ConfigManager::AssignCommandIds() should skip invisible menus
+      //sub menus of a menu without a command id also get an invalid command id
+      bool skip = (!node.visible || first_command_id == Menu::INVALID_COMMAND_ID);
+      if (node.parent != INVALID_NODE_INDEX && mMenuNodes[node.parent].command_id == Menu::INVALID_COMMAND_ID)
+        skip = true;
+
+      if (skip)
+      {
+        node.command_id = Menu::INVALID_COMMAND_ID;
+      }
+      else
+      {
+        node.command_id = nextCommandId;
+        nextCommandId++;
+      }
+      node.menu->SetCommandId(node.command_id);
     }
 
     return nextCommandId;
@@ -461,39 +906,82 @@ namespace shellanything
     return mPlugins;
   }
 
-  Menu::MenuPtrList ConfigFile::GetMenus()
+  const Menu::MenuPtrList& ConfigFile::GetMenus() const
   {
     return mMenus;
   }
 
-  void ConfigFile::SetDefaultSettings(DefaultSettings* defaults)
+  const ConfigFile::MenuNodeList& ConfigFile::GetMenuNodes()
   {
-    if (mDefaults)
-      delete mDefaults;
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+    return mMenuNodes;
+  }
+
+  void ConfigFile::InvalidateMenuNodes()
+  {
+    mMenuNodesValid = false;
+  }
 
-    mDefaults = defaults;
+  void ConfigFile::BuildMenuNodesIfInvalid()
+  {
+    if (!mMenuNodesValid)
+      BuildMenuNodes();
+  }
+
+  void ConfigFile::SetDefaultSettings(DefaultSettings* defaults)
+  {
+    mDefaults.reset();
+    if (defaults)
+      mDefaults = MakeSharedObject(defaults, mArena);
   }
 
   const DefaultSettings* ConfigFile::GetDefaultSettings() const
   {
-    return mDefaults;
+    return mDefaults.get();
   }
 
   void ConfigFile::AddMenu(Menu* menu)
   {
-    mMenus.push_back(menu);
+    //a menu allocated from the heap does not need the arena
+    std::shared_ptr<MemoryArena> arena;
+    if (ArenaObject::GetObjectArena(menu) == mArena.get())
+      arena = mArena;
     menu->SetParentConfigFile(this);
+    AddSharedMenu(MakeSharedObject(menu, arena));
   }
 
-  void ConfigFile::DeleteChildren()
+  void ConfigFile::AddSharedMenu(const MenuSharedPtr& menu)
+  {
+    mMenus.push_back(menu.get());
+    mSharedMenus.push_back(menu);
+    InvalidateMenuNodes();
+  }
+
+  void ConfigFile::DetachMenus()
   {
-    // Delete menus
+    //the menus are not shared yet
     for (size_t i = 0; i < mMenus.size(); i++)
     {
-      Menu* sub = mMenus[i];
-      delete sub;
+      Menu* menu = mMenus[i];
+      if (menu->GetParentConfigFile() == this)
+        menu->SetParentConfigFile(NULL);
     }
+  }
+
+  void ConfigFile::DeleteChildren()
+  {
+    // Delete menus and default settings which are not shared with another configuration
     mMenus.clear();
+    mSharedMenus.clear();
+    mDefaults.reset();
+    mMenuNodes.clear();
+    mMenuNodesValid = false;
+    mNames.clear();
+    mFoldedNames.clear();
+    mExpandedNames.clear();
+    mFoldedExpandedNames.clear();
+    mExpandedNamesValid = false;
 
     // Delete plugins
     // Note that plugins must be deleted after everything else.
@@ -508,9 +996,88 @@ namespace shellanything
     mPlugins.clear();
   }
 
-  void ConfigFile::DeleteChild(Menu* menu)
+  void ConfigFile::BuildMenuNodes()
+  {
+    mMenuNodes.clear();
+
+    size_t previous = INVALID_NODE_INDEX;
+    for (size_t i = 0; i < mMenus.size(); i++)
+    {
+      size_t index = FlattenMenu(mMenus[i], INVALID_NODE_INDEX);
+      if (previous != INVALID_NODE_INDEX)
+        mMenuNodes[previous].next_sibling = index;
+      previous = index;
+    }
+
+    //index the names of the menus
+    BuildInternedNameIndex();
+    mExpandedNamesValid = false;
+
+    mMenuNodesValid = true;
+  }
+
+  size_t ConfigFile::FlattenMenu(Menu* menu, size_t parent)
+  {
+    size_t index = mMenuNodes.size();
+
+    MENU_NODE node;
+    node.menu = menu;
+    node.parent = parent;
+    node.first_child = INVALID_NODE_INDEX;
+    node.next_sibling = INVALID_NODE_INDEX;
+    node.command_id = menu->GetCommandId();
+    node.visible = menu->IsVisible();
+    node.enabled = menu->IsEnabled();
+    node.separator = menu->IsSeparator();
+    mMenuNodes.push_back(node);
+
+    //submenus are stored right after their parent
+    size_t previous = INVALID_NODE_INDEX;
+    const Menu::MenuPtrList& submenus = menu->GetSubMenus();
+    for (size_t i = 0; i < submenus.size(); i++)
+    {
+      size_t child = FlattenMenu(submenus[i], index);
+      if (previous == INVALID_NODE_INDEX)
+        mMenuNodes[index].first_child = child;
+      else
+        mMenuNodes[previous].next_sibling = child;
+      previous = child;
+    }
+
+    return index;
+  }
+
+  void ConfigFile::BuildInternedNameIndex()
   {
-    delete menu;
+    mNames.clear();
+    mFoldedNames.clear();
+
+    for (size_t i = 0; i < mMenuNodes.size(); i++)
+    {
+      const Menu* menu = mMenuNodes[i].menu;
+      const InternedString& name = menu->GetInternedName();
+
+      //the first menu in pre-order wins. insert() does not replace an existing name.
+      mFoldedNames.insert(MenuNameIndex::value_type(FoldCase(name.Get()), i));
+      mNames.insert(InternedNameIndex::value_type(name, i));
+    }
+  }
+
+  void ConfigFile::BuildNameIndex(MenuNameIndex& names, MenuNameIndex& folded_names, bool expand) const
+  {
+    names.clear();
+    folded_names.clear();
+
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    for (size_t i = 0; i < mMenuNodes.size(); i++)
+    {
+      const Menu* menu = mMenuNodes[i].menu;
+      std::string name = (expand ? pmgr.Expand(menu->GetName()) : menu->GetName());
+
+      //the first menu in pre-order wins. insert() does not replace an existing name.
+      folded_names.insert(MenuNameIndex::value_type(FoldCase(name), i));
+      names.insert(MenuNameIndex::value_type(name, i));
+    }
   }
 
 } //namespace shellanything
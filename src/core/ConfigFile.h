@@ -31,8 +31,13 @@
 #include "DefaultSettings.h"
 #include "Plugin.h"
 #include "Enums.h"
+#include "MemoryArena.h"
 
 #include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 
 namespace shellanything
 {
@@ -40,6 +45,10 @@ namespace shellanything
   /// <summary>
   /// A ConfigFile holds mutiple Menu instances.
   /// </summary>
+  /// <remarks>
+  /// The state of the menus (visibility, enabled state and command ids) is written by Update(), AssignCommandIds() and FoldConstants().
+  /// These methods are serialized for a configuration. Threads that read the state of the menus while another thread may write it must use a read scope. See BeginRead().
+  /// </remarks>
   class SHELLANYTHING_EXPORT ConfigFile
   {
   public:
@@ -48,6 +57,47 @@ namespace shellanything
     /// </summary>
     typedef std::vector<ConfigFile*> ConfigFilePtrList;
 
+    /// <summary>
+    /// A node of the flattened menu tree of a ConfigFile.
+    /// Nodes are stored in pre-order: a parent node is always located before its children.
+    /// </summary>
+    struct MENU_NODE
+    {
+      ///<summary>The menu of the node.</summary>
+      Menu* menu;
+
+      ///<summary>The index of the parent node. INVALID_NODE_INDEX for top level menus.</summary>
+      size_t parent;
+
+      ///<summary>The index of the first child node. INVALID_NODE_INDEX if the menu have no submenus.</summary>
+      size_t first_child;
+
+      ///<summary>The index of the next sibling node. INVALID_NODE_INDEX for the last submenu.</summary>
+      size_t next_sibling;
+
+      ///<summary>The command id of the menu as assigned by AssignCommandIds().</summary>
+      uint32_t command_id;
+
+      ///<summary>The visible property of the menu as of the last Update().</summary>
+      bool visible;
+
+      ///<summary>The enabled property of the menu as of the last Update().</summary>
+      bool enabled;
+
+      ///<summary>The separator property of the menu.</summary>
+      bool separator;
+    };
+
+    /// <summary>
+    /// A list of MENU_NODE.
+    /// </summary>
+    typedef std::vector<MENU_NODE> MenuNodeList;
+
+    /// <summary>
+    /// Defines an invalid MENU_NODE index.
+    /// </summary>
+    static const size_t INVALID_NODE_INDEX;
+
     ConfigFile();
     virtual ~ConfigFile();
 
@@ -58,13 +108,14 @@ namespace shellanything
   public:
 
     /// <summary>
-    /// Get the ConfigFile pointer that is currently updating.
+    /// Get the ConfigFile pointer that is currently updating in the current thread.
+    /// Configurations updated concurrently by other threads are not reported.
     /// </summary>
     /// <returns>Returns the ConfigFile pointer that is currently updating. Returns NULL if no configuration is updating.</returns>
     static ConfigFile* GetUpdatingConfigFile();
 
     /// <summary>
-    /// Set the ConfigFile pointer that is currently updating.
+    /// Set the ConfigFile pointer that is currently updating in the current thread.
     /// </summary>
     /// <param name="config_file">The current updating ConfigFile</param>
     static void SetUpdatingConfigFile(ConfigFile* config_file);
@@ -77,6 +128,42 @@ namespace shellanything
     /// <returns>Returns a valid Configuration pointer if the file can be loaded. Returns NULL otherwise.</returns>
     static ConfigFile* LoadFile(const std::string& path, std::string& error);
 
+    /// <summary>
+    /// Load a Configuration File from its content in memory.
+    /// The elements of the file are parsed one at a time. A document of the whole file is never built.
+    /// </summary>
+    /// <param name="path">The path of the file.</param>
+    /// <param name="content">The content of the file.</param>
+    /// <param name="error">The error desription if the file cannot be loaded.</param>
+    /// <returns>Returns a valid Configuration pointer if the file can be loaded. Returns NULL otherwise.</returns>
+    static ConfigFile* LoadFile(const std::string& path, const std::string& content, std::string& error);
+
+    /// <summary>
+    /// Create a copy of this configuration which shares its menus and its default settings.
+    /// The shared objects are deleted with the last configuration that uses them. The clone and this configuration share their evaluation lock. See BeginRead().
+    /// A clone can be reloaded while this configuration is read by other threads. See Reload().
+    /// </summary>
+    /// <returns>Returns a new configuration. Returns NULL if the configuration declares plugins.</returns>
+    ConfigFile* Clone() const;
+
+    /// <summary>
+    /// Reload the configuration from its file. Only the top level menus whose xml source changed are parsed again.
+    /// Unchanged menus are kept with their validators, resolved icons, command ids and cached states.
+    /// The default settings are replaced only if their xml source changed.
+    /// The replaced menus and default settings are deleted unless they are shared with another configuration.
+    /// A configuration which is read by other threads must not be reloaded. Reload a clone of the configuration instead. See Clone().
+    /// Configurations that declare plugins cannot be reloaded and must be loaded again with LoadFile().
+    /// </summary>
+    /// <param name="error">The error description if the configuration cannot be reloaded.</param>
+    /// <param name="defaults_changed">The output value set to true if the default settings were replaced. Set to false otherwise.</param>
+    /// <returns>Returns true if the configuration was reloaded. Returns false otherwise and the configuration is unchanged.</returns>
+    bool Reload(std::string& error, bool& defaults_changed);
+
+    /// <summary>
+    /// Get the number of menus, including submenus, that were parsed by the last Reload().
+    /// </summary>
+    const size_t& GetReplacedMenuCount() const;
+
     /// <summary>
     /// Detect if a given file is a valid Configuration File.
     /// </summary>
@@ -84,6 +171,14 @@ namespace shellanything
     /// <returns>Returns true if the file is a valid Configuration File. Returns false otherwise.</returns>
     static bool IsValidConfigFile(const std::string& path);
 
+    /// <summary>
+    /// Detect if a given file is a valid Configuration File and if the file declares plugins.
+    /// </summary>
+    /// <param name="path">The file path to load</param>
+    /// <param name="has_plugins">The output value set to true if the file may declare plugins. Set to false otherwise.</param>
+    /// <returns>Returns true if the file is a valid Configuration File. Returns false otherwise.</returns>
+    static bool IsValidConfigFile(const std::string& path, bool& has_plugins);
+
     /// <summary>
     /// Returns the file path of this ConfigFile.
     /// </summary>
@@ -105,18 +200,59 @@ namespace shellanything
     void SetFileModifiedDate(const uint64_t& file_modified_date);
 
     /// <summary>
-    /// Recursively update all menus of this Configuration.
+    /// Get the memory arena of this ConfigFile.
+    /// The menus, validators and actions created while loading the configuration are allocated from this arena.
+    /// The arena is released in a single step when the ConfigFile is destroyed.
+    /// </summary>
+    MemoryArena& GetArena();
+    const MemoryArena& GetArena() const;
+
+    /// <summary>
+    /// Update all menus of this Configuration.
+    /// Menus whose validators inputs did not change since the previous update keep their previous state.
     /// </summary>
     /// <param name="context">The selection context</param>
     void Update(const SelectionContext& context);
 
+    /// <summary>
+    /// Update all menus of this Configuration.
+    /// The validators of the menus are evaluated with the given context. The configuration being updated is set to this configuration.
+    /// Updates of the same configuration by multiple threads are serialized. The menus keep the state of the last update.
+    /// </summary>
+    /// <param name="context">The evaluation context</param>
+    void Update(const EvaluationContext& context);
+
+    /// <summary>
+    /// Get the number of menus that were evaluated again by the last Update().
+    /// </summary>
+    size_t GetEvaluatedMenuCount() const;
+
+    /// <summary>
+    /// Begin a read scope of the state of the menus for the calling thread.
+    /// Update(), AssignCommandIds() and FoldConstants() wait until all read scopes of the configuration are ended.
+    /// Each call to BeginRead() must be matched by a call to EndRead() from the same thread. Read scopes of a configuration must not be nested.
+    /// </summary>
+    void BeginRead() const;
+
+    /// <summary>
+    /// End a read scope of the state of the menus for the calling thread. See BeginRead().
+    /// </summary>
+    void EndRead() const;
+
     /// <summary>
     /// Apply the configuration's default properties.
     /// </summary>
     void ApplyDefaultSettings();
 
+    /// <summary>
+    /// Recursively pre-evaluates the validators of all menus which only depends on stable properties.
+    /// Must be called after ApplyDefaultSettings() since the default properties are stable.
+    /// </summary>
+    void FoldConstants();
+
     /// <summary>
     /// Finds a loaded Menu that have the given command_id assigned.
+    /// The command ids are part of the state of the menus. Use a read scope if another thread may assign them. See BeginRead().
     /// </summary>
     /// <param name="command_id">The search command id value.</param>
     /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
@@ -124,6 +260,9 @@ namespace shellanything
 
     /// <summary>
     /// Finds a loaded Menu pointer by a given name. The first menu that matches the given name is returned.
+    /// Menus are searched with an index of their names. Expanded names are cached until a property changes.
+    /// Names that are not expanded and case sensitive are compared by their interned handle.
+    /// The function can be called by multiple threads once the menu nodes are built. See BuildMenuNodesIfInvalid().
     /// </summary>
     /// <param name="name">The name of the menu.</param>
     /// <param name="flags">The flags for searching by name.</param>
@@ -151,7 +290,31 @@ namespace shellanything
     /// <summary>
     /// Get the list of menu pointers handled by the configuration.
     /// </summary>
-    Menu::MenuPtrList GetMenus();
+    const Menu::MenuPtrList& GetMenus() const;
+
+    /// <summary>
+    /// Get the flattened tree of all menus handled by the configuration.
+    /// The list is rebuilt when menus are added to the configuration.
+    /// </summary>
+    const MenuNodeList& GetMenuNodes();
+
+    /// <summary>
+    /// Mark the flattened tree of menus as out of date. Must be called when a submenu is added to one of the menus of the configuration.
+    /// </summary>
+    void InvalidateMenuNodes();
+
+    /// <summary>
+    /// Remove this configuration from the parent of its menus. See Menu::GetParentConfigFile().
+    /// The menus of a configuration are detached before the configuration is published in a snapshot, since they may be shared with its clones.
+    /// The menus of a detached configuration must not be modified anymore.
+    /// </summary>
+    void DetachMenus();
+
+    /// <summary>
+    /// Build the flattened tree of menus and the indexes of their names if they are out of date.
+    /// A configuration is built before it is published in a snapshot. The readers of a published configuration never rebuild them. See ConfigManager::Refresh().
+    /// </summary>
+    void BuildMenuNodesIfInvalid();
 
     /// <summary>
     /// Set a new DefaultSettings instance to the Configuration. The Configuration instance takes ownership of the instance.
@@ -173,14 +336,46 @@ namespace shellanything
 
   private:
     //methods
+    typedef std::shared_ptr<Menu> MenuSharedPtr;
+    typedef std::vector<MenuSharedPtr> MenuSharedPtrList;
     void DeleteChildren();
-    void DeleteChild(Menu* menu);
+    void AddSharedMenu(const MenuSharedPtr& menu);
+    typedef std::map<std::string /*name*/, size_t /*node index*/> MenuNameIndex;
+    typedef std::map<InternedString /*name*/, size_t /*node index*/> InternedNameIndex;
+    void BuildMenuNodes();
+    void BuildInternedNameIndex();
+    size_t FlattenMenu(Menu* menu, size_t parent);
+    void BuildNameIndex(MenuNameIndex& names, MenuNameIndex& folded_names, bool expand) const;
+
+    // The state of the evaluation of the menus. See BeginRead().
+    struct EVALUATION_STATE
+    {
+      std::shared_timed_mutex mutex; // locked exclusively by the writers of the state of the menus
+      StringList last_selection;
+      bool last_selection_valid;
+
+      EVALUATION_STATE() : last_selection_valid(false) {}
+    };
 
-    DefaultSettings* mDefaults;
+    std::shared_ptr<MemoryArena> mArena; // shared with the clones. Must be destroyed after all the objects allocated from it
+    std::shared_ptr<DefaultSettings> mDefaults;
     uint64_t mFileModifiedDate;
     std::string mFilePath;
     Plugin::PluginPtrList mPlugins;
     Menu::MenuPtrList mMenus;
+    MenuSharedPtrList mSharedMenus; // keeps the menus alive. Same order as mMenus.
+    MenuNodeList mMenuNodes;
+    bool mMenuNodesValid;
+    InternedNameIndex mNames;
+    MenuNameIndex mFoldedNames;
+    MenuNameIndex mExpandedNames;
+    MenuNameIndex mFoldedExpandedNames;
+    bool mExpandedNamesValid;
+    PropertyDependencies mExpandedNamesDependencies;
+    std::mutex mExpandedNamesMutex; // the expanded names are rebuilt by the readers when a property changes
+    std::shared_ptr<EVALUATION_STATE> mEvaluation;
+    size_t mEvaluatedMenuCount;
+    size_t mReplacedMenuCount;
   };
 
 } //namespace shellanything
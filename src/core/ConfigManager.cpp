@@ -24,15 +24,47 @@
 
 #include "ConfigManager.h"
 #include "Menu.h"
+#include "FileProbeCache.h"
 #include "LoggerHelper.h"
+#include "App.h"
 
 #include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/strings.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
 namespace shellanything
 {
+  // The snapshot read by the current thread.
+  struct CONFIG_READER
+  {
+    ConfigSnapshotPtr pinned;   // the snapshot read by the thread
+    size_t pinned_publication;  // the publication of the pinned snapshot
+    size_t depth;               // the depth of the read scopes. See BeginRead().
+  };
+  static thread_local CONFIG_READER gConfigReader = { ConfigSnapshotPtr(), 0, 0 };
+
+  // Returns true if the current thread is within a read scope.
+  // The configurations are locked by the read scope and cannot be written by the same thread.
+  bool IsReading(const char* function)
+  {
+    if (gConfigReader.depth == 0)
+      return false;
+    SA_LOG(ERROR) << function << "(), cannot be called within a read scope.";
+    return true;
+  }
 
-  ConfigManager::ConfigManager()
+  ConfigManager::ConfigManager() :
+    mSnapshot(std::make_shared<ConfigSnapshot>()),
+    mPublication(0),
+    mEvaluatedMenuCount(0),
+    mUpdateThreadCount(1),
+    mLoadThreadCount(1),
+    mWatchService(NULL),
+    mWatchingPaths(false)
   {
   }
 
@@ -49,23 +81,216 @@ namespace shellanything
 
   void ConfigManager::Clear()
   {
+    if (IsReading(__FUNCTION__))
+      return;
+
     ClearSearchPath(); //remove all search path to make sure that a refresh won’t find any other configuration file
     DeleteChildren();
     Refresh(); //forces all loaded configurations to be unloaded
   }
 
+  // The result of the validation and the parsing of a new configuration file.
+  struct LOADED_FILE
+  {
+    bool valid;
+    bool has_plugins;
+    ConfigFile* config;
+    std::string error;
+
+    LOADED_FILE() : valid(false), has_plugins(false), config(NULL) {}
+  };
+
+  // Loads the files of a shared list. Each thread takes the next file that is not loaded.
+  struct CONCURRENT_LOAD
+  {
+    ConfigCache* cache;
+    const StringList* files;
+    std::vector<LOADED_FILE>* loaded_files;
+    std::atomic<size_t> next;
+
+    void operator()()
+    {
+      size_t index = next++;
+      while (index < files->size())
+      {
+        const std::string& file_path = (*files)[index];
+        LOADED_FILE& loaded = (*loaded_files)[index];
+        loaded.valid = ConfigFile::IsValidConfigFile(file_path, loaded.has_plugins);
+
+        //files with plugins are loaded later, in order
+        if (loaded.valid && !loaded.has_plugins)
+          loaded.config = cache->LoadFile(file_path, loaded.error);
+
+        index = next++;
+      }
+    }
+  };
+
+  void LoadConcurrently(ConfigCache& cache, const StringList& files, std::vector<LOADED_FILE>& loaded_files, size_t thread_count)
+  {
+    CONCURRENT_LOAD load;
+    load.cache = &cache;
+    load.files = &files;
+    load.loaded_files = &loaded_files;
+    load.next = 0;
+
+    if (thread_count > files.size())
+      thread_count = files.size();
+
+    //the current thread also loads files
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; i++)
+    {
+      threads.push_back(std::thread(std::ref(load)));
+    }
+    load();
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+      threads[i].join();
+    }
+  }
+
+  bool ConfigManager::GetChangedFiles(StringList& files)
+  {
+    IDirectoryWatchService* service = App::GetInstance().GetDirectoryWatchService();
+    if (service == NULL)
+    {
+      mWatchService = NULL;
+      mWatchedPaths.clear();
+      mWatchingPaths = false;
+      return false;
+    }
+
+    //are the search paths already watched ?
+    if (service != mWatchService || mPaths != mWatchedPaths)
+    {
+      service->Clear();
+      mWatchingPaths = true;
+      for (size_t i = 0; i < mPaths.size(); i++)
+      {
+        const std::string& path = mPaths[i];
+        if (!service->Watch(path))
+        {
+          SA_LOG(WARNING) << "Failed watching directory '" << path << "'.";
+          mWatchingPaths = false;
+        }
+      }
+      mWatchService = service;
+      mWatchedPaths = mPaths;
+
+      //the files that changed before the directories were watched are unknown
+      StringList ignored;
+      service->GetChanges(ignored);
+      return false;
+    }
+
+    if (!mWatchingPaths)
+      return false;
+
+    bool complete = service->GetChanges(files);
+    return complete;
+  }
+
+  const ConfigSnapshotPtr& ConfigManager::ReadSnapshot() const
+  {
+    CONFIG_READER& reader = gConfigReader;
+
+    //the snapshot does not change within a read scope
+    if (reader.pinned && reader.depth > 0)
+      return reader.pinned;
+
+    size_t current_publication = mPublication.load(std::memory_order_acquire);
+    if (reader.pinned && reader.pinned_publication == current_publication)
+      return reader.pinned;
+
+    //the previous snapshot is released when its last reader releases it
+    reader.pinned = std::atomic_load(&mSnapshot);
+    reader.pinned_publication = current_publication;
+    return reader.pinned;
+  }
+
+  void ConfigManager::Publish(const ConfigSnapshotPtr& draft)
+  {
+    //mWriteMutex must be locked by the caller
+    //the readers of the snapshot do not build the menu nodes and the name indexes of its configurations
+    //the menus of the new configurations may be shared with their clones. See ConfigFile::Clone().
+    const ConfigFile::ConfigFilePtrList& configurations = draft->configurations;
+    ConfigSnapshotPtr current = std::atomic_load(&mSnapshot);
+    const ConfigFile::ConfigFilePtrList& published = current->configurations;
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      ConfigFile* config = configurations[i];
+      if (std::find(published.begin(), published.end(), config) != published.end())
+        continue;
+      config->DetachMenus();
+      config->BuildMenuNodesIfInvalid();
+    }
+    std::atomic_store(&mSnapshot, draft);
+    mPublication.fetch_add(1, std::memory_order_release);
+  }
+
+  ConfigSnapshotPtr ConfigManager::GetSnapshot() const
+  {
+    return std::atomic_load(&mSnapshot);
+  }
+
+  void ConfigManager::BeginRead() const
+  {
+    CONFIG_READER& reader = gConfigReader;
+    if (reader.depth == 0)
+    {
+      const ConfigSnapshotPtr& snapshot = ReadSnapshot();
+      snapshot->BeginRead();
+    }
+    reader.depth++;
+  }
+
+  void ConfigManager::EndRead() const
+  {
+    CONFIG_READER& reader = gConfigReader;
+    if (reader.depth == 0)
+      return;
+    reader.depth--;
+    if (reader.depth == 0)
+      reader.pinned->EndRead();
+  }
+
   void ConfigManager::Refresh()
   {
     SA_LOG(INFO) << __FUNCTION__ << "()";
 
+    if (IsReading(__FUNCTION__))
+      return;
+
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+
+    //get the files that changed since the last refresh
+    StringList changed_files;
+    bool changes_known = GetChangedFiles(changed_files);
+    if (changes_known && changed_files.empty())
+    {
+      SA_LOG(INFO) << "Configuration files are unchanged.";
+      return;
+    }
+
+    //build the next snapshot off to the side. the assigned command ids are not valid for the next snapshot.
+    ConfigSnapshotPtr current = std::atomic_load(&mSnapshot);
+    std::shared_ptr<ConfigSnapshot> draft = std::make_shared<ConfigSnapshot>();
+    draft->configurations = current->configurations;
+    draft->owners = current->owners;
+    bool changed = false;
+
     //validate existing configurations
-    ConfigFile::ConfigFilePtrList existing = GetConfigFiles();
+    const ConfigFile::ConfigFilePtrList& existing = current->configurations;
     for (size_t i = 0; i < existing.size(); i++)
     {
       ConfigFile* config = existing[i];
 
       //compare the file's date at the load time and the current date
       const std::string& file_path = config->GetFilePath();
+      if (changes_known && std::find(changed_files.begin(), changed_files.end(), file_path) == changed_files.end())
+        continue; //not changed
+
       const uint64_t& old_file_date = config->GetFileModifiedDate();
       const uint64_t new_file_date = ra::filesystem::GetFileModifiedDateUtf8(file_path);
       if (ra::filesystem::FileExistsUtf8(file_path.c_str()) && old_file_date == new_file_date)
@@ -73,130 +298,326 @@ namespace shellanything
         //current configuration is up to date
         SA_LOG(INFO) << "Configuration file '" << file_path << "' is up to date.";
       }
+      else if (ra::filesystem::FileExistsUtf8(file_path.c_str()) && ReloadChild(*draft, config))
+      {
+        //current configuration was out of date. only its modified menus were parsed again.
+        changed = true;
+      }
       else
       {
-        //file is missing or current configuration is out of date
-        //forget about existing config
+        //file is missing or current configuration cannot be reloaded
+        //forget about existing config. readers of the current snapshot can still use it.
+        //a modified file is found again below and loaded as a new configuration.
         SA_LOG(INFO) << "Configuration file '" << file_path << "' is missing or is not up to date. Deleting configuration.";
-        DeleteChild(config);
+        DeleteChild(*draft, config);
+        changed = true;
       }
     }
 
-    //search every known path
-    for (size_t i = 0; i < mPaths.size(); i++)
+    //search every known path for new files
+    StringList new_files;
+    if (changes_known)
+    {
+      //only the changed files can be new
+      for (size_t i = 0; i < changed_files.size(); i++)
+      {
+        const std::string& file_path = changed_files[i];
+        if (!draft->IsConfigFileLoaded(file_path) &&
+            ra::filesystem::FileExistsUtf8(file_path.c_str()) &&
+            std::find(new_files.begin(), new_files.end(), file_path) == new_files.end())
+        {
+          new_files.push_back(file_path);
+        }
+      }
+    }
+    else
     {
-      const std::string& path = mPaths[i];
+      for (size_t i = 0; i < mPaths.size(); i++)
+      {
+        const std::string& path = mPaths[i];
 
-      SA_LOG(INFO) << "Searching configuration files in directory '" << path << "'";
+        SA_LOG(INFO) << "Searching configuration files in directory '" << path << "'";
 
-      //search files in each directory
-      ra::strings::StringVector files;
-      bool dir_found = ra::filesystem::FindFilesUtf8(files, path.c_str());
-      if (dir_found)
-      {
-        //search through each files for *.xml files
-        for (size_t j = 0; j < files.size(); j++)
+        //search files in each directory
+        ra::strings::StringVector files;
+        bool dir_found = ra::filesystem::FindFilesUtf8(files, path.c_str());
+        if (dir_found)
         {
-          const std::string& file_path = files[j];
-          if (ConfigFile::IsValidConfigFile(file_path))
+          for (size_t j = 0; j < files.size(); j++)
           {
+            const std::string& file_path = files[j];
+
             //is this file already loaded ?
-            if (!IsConfigFileLoaded(file_path))
+            if (draft->IsConfigFileLoaded(file_path))
             {
-              SA_LOG(INFO) << "Found new configuration file '" << file_path << "'";
-
-              //parse the file
-              std::string error;
-              ConfigFile* config = ConfigFile::LoadFile(file_path, error);
-              if (config == NULL)
-              {
-                //log an error message
-                SA_LOG(ERROR) << "Failed loading configuration file '" << file_path << "'. Error=" << error << ".";
-              }
-              else
-              {
-                //add to current list of configurations
-                mConfigurations.push_back(config);
-
-                //apply default properties of the configuration
-                config->ApplyDefaultSettings();
-              }
+              SA_LOG(INFO) << "Skipped configuration file '" << file_path << "'. File is already loaded.";
             }
-            else
+            else if (std::find(new_files.begin(), new_files.end(), file_path) == new_files.end())
             {
-              SA_LOG(INFO) << "Skipped configuration file '" << file_path << "'. File is already loaded.";
+              new_files.push_back(file_path);
             }
           }
         }
+        else
+        {
+          //log an error message
+          SA_LOG(ERROR) << "Failed searching for configuration files in directory '" << path << "'.";
+        }
       }
-      else
+    }
+
+    size_t thread_count = mLoadThreadCount;
+    if (thread_count == 0)
+      thread_count = std::thread::hardware_concurrency();
+
+    //validate and parse the new files concurrently
+    std::vector<LOADED_FILE> loaded_files(new_files.size());
+    LoadConcurrently(mCache, new_files, loaded_files, thread_count);
+
+    //add the new configurations in file order
+    for (size_t i = 0; i < new_files.size(); i++)
+    {
+      const std::string& file_path = new_files[i];
+      LOADED_FILE& loaded = loaded_files[i];
+      if (!loaded.valid)
+        continue;
+
+      SA_LOG(INFO) << "Found new configuration file '" << file_path << "'";
+
+      //plugins are loaded by this thread, in order, since plugins can modify properties
+      ConfigFile* config = loaded.config;
+      if (loaded.has_plugins)
+        config = mCache.LoadFile(file_path, loaded.error);
+
+      if (config == NULL)
       {
         //log an error message
-        SA_LOG(ERROR) << "Failed searching for configuration files in directory '" << path << "'.";
+        SA_LOG(ERROR) << "Failed loading configuration file '" << file_path << "'. Error=" << loaded.error << ".";
+      }
+      else
+      {
+        //apply default properties of the configuration
+        config->ApplyDefaultSettings();
+
+        //pre-evaluate validators which only depends on stable properties
+        config->FoldConstants();
+
+        //add to the next list of configurations
+        draft->owners.push_back(ConfigSnapshot::ConfigFileSharedPtr(config));
+        draft->configurations.push_back(config);
+        changed = true;
       }
     }
+
+    //replace the current snapshot
+    if (changed)
+      Publish(draft);
+  }
+
+  ConfigCache& ConfigManager::GetCache()
+  {
+    return mCache;
   }
 
   void ConfigManager::Update(const SelectionContext& context)
   {
-    //for each child
-    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
-    for (size_t i = 0; i < configurations.size(); i++)
-    {
-      ConfigFile* config = configurations[i];
-      config->Update(context);
-    }
+    EvaluationContext evaluation_context(context);
+    Update(evaluation_context);
   }
 
-  Menu* ConfigManager::FindMenuByCommandId(const uint32_t& command_id)
+  void ConfigManager::Update(const EvaluationContext& context)
   {
-    //for each child
-    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
+    if (IsReading(__FUNCTION__))
+      return;
+
+    //file system probes are cached for the duration of the update. each update uses its own pass.
+    FileProbeCache& probes = context.GetFileProbeCache();
+    EvaluationContext update_context = context;
+    update_context.SetFileProbePass(probes.BeginPass());
+
+    size_t thread_count = mUpdateThreadCount;
+    if (thread_count == 0)
+      thread_count = std::thread::hardware_concurrency();
+
+    //the configurations are kept alive until the update is completed, even if a new snapshot is published
+    ConfigSnapshotPtr snapshot = ReadSnapshot();
+    const ConfigFile::ConfigFilePtrList& configurations = snapshot->GetConfigFiles();
+    if (thread_count <= 1)
+    {
+      //for each child
+      for (size_t i = 0; i < configurations.size(); i++)
+      {
+        ConfigFile* config = configurations[i];
+        config->Update(update_context);
+      }
+    }
+    else
+    {
+      //configurations with plugins may modify properties read by the following configurations.
+      //they are updated alone, in order, to get the same results as a serial update.
+      size_t begin = 0;
+      while (begin < configurations.size())
+      {
+        size_t end = begin;
+        while (end < configurations.size() && configurations[end]->GetPlugins().empty())
+          end++;
+
+        UpdateConcurrently(update_context, configurations, begin, end, thread_count);
+
+        if (end < configurations.size())
+        {
+          ConfigFile* config = configurations[end];
+          config->Update(update_context);
+          end++;
+        }
+        begin = end;
+      }
+    }
+
+    //merge the statistics in order. Update() may be called concurrently by multiple shell threads.
+    size_t evaluated_count = 0;
+    size_t menu_count = 0;
     for (size_t i = 0; i < configurations.size(); i++)
     {
       ConfigFile* config = configurations[i];
-      Menu* match = config->FindMenuByCommandId(command_id);
-      if (match)
-        return match;
+      evaluated_count += config->GetEvaluatedMenuCount();
+      menu_count += config->GetMenuNodes().size();
     }
+    mEvaluatedMenuCount.store(evaluated_count);
+
+    probes.EndPass(update_context.GetFileProbePass());
 
-    return NULL;
+    SA_LOG(INFO) << __FUNCTION__ << "(), evaluated " << evaluated_count << " of " << menu_count << " menus.";
   }
 
-  Menu* ConfigManager::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
+  // Updates the configurations of a shared list. Each thread takes the next configuration that is not updated.
+  struct CONCURRENT_UPDATE
   {
-    //for each child
-    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
-    for (size_t i = 0; i < configurations.size(); i++)
+    const ConfigFile::ConfigFilePtrList* configurations;
+    const EvaluationContext* context;
+    size_t end;
+    std::atomic<size_t> next;
+
+    void operator()()
     {
-      ConfigFile* config = configurations[i];
-      Menu* match = config->FindMenuByName(name, flags);
-      if (match)
-        return match;
+      size_t index = next++;
+      while (index < end)
+      {
+        ConfigFile* config = (*configurations)[index];
+        config->Update(*context);
+        index = next++;
+      }
+    }
+  };
+
+  void ConfigManager::UpdateConcurrently(const EvaluationContext& context, const ConfigFile::ConfigFilePtrList& configurations, size_t begin, size_t end, size_t thread_count)
+  {
+    //configurations without plugins only read properties.
+    //properties are not modified until all threads are completed.
+    CONCURRENT_UPDATE update;
+    update.configurations = &configurations;
+    update.context = &context;
+    update.end = end;
+    update.next = begin;
+
+    size_t count = end - begin;
+    if (thread_count > count)
+      thread_count = count;
+
+    //the current thread also updates configurations
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < thread_count; i++)
+    {
+      threads.push_back(std::thread(std::ref(update)));
+    }
+    update();
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+      threads[i].join();
     }
+  }
+
+  void ConfigManager::SetLoadThreadCount(size_t count)
+  {
+    mLoadThreadCount = count;
+  }
+
+  size_t ConfigManager::GetLoadThreadCount() const
+  {
+    return mLoadThreadCount;
+  }
+
+  void ConfigManager::SetUpdateThreadCount(size_t count)
+  {
+    mUpdateThreadCount = count;
+  }
+
+  size_t ConfigManager::GetUpdateThreadCount() const
+  {
+    return mUpdateThreadCount;
+  }
 
-    return NULL;
+  size_t ConfigManager::GetEvaluatedMenuCount() const
+  {
+    return mEvaluatedMenuCount.load();
+  }
+
+  Menu* ConfigManager::FindMenuByCommandId(const uint32_t& command_id)
+  {
+    Menu* match = ReadSnapshot()->FindMenuByCommandId(command_id);
+    return match;
+  }
+
+  Menu* ConfigManager::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
+  {
+    Menu* match = ReadSnapshot()->FindMenuByName(name, flags);
+    return match;
   }
 
 
   uint32_t ConfigManager::AssignCommandIds(const uint32_t& first_command_id)
   {
+    if (IsReading(__FUNCTION__))
+      return first_command_id;
+
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+
     uint32_t nextCommandId = first_command_id;
 
     //for each child
-    ConfigFile::ConfigFilePtrList configurations = ConfigManager::GetConfigFiles();
+    ConfigSnapshotPtr current = std::atomic_load(&mSnapshot);
+    const ConfigFile::ConfigFilePtrList& configurations = current->configurations;
     for (size_t i = 0; i < configurations.size(); i++)
     {
       ConfigFile* config = configurations[i];
       nextCommandId = config->AssignCommandIds(nextCommandId);
     }
 
+    //publish the same configurations with the lookup table of the assigned command ids
+    std::shared_ptr<ConfigSnapshot> draft = std::make_shared<ConfigSnapshot>();
+    draft->configurations = current->configurations;
+    draft->owners = current->owners;
+    draft->first_command_id = first_command_id;
+    draft->command_id_menus.assign(nextCommandId - first_command_id, (Menu*)NULL);
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      ConfigFile* config = configurations[i];
+      const ConfigFile::MenuNodeList& nodes = config->GetMenuNodes();
+      for (size_t j = 0; j < nodes.size(); j++)
+      {
+        const ConfigFile::MENU_NODE& node = nodes[j];
+        if (node.command_id != Menu::INVALID_COMMAND_ID)
+          draft->command_id_menus[node.command_id - first_command_id] = node.menu;
+      }
+    }
+    Publish(draft);
+
     return nextCommandId;
   }
 
-  ConfigFile::ConfigFilePtrList ConfigManager::GetConfigFiles()
+  const ConfigFile::ConfigFilePtrList& ConfigManager::GetConfigFiles() const
   {
-    return mConfigurations;
+    return ReadSnapshot()->GetConfigFiles();
   }
 
   void ConfigManager::ClearSearchPath()
@@ -211,30 +632,69 @@ namespace shellanything
 
   bool ConfigManager::IsConfigFileLoaded(const std::string& path) const
   {
-    for (size_t i = 0; i < mConfigurations.size(); i++)
+    return ReadSnapshot()->IsConfigFileLoaded(path);
+  }
+
+  void ConfigManager::DeleteChildren()
+  {
+    //configurations are deleted when the readers of the current snapshot release it
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    ConfigSnapshotPtr current = std::atomic_load(&mSnapshot);
+    const ConfigFile::ConfigFilePtrList& configs = current->configurations;
+    for (size_t i = 0; i < configs.size(); i++)
     {
-      const ConfigFile* config = mConfigurations[i];
-      if (config != NULL && config->GetFilePath() == path)
-        return true;
+      mCache.ReleaseSharedMemory(configs[i]->GetFilePath());
     }
-    return false;
+    Publish(std::make_shared<ConfigSnapshot>());
   }
 
-  void ConfigManager::DeleteChildren()
+  bool ConfigManager::ReloadChild(ConfigSnapshot& draft, ConfigFile* config)
   {
-    // delete configurations
-    for (size_t i = 0; i < mConfigurations.size(); i++)
+    //the configuration is read by the readers of the current snapshot. reload a copy of it.
+    ConfigFile* clone = config->Clone();
+    if (clone == NULL)
+      return false;
+
+    std::string error;
+    bool defaults_changed = false;
+    if (!clone->Reload(error, defaults_changed))
     {
-      ConfigFile* config = mConfigurations[i];
-      delete config;
+      SA_LOG(INFO) << "Failed reloading configuration file '" << config->GetFilePath() << "'. Error=" << error << ".";
+      delete clone;
+      return false;
     }
-    mConfigurations.clear();
+
+    SA_LOG(INFO) << "Reloaded configuration file '" << config->GetFilePath() << "'. " << clone->GetReplacedMenuCount() << " menus were parsed again.";
+
+    //the compiled configuration in shared memory is out of date
+    mCache.ReleaseSharedMemory(config->GetFilePath());
+
+    //apply default properties of the configuration if they changed
+    if (defaults_changed)
+      clone->ApplyDefaultSettings();
+
+    //pre-evaluate validators of the new menus
+    clone->FoldConstants();
+
+    //replace the configuration at the same position
+    size_t index = std::find(draft.configurations.begin(), draft.configurations.end(), config) - draft.configurations.begin();
+    draft.configurations[index] = clone;
+    draft.owners[index] = ConfigSnapshot::ConfigFileSharedPtr(clone);
+    return true;
   }
 
-  void ConfigManager::DeleteChild(ConfigFile* config)
+  void ConfigManager::DeleteChild(ConfigSnapshot& draft, ConfigFile* config)
   {
-    mConfigurations.erase(std::find(mConfigurations.begin(), mConfigurations.end(), config));
-    delete config;
+    //the shared memory segments of a missing file are not used by any process
+    const std::string& file_path = config->GetFilePath();
+    if (ra::filesystem::FileExistsUtf8(file_path.c_str()))
+      mCache.ReleaseSharedMemory(file_path);
+    else
+      mCache.RemoveSharedMemory(file_path);
+
+    size_t index = std::find(draft.configurations.begin(), draft.configurations.end(), config) - draft.configurations.begin();
+    draft.configurations.erase(draft.configurations.begin() + index);
+    draft.owners.erase(draft.owners.begin() + index);
   }
 
 } //namespace shellanything
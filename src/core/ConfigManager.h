@@ -29,15 +29,28 @@
 #include "shellanything/config.h"
 #include "StringList.h"
 #include "ConfigFile.h"
+#include "ConfigCache.h"
+#include "ConfigSnapshot.h"
+#include "IDirectoryWatchService.h"
 #include "SelectionContext.h"
 #include "Enums.h"
 
+#include <atomic>
+#include <mutex>
+
 namespace shellanything
 {
 
   /// <summary>
   /// The ConfigManager holds mutiple ConfigFile instances.
   /// </summary>
+  /// <remarks>
+  /// The set of loaded configurations is published as immutable snapshots. See ConfigSnapshot.
+  /// Readers use the snapshot pinned by their thread without locking. The snapshot is pinned again on the first call after a new snapshot is published.
+  /// Writers are serialized. Refresh(), Clear() and AssignCommandIds() build the next snapshot off to the side and replace the current one atomically.
+  /// The state of the menus (visibility, enabled state and command ids) is stored in the configurations and is shared by all snapshots.
+  /// Update() and AssignCommandIds() write the state of the menus. Threads that read it while another thread may write it must use a read scope. See BeginRead().
+  /// </remarks>
   class SHELLANYTHING_EXPORT ConfigManager
   {
   private:
@@ -53,9 +66,31 @@ namespace shellanything
     static ConfigManager& GetInstance();
 
     /// <summary>
-    /// Get the list of ConfigFile pointers handled by the manager
+    /// Get the list of ConfigFile pointers handled by the manager.
+    /// The list is valid until the calling thread uses the manager after a new snapshot is published. Use GetSnapshot() to keep it longer.
     /// </summary>
-    ConfigFile::ConfigFilePtrList GetConfigFiles();
+    const ConfigFile::ConfigFilePtrList& GetConfigFiles() const;
+
+    /// <summary>
+    /// Get the last published snapshot of the loaded configurations.
+    /// The snapshot does not change and its configurations stay valid as long as the returned pointer is kept.
+    /// </summary>
+    /// <returns>Returns the last published snapshot.</returns>
+    ConfigSnapshotPtr GetSnapshot() const;
+
+    /// <summary>
+    /// Begin a read scope for the calling thread.
+    /// Within a read scope, the calling thread keeps reading the same snapshot and the state of its menus does not change.
+    /// Update() and AssignCommandIds() from other threads wait until the read scopes of the configurations they write are ended.
+    /// Refresh(), Clear(), Update() and AssignCommandIds() fail if they are called within a read scope.
+    /// Read scopes can be nested. Each call to BeginRead() must be matched by a call to EndRead() from the same thread.
+    /// </summary>
+    void BeginRead() const;
+
+    /// <summary>
+    /// End a read scope for the calling thread. See BeginRead().
+    /// </summary>
+    void EndRead() const;
 
     /// <summary>
     /// Returns true if the given path is a ConfigFile loaded by the manager.
@@ -74,20 +109,71 @@ namespace shellanything
     /// * Reload configuration files that were modified.
     /// * Deleted loaded configurations whose file are missing.
     /// * Discover new unloaded configuration files.
+    /// Modified configuration files are reloaded into a copy of their configuration. Only the modified top level menus are parsed again. See ConfigFile::Reload().
+    /// Modified configuration files which cannot be reloaded, such as files that declare plugins, are loaded as new configurations.
+    /// The previous configurations stay valid for the readers of the previous snapshots.
+    /// If a directory watch service is set, only the files reported as changed by the service are checked. See App::SetDirectoryWatchService().
     /// </summary>
     void Refresh();
 
+    /// <summary>
+    /// Set the number of threads used by Refresh() to validate and parse new configuration files concurrently.
+    /// Configuration files which declare plugins are loaded alone, in order, since plugins can modify properties.
+    /// The configurations are always added, and their default settings applied, in file order.
+    /// Refresh() waits for its threads. The count must be 1 when Refresh() is called from DllMain() since threads cannot start while the loader lock is held.
+    /// </summary>
+    /// <param name="count">The number of threads. 1 loads configuration files serially. 0 uses one thread per processor.</param>
+    void SetLoadThreadCount(size_t count);
+
+    /// <summary>
+    /// Get the number of threads used by Refresh() to load configuration files concurrently.
+    /// </summary>
+    size_t GetLoadThreadCount() const;
+
+    /// <summary>
+    /// Get the cache of compiled configuration files used by Refresh() to load new configuration files.
+    /// The cache is disabled until its directory is set. See ConfigCache::SetDirectory().
+    /// </summary>
+    ConfigCache& GetCache();
+
     /// <summary>
     /// Recursively update all loaded configurations.
     /// </summary>
     /// <param name="context">The selection context</param>
     void Update(const SelectionContext& context);
 
+    /// <summary>
+    /// Recursively update all loaded configurations.
+    /// The selection, the properties and the services are read from the given evaluation context.
+    /// </summary>
+    /// <param name="context">The evaluation context</param>
+    void Update(const EvaluationContext& context);
+
+    /// <summary>
+    /// Set the number of threads used by Update() to evaluate configurations concurrently.
+    /// Configurations which have plugins are updated alone, in order, since plugins can modify properties.
+    /// Other configurations only read properties and are updated concurrently. The results are the same as a serial update.
+    /// </summary>
+    /// <param name="count">The number of threads. 1 updates configurations serially. 0 uses one thread per processor.</param>
+    void SetUpdateThreadCount(size_t count);
+
+    /// <summary>
+    /// Get the number of threads used by Update() to evaluate configurations concurrently.
+    /// </summary>
+    size_t GetUpdateThreadCount() const;
+
+    /// <summary>
+    /// Get the number of menus that were evaluated again by the last Update().
+    /// Menus whose validators inputs did not change are not evaluated again.
+    /// </summary>
+    size_t GetEvaluatedMenuCount() const;
+
     /// <summary>
     /// Finds a loaded Menu pointer that is assigned the command id command_id.
+    /// After AssignCommandIds(), the search is a direct lookup in the table of assigned command ids.
     /// </summary>
     /// <param name="command_id">The search command id value.</param>
-    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise. The pointer is valid as long as the list returned by GetConfigFiles().</returns>
     Menu* FindMenuByCommandId(const uint32_t& command_id);
 
     /// <summary>
@@ -100,6 +186,8 @@ namespace shellanything
 
     /// <summary>
     /// Assign unique command id to all menus loaded by the configuration manager.
+    /// The command ids are written to the menus, which are shared with the previous snapshots. Readers of the command ids must use a read scope. See BeginRead().
+    /// The previous snapshots keep their own lookup table of command ids. See ConfigSnapshot::FindMenuByCommandId().
     /// </summary>
     /// <param name="first_command_id">The first command id available.</param>
     /// <returns>Returns the next available command id. Returns first_command_id if it failed assining command id.</returns>
@@ -119,11 +207,25 @@ namespace shellanything
   private:
     //methods
     void DeleteChildren();
-    void DeleteChild(ConfigFile* config);
+    void DeleteChild(ConfigSnapshot& draft, ConfigFile* config);
+    bool ReloadChild(ConfigSnapshot& draft, ConfigFile* config);
+    void UpdateConcurrently(const EvaluationContext& context, const ConfigFile::ConfigFilePtrList& configurations, size_t begin, size_t end, size_t thread_count);
+    bool GetChangedFiles(StringList& files);
+    const ConfigSnapshotPtr& ReadSnapshot() const;
+    void Publish(const ConfigSnapshotPtr& draft);
 
     //attributes
     StringList mPaths;
-    ConfigFile::ConfigFilePtrList mConfigurations;
+    ConfigSnapshotPtr mSnapshot; // accessed with std::atomic_load() and std::atomic_store()
+    std::atomic<size_t> mPublication;
+    std::mutex mWriteMutex;
+    std::atomic<size_t> mEvaluatedMenuCount;
+    size_t mUpdateThreadCount;
+    size_t mLoadThreadCount;
+    ConfigCache mCache;
+    IDirectoryWatchService* mWatchService; //the service which is watching mWatchedPaths
+    StringList mWatchedPaths;
+    bool mWatchingPaths; //true if all paths are watched
   };
 
 } //namespace shellanything
@@ -0,0 +1,110 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "ConfigSnapshot.h"
+
+namespace shellanything
+{
+  ConfigSnapshot::ConfigSnapshot() :
+    first_command_id(Menu::INVALID_COMMAND_ID)
+  {
+  }
+
+  ConfigSnapshot::~ConfigSnapshot()
+  {
+  }
+
+  const ConfigFile::ConfigFilePtrList& ConfigSnapshot::GetConfigFiles() const
+  {
+    return configurations;
+  }
+
+  bool ConfigSnapshot::IsConfigFileLoaded(const std::string& path) const
+  {
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      const ConfigFile* config = configurations[i];
+      if (config != NULL && config->GetFilePath() == path)
+        return true;
+    }
+    return false;
+  }
+
+  Menu* ConfigSnapshot::FindMenuByCommandId(const uint32_t& command_id) const
+  {
+    //command ids assigned by ConfigManager::AssignCommandIds() are contiguous
+    if (!command_id_menus.empty())
+    {
+      if (command_id < first_command_id)
+        return NULL;
+      size_t index = (size_t)(command_id - first_command_id);
+      if (index >= command_id_menus.size())
+        return NULL;
+      return command_id_menus[index];
+    }
+
+    //for each child
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      ConfigFile* config = configurations[i];
+      Menu* match = config->FindMenuByCommandId(command_id);
+      if (match)
+        return match;
+    }
+
+    return NULL;
+  }
+
+  Menu* ConfigSnapshot::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags) const
+  {
+    //for each child
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      ConfigFile* config = configurations[i];
+      Menu* match = config->FindMenuByName(name, flags);
+      if (match)
+        return match;
+    }
+
+    return NULL;
+  }
+
+  void ConfigSnapshot::BeginRead() const
+  {
+    //the configurations are always locked in the same order
+    for (size_t i = 0; i < configurations.size(); i++)
+    {
+      configurations[i]->BeginRead();
+    }
+  }
+
+  void ConfigSnapshot::EndRead() const
+  {
+    for (size_t i = configurations.size(); i > 0; i--)
+    {
+      configurations[i - 1]->EndRead();
+    }
+  }
+
+} //namespace shellanything
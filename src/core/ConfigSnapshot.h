@@ -0,0 +1,111 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_CONFIG_SNAPSHOT_H
+#define SA_CONFIG_SNAPSHOT_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "ConfigFile.h"
+#include "Menu.h"
+#include "Enums.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+namespace shellanything
+{
+  /// <summary>
+  /// An immutable version of the set of configurations loaded by the ConfigManager.
+  /// The set of a snapshot is never modified once it is published. It can be read by multiple threads without synchronization.
+  /// The menu nodes and the name indexes of the configurations are built before the snapshot is published. They can also be searched by multiple threads without synchronization.
+  /// The configurations of a snapshot are shared with the following snapshots. A configuration is deleted when the last snapshot that contains it is released.
+  /// The state of the menus of the configurations is not part of the snapshot. Use BeginRead() to read it while other threads may update the configurations.
+  /// See ConfigManager::GetSnapshot().
+  /// </summary>
+  class SHELLANYTHING_EXPORT ConfigSnapshot
+  {
+  public:
+    ConfigSnapshot();
+    virtual ~ConfigSnapshot();
+
+    /// <summary>
+    /// Get the list of ConfigFile pointers of this snapshot. The pointers are valid for the lifetime of the snapshot.
+    /// </summary>
+    const ConfigFile::ConfigFilePtrList& GetConfigFiles() const;
+
+    /// <summary>
+    /// Returns true if the given path is a ConfigFile of this snapshot.
+    /// </summary>
+    /// <param name="path">The path of a Configuration file</param>
+    /// <returns>Returns true if the given path is a ConfigFile of this snapshot. Returns false otherwise.</returns>
+    bool IsConfigFileLoaded(const std::string& path) const;
+
+    /// <summary>
+    /// Finds a Menu pointer that is assigned the command id command_id.
+    /// If the command ids were assigned when this snapshot was published, the search is a direct lookup in the table of assigned command ids.
+    /// Otherwise, the command ids of the menus are searched. They are part of the state of the menus. See BeginRead().
+    /// </summary>
+    /// <param name="command_id">The search command id value.</param>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    Menu* FindMenuByCommandId(const uint32_t& command_id) const;
+
+    /// <summary>
+    /// Finds a Menu pointer by a given name. The first menu that matches the given name is returned.
+    /// </summary>
+    /// <param name="name">The name of the menu.</param>
+    /// <param name="flags">The flags for searching by name.</param>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    Menu* FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_NONE) const;
+
+    /// <summary>
+    /// Begin a read scope of the state of the menus of all the configurations of this snapshot. See ConfigFile::BeginRead().
+    /// </summary>
+    void BeginRead() const;
+
+    /// <summary>
+    /// End a read scope of the state of the menus of all the configurations of this snapshot. See BeginRead().
+    /// </summary>
+    void EndRead() const;
+
+  private:
+    friend class ConfigManager;
+    typedef std::shared_ptr<ConfigFile> ConfigFileSharedPtr;
+    typedef std::vector<ConfigFileSharedPtr> ConfigFileSharedPtrList;
+
+    ConfigFile::ConfigFilePtrList configurations;
+    ConfigFileSharedPtrList owners; // keeps the configurations alive. Same order as configurations.
+    uint32_t first_command_id;
+    Menu::MenuPtrList command_id_menus; // menus indexed by command id, starting at first_command_id
+  };
+
+  /// <summary>
+  /// A shared pointer to a published ConfigSnapshot. The snapshot is released when the last pointer is released.
+  /// </summary>
+  typedef std::shared_ptr<const ConfigSnapshot> ConfigSnapshotPtr;
+
+} //namespace shellanything
+
+#endif //SA_CONFIG_SNAPSHOT_H
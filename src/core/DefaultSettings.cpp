@@ -27,7 +27,8 @@
 namespace shellanything
 {
 
-  DefaultSettings::DefaultSettings()
+  DefaultSettings::DefaultSettings() :
+    mSourceHash(0)
   {
   }
 
@@ -51,4 +52,14 @@ namespace shellanything
     return mActions;
   }
 
+  const uint64_t& DefaultSettings::GetSourceHash() const
+  {
+    return mSourceHash;
+  }
+
+  void DefaultSettings::SetSourceHash(const uint64_t& hash)
+  {
+    mSourceHash = hash;
+  }
+
 } //namespace shellanything
@@ -29,6 +29,8 @@
 #include "shellanything/config.h"
 #include "IAction.h"
 
+#include <stdint.h>
+
 namespace shellanything
 {
 
@@ -59,8 +61,20 @@ namespace shellanything
     /// </summary>
     const IAction::ActionPtrList& GetActions() const;
 
+    /// <summary>
+    /// Get the hash of the xml source of the default settings. See ConfigFile::Reload().
+    /// </summary>
+    /// <returns>Returns the hash of the xml source. Returns 0 if the source is unknown.</returns>
+    const uint64_t& GetSourceHash() const;
+
+    /// <summary>
+    /// Set the hash of the xml source of the default settings.
+    /// </summary>
+    void SetSourceHash(const uint64_t& hash);
+
   private:
     IAction::ActionPtrList mActions;
+    uint64_t mSourceHash;
   };
 
 } //namespace shellanything
@@ -39,6 +39,12 @@ namespace shellanything
     FIND_BY_NAME_ALL = (-1),
   };
 
+  enum WILDCARD_FLAGS
+  {
+    WILDCARD_NONE = 0,
+    WILDCARD_CASE_INSENSITIVE = 1,
+  };
+
 } //namespace shellanything
 
 #endif //SA_ENUMS_H
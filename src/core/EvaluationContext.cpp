@@ -0,0 +1,116 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "EvaluationContext.h"
+#include "PropertyManager.h"
+#include "FileProbeCache.h"
+
+namespace shellanything
+{
+  // Each thread runs its own evaluation.
+  static thread_local const EvaluationContext* gCurrentEvaluationContext = NULL;
+
+  EvaluationContext::EvaluationContext() :
+    mSelection(NULL),
+    mConfigFile(NULL),
+    mFileProbeCache(NULL),
+    mFileProbePass(FileProbeCache::INVALID_PASS)
+  {
+  }
+
+  EvaluationContext::EvaluationContext(const SelectionContext& selection) :
+    mSelection(&selection),
+    mConfigFile(NULL),
+    mFileProbeCache(NULL),
+    mFileProbePass(FileProbeCache::INVALID_PASS)
+  {
+  }
+
+  EvaluationContext::~EvaluationContext()
+  {
+  }
+
+  const SelectionContext& EvaluationContext::GetSelectionContext() const
+  {
+    static const SelectionContext empty_selection;
+    if (mSelection == NULL)
+      return empty_selection;
+    return *mSelection;
+  }
+
+  void EvaluationContext::SetSelectionContext(const SelectionContext* selection)
+  {
+    mSelection = selection;
+  }
+
+  PropertyManager& EvaluationContext::GetPropertyManager() const
+  {
+    return PropertyManager::GetInstance();
+  }
+
+  ConfigFile* EvaluationContext::GetConfigFile() const
+  {
+    return mConfigFile;
+  }
+
+  void EvaluationContext::SetConfigFile(ConfigFile* config)
+  {
+    mConfigFile = config;
+  }
+
+  FileProbeCache& EvaluationContext::GetFileProbeCache() const
+  {
+    if (mFileProbeCache == NULL)
+      return FileProbeCache::GetInstance();
+    return *mFileProbeCache;
+  }
+
+  void EvaluationContext::SetFileProbeCache(FileProbeCache* probes)
+  {
+    mFileProbeCache = probes;
+  }
+
+  size_t EvaluationContext::GetFileProbePass() const
+  {
+    return mFileProbePass;
+  }
+
+  void EvaluationContext::SetFileProbePass(size_t pass)
+  {
+    mFileProbePass = pass;
+  }
+
+  const EvaluationContext* EvaluationContext::GetCurrent()
+  {
+    return gCurrentEvaluationContext;
+  }
+
+  const EvaluationContext* EvaluationContext::SetCurrent(const EvaluationContext* context)
+  {
+    const EvaluationContext* previous = gCurrentEvaluationContext;
+    gCurrentEvaluationContext = context;
+    return previous;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,130 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_EVALUATION_CONTEXT_H
+#define SA_EVALUATION_CONTEXT_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "SelectionContext.h"
+
+namespace shellanything
+{
+  class PropertyManager;
+  class ConfigFile;
+  class FileProbeCache;
+
+  /// <summary>
+  /// The state of an evaluation of the menus.
+  /// An EvaluationContext carries the selection, the properties, the configuration being updated and the services
+  /// used by ConfigManager::Update(), Menu::Update(), Validator::Validate() and IAction::ExecuteInContext().
+  /// Each evaluation uses its own context. Evaluations using different contexts can run at the same time.
+  /// The state of the menus is stored in the configuration and is shared by all evaluations. Updates of the same configuration are serialized
+  /// and the menus keep the state of the last update. See ConfigFile::BeginRead().
+  /// </summary>
+  class SHELLANYTHING_EXPORT EvaluationContext
+  {
+  public:
+    EvaluationContext();
+    explicit EvaluationContext(const SelectionContext& selection);
+    virtual ~EvaluationContext();
+
+    /// <summary>
+    /// Get the selected elements of the evaluation.
+    /// </summary>
+    /// <returns>Returns the selected elements. Returns an empty selection if no selection is set.</returns>
+    const SelectionContext& GetSelectionContext() const;
+
+    /// <summary>
+    /// Set the selected elements of the evaluation.
+    /// </summary>
+    /// <param name="selection">The selected elements. The object must exists for the duration of the evaluation. Can be NULL.</param>
+    void SetSelectionContext(const SelectionContext* selection);
+
+    /// <summary>
+    /// Get the properties read by the evaluation.
+    /// </summary>
+    /// <returns>Returns the PropertyManager instance.</returns>
+    PropertyManager& GetPropertyManager() const;
+
+    /// <summary>
+    /// Get the configuration being updated.
+    /// </summary>
+    /// <returns>Returns the configuration being updated. Returns NULL if no configuration is updated.</returns>
+    ConfigFile* GetConfigFile() const;
+
+    /// <summary>
+    /// Set the configuration being updated.
+    /// </summary>
+    /// <param name="config">The configuration being updated. Can be NULL.</param>
+    void SetConfigFile(ConfigFile* config);
+
+    /// <summary>
+    /// Get the cache of file system probes used by the evaluation.
+    /// </summary>
+    /// <returns>Returns the cache set with SetFileProbeCache(). Returns the FileProbeCache instance if none is set.</returns>
+    FileProbeCache& GetFileProbeCache() const;
+
+    /// <summary>
+    /// Set the cache of file system probes used by the evaluation.
+    /// </summary>
+    /// <param name="probes">The cache of file system probes. Set to NULL to use the FileProbeCache instance.</param>
+    void SetFileProbeCache(FileProbeCache* probes);
+
+    /// <summary>
+    /// Get the pass of the cache of file system probes used by the evaluation.
+    /// </summary>
+    /// <returns>Returns the pass set with SetFileProbePass(). Returns FileProbeCache::INVALID_PASS if the probes are not cached.</returns>
+    size_t GetFileProbePass() const;
+
+    /// <summary>
+    /// Set the pass of the cache of file system probes used by the evaluation. See FileProbeCache::BeginPass().
+    /// </summary>
+    /// <param name="pass">The identifier of the pass. Set to FileProbeCache::INVALID_PASS to probe the file system directly.</param>
+    void SetFileProbePass(size_t pass);
+
+    /// <summary>
+    /// Get the context of the evaluation running on the current thread.
+    /// This allows functions that do not receive a context, like the plugin api, to find the one of the caller.
+    /// </summary>
+    /// <returns>Returns the context of the current thread. Returns NULL if no evaluation is running on the current thread.</returns>
+    static const EvaluationContext* GetCurrent();
+
+    /// <summary>
+    /// Set the context of the evaluation running on the current thread.
+    /// </summary>
+    /// <param name="context">The context of the current thread. Can be NULL.</param>
+    /// <returns>Returns the previous context of the current thread. The previous context must be restored when the evaluation completes.</returns>
+    static const EvaluationContext* SetCurrent(const EvaluationContext* context);
+
+  private:
+    const SelectionContext* mSelection;
+    ConfigFile* mConfigFile;
+    FileProbeCache* mFileProbeCache;
+    size_t mFileProbePass;
+  };
+
+} //namespace shellanything
+
+#endif //SA_EVALUATION_CONTEXT_H
@@ -0,0 +1,273 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "FileProbeCache.h"
+#include "DriveClass.h"
+
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+#include <thread>
+#include <functional>
+
+namespace shellanything
+{
+  static const int PROBE_NONE = 0;
+  static const int PROBE_FILE = 1;
+  static const int PROBE_DIRECTORY = 2;
+
+  const double FileProbeCache::DEFAULT_TIME_TO_LIVE = 0.0;
+  const double FileProbeCache::DEFAULT_NETWORK_DEADLINE = 250.0;
+  const size_t FileProbeCache::INVALID_PASS = 0;
+
+  int ProbeFileSystem(const std::string& path)
+  {
+    int flags = PROBE_NONE;
+    if (ra::filesystem::FileExistsUtf8(path.c_str()))
+      flags |= PROBE_FILE;
+    else if (ra::filesystem::DirectoryExistsUtf8(path.c_str()))
+      flags |= PROBE_DIRECTORY;
+    return flags;
+  }
+
+  FileProbeCache::FileProbeCache() :
+    mPass(INVALID_PASS),
+    mTimeToLive(DEFAULT_TIME_TO_LIVE),
+    mNetworkDeadline(DEFAULT_NETWORK_DEADLINE),
+    mHits(0),
+    mMisses(0),
+    mTimeouts(0)
+  {
+  }
+
+  FileProbeCache::~FileProbeCache()
+  {
+    //the cache is destroyed while the loader lock is held. the network probes are not joined.
+    //each probe owns its state and completes on its own.
+  }
+
+  FileProbeCache& FileProbeCache::GetInstance()
+  {
+    static FileProbeCache _instance;
+    return _instance;
+  }
+
+  size_t FileProbeCache::BeginPass()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mPass++;
+    if (mPass == INVALID_PASS)
+      mPass++;
+    mActivePasses.insert(mPass);
+
+    //forget about expired entries which are not used by an active pass
+    double now = ra::timing::GetMillisecondsTimer();
+    EntryMap::iterator it = mEntries.begin();
+    while (it != mEntries.end())
+    {
+      const ENTRY& entry = it->second;
+      if (!entry.pending.valid() && mActivePasses.find(entry.pass) == mActivePasses.end() && !IsValid(entry, mPass, now))
+        it = mEntries.erase(it);
+      else
+        it++;
+    }
+
+    return mPass;
+  }
+
+  void FileProbeCache::EndPass(size_t pass)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mActivePasses.erase(pass);
+  }
+
+  bool FileProbeCache::IsPassActive(size_t pass) const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mActivePasses.find(pass) != mActivePasses.end();
+  }
+
+  void FileProbeCache::SetTimeToLive(double milliseconds)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mTimeToLive = milliseconds;
+  }
+
+  double FileProbeCache::GetTimeToLive() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTimeToLive;
+  }
+
+  void FileProbeCache::SetNetworkDeadline(double milliseconds)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNetworkDeadline = milliseconds;
+  }
+
+  double FileProbeCache::GetNetworkDeadline() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNetworkDeadline;
+  }
+
+  bool FileProbeCache::FileExists(const std::string& path, size_t pass)
+  {
+    return (Probe(path, pass) & PROBE_FILE) != 0;
+  }
+
+  bool FileProbeCache::DirectoryExists(const std::string& path, size_t pass)
+  {
+    return (Probe(path, pass) & PROBE_DIRECTORY) != 0;
+  }
+
+  bool FileProbeCache::Exists(const std::string& path, size_t pass)
+  {
+    return Probe(path, pass) != PROBE_NONE;
+  }
+
+  void FileProbeCache::Clear()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+  }
+
+  size_t FileProbeCache::GetHitCount() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHits;
+  }
+
+  size_t FileProbeCache::GetMissCount() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMisses;
+  }
+
+  size_t FileProbeCache::GetTimeoutCount() const
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTimeouts;
+  }
+
+  void FileProbeCache::ResetStatistics()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mHits = 0;
+    mMisses = 0;
+    mTimeouts = 0;
+  }
+
+  bool FileProbeCache::IsValid(const ENTRY& entry, size_t pass, double now) const
+  {
+    if (entry.pass == pass)
+      return true;
+    return (now - entry.time <= mTimeToLive);
+  }
+
+  int FileProbeCache::Probe(const std::string& path, size_t pass)
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    //without a pass, the file system may change between two probes
+    if (mActivePasses.find(pass) == mActivePasses.end())
+    {
+      lock.unlock();
+      return ProbeFileSystem(path);
+    }
+
+    double now = ra::timing::GetMillisecondsTimer();
+    int previous_flags = PROBE_NONE;
+    EntryMap::iterator it = mEntries.find(path);
+    if (it != mEntries.end())
+    {
+      ENTRY& entry = it->second;
+      if (entry.pending.valid())
+      {
+        //a network probe is running
+        if (entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+          mTimeouts++;
+          return entry.flags;
+        }
+
+        //the network probe has completed
+        entry.flags = entry.pending.get();
+        entry.pending = std::shared_future<int>();
+        entry.time = now;
+        entry.pass = pass;
+      }
+
+      if (IsValid(entry, pass, now))
+      {
+        mHits++;
+        return entry.flags;
+      }
+      previous_flags = entry.flags;
+    }
+    mMisses++;
+
+    ENTRY entry;
+    entry.flags = previous_flags;
+    entry.time = now;
+    entry.pass = pass;
+
+    //mapped network drives are as slow as network paths
+    if (GetDriveClassFromPath(path) == DRIVE_CLASS_NETWORK)
+    {
+      //probe in the background to prevent an unreachable host from blocking the update
+      std::packaged_task<int()> task(std::bind(&ProbeFileSystem, path));
+      //the thread owns the task. the result is shared with the future.
+      std::shared_future<int> pending = task.get_future().share();
+      std::thread(std::move(task)).detach();
+
+      std::chrono::microseconds deadline((long long)(mNetworkDeadline * 1000.0));
+      lock.unlock();
+      bool completed = (pending.wait_for(deadline) == std::future_status::ready);
+      lock.lock();
+
+      if (completed)
+      {
+        entry.flags = pending.get();
+      }
+      else
+      {
+        //keep the previous result until the probe completes
+        entry.pending = pending;
+        mTimeouts++;
+      }
+    }
+    else
+    {
+      lock.unlock();
+      entry.flags = ProbeFileSystem(path);
+      lock.lock();
+    }
+
+    mEntries[path] = entry;
+    return entry.flags;
+  }
+
+} //namespace shellanything
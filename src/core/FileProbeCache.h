@@ -0,0 +1,196 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_FILE_PROBE_CACHE_H
+#define SA_FILE_PROBE_CACHE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include <string>
+#include <map>
+#include <set>
+#include <mutex>
+#include <future>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Caches the existence of files and directories during an update of the configurations.
+  /// </summary>
+  /// <remarks>
+  /// Probes are only cached between BeginPass() and EndPass(). Outside of a pass, the file system is probed directly.
+  /// Each update uses its own pass. Passes of concurrent updates are independent. See EvaluationContext::SetFileProbePass().
+  /// An entry is valid for the pass in which it was probed. It stays valid in the next passes until its time to live expires.
+  /// Network paths are probed asynchronously. If a probe does not complete before the network deadline,
+  /// the last known state of the path is reported, or missing if the path was never probed. The result of the probe is used by the next passes once available.
+  /// The background probes are detached and are never joined. A probe of an unreachable host can block for a long time
+  /// and the cache is destroyed while the process unloads the library.
+  /// </remarks>
+  class SHELLANYTHING_EXPORT FileProbeCache
+  {
+  public:
+    static FileProbeCache& GetInstance();
+  private:
+    FileProbeCache();
+    ~FileProbeCache();
+
+    // Disable copy constructor and copy operator
+    FileProbeCache(const FileProbeCache&);
+    FileProbeCache& operator=(const FileProbeCache&);
+
+  public:
+
+    /// <summary>
+    /// Default time to live of an entry in milliseconds. Entries are only valid for the pass in which they were probed.
+    /// </summary>
+    static const double DEFAULT_TIME_TO_LIVE;
+
+    /// <summary>
+    /// Default maximum time in milliseconds to wait for a network path to be probed.
+    /// </summary>
+    static const double DEFAULT_NETWORK_DEADLINE;
+
+    /// <summary>
+    /// An invalid pass identifier. Probes without a pass are not cached.
+    /// </summary>
+    static const size_t INVALID_PASS;
+
+    /// <summary>
+    /// Begin a new pass. The probes of the pass are cached until EndPass() is called.
+    /// Expired entries are removed from the cache.
+    /// </summary>
+    /// <returns>Returns the identifier of the new pass.</returns>
+    size_t BeginPass();
+
+    /// <summary>
+    /// End a pass. The other active passes are not affected.
+    /// </summary>
+    /// <param name="pass">The identifier of the pass returned by BeginPass().</param>
+    void EndPass(size_t pass);
+
+    /// <summary>
+    /// Returns true if the given pass is active.
+    /// </summary>
+    /// <param name="pass">The identifier of the pass returned by BeginPass().</param>
+    bool IsPassActive(size_t pass) const;
+
+    /// <summary>
+    /// Set the time in milliseconds an entry stays valid after the pass in which it was probed.
+    /// </summary>
+    /// <param name="milliseconds">The time to live of an entry in milliseconds.</param>
+    void SetTimeToLive(double milliseconds);
+
+    /// <summary>
+    /// Get the time in milliseconds an entry stays valid after the pass in which it was probed.
+    /// </summary>
+    double GetTimeToLive() const;
+
+    /// <summary>
+    /// Set the maximum time in milliseconds to wait for a network path to be probed.
+    /// </summary>
+    /// <param name="milliseconds">The maximum time to wait in milliseconds.</param>
+    void SetNetworkDeadline(double milliseconds);
+
+    /// <summary>
+    /// Get the maximum time in milliseconds to wait for a network path to be probed.
+    /// </summary>
+    double GetNetworkDeadline() const;
+
+    /// <summary>
+    /// Check if the given path is an existing file.
+    /// </summary>
+    /// <param name="path">The path of the file.</param>
+    /// <param name="pass">The pass of the caller. If the pass is not active, the file system is probed directly.</param>
+    /// <returns>Returns true if the file exists. Returns false otherwise.</returns>
+    bool FileExists(const std::string& path, size_t pass);
+
+    /// <summary>
+    /// Check if the given path is an existing directory.
+    /// </summary>
+    /// <param name="path">The path of the directory.</param>
+    /// <param name="pass">The pass of the caller. If the pass is not active, the file system is probed directly.</param>
+    /// <returns>Returns true if the directory exists. Returns false otherwise.</returns>
+    bool DirectoryExists(const std::string& path, size_t pass);
+
+    /// <summary>
+    /// Check if the given path is an existing file or directory.
+    /// </summary>
+    /// <param name="path">The path of the file or directory.</param>
+    /// <param name="pass">The pass of the caller. If the pass is not active, the file system is probed directly.</param>
+    /// <returns>Returns true if the file or directory exists. Returns false otherwise.</returns>
+    bool Exists(const std::string& path, size_t pass);
+
+    /// <summary>
+    /// Removes all the entries from the cache.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Get the number of probes that were resolved from the cache.
+    /// </summary>
+    size_t GetHitCount() const;
+
+    /// <summary>
+    /// Get the number of probes that required accessing the file system.
+    /// </summary>
+    size_t GetMissCount() const;
+
+    /// <summary>
+    /// Get the number of network probes that did not complete before the network deadline.
+    /// </summary>
+    size_t GetTimeoutCount() const;
+
+    /// <summary>
+    /// Reset the hit, miss and timeout counters.
+    /// </summary>
+    void ResetStatistics();
+
+  private:
+    struct ENTRY
+    {
+      int flags;
+      double time;
+      size_t pass;
+      std::shared_future<int> pending; // valid while a network probe is running
+    };
+    typedef std::map<std::string, ENTRY> EntryMap;
+    typedef std::set<size_t> PassSet;
+
+    int Probe(const std::string& path, size_t pass);
+    bool IsValid(const ENTRY& entry, size_t pass, double now) const;
+
+    mutable std::mutex mMutex;
+    EntryMap mEntries;
+    PassSet mActivePasses;
+    size_t mPass; // the identifier of the last pass
+    double mTimeToLive;
+    double mNetworkDeadline;
+    size_t mHits;
+    size_t mMisses;
+    size_t mTimeouts;
+  };
+
+} //namespace shellanything
+
+#endif //SA_FILE_PROBE_CACHE_H
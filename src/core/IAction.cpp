@@ -35,4 +35,12 @@ namespace shellanything
   {
   }
 
+  bool IAction::ExecuteInContext(const EvaluationContext& context) const
+  {
+    const EvaluationContext* previous_context = EvaluationContext::SetCurrent(&context);
+    bool success = Execute(context.GetSelectionContext());
+    EvaluationContext::SetCurrent(previous_context);
+    return success;
+  }
+
 } //namespace shellanything
@@ -28,6 +28,8 @@
 #include "shellanything/export.h"
 #include "shellanything/config.h"
 #include "SelectionContext.h"
+#include "EvaluationContext.h"
+#include "MemoryArena.h"
 #include <vector>
 
 namespace shellanything
@@ -37,7 +39,7 @@ namespace shellanything
   /// <summary>
   /// Abstract action class.
   /// </summary>
-  class SHELLANYTHING_EXPORT IAction
+  class SHELLANYTHING_EXPORT IAction : public ArenaObject
   {
   public:
     /// <summary>
@@ -74,6 +76,15 @@ namespace shellanything
     /// <returns>Returns true if the execution is successful. Returns false otherwise.</returns>
     virtual bool Execute(const SelectionContext& context) const = 0;
 
+    /// <summary>
+    /// Execute the action on the system with the given evaluation context.
+    /// The default implementation makes the context current for the duration of the execution and calls Execute() with the selection of the context.
+    /// The method has a distinct name so that actions which override Execute() do not hide it.
+    /// </summary>
+    /// <param name="context">The current context of evaluation.</param>
+    /// <returns>Returns true if the execution is successful. Returns false otherwise.</returns>
+    virtual bool ExecuteInContext(const EvaluationContext& context) const;
+
   };
 
 
@@ -24,8 +24,12 @@
 
 #include "IActionFactory.h"
 
+using namespace tinyxml2;
+
 namespace shellanything
 {
+  // The factory whose default ParseFromElement() is calling ParseFromXml() in the current thread.
+  static thread_local const IActionFactory* gDefaultParsingFactory = NULL;
 
   IActionFactory::IActionFactory()
   {
@@ -35,4 +39,54 @@ namespace shellanything
   {
   }
 
+  IAction* IActionFactory::ParseFromElement(const XMLElement* element, std::string& error) const
+  {
+    //convert the xml element to a string
+    XMLPrinter printer;
+    element->Accept(&printer);
+    std::string xml = printer.CStr();
+
+    const IActionFactory* previous_factory = gDefaultParsingFactory;
+    gDefaultParsingFactory = this;
+    IAction* action = ParseFromXml(xml, error);
+    gDefaultParsingFactory = previous_factory;
+    return action;
+  }
+
+  IAction* IActionFactory::ParseFromXml(const std::string& xml, std::string& error) const
+  {
+    //the default implementations call each other. One of them must be overridden.
+    if (gDefaultParsingFactory == this)
+    {
+      error = "Action factory '" + GetName() + "' does not implement ParseFromElement() or ParseFromXml().";
+      return NULL;
+    }
+
+    XMLDocument doc;
+    XMLError result = doc.Parse(xml.c_str());
+    if (result != XML_SUCCESS)
+    {
+      if (doc.ErrorStr())
+      {
+        error = doc.ErrorStr();
+        return NULL;
+      }
+      else
+      {
+        error = "Unknown error reported by XML library.";
+        return NULL;
+      }
+    }
+
+    const XMLElement* element = doc.FirstChildElement(GetName().c_str());
+    if (element == NULL)
+    {
+      error = "Element '" + GetName() + "' not found.";
+      return NULL;
+    }
+
+    IAction* action = ParseFromElement(element, error);
+    return action;
+  }
+
 } //namespace shellanything
@@ -28,6 +28,7 @@
 #include "shellanything/export.h"
 #include "shellanything/config.h"
 #include "IAction.h"
+#include "tinyxml2.h"
 #include <vector>
 
 namespace shellanything
@@ -59,13 +60,25 @@ namespace shellanything
     /// <returns>Returns the name of the action.</returns>
     virtual const std::string& GetName() const = 0;
 
+    /// <summary>
+    /// Parse an Action from an already parsed xml element.
+    /// The default implementation converts the element to a string and calls ParseFromXml().
+    /// Implementations must override this method, ParseFromXml() or both.
+    /// </summary>
+    /// <param name="element">The xml element (including child nodes) to parse.</param>
+    /// <param name="error">Provides an error description in case the parsing fails.</param>
+    /// <returns>Returns a pointer to a valid IAction if the parsing is successful. Returns NULL otherwise.</returns>
+    virtual IAction* ParseFromElement(const tinyxml2::XMLElement* element, std::string& error) const;
+
     /// <summary>
     /// Parse an Action from a xml.
+    /// The default implementation parses the string and calls ParseFromElement().
+    /// If neither method is overridden, the parsing fails with an error instead of recursing.
     /// </summary>
     /// <param name="xml">A string that contains the xml element (including child nodes) to parse.</param>
     /// <param name="error">Provides an error description in case the parsing fails.</param>
     /// <returns>Returns a pointer to a valid IAction if the parsing is successful. Returns NULL otherwise.</returns>
-    virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const = 0;
+    virtual IAction* ParseFromXml(const std::string& xml, std::string& error) const;
 
   };
 
@@ -0,0 +1,77 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_IDIRECTORY_WATCH_SERVICE_H
+#define SA_IDIRECTORY_WATCH_SERVICE_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+
+#include <string>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Abstract directory watching class.
+  /// A directory watch service records the files that are created, modified, deleted or renamed in watched directories.
+  /// </summary>
+  class SHELLANYTHING_EXPORT IDirectoryWatchService
+  {
+  public:
+    IDirectoryWatchService();
+    virtual ~IDirectoryWatchService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    IDirectoryWatchService(const IDirectoryWatchService&);
+    IDirectoryWatchService& operator=(const IDirectoryWatchService&);
+  public:
+
+    /// <summary>
+    /// Start watching a directory and its subdirectories.
+    /// </summary>
+    /// <param name="path">The path of the directory to watch.</param>
+    /// <returns>Returns true if the directory is watched. Returns false otherwise.</returns>
+    virtual bool Watch(const std::string& path) = 0;
+
+    /// <summary>
+    /// Stop watching all directories and forget the recorded changes.
+    /// </summary>
+    virtual void Clear() = 0;
+
+    /// <summary>
+    /// Get the files that have changed in the watched directories since the previous call.
+    /// The recorded changes are forgotten.
+    /// </summary>
+    /// <param name="files">The output list of the paths of the created, modified, deleted or renamed files.</param>
+    /// <returns>Returns true if the list contains all the changes. Returns false if changes may have been missed and the directories must be searched again.</returns>
+    virtual bool GetChanges(StringList& files) = 0;
+
+  };
+
+
+} //namespace shellanything
+
+#endif //SA_IDIRECTORY_WATCH_SERVICE_H
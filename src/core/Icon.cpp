@@ -61,9 +61,9 @@ namespace shellanything
 
   bool Icon::IsValid() const
   {
-    if (!mFileExtension.empty())
+    if (!mFileExtension.IsEmpty())
       return true;
-    if (mPath.empty() || mIndex == Icon::INVALID_ICON_INDEX)
+    if (mPath.IsEmpty() || mIndex == Icon::INVALID_ICON_INDEX)
       return false;
     return true;
   }
@@ -72,7 +72,7 @@ namespace shellanything
   {
     //is this menu have a file extension ?
     shellanything::PropertyManager& pmgr = shellanything::PropertyManager::GetInstance();
-    std::string file_extension = pmgr.Expand(mFileExtension);
+    std::string file_extension = pmgr.Expand(mFileExtension.Get());
     if (!file_extension.empty())
     {
       //check for multiple values. keep the first value, forget about other selected file extensions.
@@ -120,7 +120,7 @@ namespace shellanything
 
   const std::string& Icon::GetFileExtension() const
   {
-    return mFileExtension;
+    return mFileExtension.Get();
   }
 
   void Icon::SetFileExtension(const std::string& file_extension)
@@ -130,7 +130,7 @@ namespace shellanything
 
   const std::string& Icon::GetPath() const
   {
-    return mPath;
+    return mPath.Get();
   }
 
   void Icon::SetPath(const std::string& path)
@@ -27,6 +27,7 @@
 
 #include "shellanything/export.h"
 #include "shellanything/config.h"
+#include "InternedString.h"
 #include <string>
 #include <vector>
 #include <set>
@@ -98,8 +99,8 @@ namespace shellanything
   private:
     typedef std::set<std::string /*file extension*/> FileExtensionSet;
     static FileExtensionSet mUnresolvedFileExtensions;
-    std::string mFileExtension;
-    std::string mPath;
+    InternedString mFileExtension;
+    InternedString mPath;
     int mIndex;
   };
 
@@ -0,0 +1,172 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "InotifyDirectoryWatchService.h"
+
+#include <algorithm>
+
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+
+namespace shellanything
+{
+  static const uint32_t WATCH_EVENTS = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+  InotifyDirectoryWatchService::InotifyDirectoryWatchService() :
+    mFileDescriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+  {
+  }
+
+  InotifyDirectoryWatchService::~InotifyDirectoryWatchService()
+  {
+    if (mFileDescriptor >= 0)
+      close(mFileDescriptor);
+  }
+
+  bool InotifyDirectoryWatchService::Watch(const std::string& path)
+  {
+    if (mFileDescriptor < 0)
+      return false;
+    return AddWatch(path);
+  }
+
+  void InotifyDirectoryWatchService::Clear()
+  {
+    for (std::map<int, std::string>::const_iterator it = mDirectories.begin(); it != mDirectories.end(); it++)
+    {
+      inotify_rm_watch(mFileDescriptor, it->first);
+    }
+    mDirectories.clear();
+
+    //forget the pending events of the removed watches
+    StringList files;
+    bool complete = true;
+    ReadEvents(files, complete);
+  }
+
+  bool InotifyDirectoryWatchService::GetChanges(StringList& files)
+  {
+    files.clear();
+    if (mFileDescriptor < 0)
+      return false;
+
+    bool complete = true;
+    ReadEvents(files, complete);
+    return complete;
+  }
+
+  bool InotifyDirectoryWatchService::AddWatch(const std::string& path)
+  {
+    int wd = inotify_add_watch(mFileDescriptor, path.c_str(), WATCH_EVENTS | IN_ONLYDIR);
+    if (wd < 0)
+      return false;
+    mDirectories[wd] = path;
+
+    //watch the subdirectories
+    DIR* dir = opendir(path.c_str());
+    if (dir == NULL)
+      return false;
+
+    bool success = true;
+    struct dirent* entry = readdir(dir);
+    while (entry)
+    {
+      std::string name = entry->d_name;
+      if (name != "." && name != "..")
+      {
+        std::string child = path + "/" + name;
+        struct stat child_stat;
+        if (lstat(child.c_str(), &child_stat) == 0 && S_ISDIR(child_stat.st_mode))
+          success = AddWatch(child) && success;
+      }
+      entry = readdir(dir);
+    }
+    closedir(dir);
+
+    return success;
+  }
+
+  void InotifyDirectoryWatchService::ReadEvents(StringList& files, bool& complete)
+  {
+    //read all pending events without blocking
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (true)
+    {
+      ssize_t length = read(mFileDescriptor, buffer, sizeof(buffer));
+      if (length <= 0)
+        break; //EAGAIN: no more events
+
+      const char* position = buffer;
+      while (position < buffer + length)
+      {
+        const struct inotify_event* event = (const struct inotify_event*)position;
+        position += sizeof(struct inotify_event) + event->len;
+
+        //some events were dropped by the kernel
+        if (event->mask & IN_Q_OVERFLOW)
+        {
+          complete = false;
+          continue;
+        }
+
+        std::map<int, std::string>::iterator it = mDirectories.find(event->wd);
+        if (it == mDirectories.end())
+          continue; //not watched anymore
+
+        if (event->mask & IN_IGNORED)
+        {
+          mDirectories.erase(it);
+          continue;
+        }
+
+        //a watched directory was deleted or renamed
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+        {
+          complete = false;
+          continue;
+        }
+
+        if (event->len == 0)
+          continue;
+        std::string path = it->second + "/" + event->name;
+
+        //the files of a new directory are not known. Watch the directory and search it again.
+        if (event->mask & IN_ISDIR)
+        {
+          if (event->mask & (IN_CREATE | IN_MOVED_TO))
+            AddWatch(path);
+          complete = false;
+          continue;
+        }
+
+        if (std::find(files.begin(), files.end(), path) == files.end())
+          files.push_back(path);
+      }
+    }
+  }
+
+} //namespace shellanything
@@ -0,0 +1,79 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_INOTIFY_DIRECTORY_WATCH_SERVICE_H
+#define SA_INOTIFY_DIRECTORY_WATCH_SERVICE_H
+
+#include "IDirectoryWatchService.h"
+
+#include <map>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A IDirectoryWatchService which receives the changes of the watched directories from the Linux kernel (inotify).
+  /// The changes are read without blocking. GetChanges() costs nothing when no file has changed.
+  /// </summary>
+  class SHELLANYTHING_EXPORT InotifyDirectoryWatchService : public virtual IDirectoryWatchService
+  {
+  public:
+    InotifyDirectoryWatchService();
+    virtual ~InotifyDirectoryWatchService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    InotifyDirectoryWatchService(const InotifyDirectoryWatchService&);
+    InotifyDirectoryWatchService& operator=(const InotifyDirectoryWatchService&);
+  public:
+
+    /// <summary>
+    /// Start watching a directory and its subdirectories.
+    /// </summary>
+    /// <param name="path">The path of the directory to watch.</param>
+    /// <returns>Returns true if the directory is watched. Returns false otherwise.</returns>
+    virtual bool Watch(const std::string& path);
+
+    /// <summary>
+    /// Stop watching all directories and forget the recorded changes.
+    /// </summary>
+    virtual void Clear();
+
+    /// <summary>
+    /// Get the files that have changed in the watched directories since the previous call.
+    /// </summary>
+    /// <param name="files">The output list of the paths of the created, modified, deleted or renamed files.</param>
+    /// <returns>Returns true if the list contains all the changes. Returns false if the kernel's event queue overflowed or if a directory was created, deleted or renamed.</returns>
+    virtual bool GetChanges(StringList& files);
+
+  private:
+    bool AddWatch(const std::string& path);
+    void ReadEvents(StringList& files, bool& complete);
+
+    int mFileDescriptor;
+    std::map<int /*watch descriptor*/, std::string /*path*/> mDirectories;
+  };
+
+} //namespace shellanything
+
+#endif //SA_INOTIFY_DIRECTORY_WATCH_SERVICE_H
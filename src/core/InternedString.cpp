@@ -0,0 +1,200 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "InternedString.h"
+
+#include <unordered_map>
+#include <mutex>
+
+namespace shellanything
+{
+  typedef std::unordered_map<std::string /*value*/, std::atomic<size_t> /*references*/> StringPoolMap;
+
+  // The pool is never destroyed. Objects owned by static instances may release their strings during static destruction.
+  StringPoolMap& GetStringPool()
+  {
+    static StringPoolMap* _pool = new StringPoolMap();
+    return *_pool;
+  }
+
+  std::mutex& GetStringPoolMutex()
+  {
+    static std::mutex* _mutex = new std::mutex();
+    return *_mutex;
+  }
+
+  // Get the pool entry of a string value. The reference count of the entry is incremented.
+  StringPoolMap::value_type* AcquireString(const std::string& value)
+  {
+    if (value.empty())
+      return NULL;
+
+    //the lock prevents the entry from being removed while it is acquired
+    std::lock_guard<std::mutex> lock(GetStringPoolMutex());
+    StringPoolMap& pool = GetStringPool();
+    StringPoolMap::iterator it = pool.emplace(std::piecewise_construct, std::forward_as_tuple(value), std::forward_as_tuple(0)).first;
+    StringPoolMap::value_type* entry = &(*it);
+    entry->second.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+  }
+
+  void AcquireString(StringPoolMap::value_type* entry)
+  {
+    if (entry == NULL)
+      return;
+
+    //the caller already holds a reference. The entry can not be removed.
+    entry->second.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void ReleaseString(StringPoolMap::value_type* entry)
+  {
+    if (entry == NULL)
+      return;
+
+    //release without locking while other references remain
+    size_t references = entry->second.load(std::memory_order_relaxed);
+    while (references > 1)
+    {
+      if (entry->second.compare_exchange_weak(references, references - 1, std::memory_order_release, std::memory_order_relaxed))
+        return;
+    }
+
+    //the last reference may be released. The entry is removed under the lock, which prevents it from being acquired again by value.
+    std::lock_guard<std::mutex> lock(GetStringPoolMutex());
+    if (entry->second.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      StringPoolMap& pool = GetStringPool();
+      pool.erase(pool.find(entry->first));
+    }
+  }
+
+  InternedString::InternedString() :
+    mEntry(NULL)
+  {
+  }
+
+  InternedString::InternedString(const std::string& value) :
+    mEntry(AcquireString(value))
+  {
+  }
+
+  InternedString::InternedString(const InternedString& other) :
+    mEntry(other.mEntry)
+  {
+    AcquireString(mEntry);
+  }
+
+  InternedString::InternedString(STRING_ENTRY* entry) :
+    mEntry(entry)
+  {
+  }
+
+  InternedString::~InternedString()
+  {
+    ReleaseString(mEntry);
+  }
+
+  InternedString& InternedString::operator=(const InternedString& other)
+  {
+    if (mEntry != other.mEntry)
+    {
+      AcquireString(other.mEntry);
+      Assign(other.mEntry);
+    }
+    return (*this);
+  }
+
+  InternedString& InternedString::operator=(const std::string& value)
+  {
+    Assign(AcquireString(value));
+    return (*this);
+  }
+
+  bool InternedString::operator==(const InternedString& other) const
+  {
+    return mEntry == other.mEntry;
+  }
+
+  bool InternedString::operator!=(const InternedString& other) const
+  {
+    return mEntry != other.mEntry;
+  }
+
+  bool InternedString::operator<(const InternedString& other) const
+  {
+    return mEntry < other.mEntry;
+  }
+
+  bool InternedString::Find(const std::string& value, InternedString& result)
+  {
+    if (value.empty())
+    {
+      result = InternedString();
+      return true;
+    }
+
+    STRING_ENTRY* entry = NULL;
+    {
+      std::lock_guard<std::mutex> lock(GetStringPoolMutex());
+      StringPoolMap& pool = GetStringPool();
+      StringPoolMap::iterator it = pool.find(value);
+      if (it == pool.end())
+        return false;
+      entry = &(*it);
+      entry->second.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    result = InternedString(entry);
+    return true;
+  }
+
+  size_t InternedString::GetPoolSize()
+  {
+    std::lock_guard<std::mutex> lock(GetStringPoolMutex());
+    return GetStringPool().size();
+  }
+
+  const std::string& InternedString::Get() const
+  {
+    static const std::string EMPTY_STRING;
+    if (mEntry == NULL)
+      return EMPTY_STRING;
+    return mEntry->first;
+  }
+
+  bool InternedString::IsEmpty() const
+  {
+    return mEntry == NULL;
+  }
+
+  void InternedString::Assign(STRING_ENTRY* entry)
+  {
+    // The new entry is acquired before the previous one is released.
+    STRING_ENTRY* previous = mEntry;
+    mEntry = entry;
+    ReleaseString(previous);
+  }
+
+} //namespace shellanything
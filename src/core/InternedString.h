@@ -0,0 +1,94 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_INTERNEDSTRING_H
+#define SA_INTERNEDSTRING_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <string>
+#include <utility>
+#include <atomic>
+
+namespace shellanything
+{
+  /// <summary>
+  /// An InternedString is a handle to an immutable string stored in a process-wide pool.
+  /// All the handles of the same string value share a single copy of the string.
+  /// Two handles are equal if and only if they point to the same pooled string. Comparing handles only compares pointers.
+  /// A pooled string is released when its last handle is destroyed.
+  /// Handles can be created, copied and destroyed by multiple threads at the same time.
+  /// Copying a handle and releasing a string that has other handles only change an atomic reference count. The pool is only locked to add or remove a string.
+  /// </summary>
+  class SHELLANYTHING_EXPORT InternedString
+  {
+  public:
+    InternedString();
+    explicit InternedString(const std::string& value);
+    InternedString(const InternedString& other);
+    ~InternedString();
+
+    InternedString& operator=(const InternedString& other);
+    InternedString& operator=(const std::string& value);
+
+    bool operator==(const InternedString& other) const;
+    bool operator!=(const InternedString& other) const;
+    bool operator<(const InternedString& other) const;
+
+    /// <summary>
+    /// Find the handle of a string value in the pool. The pool is not modified.
+    /// </summary>
+    /// <param name="value">The string value to find.</param>
+    /// <param name="result">The output handle of the pooled string.</param>
+    /// <returns>Returns true if the value is an empty string or if the value is in the pool. Returns false otherwise.</returns>
+    static bool Find(const std::string& value, InternedString& result);
+
+    /// <summary>
+    /// Get the number of distinct strings in the pool.
+    /// </summary>
+    static size_t GetPoolSize();
+
+    /// <summary>
+    /// Get the value of the string.
+    /// </summary>
+    /// <returns>Returns the string value. The reference is valid for the lifetime of the handle.</returns>
+    const std::string& Get() const;
+
+    /// <summary>
+    /// Check if the string is empty.
+    /// </summary>
+    bool IsEmpty() const;
+
+  private:
+    typedef std::pair<const std::string /*value*/, std::atomic<size_t> /*references*/> STRING_ENTRY;
+    explicit InternedString(STRING_ENTRY* entry);
+    void Assign(STRING_ENTRY* entry);
+
+    STRING_ENTRY* mEntry; // NULL for the empty string
+  };
+
+} //namespace shellanything
+
+#endif //SA_INTERNEDSTRING_H
@@ -0,0 +1,156 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "MemoryArena.h"
+
+#include <new>
+
+namespace shellanything
+{
+  static thread_local MemoryArena* gCurrentArena = NULL;
+
+  const size_t MemoryArena::CHUNK_SIZE = 64 * 1024;
+  const size_t MemoryArena::ALIGNMENT = 16;
+
+  // The header stored before each block allocated by ArenaObject::operator new().
+  // The header size is a multiple of MemoryArena::ALIGNMENT to keep the objects aligned.
+  union OBJECT_HEADER
+  {
+    MemoryArena* arena;
+    char padding[16];
+  };
+
+  static size_t AlignSize(size_t size)
+  {
+    size_t aligned_size = (size + MemoryArena::ALIGNMENT - 1) & ~(MemoryArena::ALIGNMENT - 1);
+    return aligned_size;
+  }
+
+  MemoryArena::MemoryArena() :
+    mOffset(0),
+    mAllocations(0),
+    mAllocatedSize(0),
+    mCapacity(0)
+  {
+  }
+
+  MemoryArena::~MemoryArena()
+  {
+    for (size_t i = 0; i < mChunks.size(); i++)
+    {
+      ::operator delete(mChunks[i].data);
+    }
+    mChunks.clear();
+  }
+
+  MemoryArena* MemoryArena::GetCurrentArena()
+  {
+    return gCurrentArena;
+  }
+
+  MemoryArena* MemoryArena::SetCurrentArena(MemoryArena* arena)
+  {
+    MemoryArena* previous = gCurrentArena;
+    gCurrentArena = arena;
+    return previous;
+  }
+
+  void* MemoryArena::Allocate(size_t size)
+  {
+    size = AlignSize(size);
+
+    //allocate a new chunk if the block does not fit in the last chunk
+    if (mChunks.empty() || mOffset + size > mChunks.back().size)
+    {
+      //large blocks get their own chunk
+      CHUNK chunk;
+      chunk.size = (size > CHUNK_SIZE ? size : CHUNK_SIZE);
+      chunk.data = static_cast<char*>(::operator new(chunk.size));
+      mChunks.push_back(chunk);
+      mOffset = 0;
+      mCapacity += chunk.size;
+    }
+
+    void* block = mChunks.back().data + mOffset;
+    mOffset += size;
+    mAllocations++;
+    mAllocatedSize += size;
+    return block;
+  }
+
+  size_t MemoryArena::GetAllocationCount() const
+  {
+    return mAllocations;
+  }
+
+  size_t MemoryArena::GetAllocatedSize() const
+  {
+    return mAllocatedSize;
+  }
+
+  size_t MemoryArena::GetChunkCount() const
+  {
+    return mChunks.size();
+  }
+
+  size_t MemoryArena::GetCapacity() const
+  {
+    return mCapacity;
+  }
+
+  void* ArenaObject::operator new(size_t size)
+  {
+    MemoryArena* arena = gCurrentArena;
+    size_t block_size = sizeof(OBJECT_HEADER) + size;
+
+    OBJECT_HEADER* header = NULL;
+    if (arena)
+      header = static_cast<OBJECT_HEADER*>(arena->Allocate(block_size));
+    else
+      header = static_cast<OBJECT_HEADER*>(::operator new(block_size));
+    header->arena = arena;
+
+    return header + 1;
+  }
+
+  void ArenaObject::operator delete(void* ptr)
+  {
+    if (ptr == NULL)
+      return;
+
+    //the memory of arena objects is released with their arena
+    OBJECT_HEADER* header = static_cast<OBJECT_HEADER*>(ptr) - 1;
+    if (header->arena == NULL)
+      ::operator delete(header);
+  }
+
+  MemoryArena* ArenaObject::GetObjectArena(const void* ptr)
+  {
+    if (ptr == NULL)
+      return NULL;
+    const OBJECT_HEADER* header = static_cast<const OBJECT_HEADER*>(ptr) - 1;
+    return header->arena;
+  }
+
+} //namespace shellanything
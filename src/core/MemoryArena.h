@@ -0,0 +1,141 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_MEMORYARENA_H
+#define SA_MEMORYARENA_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <stddef.h>
+#include <vector>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A MemoryArena allocates many small memory blocks from a few large chunks.
+  /// The blocks are never released individually. All chunks are released at once when the arena is destroyed.
+  /// An arena is not thread safe. It must only be used by a single thread at a time.
+  /// </summary>
+  class SHELLANYTHING_EXPORT MemoryArena
+  {
+  public:
+    MemoryArena();
+    virtual ~MemoryArena();
+
+  private:
+    // Disable copy constructor and copy operator
+    MemoryArena(const MemoryArena&);
+    MemoryArena& operator=(const MemoryArena&);
+  public:
+
+    /// <summary>
+    /// The default size in bytes of the chunks of an arena.
+    /// </summary>
+    static const size_t CHUNK_SIZE;
+
+    /// <summary>
+    /// The alignment in bytes of the blocks allocated by an arena.
+    /// </summary>
+    static const size_t ALIGNMENT;
+
+    /// <summary>
+    /// Get the arena used for allocating ArenaObject instances in the current thread.
+    /// </summary>
+    /// <returns>Returns the current arena of the thread. Returns NULL if objects are allocated on the heap.</returns>
+    static MemoryArena* GetCurrentArena();
+
+    /// <summary>
+    /// Set the arena used for allocating ArenaObject instances in the current thread.
+    /// </summary>
+    /// <param name="arena">The new current arena. Set to NULL to allocate objects on the heap.</param>
+    /// <returns>Returns the previous current arena of the thread.</returns>
+    static MemoryArena* SetCurrentArena(MemoryArena* arena);
+
+    /// <summary>
+    /// Allocate a memory block from the arena. The block is aligned on ALIGNMENT bytes.
+    /// The block is released when the arena is destroyed.
+    /// </summary>
+    /// <param name="size">The size in bytes of the block.</param>
+    /// <returns>Returns a pointer to the allocated block.</returns>
+    void* Allocate(size_t size);
+
+    /// <summary>
+    /// Get the number of blocks allocated from the arena.
+    /// </summary>
+    size_t GetAllocationCount() const;
+
+    /// <summary>
+    /// Get the total size in bytes of the blocks allocated from the arena.
+    /// </summary>
+    size_t GetAllocatedSize() const;
+
+    /// <summary>
+    /// Get the number of chunks of the arena.
+    /// </summary>
+    size_t GetChunkCount() const;
+
+    /// <summary>
+    /// Get the total size in bytes of the chunks of the arena.
+    /// </summary>
+    size_t GetCapacity() const;
+
+  private:
+    struct CHUNK
+    {
+      char* data;
+      size_t size;
+    };
+    typedef std::vector<CHUNK> ChunkList;
+
+    ChunkList mChunks;
+    size_t mOffset; // offset of the next block in the last chunk
+    size_t mAllocations;
+    size_t mAllocatedSize;
+    size_t mCapacity;
+  };
+
+  /// <summary>
+  /// Base class for objects allocated from the current MemoryArena of the thread.
+  /// Objects created while an arena is current are allocated from that arena. Other objects are allocated on the heap.
+  /// Deleting an object always runs its destructor. The memory of an arena object is only released with its arena.
+  /// An arena object must be deleted before its arena is destroyed.
+  /// </summary>
+  class SHELLANYTHING_EXPORT ArenaObject
+  {
+  public:
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
+    /// <summary>
+    /// Check if an object was allocated from an arena.
+    /// </summary>
+    /// <param name="ptr">A pointer to an object allocated with ArenaObject::operator new().</param>
+    /// <returns>Returns the arena of the object. Returns NULL if the object was allocated on the heap.</returns>
+    static MemoryArena* GetObjectArena(const void* ptr);
+  };
+
+} //namespace shellanything
+
+#endif //SA_MEMORYARENA_H
@@ -23,7 +23,9 @@
  *********************************************************************************/
 
 #include "Menu.h"
+#include "ConfigFile.h"
 #include "Unicode.h"
+#include "CaseFolding.h"
 #include "PropertyManager.h"
 
 #include "rapidassist/strings.h"
@@ -41,7 +43,14 @@ namespace shellanything
     mColumnSeparator(false),
     mCommandId(INVALID_COMMAND_ID),
     mVisible(true),
-    mEnabled(true)
+    mEnabled(true),
+    mSourceHash(0),
+    mStateValid(false),
+    mStateVisible(true),
+    mStateEnabled(true),
+    mStateVolatile(false),
+    mStateSelectionDependent(false),
+    mStateStableVersion(0)
   {
   }
 
@@ -138,12 +147,18 @@ namespace shellanything
 
   const std::string& Menu::GetName() const
   {
-    return mName;
+    return mName.Get();
   }
 
   void Menu::SetName(const std::string& name)
   {
     mName = name;
+    InvalidateMenuNodes();
+  }
+
+  const InternedString& Menu::GetInternedName() const
+  {
+    return mName;
   }
 
   const int& Menu::GetNameMaxLength() const
@@ -184,7 +199,7 @@ namespace shellanything
 
   const std::string& Menu::GetDescription() const
   {
-    return mDescription;
+    return mDescription.Get();
   }
 
   void Menu::SetDescription(const std::string& description)
@@ -202,11 +217,69 @@ namespace shellanything
     mIcon = icon;
   }
 
+  // Returns true if one of the given validators is valid for any selection.
+  bool HasAlwaysValidValidator(const Validator::ValidatorPtrList& validators)
+  {
+    for (size_t i = 0; i < validators.size(); i++)
+    {
+      const Validator* validator = validators[i];
+      if (validator && validator->IsAlwaysValid())
+        return true;
+    }
+    return false;
+  }
+
   void Menu::Update(const SelectionContext& context)
   {
+    EvaluationContext evaluation_context(context);
+    Update(evaluation_context);
+  }
+
+  void Menu::Update(const EvaluationContext& context)
+  {
+    //update current menu
+    UpdateState(context);
+
+    //update children
+    bool all_invisible_children = true;
+
+    //for each child
+    const Menu::MenuPtrList& children = mSubMenus;
+    for (size_t i = 0; i < children.size(); i++)
+    {
+      Menu* child = children[i];
+      child->Update(context);
+
+      //refresh the flag
+      all_invisible_children = all_invisible_children && !child->IsVisible();
+    }
+
+    //Issue #4 - Parent menu with no children.
+    //if all the direct children of this menu are invisible
+    if (IsParentMenu() && IsVisible() && all_invisible_children)
+    {
+      //force this node as invisible.
+      SetVisible(false);
+    }
+  }
+
+  void Menu::UpdateState(const SelectionContext& context)
+  {
+    EvaluationContext evaluation_context(context);
+    UpdateState(evaluation_context);
+  }
+
+  void Menu::UpdateState(const EvaluationContext& context)
+  {
+    //record the properties read by the validators
+    PropertyManager& pmgr = context.GetPropertyManager();
+    mStateDependencies.Clear();
+    PropertyDependencies* previous_recorder = pmgr.SetDependencyRecorder(&mStateDependencies);
+
     //update current menu
+    //note, validators are combined with a logical OR. A validator which is always valid makes the others irrelevant.
     bool visible = true;
-    if (!mVisibilities.empty())
+    if (!mVisibilities.empty() && !HasAlwaysValidValidator(mVisibilities))
     {
       visible = false;
       size_t count = GetVisibilityCount();
@@ -220,7 +293,7 @@ namespace shellanything
       }
     }
     bool enabled = true;
-    if (!mValidities.empty())
+    if (!mValidities.empty() && !HasAlwaysValidValidator(mValidities))
     {
       enabled = false;
       size_t count = GetValidityCount();
@@ -233,29 +306,80 @@ namespace shellanything
         }
       }
     }
+    pmgr.SetDependencyRecorder(previous_recorder);
+
     SetVisible(visible);
     SetEnabled(enabled);
 
-    //update children
-    bool all_invisible_children = true;
+    //remember the results and what they depends on
+    mStateValid = true;
+    mStateVisible = visible;
+    mStateEnabled = enabled;
+    mStateVolatile = false;
+    mStateSelectionDependent = false;
+    mStateStableVersion = pmgr.GetStableVersion();
+    for (size_t i = 0; i < mVisibilities.size(); i++)
+    {
+      mStateVolatile |= mVisibilities[i]->IsVolatile();
+      mStateSelectionDependent |= mVisibilities[i]->IsSelectionDependent();
+    }
+    for (size_t i = 0; i < mValidities.size(); i++)
+    {
+      mStateVolatile |= mValidities[i]->IsVolatile();
+      mStateSelectionDependent |= mValidities[i]->IsSelectionDependent();
+    }
+  }
 
-    //for each child
-    Menu::MenuPtrList children = GetSubMenus();
-    for (size_t i = 0; i < children.size(); i++)
+  bool Menu::UpdateStateIfChanged(const SelectionContext& context, bool selection_changed)
+  {
+    EvaluationContext evaluation_context(context);
+    return UpdateStateIfChanged(evaluation_context, selection_changed);
+  }
+
+  bool Menu::UpdateStateIfChanged(const EvaluationContext& context, bool selection_changed)
+  {
+    PropertyManager& pmgr = context.GetPropertyManager();
+    bool changed = (!mStateValid ||
+                    mStateVolatile ||
+                    (mStateSelectionDependent && selection_changed) ||
+                    mStateStableVersion != pmgr.GetStableVersion() ||
+                    mStateDependencies.IsChanged());
+    if (changed)
     {
-      Menu* child = children[i];
-      child->Update(context);
+      UpdateState(context);
+      return true;
+    }
 
-      //refresh the flag
-      all_invisible_children = all_invisible_children && !child->IsVisible();
+    //restore the results of the last update. a parent menu may have been forced invisible since then.
+    SetVisible(mStateVisible);
+    SetEnabled(mStateEnabled);
+    return false;
+  }
+
+  void Menu::InvalidateState()
+  {
+    mStateValid = false;
+  }
+
+  void Menu::FoldConstants()
+  {
+    for (size_t i = 0; i < mVisibilities.size(); i++)
+    {
+      Validator* validator = mVisibilities[i];
+      validator->FoldConstants();
+    }
+    for (size_t i = 0; i < mValidities.size(); i++)
+    {
+      Validator* validator = mValidities[i];
+      validator->FoldConstants();
     }
 
-    //Issue #4 - Parent menu with no children.
-    //if all the direct children of this menu are invisible
-    if (IsParentMenu() && visible && all_invisible_children)
+    //for each child
+    const Menu::MenuPtrList& children = mSubMenus;
+    for (size_t i = 0; i < children.size(); i++)
     {
-      //force this node as invisible.
-      SetVisible(false);
+      Menu* child = children[i];
+      child->FoldConstants();
     }
   }
 
@@ -265,7 +389,7 @@ namespace shellanything
       return this;
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
+    const Menu::MenuPtrList& children = mSubMenus;
     for (size_t i = 0; i < children.size(); i++)
     {
       Menu* child = children[i];
@@ -279,28 +403,33 @@ namespace shellanything
 
   Menu* Menu::FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags)
   {
+    // Names that are not expanded and case sensitive are compared by their interned handle.
+    if ((flags & FIND_BY_NAME_EXPANDS) == 0 && (flags & FIND_BY_NAME_CASE_INSENSITIVE) == 0)
+    {
+      //a name that is not in the string pool is not the name of any menu
+      InternedString interned_name;
+      if (!InternedString::Find(name, interned_name))
+        return NULL;
+      return FindMenuByName(interned_name);
+    }
+
     // Get the menu name and expand it if requested.
-    std::string menu_name = mName;
+    std::string menu_name = mName.Get();
     if (flags & FIND_BY_NAME_EXPANDS)
     {
       PropertyManager& pmgr = PropertyManager::GetInstance();
-      std::string expanded = pmgr.Expand(mName);
+      std::string expanded = pmgr.Expand(mName.Get());
       menu_name = expanded;
     }
 
     // Is it this menu?
     if (menu_name == name)
       return this;
-    else if (flags & FIND_BY_NAME_CASE_INSENSITIVE)
-    {
-      std::string u_menu_name = ra::strings::Uppercase(menu_name);
-      std::string u_name = ra::strings::Uppercase(name);
-      if (u_menu_name == u_name)
-        return this;
-    }
+    else if ((flags & FIND_BY_NAME_CASE_INSENSITIVE) && EqualsCaseInsensitive(menu_name, name))
+      return this;
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
+    const Menu::MenuPtrList& children = mSubMenus;
     for (size_t i = 0; i < children.size(); i++)
     {
       Menu* child = children[i];
@@ -312,6 +441,24 @@ namespace shellanything
     return NULL;
   }
 
+  Menu* Menu::FindMenuByName(const InternedString& name)
+  {
+    // Is it this menu?
+    if (mName == name)
+      return this;
+
+    //for each child
+    for (size_t i = 0; i < mSubMenus.size(); i++)
+    {
+      Menu* child = mSubMenus[i];
+      Menu* match = child->FindMenuByName(name);
+      if (match)
+        return match;
+    }
+
+    return NULL;
+  }
+
   uint32_t Menu::AssignCommandIds(const uint32_t& first_command_id)
   {
     uint32_t next_command_id = first_command_id;
@@ -329,7 +476,7 @@ namespace shellanything
     }
 
     //for each child
-    Menu::MenuPtrList children = GetSubMenus();
+    const Menu::MenuPtrList& children = mSubMenus;
     for (size_t i = 0; i < children.size(); i++)
     {
       Menu* child = children[i];
@@ -391,6 +538,7 @@ namespace shellanything
   {
     mValidities.push_back(validator);
     validator->SetParentMenu(this);
+    InvalidateState();
   }
 
   size_t Menu::GetVisibilityCount() const
@@ -411,9 +559,10 @@ namespace shellanything
   {
     mVisibilities.push_back(validator);
     validator->SetParentMenu(this);
+    InvalidateState();
   }
 
-  Menu::MenuPtrList Menu::GetSubMenus()
+  const Menu::MenuPtrList& Menu::GetSubMenus() const
   {
     return mSubMenus;
   }
@@ -422,6 +571,17 @@ namespace shellanything
   {
     mSubMenus.push_back(menu);
     menu->SetParentMenu(this);
+    InvalidateMenuNodes();
+  }
+
+  const uint64_t& Menu::GetSourceHash() const
+  {
+    return mSourceHash;
+  }
+
+  void Menu::SetSourceHash(const uint64_t& hash)
+  {
+    mSourceHash = hash;
   }
 
   void Menu::AddAction(IAction* action)
@@ -435,4 +595,15 @@ namespace shellanything
     return mActions;
   }
 
+  void Menu::InvalidateMenuNodes()
+  {
+    //the flattened menus of the configuration are out of date
+    Menu* root = this;
+    while (root->GetParentMenu())
+      root = root->GetParentMenu();
+    ConfigFile* config = root->GetParentConfigFile();
+    if (config)
+      config->InvalidateMenuNodes();
+  }
+
 } //namespace shellanything
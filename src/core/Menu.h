@@ -31,6 +31,9 @@
 #include "Validator.h"
 #include "IAction.h"
 #include "Enums.h"
+#include "PropertyDependencies.h"
+#include "MemoryArena.h"
+#include "InternedString.h"
 
 #include <string>
 #include <vector>
@@ -43,7 +46,7 @@ namespace shellanything
   /// <summary>
   /// The Menu class defines a displayed menu option.
   /// </summary>
-  class SHELLANYTHING_EXPORT Menu
+  class SHELLANYTHING_EXPORT Menu : public ArenaObject
   {
   public:
     /// <summary>
@@ -86,6 +89,7 @@ namespace shellanything
 
     /// <summary>
     /// Get the parent ConfigFile.
+    /// The parent is the configuration which loaded the menu. It is removed once the configuration is published, since a published menu may be shared by multiple configurations. See ConfigFile::DetachMenus().
     /// </summary>
     /// <returns>Returns a pointer to the parent ConfigFile. Returns NULL if the object has no parent ConfigFile.</returns>
     ConfigFile* GetParentConfigFile();
@@ -137,6 +141,11 @@ namespace shellanything
     /// </summary>
     void SetName(const std::string& name);
 
+    /// <summary>
+    /// Get the interned handle of the 'name' parameter.
+    /// </summary>
+    const InternedString& GetInternedName() const;
+
     /// <summary>
     /// Getter for the 'max_length' parameter.
     /// </summary>
@@ -186,6 +195,53 @@ namespace shellanything
     /// <param name="context">The selection context</param>
     void Update(const SelectionContext& context);
 
+    /// <summary>
+    /// Recursively update the menu and submenus properties.
+    /// </summary>
+    /// <param name="context">The evaluation context</param>
+    void Update(const EvaluationContext& context);
+
+    /// <summary>
+    /// Update the visible and enabled properties of this menu only. Submenus are not updated.
+    /// The properties read by the validators are recorded. See UpdateStateIfChanged().
+    /// </summary>
+    /// <param name="context">The selection context</param>
+    void UpdateState(const SelectionContext& context);
+
+    /// <summary>
+    /// Update the visible and enabled properties of this menu only. Submenus are not updated.
+    /// </summary>
+    /// <param name="context">The evaluation context</param>
+    void UpdateState(const EvaluationContext& context);
+
+    /// <summary>
+    /// Update the visible and enabled properties of this menu only if the inputs of its validators have changed since the last update.
+    /// Otherwise, the results of the last update are restored.
+    /// </summary>
+    /// <param name="context">The selection context</param>
+    /// <param name="selection_changed">True if the elements of the selection have changed since the last update. False otherwise.</param>
+    /// <returns>Returns true if the validators of the menu were evaluated. Returns false otherwise.</returns>
+    bool UpdateStateIfChanged(const SelectionContext& context, bool selection_changed);
+
+    /// <summary>
+    /// Update the visible and enabled properties of this menu only if the inputs of its validators have changed since the last update.
+    /// </summary>
+    /// <param name="context">The evaluation context</param>
+    /// <param name="selection_changed">True if the elements of the selection have changed since the last update. False otherwise.</param>
+    /// <returns>Returns true if the validators of the menu were evaluated. Returns false otherwise.</returns>
+    bool UpdateStateIfChanged(const EvaluationContext& context, bool selection_changed);
+
+    /// <summary>
+    /// Invalidate the results of the last update. The next call to UpdateStateIfChanged() evaluates the validators again.
+    /// </summary>
+    void InvalidateState();
+
+    /// <summary>
+    /// Recursively pre-evaluates the validators of the menu and submenus which only depends on stable properties.
+    /// See Validator::FoldConstants() for details.
+    /// </summary>
+    void FoldConstants();
+
     /// <summary>
     /// Searches this menu and submenus for a menu whose command id is command_id.
     /// </summary>
@@ -201,6 +257,13 @@ namespace shellanything
     /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
     Menu* FindMenuByName(const std::string& name, FIND_BY_NAME_FLAGS flags = FIND_BY_NAME_NONE);
 
+    /// <summary>
+    /// Finds a loaded Menu pointer by a given interned name. Names are compared by their interned handle.
+    /// </summary>
+    /// <param name="name">The interned name of the menu.</param>
+    /// <returns>Returns a Menu pointer if a match is found. Returns NULL otherwise.</returns>
+    Menu* FindMenuByName(const InternedString& name);
+
     /// <summary>
     /// Assign unique command id to this menus and submenus.
     /// </summary>
@@ -294,9 +357,24 @@ namespace shellanything
     /// <summary>
     /// Get the list of submenu of the menu.
     /// </summary>
-    MenuPtrList GetSubMenus();
+    const MenuPtrList& GetSubMenus() const;
+
+    /// <summary>
+    /// Get the hash of the xml source of the menu, including its submenus. See ConfigFile::Reload().
+    /// </summary>
+    /// <returns>Returns the hash of the xml source. Returns 0 if the source of the menu is unknown.</returns>
+    const uint64_t& GetSourceHash() const;
+
+    /// <summary>
+    /// Set the hash of the xml source of the menu.
+    /// </summary>
+    void SetSourceHash(const uint64_t& hash);
 
   private:
+    //methods
+    void InvalidateMenuNodes();
+
+    //attributes
     Menu* mParentMenu;
     ConfigFile* mParentConfigFile;
     Icon mIcon;
@@ -307,11 +385,21 @@ namespace shellanything
     bool mSeparator;
     bool mColumnSeparator;
     uint32_t mCommandId;
-    std::string mName;
+    InternedString mName;
     int mNameMaxLength;
-    std::string mDescription;
+    InternedString mDescription;
     IAction::ActionPtrList mActions;
     MenuPtrList mSubMenus;
+    uint64_t mSourceHash;
+
+    // Results of the last UpdateState() and their inputs.
+    bool mStateValid;
+    bool mStateVisible;
+    bool mStateEnabled;
+    bool mStateVolatile;
+    bool mStateSelectionDependent;
+    size_t mStateStableVersion;
+    PropertyDependencies mStateDependencies;
   };
 
 } //namespace shellanything
@@ -53,6 +53,18 @@ namespace shellanything
   static const std::string& NODE_ACTION_PROPERTY = ActionProperty::XML_ELEMENT_NAME;
   static const std::string NODE_PLUGIN = "plugin";
 
+  // Each thread parses its own configuration file.
+  // The active plugins and the recorded action sources are specific to the parsing thread.
+  static thread_local Plugin::PluginPtrList gActivePlugins;
+  static thread_local ObjectFactory::ActionSourceMap* gActionSources = NULL;
+  static thread_local int gLineOffset = 0;
+
+  // Get the line number of an element in its file. See ObjectFactory::SetLineOffset().
+  int GetLineNumber(const XMLElement* element)
+  {
+    return element->GetLineNum() + gLineOffset;
+  }
+
   ObjectFactory::ObjectFactory()
   {
     // Add IAction factories for native actions.
@@ -97,6 +109,25 @@ namespace shellanything
     return elements;
   }
 
+  // Look for a factory in the registry for the element name or in the registry of the given plugins.
+  IActionFactory* FindActionFactory(const Registry& registry, const Plugin::PluginPtrList& plugins, const std::string& name)
+  {
+    IActionFactory* factory = registry.GetActionFactoryFromName(name);
+
+    //or look for a factory in plugin's registry
+    for (size_t i = 0; i < plugins.size() && factory == NULL; i++)
+    {
+      Plugin* p = plugins[i];
+      if (!p)
+        continue;
+
+      Registry& plugin_registry = p->GetRegistry();
+      factory = plugin_registry.GetActionFactoryFromName(name);
+    }
+
+    return factory;
+  }
+
   bool ObjectFactory::ParseAttribute(const XMLElement* element, const char* attr_name, bool is_optional, bool allow_empty_values, std::string& attr_value, std::string& error)
   {
     if (element == NULL)
@@ -115,7 +146,7 @@ namespace shellanything
     }
     else if (!attr_node)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is missing attribute '" + std::string(attr_name) + "'.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is missing attribute '" + std::string(attr_name) + "'.";
       return false;
     }
 
@@ -123,7 +154,7 @@ namespace shellanything
 
     if (!allow_empty_values && attr_value.empty())
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " have attribute '" + std::string(attr_name) + "' value empty.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " have attribute '" + std::string(attr_name) + "' value empty.";
       return false;
     }
 
@@ -152,12 +183,22 @@ namespace shellanything
 
   void ObjectFactory::SetActivePlugins(const Plugin::PluginPtrList& plugins)
   {
-    mPlugins = plugins;
+    gActivePlugins = plugins;
   }
 
   void ObjectFactory::ClearActivePlugins()
   {
-    mPlugins.clear();
+    gActivePlugins.clear();
+  }
+
+  const Plugin::PluginPtrList& ObjectFactory::GetActivePlugins() const
+  {
+    return gActivePlugins;
+  }
+
+  void ObjectFactory::SetLineOffset(int offset)
+  {
+    gLineOffset = offset;
   }
 
   Validator* ObjectFactory::ParseValidator(const tinyxml2::XMLElement* element, std::string& error)
@@ -170,7 +211,7 @@ namespace shellanything
 
     if (NODE_VALIDITY != element->Name() && NODE_VISIBILITY != element->Name() && NODE_ACTION_STOP != element->Name())
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is not a <validity> or <visibility> node";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is not a <validity> or <visibility> node";
       return NULL;
     }
 
@@ -294,9 +335,9 @@ namespace shellanything
 
     //parse plugin's custom conditions attributes
     PropertyStore customs_attributes;
-    for (size_t i = 0; i < mPlugins.size(); i++)
+    for (size_t i = 0; i < gActivePlugins.size(); i++)
     {
-      Plugin* p = mPlugins[i];
+      Plugin* p = gActivePlugins[i];
       if (!p)
         continue;
 
@@ -318,6 +359,9 @@ namespace shellanything
     }
     validator->SetCustomAttributes(customs_attributes);
 
+    //resolve which plugin's attribute validators are required by the custom attributes
+    validator->ResolvePluginValidators(gActivePlugins);
+
     //success
     return validator;
   }
@@ -333,37 +377,55 @@ namespace shellanything
     std::string name = element->Name();
 
     //look for a factory in the registry for the element name
-    IActionFactory* factory = registry.GetActionFactoryFromName(name);
-
-    //or look for a factory in plugin's registry
-    for (size_t i = 0; i < mPlugins.size() && factory == NULL; i++)
-    {
-      Plugin* p = mPlugins[i];
-      if (!p)
-        continue;
-
-      Registry& plugin_registry = p->GetRegistry();
-      factory = plugin_registry.GetActionFactoryFromName(name);
-    }
+    IActionFactory* factory = FindActionFactory(registry, gActivePlugins, name);
 
     //if a factory was found
     if (factory)
     {
-      //convert the xml element to a string
-      XMLPrinter printer;
-      element->Accept(&printer);
-      std::string text = printer.CStr();
+      //try to parse an IAction from the element
+      IAction* action = factory->ParseFromElement(element, error);
+
+      //remember the source of the action
+      if (action && gActionSources)
+      {
+        //convert the xml element to a string
+        XMLPrinter printer;
+        element->Accept(&printer);
+
+        ACTION_SOURCE& source = (*gActionSources)[action];
+        source.name = name;
+        source.xml = printer.CStr();
+      }
 
-      //try to parse an IAction from the string
-      IAction* action = factory->ParseFromXml(text, error);
       return action;
     }
 
     //invalid
-    error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is an unknown type.";
+    error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is an unknown type.";
     return NULL;
   }
 
+  IAction* ObjectFactory::ParseAction(const std::string& name, const std::string& xml, std::string& error)
+  {
+    IActionFactory* factory = FindActionFactory(registry, gActivePlugins, name);
+    if (factory == NULL)
+    {
+      error = "Action '" + name + "' is an unknown type.";
+      return NULL;
+    }
+
+    //try to parse an IAction from the string
+    IAction* action = factory->ParseFromXml(xml, error);
+    return action;
+  }
+
+  ObjectFactory::ActionSourceMap* ObjectFactory::SetActionSources(ActionSourceMap* sources)
+  {
+    ActionSourceMap* previous = gActionSources;
+    gActionSources = sources;
+    return previous;
+  }
+
   Menu* ObjectFactory::ParseMenu(const XMLElement* element, std::string& error)
   {
     if (element == NULL)
@@ -375,7 +437,7 @@ namespace shellanything
     std::string xml_name = element->Name();
     if (xml_name != NODE_MENU)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is an unknown type.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is an unknown type.";
       return NULL;
     }
 
@@ -583,7 +645,7 @@ namespace shellanything
     std::string xml_name = element->Name();
     if (xml_name != NODE_ICON)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is an unknown type.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is an unknown type.";
       return NULL;
     }
 
@@ -630,7 +692,7 @@ namespace shellanything
     std::string xml_name = element->Name();
     if (xml_name != NODE_DEFAULTSETTINGS)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is an unknown type.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is an unknown type.";
       return NULL;
     }
 
@@ -683,7 +745,7 @@ namespace shellanything
     std::string xml_name = element->Name();
     if (xml_name != NODE_PLUGIN)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is an unknown type.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is an unknown type.";
       return NULL;
     }
 
@@ -692,7 +754,7 @@ namespace shellanything
     bool hasPath = ParseAttribute(element, "path", true, true, path, error);
     if (!hasPath)
     {
-      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(element->GetLineNum()) + " is missing a path attribute.";
+      error = "Node '" + std::string(element->Name()) + "' at line " + ra::strings::ToString(GetLineNumber(element)) + " is missing a path attribute.";
       return NULL;
     }
 
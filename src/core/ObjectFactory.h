@@ -37,6 +37,8 @@
 #include "Registry.h"
 #include "tinyxml2.h"
 
+#include <map>
+
 namespace shellanything
 {
 
@@ -56,6 +58,20 @@ namespace shellanything
   public:
     static ObjectFactory& GetInstance();
 
+    /// <summary>
+    /// The xml source of a parsed IAction.
+    /// </summary>
+    struct ACTION_SOURCE
+    {
+      std::string name; // the name of the xml element
+      std::string xml;  // the xml text given to the action's factory
+    };
+
+    /// <summary>
+    /// A map of the xml source of parsed IAction objects.
+    /// </summary>
+    typedef std::map<const IAction*, ACTION_SOURCE> ActionSourceMap;
+
     /// <summary>
     /// Parse a string attribute in a xml node.
     /// </summary>
@@ -82,15 +98,29 @@ namespace shellanything
 
     /// <summary>
     /// Set the list of active plugins that must be used for parsing object.
+    /// The active plugins are set for the current thread only. Each thread can parse a different configuration file.
     /// </summary>
     /// <param name="plugins">The list of plugins objects.</param>
     void SetActivePlugins(const Plugin::PluginPtrList& plugins);
 
     /// <summary>
-    /// Clears the active plugins used for parsing.
+    /// Clears the active plugins used for parsing on the current thread.
     /// </summary>
     void ClearActivePlugins();
 
+    /// <summary>
+    /// Get the list of active plugins used for parsing on the current thread.
+    /// </summary>
+    const Plugin::PluginPtrList& GetActivePlugins() const;
+
+    /// <summary>
+    /// Set the number of lines to add to the line numbers of the parsed elements, in error descriptions.
+    /// This is required when an element is parsed apart from the rest of its file.
+    /// The offset is set for the current thread only.
+    /// </summary>
+    /// <param name="offset">The number of lines that precede the parsed xml in its file.</param>
+    void SetLineOffset(int offset);
+
     /// <summary>
     /// Parses an Icon class from xml. Returns false if the parsing failed.
     /// </summary>
@@ -115,6 +145,23 @@ namespace shellanything
     /// <returns>Returns a valid IAction pointer if the object was properly parsed. Returns NULL otherwise.</returns>
     IAction* ParseAction(const tinyxml2::XMLElement* element, std::string& error);
 
+    /// <summary>
+    /// Parses a IAction class from the xml text of an element. Returns NULL if the parsing failed.
+    /// The action is parsed by the factory registered for the element name or by the factory of an active plugin.
+    /// </summary>
+    /// <param name="name">The name of the xml element.</param>
+    /// <param name="xml">The xml text of the element.</param>
+    /// <param name="error">The error description if the parsing failed.</param>
+    /// <returns>Returns a valid IAction pointer if the object was properly parsed. Returns NULL otherwise.</returns>
+    IAction* ParseAction(const std::string& name, const std::string& xml, std::string& error);
+
+    /// <summary>
+    /// Set the map where the xml source of the actions parsed from xml elements on the current thread is recorded.
+    /// </summary>
+    /// <param name="sources">The map of action sources. Set to NULL to stop recording.</param>
+    /// <returns>Returns the previous map of action sources.</returns>
+    ActionSourceMap* SetActionSources(ActionSourceMap* sources);
+
     /// <summary>
     /// Parses a Menu class from xml. Returns NULL if the parsing failed.
     /// </summary>
@@ -141,7 +188,6 @@ namespace shellanything
 
   public:
     Registry registry;
-    Plugin::PluginPtrList mPlugins;
   };
 
 } //namespace shellanything
@@ -52,12 +52,18 @@ namespace shellanything
   };
 
   Plugin* gLoadingPlugin = NULL;
+  size_t gPluginGeneration = 0;
 
   Plugin* Plugin::GetLoadingPlugin()
   {
     return gLoadingPlugin;
   }
 
+  size_t Plugin::GetGeneration()
+  {
+    return gPluginGeneration;
+  }
+
   Plugin::Plugin() :
     mParentConfigFile(NULL),
     mLoaded(false),
@@ -74,6 +80,7 @@ namespace shellanything
   Plugin::~Plugin()
   {
     Unload();
+    gPluginGeneration++;
 
     if (mEntryPoints)
       delete mEntryPoints;
@@ -231,6 +238,7 @@ namespace shellanything
 
     // remember this plugin while loading. This is required for plugins that registers features through the API.
     gLoadingPlugin = this;
+    gPluginGeneration++;
 
     //initialize & register the plugin
     sa_version_info_t version;
@@ -300,6 +308,7 @@ namespace shellanything
     gLoadingPlugin = NULL;
 
     mRegistry.Clear();
+    gPluginGeneration++;
 
     FreeLibrary(mEntryPoints->hModule);
     memset(mEntryPoints, 0, sizeof(Plugin::ENTRY_POINTS));
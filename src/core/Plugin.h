@@ -53,6 +53,13 @@ namespace shellanything
     /// <returns>Returns a Plugin pointer which is currently executing the Load() method. Returns NULL if no plugin is actually loading.</returns>
     static Plugin* GetLoadingPlugin();
 
+    /// <summary>
+    /// Get the generation of the plugins. The generation is increased each time a plugin is loaded, unloaded or deleted.
+    /// Objects that remember the features of a plugin must resolve them again when the generation changes.
+    /// </summary>
+    /// <returns>Returns the generation of the plugins.</returns>
+    static size_t GetGeneration();
+
     Plugin();
     Plugin(const Plugin& p);
     virtual ~Plugin();
@@ -0,0 +1,102 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PollingDirectoryWatchService.h"
+
+#include "rapidassist/filesystem_utf8.h"
+
+namespace shellanything
+{
+
+  PollingDirectoryWatchService::PollingDirectoryWatchService()
+  {
+  }
+
+  PollingDirectoryWatchService::~PollingDirectoryWatchService()
+  {
+  }
+
+  bool PollingDirectoryWatchService::Watch(const std::string& path)
+  {
+    FileDateMap files;
+    if (!Search(path, files))
+      return false;
+
+    mDirectories.push_back(path);
+    mFiles.insert(files.begin(), files.end());
+    return true;
+  }
+
+  void PollingDirectoryWatchService::Clear()
+  {
+    mDirectories.clear();
+    mFiles.clear();
+  }
+
+  bool PollingDirectoryWatchService::GetChanges(StringList& files)
+  {
+    files.clear();
+
+    bool complete = true;
+    FileDateMap current;
+    for (size_t i = 0; i < mDirectories.size(); i++)
+    {
+      if (!Search(mDirectories[i], current))
+        complete = false;
+    }
+
+    //find the created and modified files
+    for (FileDateMap::const_iterator it = current.begin(); it != current.end(); it++)
+    {
+      FileDateMap::const_iterator previous = mFiles.find(it->first);
+      if (previous == mFiles.end() || previous->second != it->second)
+        files.push_back(it->first);
+    }
+
+    //find the deleted files
+    for (FileDateMap::const_iterator it = mFiles.begin(); it != mFiles.end(); it++)
+    {
+      if (current.find(it->first) == current.end())
+        files.push_back(it->first);
+    }
+
+    mFiles.swap(current);
+    return complete;
+  }
+
+  bool PollingDirectoryWatchService::Search(const std::string& path, FileDateMap& files) const
+  {
+    ra::strings::StringVector found;
+    if (!ra::filesystem::FindFilesUtf8(found, path.c_str()))
+      return false;
+
+    for (size_t i = 0; i < found.size(); i++)
+    {
+      const std::string& file_path = found[i];
+      files[file_path] = ra::filesystem::GetFileModifiedDateUtf8(file_path);
+    }
+    return true;
+  }
+
+} //namespace shellanything
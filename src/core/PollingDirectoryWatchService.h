@@ -0,0 +1,81 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_POLLING_DIRECTORY_WATCH_SERVICE_H
+#define SA_POLLING_DIRECTORY_WATCH_SERVICE_H
+
+#include "IDirectoryWatchService.h"
+
+#include <map>
+#include <stdint.h>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A IDirectoryWatchService which searches the watched directories on each call to GetChanges().
+  /// The changes are found by comparing the files and their modified date with the previous search.
+  /// This service works on all platforms but its cost is proportional to the number of watched files.
+  /// </summary>
+  class SHELLANYTHING_EXPORT PollingDirectoryWatchService : public virtual IDirectoryWatchService
+  {
+  public:
+    PollingDirectoryWatchService();
+    virtual ~PollingDirectoryWatchService();
+
+  private:
+    // Disable and copy constructor, dtor and copy operator
+    PollingDirectoryWatchService(const PollingDirectoryWatchService&);
+    PollingDirectoryWatchService& operator=(const PollingDirectoryWatchService&);
+  public:
+
+    /// <summary>
+    /// Start watching a directory and its subdirectories.
+    /// </summary>
+    /// <param name="path">The path of the directory to watch.</param>
+    /// <returns>Returns true if the directory is watched. Returns false otherwise.</returns>
+    virtual bool Watch(const std::string& path);
+
+    /// <summary>
+    /// Stop watching all directories and forget the recorded changes.
+    /// </summary>
+    virtual void Clear();
+
+    /// <summary>
+    /// Get the files that have changed in the watched directories since the previous call.
+    /// </summary>
+    /// <param name="files">The output list of the paths of the created, modified, deleted or renamed files.</param>
+    /// <returns>Returns true if the list contains all the changes. Returns false if a watched directory cannot be searched.</returns>
+    virtual bool GetChanges(StringList& files);
+
+  private:
+    typedef std::map<std::string /*path*/, uint64_t /*modified date*/> FileDateMap;
+    bool Search(const std::string& path, FileDateMap& files) const;
+
+    StringList mDirectories;
+    FileDateMap mFiles;
+  };
+
+} //namespace shellanything
+
+#endif //SA_POLLING_DIRECTORY_WATCH_SERVICE_H
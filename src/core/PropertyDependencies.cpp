@@ -0,0 +1,78 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PropertyDependencies.h"
+#include "PropertyManager.h"
+
+namespace shellanything
+{
+  PropertyDependencies::PropertyDependencies()
+  {
+  }
+
+  PropertyDependencies::~PropertyDependencies()
+  {
+  }
+
+  void PropertyDependencies::Clear()
+  {
+    versions.clear();
+  }
+
+  void PropertyDependencies::Add(const std::string& name, size_t version)
+  {
+    //insert() does not replace the version of an existing dependency
+    versions.insert(VersionMap::value_type(name, version));
+  }
+
+  bool PropertyDependencies::Contains(const std::string& name) const
+  {
+    bool found = (versions.find(name) != versions.end());
+    return found;
+  }
+
+  bool PropertyDependencies::IsChanged() const
+  {
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    for (VersionMap::const_iterator it = versions.begin(); it != versions.end(); ++it)
+    {
+      const std::string& name = it->first;
+      size_t version = it->second;
+      if (pmgr.GetPropertyVersion(name) != version)
+        return true;
+    }
+    return false;
+  }
+
+  size_t PropertyDependencies::GetCount() const
+  {
+    return versions.size();
+  }
+
+  bool PropertyDependencies::IsEmpty() const
+  {
+    return versions.empty();
+  }
+
+} //namespace shellanything
@@ -0,0 +1,93 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_PROPERTY_DEPENDENCIES_H
+#define SA_PROPERTY_DEPENDENCIES_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include <string>
+#include <map>
+
+namespace shellanything
+{
+  /// <summary>
+  /// Records the properties read by an evaluation and the version of each property at the time it was read.
+  /// An evaluation must be done again only if one of its dependencies has changed.
+  /// See PropertyManager::SetDependencyRecorder().
+  /// </summary>
+  class SHELLANYTHING_EXPORT PropertyDependencies
+  {
+  public:
+    PropertyDependencies();
+    virtual ~PropertyDependencies();
+
+    //------------------------
+    // Typedef
+    //------------------------
+    typedef std::map<std::string /*name*/, size_t /*version*/> VersionMap;
+
+    /// <summary>
+    /// Clears all the recorded dependencies.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Record a dependency to the given property.
+    /// If the property is already recorded, the version of the first read is kept.
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    /// <param name="version">The version of the property at the time it was read. See PropertyManager::GetPropertyVersion().</param>
+    void Add(const std::string& name, size_t version);
+
+    /// <summary>
+    /// Check if the given property is a recorded dependency.
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    /// <returns>Returns true if the property is a dependency. Returns false otherwise.</returns>
+    bool Contains(const std::string& name) const;
+
+    /// <summary>
+    /// Check if one of the recorded properties have changed since it was read.
+    /// </summary>
+    /// <returns>Returns true if a dependency have changed. Returns false otherwise.</returns>
+    bool IsChanged() const;
+
+    /// <summary>
+    /// Get the number of recorded dependencies.
+    /// </summary>
+    size_t GetCount() const;
+
+    /// <summary>
+    /// Check if no dependencies are recorded.
+    /// </summary>
+    bool IsEmpty() const;
+
+  private:
+    VersionMap versions;
+  };
+
+} //namespace shellanything
+
+#endif //SA_PROPERTY_DEPENDENCIES_H
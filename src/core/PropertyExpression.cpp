@@ -0,0 +1,267 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PropertyExpression.h"
+#include "PropertyManager.h"
+#include "rapidassist/strings.h"
+
+#include <stdlib.h> // strtod
+
+namespace shellanything
+{
+  static const std::string VARIABLE_NAME_PREFIX = "sa_property_";
+
+  inline bool IsSymbolCharacter(char c)
+  {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+      return true;
+    if (c == '_' || c == '.')
+      return true;
+    return false;
+  }
+
+  /// <summary>
+  /// Returns true if the given character can be next to a numeric operand in an expression.
+  /// </summary>
+  inline bool IsOperandDelimiter(char c)
+  {
+    if (IsSymbolCharacter(c))
+      return false;
+    if (c == '\'' || c == '$' || c == '{' || c == '}')
+      return false;
+    return true;
+  }
+
+  /// <summary>
+  /// Returns true if the given value is an unsigned numeric literal. Such a value has the same meaning as text and as a numeric variable.
+  /// </summary>
+  bool IsNumericLiteral(const std::string& value, double& number)
+  {
+    if (value.empty())
+      return false;
+    if (value[0] < '0' || value[0] > '9')
+      return false;
+    for (size_t i = 0; i < value.size(); i++)
+    {
+      const char& c = value[i];
+      bool valid = (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-';
+      if (!valid)
+        return false;
+    }
+
+    const char* start = value.c_str();
+    char* end = NULL;
+    number = strtod(start, &end);
+    return (end == start + value.size());
+  }
+
+  PropertyExpression::PropertyExpression() :
+    mBindable(false)
+  {
+  }
+
+  PropertyExpression::PropertyExpression(const PropertyExpression& e)
+  {
+    (*this) = e;
+  }
+
+  PropertyExpression::~PropertyExpression()
+  {
+  }
+
+  const PropertyExpression& PropertyExpression::operator =(const PropertyExpression& e)
+  {
+    if (this != &e)
+    {
+      mExpression = e.mExpression;
+      mBoundExpression = e.mBoundExpression;
+      mReferences = e.mReferences;
+      mBindable = e.mBindable;
+    }
+    return (*this);
+  }
+
+  void PropertyExpression::SetExpression(const std::string& expression)
+  {
+    mExpression = expression;
+    mBoundExpression.clear();
+    mReferences.clear();
+    mBindable = true;
+
+    static const std::string token_open = "${";
+    static const std::string token_close = "}";
+
+    bool in_string = false;
+    size_t i = 0;
+    while (i < expression.size())
+    {
+      const char& c = expression[i];
+
+      // Is this a string literal which is a single property reference?
+      bool quoted_reference = (!in_string && c == '\'' && expression.compare(i + 1, token_open.size(), token_open) == 0);
+
+      if (c == '\'' && !quoted_reference)
+      {
+        in_string = !in_string;
+        mBoundExpression.append(1, c);
+        i++;
+        continue;
+      }
+      if (in_string && c == '\\' && i + 1 < expression.size())
+      {
+        // Escaped character in a string literal
+        mBoundExpression.append(expression, i, 2);
+        i += 2;
+        continue;
+      }
+
+      size_t reference_start = (quoted_reference ? i + 1 : i);
+      if (expression.compare(reference_start, token_open.size(), token_open) != 0)
+      {
+        mBoundExpression.append(1, c);
+        i++;
+        continue;
+      }
+
+      // Found a property reference
+      size_t name_start = reference_start + token_open.size();
+      size_t name_end = expression.find(token_close, name_start);
+      if (name_end == std::string::npos)
+      {
+        // Not a property reference
+        mBoundExpression.append(expression, i, std::string::npos);
+        break;
+      }
+      std::string name = expression.substr(name_start, name_end - name_start);
+      size_t reference_end = name_end + token_close.size(); // first character after the reference
+
+      bool bindable = (!in_string && !name.empty() && name.find('$') == std::string::npos);
+      if (bindable && quoted_reference)
+      {
+        // The reference must be the whole string literal.
+        bindable = (reference_end < expression.size() && expression[reference_end] == '\'');
+        reference_end++;
+      }
+      else if (bindable)
+      {
+        // The reference must be a whole operand.
+        bool delimited_before = (i == 0 || IsOperandDelimiter(expression[i - 1]));
+        bool delimited_after = (reference_end == expression.size() || IsOperandDelimiter(expression[reference_end]));
+        bindable = (delimited_before && delimited_after);
+      }
+      if (!bindable)
+      {
+        mBindable = false;
+        break;
+      }
+
+      // Reuse the same variable for the same property
+      REFERENCE reference;
+      reference.name = name;
+      reference.is_string = quoted_reference;
+      for (size_t j = 0; j < mReferences.size(); j++)
+      {
+        const REFERENCE& r = mReferences[j];
+        if (r.name == reference.name && r.is_string == reference.is_string)
+          reference.variable = r.variable;
+      }
+      if (reference.variable.empty())
+      {
+        reference.variable = VARIABLE_NAME_PREFIX + ra::strings::ToString(mReferences.size());
+        mReferences.push_back(reference);
+      }
+
+      mBoundExpression.append(reference.variable);
+      i = reference_end;
+    }
+
+    if (!mBindable)
+    {
+      mBoundExpression.clear();
+      mReferences.clear();
+    }
+  }
+
+  const std::string& PropertyExpression::GetExpression() const
+  {
+    return mExpression;
+  }
+
+  const std::string& PropertyExpression::GetBoundExpression() const
+  {
+    return mBoundExpression;
+  }
+
+  bool PropertyExpression::IsBindable() const
+  {
+    return mBindable;
+  }
+
+  bool PropertyExpression::Bind(VARIABLES& variables) const
+  {
+    variables.list.clear();
+    variables.expanded_values.clear();
+    if (!mBindable)
+      return false;
+
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+
+    // Values that contains property references must be expanded first.
+    // Pointers to the expanded values are only taken once all values are expanded.
+    std::vector<size_t> expanded_indices(mReferences.size(), (size_t)-1);
+    for (size_t i = 0; i < mReferences.size(); i++)
+    {
+      const REFERENCE& r = mReferences[i];
+      if (!pmgr.HasProperty(r.name))
+        return false; // the reference must be kept as text
+      const std::string& value = pmgr.GetProperty(r.name);
+      if (value.find("${") != std::string::npos)
+      {
+        expanded_indices[i] = variables.expanded_values.size();
+        variables.expanded_values.push_back(pmgr.Expand(value));
+      }
+    }
+
+    variables.list.resize(mReferences.size());
+    for (size_t i = 0; i < mReferences.size(); i++)
+    {
+      const REFERENCE& r = mReferences[i];
+      const std::string& value = (expanded_indices[i] == (size_t)-1 ? pmgr.GetProperty(r.name) : variables.expanded_values[expanded_indices[i]]);
+
+      EXPRTK_VARIABLE& v = variables.list[i];
+      v.name = r.variable.c_str();
+      v.string_value = NULL;
+      v.numeric_value = 0.0;
+      if (r.is_string && value.find('\\') != std::string::npos)
+        return false; // exprtk removes escape characters from string literals but not from string variables. The expression must be evaluated as text.
+      else if (r.is_string)
+        v.string_value = value.c_str();
+      else if (!IsNumericLiteral(value, v.numeric_value))
+        return false; // the value is not a number. The expression must be evaluated as text.
+    }
+
+    return true;
+  }
+
+} //namespace shellanything
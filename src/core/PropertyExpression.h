@@ -0,0 +1,118 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_PROPERTY_EXPRESSION_H
+#define SA_PROPERTY_EXPRESSION_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+#include "libexprtk.h"
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A PropertyExpression is an exprtk expression where property references are bound as exprtk variables.
+  /// </summary>
+  /// <remarks>
+  /// Expanding property references in an expression produces a different expression text for each property value,
+  /// which must be compiled again. Binding property references as variables allows the expression to be compiled once.
+  /// A property reference can be bound if it is a numeric operand (ie: "${selection.count} > 3")
+  /// or if it is a whole string literal (ie: "'${selection.filename}' == 'foo'").
+  /// Otherwise, the expression must be expanded as text before evaluation.
+  /// </remarks>
+  class SHELLANYTHING_EXPORT PropertyExpression
+  {
+  public:
+    /// <summary>
+    /// Values of the variables of an expression, for a single evaluation.
+    /// </summary>
+    struct VARIABLES
+    {
+      std::vector<EXPRTK_VARIABLE> list;
+      StringList expanded_values; // storage for property values that contains property references
+    };
+
+    PropertyExpression();
+    PropertyExpression(const PropertyExpression& e);
+    virtual ~PropertyExpression();
+
+    /// <summary>
+    /// Copy operator
+    /// </summary>
+    const PropertyExpression& operator =(const PropertyExpression& e);
+
+    /// <summary>
+    /// Set the expression. Property references are identified and replaced by variables.
+    /// </summary>
+    /// <param name="expression">The expression with property references.</param>
+    void SetExpression(const std::string& expression);
+
+    /// <summary>
+    /// Getter for the 'expression' parameter.
+    /// </summary>
+    const std::string& GetExpression() const;
+
+    /// <summary>
+    /// Get the expression where property references are replaced by variables.
+    /// </summary>
+    const std::string& GetBoundExpression() const;
+
+    /// <summary>
+    /// Returns true if all property references of the expression can be bound as variables.
+    /// </summary>
+    bool IsBindable() const;
+
+    /// <summary>
+    /// Get the values of the variables with the current property values.
+    /// </summary>
+    /// <remarks>
+    /// Binding fails if the expression is not bindable, if a referenced property is not defined,
+    /// if a numeric operand is not a number or if a string value contains a backslash. The expression must then be expanded as text.
+    /// String variables points to property values. Call Bind() and evaluate the expression within the same read scope. See PropertyManager::BeginRead().
+    /// </remarks>
+    /// <param name="variables">The output variables for evaluating GetBoundExpression().</param>
+    /// <returns>Returns true if all property references are bound to a variable. Returns false otherwise.</returns>
+    bool Bind(VARIABLES& variables) const;
+
+  private:
+    struct REFERENCE
+    {
+      std::string name; // property name
+      std::string variable; // variable name in the bound expression
+      bool is_string;
+    };
+    typedef std::vector<REFERENCE> ReferenceList;
+
+    std::string mExpression;
+    std::string mBoundExpression;
+    ReferenceList mReferences;
+    bool mBindable;
+  };
+
+} //namespace shellanything
+
+#endif //SA_PROPERTY_EXPRESSION_H
@@ -41,10 +41,27 @@ namespace shellanything
   const std::string PropertyManager::SYSTEM_FALSE_PROPERTY_NAME = "system.false";
   const std::string PropertyManager::SYSTEM_FALSE_DEFAULT_VALUE = "false";
 
-  PropertyManager::PropertyManager()
+  // The state of the readers and of the writer of the current thread.
+  struct PROPERTY_READER
   {
+    PropertySnapshotPtr pinned;             // the snapshot read by the thread
+    size_t pinned_publication;              // the publication of the pinned snapshot
+    size_t depth;                           // the depth of the read scopes. See BeginRead().
+    bool stale;                             // true if the thread has published changes since the snapshot was pinned
+    std::vector<PropertySnapshotPtr> retired; // snapshots read within the current read scope
+  };
+  static thread_local PROPERTY_READER gReader = { PropertySnapshotPtr(), 0, 0, false, std::vector<PropertySnapshotPtr>() };
+  static thread_local const PropertySnapshot* gWriterDraft = NULL;
+
+  PropertyManager::PropertyManager() :
+    snapshot(std::make_shared<PropertySnapshot>()),
+    publication(0),
+    batch_depth(0)
+  {
+    BeginBatch();
     RegisterEnvironmentVariables();
     RegisterDefaultProperties();
+    EndBatch();
   }
 
   PropertyManager::~PropertyManager()
@@ -57,44 +74,264 @@ namespace shellanything
     return _instance;
   }
 
+  const PropertySnapshot& PropertyManager::ReadSnapshot() const
+  {
+    //the thread that is changing properties reads its own changes
+    if (gWriterDraft)
+      return *gWriterDraft;
+
+    PROPERTY_READER& reader = gReader;
+    size_t current_publication = publication.load(std::memory_order_acquire);
+    if (reader.pinned && reader.pinned_publication == current_publication)
+      return *reader.pinned;
+
+    //within a read scope, the pinned snapshot is kept until the thread publishes its own changes
+    if (reader.pinned && reader.depth > 0)
+    {
+      if (!reader.stale)
+        return *reader.pinned;
+      reader.retired.push_back(reader.pinned);
+    }
+
+    reader.pinned = std::atomic_load(&snapshot);
+    reader.pinned_publication = current_publication;
+    reader.stale = false;
+    return *reader.pinned;
+  }
+
+  PropertySnapshot& PropertyManager::WriteSnapshot()
+  {
+    //write_mutex must be locked by the caller
+    if (!draft)
+    {
+      PropertySnapshotPtr current = std::atomic_load(&snapshot);
+      draft = std::make_shared<PropertySnapshot>(*current);
+      gWriterDraft = draft.get();
+    }
+    return *draft;
+  }
+
+  void PropertyManager::Publish()
+  {
+    //write_mutex must be locked by the caller
+    if (!draft)
+      return;
+
+    PropertySnapshotPtr published = draft;
+    std::atomic_store(&snapshot, published);
+    draft.reset();
+    gWriterDraft = NULL;
+    publication.fetch_add(1, std::memory_order_release);
+
+    //the references returned from the draft must stay valid until the read scope ends
+    PROPERTY_READER& reader = gReader;
+    reader.stale = true;
+    if (reader.depth > 0)
+      reader.retired.push_back(published);
+  }
+
+  PropertySnapshotPtr PropertyManager::GetSnapshot() const
+  {
+    return std::atomic_load(&snapshot);
+  }
+
+  void PropertyManager::BeginBatch()
+  {
+    write_mutex.lock();
+    batch_depth++;
+  }
+
+  void PropertyManager::EndBatch()
+  {
+    batch_depth--;
+    if (batch_depth == 0)
+      Publish();
+    write_mutex.unlock();
+  }
+
+  void PropertyManager::BeginRead() const
+  {
+    gReader.depth++;
+  }
+
+  void PropertyManager::EndRead() const
+  {
+    PROPERTY_READER& reader = gReader;
+    reader.depth--;
+    if (reader.depth == 0)
+      reader.retired.clear();
+  }
+
   void PropertyManager::Clear()
   {
-    properties.Clear();
+    BeginBatch();
+    PropertySnapshot& current = WriteSnapshot();
+    current.properties.Clear();
+    current.stable_properties.clear();
+    current.stable_version++;
+    current.version++;
+    current.clear_version = current.version;
+    current.property_versions.clear();
     RegisterEnvironmentVariables();
     RegisterDefaultProperties();
+    EndBatch();
   }
 
   void PropertyManager::ClearProperty(const std::string& name)
   {
-    properties.ClearProperty(name);
+    BeginBatch();
+    PropertySnapshot& current = WriteSnapshot();
+    current.properties.ClearProperty(name);
+    current.version++;
+    current.property_versions[name] = current.version;
+    if (current.stable_properties.erase(name) > 0)
+      current.stable_version++;
+    EndBatch();
   }
 
   bool PropertyManager::HasProperty(const std::string& name) const
   {
-    bool found = properties.HasProperty(name);
+    const PropertySnapshot& current = ReadSnapshot();
+    RecordDependency(current, name);
+    bool found = current.HasProperty(name);
     return found;
   }
 
   bool PropertyManager::HasProperties(const StringList& properties_) const
   {
-    bool found = properties.HasProperties(properties_);
+    const PropertySnapshot& current = ReadSnapshot();
+    for (size_t i = 0; i < properties_.size(); i++)
+    {
+      RecordDependency(current, properties_[i]);
+    }
+    bool found = current.properties.HasProperties(properties_);
     return found;
   }
 
   void PropertyManager::SetProperty(const std::string& name, const std::string& value)
   {
-    properties.SetProperty(name, value);
+    BeginBatch();
+    PropertySnapshot& current = WriteSnapshot();
+
+    //values computed from the property are out of date if the property changes
+    if (!current.properties.HasProperty(name) || current.properties.GetProperty(name) != value)
+    {
+      current.version++;
+      current.property_versions[name] = current.version;
+      if (current.stable_properties.find(name) != current.stable_properties.end())
+        current.stable_version++;
+    }
+
+    current.properties.SetProperty(name, value);
+    EndBatch();
   }
 
   const std::string& PropertyManager::GetProperty(const std::string& name) const
   {
-    const std::string& value = properties.GetProperty(name);
+    const PropertySnapshot& current = ReadSnapshot();
+    RecordDependency(current, name);
+    const std::string& value = current.GetProperty(name);
     return value;
   }
 
   void PropertyManager::FindMissingProperties(const StringList& input_names, StringList& output_names) const
   {
-    properties.FindMissingProperties(input_names, output_names);
+    const PropertySnapshot& current = ReadSnapshot();
+    for (size_t i = 0; i < input_names.size(); i++)
+    {
+      RecordDependency(current, input_names[i]);
+    }
+    current.FindMissingProperties(input_names, output_names);
+  }
+
+  void PropertyManager::SetStableProperty(const std::string& name, bool stable)
+  {
+    BeginBatch();
+    PropertySnapshot& current = WriteSnapshot();
+    bool changed = false;
+    if (stable)
+      changed = current.stable_properties.insert(name).second;
+    else
+      changed = (current.stable_properties.erase(name) > 0);
+    if (changed)
+      current.stable_version++;
+    EndBatch();
+  }
+
+  bool PropertyManager::IsStableProperty(const std::string& name) const
+  {
+    return ReadSnapshot().IsStableProperty(name);
+  }
+
+  bool PropertyManager::IsStableValue(const std::string& value) const
+  {
+    //the values of the referenced properties are read from the same snapshot
+    BeginRead();
+    std::set<std::string> visited;
+    bool stable = IsStableValue(value, visited);
+    EndRead();
+    return stable;
+  }
+
+  bool PropertyManager::IsStableValue(const std::string& value, std::set<std::string>& visited) const
+  {
+    static const std::string token_open = "${";
+    static const std::string token_close = "}";
+
+    size_t pos = value.find(token_open);
+    while (pos != std::string::npos)
+    {
+      size_t name_start_pos = pos + token_open.size();
+      size_t token_close_pos = value.find(token_close, name_start_pos);
+      if (token_close_pos == std::string::npos)
+        return true; // no more property references
+
+      //an unknown property is not expanded now but may be defined later
+      std::string name = value.substr(name_start_pos, token_close_pos - name_start_pos);
+      if (!name.empty())
+      {
+        if (!IsStableProperty(name))
+          return false;
+
+        //the property's value is also expanded
+        if (visited.insert(name).second && !IsStableValue(GetProperty(name), visited))
+          return false;
+      }
+
+      pos = value.find(token_open, name_start_pos);
+    }
+    return true;
+  }
+
+  size_t PropertyManager::GetStableVersion() const
+  {
+    return ReadSnapshot().GetStableVersion();
+  }
+
+  size_t PropertyManager::GetVersion() const
+  {
+    return ReadSnapshot().GetVersion();
+  }
+
+  size_t PropertyManager::GetPropertyVersion(const std::string& name) const
+  {
+    return ReadSnapshot().GetPropertyVersion(name);
+  }
+
+  // The recorder is per thread. Concurrent evaluations record their own dependencies.
+  static thread_local PropertyDependencies* gDependencyRecorder = NULL;
+
+  PropertyDependencies* PropertyManager::SetDependencyRecorder(PropertyDependencies* dependencies)
+  {
+    PropertyDependencies* previous = gDependencyRecorder;
+    gDependencyRecorder = dependencies;
+    return previous;
+  }
+
+  void PropertyManager::RecordDependency(const PropertySnapshot& snapshot, const std::string& name) const
+  {
+    if (gDependencyRecorder)
+      gDependencyRecorder->Add(name, snapshot.GetPropertyVersion(name));
   }
 
   inline bool IsPropertyReference(const std::string& token_open, const std::string& token_close, const std::string& value, size_t offset, std::string& name)
@@ -135,6 +372,9 @@ namespace shellanything
 
   std::string PropertyManager::Expand(const std::string& value) const
   {
+    //all passes read the same snapshot
+    BeginRead();
+
     int count = 1;
     std::string previous = value;
     std::string output = ExpandOnce(value);
@@ -147,6 +387,8 @@ namespace shellanything
       count++;
     }
 
+    EndRead();
+
     return output;
   }
 
@@ -258,6 +500,7 @@ namespace shellanything
 
       //register the variable as a valid property
       SetProperty(name, value);
+      SetStableProperty(name, true);
     }
   }
 
@@ -293,6 +536,18 @@ namespace shellanything
 
     // Set default property for multi selection. Issue #52.
     SetProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME, SelectionContext::DEFAULT_MULTI_SELECTION_SEPARATOR);
+
+    //the properties above do not change between selections
+    SetStableProperty("application.path", true);
+    SetStableProperty("application.directory", true);
+    SetStableProperty("application.install.directory", true);
+    SetStableProperty("application.version", true);
+    SetStableProperty("path.separator", true);
+    SetStableProperty("line.separator", true);
+    SetStableProperty("newline", true);
+    SetStableProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME, true);
+    SetStableProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME, true);
+    SetStableProperty(SelectionContext::MULTI_SELECTION_SEPARATOR_PROPERTY_NAME, true);
   }
 
 } //namespace shellanything
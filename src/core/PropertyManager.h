@@ -29,14 +29,25 @@
 #include "shellanything/config.h"
 #include "StringList.h"
 #include "PropertyStore.h"
+#include "PropertyDependencies.h"
+#include "PropertySnapshot.h"
 #include <string>
 #include <map>
+#include <set>
+#include <atomic>
+#include <mutex>
 
 namespace shellanything
 {
   /// <summary>
   /// Manages the property system
   /// </summary>
+  /// <remarks>
+  /// The properties are published as immutable snapshots. See PropertySnapshot.
+  /// Readers look up the snapshot pinned by their thread without locking.
+  /// Writers are serialized. Each change, or each batch of changes, publishes a new snapshot that replaces the current one.
+  /// A thread always reads its own changes. Changes published by other threads are visible on the next read, except within a read scope. See BeginRead().
+  /// </remarks>
   class SHELLANYTHING_EXPORT PropertyManager
   {
   public:
@@ -112,6 +123,12 @@ namespace shellanything
     /// Gets the value of the given property name.
     /// </summary>
     /// <param name="name">The name of the property to get.</param>
+    /// <remarks>
+    /// The returned reference points into the snapshot read by the calling thread.
+    /// Within a read scope, the reference is valid until the outermost EndRead() of the calling thread.
+    /// Outside of a read scope, the reference is only valid until the calling thread calls the PropertyManager again.
+    /// Copy the value or use GetSnapshot() to keep it longer.
+    /// </remarks>
     /// <returns>Returns value of the property if the property is set. Returns an empty string otherwise.</returns>
     const std::string& GetProperty(const std::string& name) const;
 
@@ -160,11 +177,114 @@ namespace shellanything
     /// <param name="output_list">The list of expanded values</param>
     static void ExpandAndSplit(const std::string& value, const char* separator, StringList& output_list);
 
+    /// <summary>
+    /// Set whether the given property is stable.
+    /// A stable property is expected to keep the same value for the whole session.
+    /// Environment variables, application properties and the default properties of configuration files are stable.
+    /// </summary>
+    /// <remarks>
+    /// Changing the value of a stable property increases the stable version. See GetStableVersion().
+    /// </remarks>
+    /// <param name="name">The name of the property.</param>
+    /// <param name="stable">True if the property is stable. False otherwise.</param>
+    void SetStableProperty(const std::string& name, bool stable);
+
+    /// <summary>
+    /// Check if the given property is stable.
+    /// </summary>
+    /// <param name="name">The name of the property to check.</param>
+    /// <returns>Returns true if the property is set and stable. Returns false otherwise.</returns>
+    bool IsStableProperty(const std::string& name) const;
+
+    /// <summary>
+    /// Check if the given value always expands to the same string.
+    /// This is the case when the value only references stable properties.
+    /// The values of the referenced properties must also reference only stable properties.
+    /// </summary>
+    /// <param name="value">The value to check.</param>
+    /// <returns>Returns true if the expanded value only depends on stable properties. Returns false otherwise.</returns>
+    bool IsStableValue(const std::string& value) const;
+
+    /// <summary>
+    /// Get the version of the stable properties.
+    /// The version is increased each time a stable property is changed, cleared or marked as stable.
+    /// A value computed from stable properties is only valid for the version at which it was computed.
+    /// </summary>
+    /// <returns>Returns the version of the stable properties.</returns>
+    size_t GetStableVersion() const;
+
+    /// <summary>
+    /// Get the version of the properties.
+    /// The version is increased each time a property is set to a new value or cleared.
+    /// A value expanded from properties is only valid for the version at which it was expanded.
+    /// </summary>
+    /// <returns>Returns the version of the properties.</returns>
+    size_t GetVersion() const;
+
+    /// <summary>
+    /// Get the version of the given property.
+    /// The version of a property changes each time the property is set to a new value or cleared.
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    /// <returns>Returns the version of the property.</returns>
+    size_t GetPropertyVersion(const std::string& name) const;
+
+    /// <summary>
+    /// Set the recorder of the properties read by the current thread.
+    /// While a recorder is set, each property that is read or checked for existence is added to the recorder.
+    /// </summary>
+    /// <param name="dependencies">The recorder. NULL to stop recording.</param>
+    /// <returns>Returns the previous recorder of the current thread.</returns>
+    PropertyDependencies* SetDependencyRecorder(PropertyDependencies* dependencies);
+
+    /// <summary>
+    /// Get the last published snapshot of the properties.
+    /// The snapshot does not change and stays valid as long as the returned pointer is kept.
+    /// The changes of a batch that is not ended are not part of the snapshot.
+    /// </summary>
+    /// <returns>Returns the last published snapshot.</returns>
+    PropertySnapshotPtr GetSnapshot() const;
+
+    /// <summary>
+    /// Begin a batch of changes.
+    /// The changes are published as a single snapshot when the outermost batch ends. Other threads can not change properties until then.
+    /// Each call to BeginBatch() must be matched by a call to EndBatch() from the same thread.
+    /// </summary>
+    void BeginBatch();
+
+    /// <summary>
+    /// End a batch of changes. See BeginBatch().
+    /// </summary>
+    void EndBatch();
+
+    /// <summary>
+    /// Begin a read scope for the calling thread.
+    /// Within a read scope, the calling thread reads a consistent view of the properties:
+    /// changes published by other threads are ignored and the references returned by GetProperty() stay valid until the outermost scope ends.
+    /// Changes made by the calling thread are still visible.
+    /// Each call to BeginRead() must be matched by a call to EndRead() from the same thread.
+    /// </summary>
+    void BeginRead() const;
+
+    /// <summary>
+    /// End a read scope for the calling thread. See BeginRead().
+    /// </summary>
+    void EndRead() const;
+
   private:
 
+    bool IsStableValue(const std::string& value, std::set<std::string>& visited) const;
+    void RecordDependency(const PropertySnapshot& snapshot, const std::string& name) const;
     void RegisterEnvironmentVariables();
     void RegisterDefaultProperties();
-    PropertyStore properties;
+    const PropertySnapshot& ReadSnapshot() const;
+    PropertySnapshot& WriteSnapshot();
+    void Publish();
+    PropertySnapshotPtr snapshot; // accessed with std::atomic_load() and std::atomic_store()
+    std::atomic<size_t> publication;
+    std::recursive_mutex write_mutex;
+    std::shared_ptr<PropertySnapshot> draft;
+    size_t batch_depth;
   };
 
 } //namespace shellanything
@@ -0,0 +1,87 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "PropertySnapshot.h"
+
+namespace shellanything
+{
+  PropertySnapshot::PropertySnapshot() :
+    stable_version(0),
+    version(0),
+    clear_version(0)
+  {
+  }
+
+  PropertySnapshot::~PropertySnapshot()
+  {
+  }
+
+  bool PropertySnapshot::HasProperty(const std::string& name) const
+  {
+    bool found = properties.HasProperty(name);
+    return found;
+  }
+
+  const std::string& PropertySnapshot::GetProperty(const std::string& name) const
+  {
+    const std::string& value = properties.GetProperty(name);
+    return value;
+  }
+
+  void PropertySnapshot::FindMissingProperties(const StringList& input_names, StringList& output_names) const
+  {
+    properties.FindMissingProperties(input_names, output_names);
+  }
+
+  size_t PropertySnapshot::GetPropertyCount() const
+  {
+    return properties.GetPropertyCount();
+  }
+
+  bool PropertySnapshot::IsStableProperty(const std::string& name) const
+  {
+    if (stable_properties.find(name) == stable_properties.end())
+      return false;
+    return properties.HasProperty(name);
+  }
+
+  size_t PropertySnapshot::GetStableVersion() const
+  {
+    return stable_version;
+  }
+
+  size_t PropertySnapshot::GetVersion() const
+  {
+    return version;
+  }
+
+  size_t PropertySnapshot::GetPropertyVersion(const std::string& name) const
+  {
+    std::map<std::string, size_t>::const_iterator it = property_versions.find(name);
+    if (it == property_versions.end())
+      return clear_version; // not changed since the last Clear()
+    return it->second;
+  }
+
+} //namespace shellanything
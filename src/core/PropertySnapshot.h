@@ -0,0 +1,116 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_PROPERTY_SNAPSHOT_H
+#define SA_PROPERTY_SNAPSHOT_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+#include "PropertyStore.h"
+#include <string>
+#include <map>
+#include <set>
+#include <memory>
+
+namespace shellanything
+{
+  /// <summary>
+  /// An immutable version of all the properties of the PropertyManager.
+  /// A snapshot is never modified once it is published. It can be read by multiple threads without synchronization.
+  /// See PropertyManager::GetSnapshot().
+  /// </summary>
+  class SHELLANYTHING_EXPORT PropertySnapshot
+  {
+  public:
+    PropertySnapshot();
+    virtual ~PropertySnapshot();
+
+    /// <summary>
+    /// Check if a property is set in this snapshot.
+    /// </summary>
+    /// <param name="name">The name of the property to check.</param>
+    /// <returns>Returns true if the property is set. Returns false otherwise.</returns>
+    bool HasProperty(const std::string& name) const;
+
+    /// <summary>
+    /// Gets the value of the given property name.
+    /// </summary>
+    /// <param name="name">The name of the property to get.</param>
+    /// <returns>Returns value of the property if the property is set. Returns an empty string otherwise. The value is valid for the lifetime of the snapshot.</returns>
+    const std::string& GetProperty(const std::string& name) const;
+
+    /// <summary>
+    /// Find the list of properties which are not in this snapshot.
+    /// </summary>
+    /// <param name="input_names">The list of property names to test.</param>
+    /// <param name="output_names">The output list of property names which are not in the snapshot.</param>
+    void FindMissingProperties(const StringList& input_names, StringList& output_names) const;
+
+    /// <summary>
+    /// Get the number of properties in this snapshot.
+    /// </summary>
+    size_t GetPropertyCount() const;
+
+    /// <summary>
+    /// Check if the given property is set and stable in this snapshot.
+    /// </summary>
+    /// <param name="name">The name of the property to check.</param>
+    /// <returns>Returns true if the property is set and stable. Returns false otherwise.</returns>
+    bool IsStableProperty(const std::string& name) const;
+
+    /// <summary>
+    /// Get the version of the stable properties of this snapshot. See PropertyManager::GetStableVersion().
+    /// </summary>
+    size_t GetStableVersion() const;
+
+    /// <summary>
+    /// Get the version of the properties of this snapshot. See PropertyManager::GetVersion().
+    /// </summary>
+    size_t GetVersion() const;
+
+    /// <summary>
+    /// Get the version of the given property in this snapshot. See PropertyManager::GetPropertyVersion().
+    /// </summary>
+    /// <param name="name">The name of the property.</param>
+    size_t GetPropertyVersion(const std::string& name) const;
+
+  private:
+    friend class PropertyManager;
+    PropertyStore properties;
+    std::set<std::string> stable_properties;
+    size_t stable_version;
+    size_t version;
+    size_t clear_version;
+    std::map<std::string /*name*/, size_t /*version*/> property_versions;
+  };
+
+  /// <summary>
+  /// A shared pointer to a published PropertySnapshot. The snapshot is released when the last pointer is released.
+  /// </summary>
+  typedef std::shared_ptr<const PropertySnapshot> PropertySnapshotPtr;
+
+} //namespace shellanything
+
+#endif //SA_PROPERTY_SNAPSHOT_H
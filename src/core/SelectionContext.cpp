@@ -174,6 +174,8 @@ namespace shellanything
       }
     }
 
+    //publish the properties of the selection all at once
+    pmgr.BeginBatch();
     pmgr.SetProperty("selection.path", selection_path);
     pmgr.SetProperty("selection.dir", selection_dir);
     pmgr.SetProperty("selection.dir.count", selection_dir_count);
@@ -198,11 +200,13 @@ namespace shellanything
     pmgr.SetProperty("selection.count", selection_count);
     pmgr.SetProperty("selection.files.count", selection_files_count);
     pmgr.SetProperty("selection.directories.count", selection_directories_count);
+    pmgr.EndBatch();
   }
 
   void SelectionContext::UnregisterProperties() const
   {
     PropertyManager& pmgr = PropertyManager::GetInstance();
+    pmgr.BeginBatch();
     pmgr.ClearProperty("selection.path");
     pmgr.ClearProperty("selection.dir");
     pmgr.ClearProperty("selection.parent.path");
@@ -216,6 +220,7 @@ namespace shellanything
     pmgr.ClearProperty("selection.description");
     //pmgr.ClearProperty("selection.libmagic_ext"       );
     pmgr.ClearProperty("selection.charset");
+    pmgr.EndBatch();
   }
 
   const StringList& SelectionContext::GetElements() const
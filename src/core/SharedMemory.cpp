@@ -0,0 +1,223 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "SharedMemory.h"
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "rapidassist/undef_windows_macros.h"
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace shellanything
+{
+  // Get the name of a segment for the operating system.
+  std::string GetSystemSegmentName(const std::string& name)
+  {
+#ifdef _WIN32
+    //segments are shared by the processes of the user's session
+    return "Local\\" + name;
+#else
+    return "/" + name;
+#endif
+  }
+
+  SharedMemory::SharedMemory() :
+    mData(NULL),
+    mSize(0),
+    mReadOnly(true),
+    mHandle(NULL)
+  {
+  }
+
+  SharedMemory::~SharedMemory()
+  {
+    Close();
+  }
+
+  bool SharedMemory::Create(const std::string& name, size_t size)
+  {
+    Close();
+    if (name.empty() || size == 0)
+      return false;
+
+    std::string system_name = GetSystemSegmentName(name);
+#ifdef _WIN32
+    uint64_t size64 = size;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)(size64 & 0xFFFFFFFF), system_name.c_str());
+    if (handle == NULL)
+      return false;
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+      CloseHandle(handle);
+      return false;
+    }
+    void* data = MapViewOfFile(handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+    if (data == NULL)
+    {
+      CloseHandle(handle);
+      return false;
+    }
+    mHandle = handle;
+#else
+    int fd = shm_open(system_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1)
+      return false;
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+      close(fd);
+      shm_unlink(system_name.c_str());
+      return false;
+    }
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); //the mapping keeps the segment alive
+    if (data == MAP_FAILED)
+    {
+      shm_unlink(system_name.c_str());
+      return false;
+    }
+#endif
+
+    mName = name;
+    mData = data;
+    mSize = size;
+    mReadOnly = false;
+    return true;
+  }
+
+  bool SharedMemory::Open(const std::string& name, bool read_only)
+  {
+    Close();
+    if (name.empty())
+      return false;
+
+    std::string system_name = GetSystemSegmentName(name);
+#ifdef _WIN32
+    DWORD access = (read_only ? FILE_MAP_READ : FILE_MAP_READ | FILE_MAP_WRITE);
+    HANDLE handle = OpenFileMappingA(access, FALSE, system_name.c_str());
+    if (handle == NULL)
+      return false;
+    void* data = MapViewOfFile(handle, access, 0, 0, 0);
+    if (data == NULL)
+    {
+      CloseHandle(handle);
+      return false;
+    }
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(data, &info, sizeof(info)) == 0)
+    {
+      UnmapViewOfFile(data);
+      CloseHandle(handle);
+      return false;
+    }
+    size_t size = info.RegionSize;
+    mHandle = handle;
+#else
+    int fd = shm_open(system_name.c_str(), (read_only ? O_RDONLY : O_RDWR), 0);
+    if (fd == -1)
+      return false;
+
+    //a segment which is being created may not be sized yet
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+      close(fd);
+      return false;
+    }
+    size_t size = (size_t)info.st_size;
+    void* data = mmap(NULL, size, (read_only ? PROT_READ : PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      return false;
+#endif
+
+    mName = name;
+    mData = data;
+    mSize = size;
+    mReadOnly = read_only;
+    return true;
+  }
+
+  void SharedMemory::Close()
+  {
+    if (mData == NULL)
+      return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle((HANDLE)mHandle);
+    mHandle = NULL;
+#else
+    munmap(mData, mSize);
+#endif
+
+    mName.clear();
+    mData = NULL;
+    mSize = 0;
+    mReadOnly = true;
+  }
+
+  bool SharedMemory::Remove(const std::string& name)
+  {
+#ifdef _WIN32
+    return true;
+#else
+    std::string system_name = GetSystemSegmentName(name);
+    bool removed = (shm_unlink(system_name.c_str()) == 0);
+    return removed;
+#endif
+  }
+
+  bool SharedMemory::IsOpen() const
+  {
+    return mData != NULL;
+  }
+
+  bool SharedMemory::IsReadOnly() const
+  {
+    return mReadOnly;
+  }
+
+  const std::string& SharedMemory::GetName() const
+  {
+    return mName;
+  }
+
+  void* SharedMemory::GetData() const
+  {
+    return mData;
+  }
+
+  size_t SharedMemory::GetSize() const
+  {
+    return mSize;
+  }
+
+} //namespace shellanything
@@ -0,0 +1,120 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_SHAREDMEMORY_H
+#define SA_SHAREDMEMORY_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <stddef.h>
+#include <string>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A SharedMemory is a named memory segment which is mapped by multiple processes at the same time.
+  /// The segment is a POSIX shared memory object on Linux and a file mapping object on Windows.
+  /// On Linux, a segment exists until it is removed. On Windows, a segment is destroyed when the last process closes it.
+  /// </summary>
+  class SHELLANYTHING_EXPORT SharedMemory
+  {
+  public:
+    SharedMemory();
+    virtual ~SharedMemory();
+
+  private:
+    // Disable copy constructor and copy operator
+    SharedMemory(const SharedMemory&);
+    SharedMemory& operator=(const SharedMemory&);
+  public:
+
+    /// <summary>
+    /// Create a new segment and map it for reading and writing. The content of a new segment is filled with zeros.
+    /// </summary>
+    /// <param name="name">The name of the segment.</param>
+    /// <param name="size">The size in bytes of the segment.</param>
+    /// <returns>Returns true if the segment is created. Returns false if the segment already exists or if the segment cannot be created.</returns>
+    bool Create(const std::string& name, size_t size);
+
+    /// <summary>
+    /// Map an existing segment.
+    /// </summary>
+    /// <param name="name">The name of the segment.</param>
+    /// <param name="read_only">True to map the segment for reading only. False to map the segment for reading and writing.</param>
+    /// <returns>Returns true if the segment is mapped. Returns false otherwise.</returns>
+    bool Open(const std::string& name, bool read_only);
+
+    /// <summary>
+    /// Unmap the segment. The segment is not removed.
+    /// </summary>
+    void Close();
+
+    /// <summary>
+    /// Remove the name of a segment. Processes which have mapped the segment can still use it.
+    /// On Windows, the segment is destroyed when the last process closes it. The function does nothing.
+    /// </summary>
+    /// <param name="name">The name of the segment.</param>
+    /// <returns>Returns true if the segment is removed. Returns false otherwise.</returns>
+    static bool Remove(const std::string& name);
+
+    /// <summary>
+    /// Check if the segment is mapped.
+    /// </summary>
+    bool IsOpen() const;
+
+    /// <summary>
+    /// Check if the segment is mapped for reading only.
+    /// </summary>
+    bool IsReadOnly() const;
+
+    /// <summary>
+    /// Get the name of the mapped segment.
+    /// </summary>
+    const std::string& GetName() const;
+
+    /// <summary>
+    /// Get the address of the mapped segment.
+    /// The address is different in each process. The content of the segment must not store pointers.
+    /// </summary>
+    /// <returns>Returns the address of the mapped segment. Returns NULL if the segment is not mapped.</returns>
+    void* GetData() const;
+
+    /// <summary>
+    /// Get the size in bytes of the mapped segment.
+    /// On Windows, the size is rounded up to a multiple of the page size.
+    /// </summary>
+    size_t GetSize() const;
+
+  private:
+    std::string mName;
+    void* mData;
+    size_t mSize;
+    bool mReadOnly;
+    void* mHandle; // the file mapping object on Windows
+  };
+
+} //namespace shellanything
+
+#endif //SA_SHAREDMEMORY_H
@@ -29,7 +29,10 @@
 #include "PropertyManager.h"
 #include "ConfigFile.h"
 #include "DriveClass.h"
+#include "FileProbeCache.h"
 #include "Wildcard.h"
+#include "CaseFolding.h"
+#include "PropertyExpression.h"
 #include "LoggerHelper.h"
 #include "libexprtk.h"
 #include "rapidassist/strings.h"
@@ -50,38 +53,38 @@ namespace shellanything
   const std::string& Validator::ATTRIBUTE_ISEMPTY = "isempty";
   const std::string& Validator::ATTRIBUTE_INSERVE = "inverse";
 
-  bool HasValue(const ra::strings::StringVector& values, const std::string& token)
+  bool HasValueCaseInsensitive(const ra::strings::StringVector& values, const std::string& token)
   {
     for (size_t i = 0; i < values.size(); i++)
     {
       const std::string& v = values[i];
-      if (token == v)
+      if (EqualsCaseInsensitive(token, v))
         return true;
     }
     return false;
   }
 
-  void Uppercase(ra::strings::StringVector& values)
-  {
-    for (size_t i = 0; i < values.size(); i++)
-    {
-      std::string tmp = ra::strings::Uppercase(values[i]);
-      values[i] = tmp;
-    }
-  }
-
-
-
-
-
   Validator::Validator() :
     mMaxFiles(std::numeric_limits<int>::max()),
-    mMaxDirectories(std::numeric_limits<int>::max())
+    mMaxDirectories(std::numeric_limits<int>::max()),
+    mParentMenu(NULL),
+    mExprtk(new PropertyExpression()),
+    mFolded(false),
+    mFoldedVersion(0),
+    mAlwaysValid(false),
+    mExprtkResult(CONSTANT_RESULT_UNKNOWN),
+    mIsTrueResult(CONSTANT_RESULT_UNKNOWN),
+    mIsFalseResult(CONSTANT_RESULT_UNKNOWN),
+    mIsEmptyResult(CONSTANT_RESULT_UNKNOWN),
+    mPluginValidatorsResolved(false),
+    mPluginValidatorsGeneration(0)
   {
   }
 
   Validator::~Validator()
   {
+    delete mExprtk;
+    mExprtk = NULL;
   }
 
   Menu* Validator::GetParentMenu()
@@ -107,8 +110,9 @@ namespace shellanything
   void Validator::SetMaxFiles(const int& max_files)
   {
     std::string str_value = ra::strings::ToString(max_files);
-    mAttributes.SetProperty(ATTRIBUTE_MAXFILES, str_value);
+    SetAttribute(ATTRIBUTE_MAXFILES, str_value);
     mMaxFiles = max_files;
+    InvalidateConstants();
   }
 
   const int& Validator::GetMaxDirectories() const
@@ -119,98 +123,109 @@ namespace shellanything
   void Validator::SetMaxDirectories(const int& max_directories)
   {
     std::string str_value = ra::strings::ToString(max_directories);
-    mAttributes.SetProperty(ATTRIBUTE_MAXDIRECTORIES, str_value);
+    SetAttribute(ATTRIBUTE_MAXDIRECTORIES, str_value);
     mMaxDirectories = max_directories;
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetProperties() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_PROPERTIES);
+    return GetAttribute(ATTRIBUTE_PROPERTIES);
   }
 
   void Validator::SetProperties(const std::string& properties)
   {
-    mAttributes.SetProperty(ATTRIBUTE_PROPERTIES, properties);
+    SetAttribute(ATTRIBUTE_PROPERTIES, properties);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetFileExtensions() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_FILEEXTENSIONS);
+    return GetAttribute(ATTRIBUTE_FILEEXTENSIONS);
   }
 
   void Validator::SetFileExtensions(const std::string& file_extensions)
   {
-    mAttributes.SetProperty(ATTRIBUTE_FILEEXTENSIONS, file_extensions);
+    SetAttribute(ATTRIBUTE_FILEEXTENSIONS, file_extensions);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetFileExists() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_EXISTS);
+    return GetAttribute(ATTRIBUTE_EXISTS);
   }
 
   void Validator::SetFileExists(const std::string& file_exists)
   {
-    mAttributes.SetProperty(ATTRIBUTE_EXISTS, file_exists);
+    SetAttribute(ATTRIBUTE_EXISTS, file_exists);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetClass() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_CLASS);
+    return GetAttribute(ATTRIBUTE_CLASS);
   }
 
   void Validator::SetClass(const std::string& classes)
   {
-    mAttributes.SetProperty(ATTRIBUTE_CLASS, classes);
+    SetAttribute(ATTRIBUTE_CLASS, classes);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetPattern() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_PATTERN);
+    return GetAttribute(ATTRIBUTE_PATTERN);
   }
 
   void Validator::SetPattern(const std::string& pattern)
   {
-    mAttributes.SetProperty(ATTRIBUTE_PATTERN, pattern);
+    SetAttribute(ATTRIBUTE_PATTERN, pattern);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetExprtk() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_EXPRTK);
+    return GetAttribute(ATTRIBUTE_EXPRTK);
   }
 
   void Validator::SetExprtk(const std::string& exprtk)
   {
-    mAttributes.SetProperty(ATTRIBUTE_EXPRTK, exprtk);
+    SetAttribute(ATTRIBUTE_EXPRTK, exprtk);
+    mExprtk->SetExpression(exprtk);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetIsTrue() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_ISTRUE);
+    return GetAttribute(ATTRIBUTE_ISTRUE);
   }
 
   void Validator::SetIsTrue(const std::string& istrue)
   {
-    mAttributes.SetProperty(ATTRIBUTE_ISTRUE, istrue);
+    SetAttribute(ATTRIBUTE_ISTRUE, istrue);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetIsFalse() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_ISFALSE);
+    return GetAttribute(ATTRIBUTE_ISFALSE);
   }
 
   void Validator::SetIsFalse(const std::string& isfalse)
   {
-    mAttributes.SetProperty(ATTRIBUTE_ISFALSE, isfalse);
+    SetAttribute(ATTRIBUTE_ISFALSE, isfalse);
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetIsEmpty() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_ISEMPTY);
+    return GetAttribute(ATTRIBUTE_ISEMPTY);
   }
 
   void Validator::SetIsEmpty(const std::string& isempty)
   {
-    mAttributes.SetProperty(ATTRIBUTE_ISEMPTY, isempty);
+    SetAttribute(ATTRIBUTE_ISEMPTY, isempty);
+    InvalidateConstants();
   }
 
   const PropertyStore& Validator::GetCustomAttributes() const
@@ -221,16 +236,19 @@ namespace shellanything
   void Validator::SetCustomAttributes(const PropertyStore& attributes)
   {
     mCustomAttributes = attributes;
+    mPluginValidatorsResolved = false;
+    InvalidateConstants();
   }
 
   const std::string& Validator::GetInserve() const
   {
-    return mAttributes.GetProperty(ATTRIBUTE_INSERVE);
+    return GetAttribute(ATTRIBUTE_INSERVE);
   }
 
   void Validator::SetInserve(const std::string& inserve)
   {
-    mAttributes.SetProperty(ATTRIBUTE_INSERVE, inserve);
+    SetAttribute(ATTRIBUTE_INSERVE, inserve);
+    InvalidateConstants();
   }
 
   bool Validator::IsInversed(const char* name) const
@@ -249,7 +267,7 @@ namespace shellanything
         return true;
     }
 
-    const std::string& inverse_attr = mAttributes.GetProperty(Validator::ATTRIBUTE_INSERVE);
+    const std::string& inverse_attr = GetAttribute(Validator::ATTRIBUTE_INSERVE);
 
     size_t name_length = tmp_name.size();
     size_t search_index = 0;
@@ -295,22 +313,40 @@ namespace shellanything
 
   bool Validator::Validate(const SelectionContext& context) const
   {
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    EvaluationContext evaluation_context(context);
+    evaluation_context.SetConfigFile(ConfigFile::GetUpdatingConfigFile());
+    return Validate(evaluation_context);
+  }
+
+  bool Validator::Validate(const EvaluationContext& context) const
+  {
+    const SelectionContext& selection = context.GetSelectionContext();
+    PropertyManager& pmgr = context.GetPropertyManager();
+
+    //attributes which only depends on stable properties are not evaluated again
+    UpdateConstants();
+    if (mAlwaysValid)
+      return true;
+    if (mExprtkResult == CONSTANT_RESULT_INVALID ||
+        mIsTrueResult == CONSTANT_RESULT_INVALID ||
+        mIsFalseResult == CONSTANT_RESULT_INVALID ||
+        mIsEmptyResult == CONSTANT_RESULT_INVALID)
+      return false;
 
     bool maxfiles_inversed = IsInversed("maxfiles");
-    if (!maxfiles_inversed && context.GetNumFiles() > mMaxFiles)
+    if (!maxfiles_inversed && selection.GetNumFiles() > mMaxFiles)
       return false; //too many files selected
-    if (maxfiles_inversed && context.GetNumFiles() <= mMaxFiles)
+    if (maxfiles_inversed && selection.GetNumFiles() <= mMaxFiles)
       return false; //too many files selected
 
     bool maxfolders_inversed = IsInversed("maxfolders");
-    if (!maxfolders_inversed && context.GetNumDirectories() > mMaxDirectories)
+    if (!maxfolders_inversed && selection.GetNumDirectories() > mMaxDirectories)
       return false; //too many directories selected
-    if (maxfolders_inversed && context.GetNumDirectories() <= mMaxDirectories)
+    if (maxfolders_inversed && selection.GetNumDirectories() <= mMaxDirectories)
       return false; //too many directories selected
 
     //validate properties
-    const std::string properties = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_PROPERTIES));
+    const std::string properties = pmgr.Expand(GetAttribute(ATTRIBUTE_PROPERTIES));
     if (!properties.empty())
     {
       bool inversed = IsInversed("properties");
@@ -320,7 +356,7 @@ namespace shellanything
     }
 
     //validate file extentions
-    const std::string file_extensions = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_FILEEXTENSIONS));
+    const std::string file_extensions = pmgr.Expand(GetAttribute(ATTRIBUTE_FILEEXTENSIONS));
     if (!file_extensions.empty())
     {
       bool inversed = IsInversed("fileextensions");
@@ -330,7 +366,7 @@ namespace shellanything
     }
 
     //validate file/directory exists
-    const std::string file_exists = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_EXISTS));
+    const std::string file_exists = pmgr.Expand(GetAttribute(ATTRIBUTE_EXISTS));
     if (!file_exists.empty())
     {
       bool inversed = IsInversed("exists");
@@ -340,7 +376,7 @@ namespace shellanything
     }
 
     //validate class
-    const std::string class_ = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_CLASS));
+    const std::string class_ = pmgr.Expand(GetAttribute(ATTRIBUTE_CLASS));
     if (!class_.empty())
     {
       bool inversed = IsInversed("class");
@@ -350,7 +386,7 @@ namespace shellanything
     }
 
     //validate pattern
-    const std::string pattern = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_PATTERN));
+    const std::string pattern = pmgr.Expand(GetAttribute(ATTRIBUTE_PATTERN));
     if (!pattern.empty())
     {
       bool inversed = IsInversed("pattern");
@@ -360,8 +396,9 @@ namespace shellanything
     }
 
     //validate exprtx
-    const std::string exprtk = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_EXPRTK));
-    if (!exprtk.empty())
+    //note, the expression is expanded by ValidateExprtk() only if property references can not be bound as variables
+    const std::string& exprtk = GetAttribute(ATTRIBUTE_EXPRTK);
+    if (!exprtk.empty() && mExprtkResult == CONSTANT_RESULT_UNKNOWN)
     {
       bool inversed = IsInversed("exprtk");
       bool valid = ValidateExprtk(context, exprtk, inversed);
@@ -370,37 +407,50 @@ namespace shellanything
     }
 
     //validate istrue
-    const std::string istrue = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_ISTRUE));
-    if (!istrue.empty())
+    if (mIsTrueResult == CONSTANT_RESULT_UNKNOWN)
     {
-      bool inversed = IsInversed("istrue");
-      bool valid = ValidateIsTrue(context, istrue, inversed);
-      if (!valid)
-        return false;
+      const std::string istrue = pmgr.Expand(GetAttribute(ATTRIBUTE_ISTRUE));
+      if (!istrue.empty())
+      {
+        bool inversed = IsInversed("istrue");
+        bool valid = ValidateIsTrue(context, istrue, inversed);
+        if (!valid)
+          return false;
+      }
     }
 
     //validate isfalse
-    const std::string isfalse = pmgr.Expand(mAttributes.GetProperty(ATTRIBUTE_ISFALSE));
-    if (!isfalse.empty())
+    if (mIsFalseResult == CONSTANT_RESULT_UNKNOWN)
     {
-      bool inversed = IsInversed("isfalse");
-      bool valid = ValidateIsFalse(context, isfalse, inversed);
-      if (!valid)
-        return false;
+      const std::string isfalse = pmgr.Expand(GetAttribute(ATTRIBUTE_ISFALSE));
+      if (!isfalse.empty())
+      {
+        bool inversed = IsInversed("isfalse");
+        bool valid = ValidateIsFalse(context, isfalse, inversed);
+        if (!valid)
+          return false;
+      }
     }
 
     //validate isempty
-    const std::string& isempty_attr = mAttributes.GetProperty(ATTRIBUTE_ISEMPTY);
-    const std::string isempty = pmgr.Expand(isempty_attr);
-    if (!isempty_attr.empty())  // note, testing with non-expanded value instead of expanded value
+    if (mIsEmptyResult == CONSTANT_RESULT_UNKNOWN)
     {
-      bool inversed = IsInversed("isempty");
-      bool valid = ValidateIsEmpty(context, isempty, inversed);
-      if (!valid)
-        return false;
+      const std::string& isempty_attr = GetAttribute(ATTRIBUTE_ISEMPTY);
+      const std::string isempty = pmgr.Expand(isempty_attr);
+      if (!isempty_attr.empty())  // note, testing with non-expanded value instead of expanded value
+      {
+        bool inversed = IsInversed("isempty");
+        bool valid = ValidateIsEmpty(context, isempty, inversed);
+        if (!valid)
+          return false;
+      }
     }
 
     //validate using plugins
+    //plugins only validates custom attributes
+    if (mCustomAttributes.IsEmpty())
+      return true;
+
     //for each plugins
     for (size_t i = 0; i < mPlugins.size(); i++)
     {
@@ -411,38 +461,168 @@ namespace shellanything
     }
 
     //check if we are updating a ConfigFile.
-    ConfigFile* updating_config = ConfigFile::GetUpdatingConfigFile();
+    ConfigFile* updating_config = context.GetConfigFile();
     if (updating_config != NULL)
     {
+      //the attribute validators are resolved when parsing the configuration file.
+      //they only need to be resolved again if the plugins are reloaded.
       const Plugin::PluginPtrList& config_plugins = updating_config->GetPlugins();
-      //for each plugins
-      for (size_t i = 0; i < config_plugins.size(); i++)
-      {
-        Plugin* p = config_plugins[i];
-        bool valid = ValidatePlugin(context, p);
-        if (!valid)
-          return false;
-      }
+      if (!mPluginValidatorsResolved || mPluginValidatorsGeneration != Plugin::GetGeneration() || mPluginValidatorsSource != config_plugins)
+        ResolvePluginValidators(config_plugins);
+
+      bool valid = ValidatePluginValidators(context, mPluginValidators);
+      if (!valid)
+        return false;
     }
 
     return true;
   }
 
+  void Validator::FoldConstants() const
+  {
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+
+    mFolded = true;
+    mFoldedVersion = pmgr.GetStableVersion();
+    mExprtkResult = CONSTANT_RESULT_UNKNOWN;
+    mIsTrueResult = CONSTANT_RESULT_UNKNOWN;
+    mIsFalseResult = CONSTANT_RESULT_UNKNOWN;
+    mIsEmptyResult = CONSTANT_RESULT_UNKNOWN;
+    mAlwaysValid = false;
+
+    //these attributes do not depend on the selection
+    EvaluationContext empty_context;
+
+    //fold exprtk
+    const std::string& exprtk = GetAttribute(ATTRIBUTE_EXPRTK);
+    if (pmgr.IsStableValue(exprtk))
+    {
+      bool valid = ValidateExprtk(empty_context, exprtk, IsInversed("exprtk"));
+      mExprtkResult = (valid ? CONSTANT_RESULT_VALID : CONSTANT_RESULT_INVALID);
+    }
+
+    //fold istrue. IsTrue() also depends on the 'system.true' property.
+    const std::string& istrue = GetAttribute(ATTRIBUTE_ISTRUE);
+    if (pmgr.IsStableValue(istrue) && pmgr.IsStableProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME))
+    {
+      bool valid = ValidateIsTrue(empty_context, pmgr.Expand(istrue), IsInversed("istrue"));
+      mIsTrueResult = (valid ? CONSTANT_RESULT_VALID : CONSTANT_RESULT_INVALID);
+    }
+
+    //fold isfalse. IsFalse() also depends on the 'system.false' property.
+    const std::string& isfalse = GetAttribute(ATTRIBUTE_ISFALSE);
+    if (pmgr.IsStableValue(isfalse) && pmgr.IsStableProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME))
+    {
+      bool valid = ValidateIsFalse(empty_context, pmgr.Expand(isfalse), IsInversed("isfalse"));
+      mIsFalseResult = (valid ? CONSTANT_RESULT_VALID : CONSTANT_RESULT_INVALID);
+    }
+
+    //fold isempty
+    const std::string& isempty = GetAttribute(ATTRIBUTE_ISEMPTY);
+    if (isempty.empty())
+    {
+      mIsEmptyResult = CONSTANT_RESULT_VALID;
+    }
+    else if (pmgr.IsStableValue(isempty))
+    {
+      bool valid = ValidateIsEmpty(empty_context, pmgr.Expand(isempty), IsInversed("isempty"));
+      mIsEmptyResult = (valid ? CONSTANT_RESULT_VALID : CONSTANT_RESULT_INVALID);
+    }
+
+    //the other attributes depends on the selection, on the file system or on plugins
+    bool unconstrained = true;
+    unconstrained = unconstrained && (mMaxFiles == std::numeric_limits<int>::max() && !IsInversed("maxfiles"));
+    unconstrained = unconstrained && (mMaxDirectories == std::numeric_limits<int>::max() && !IsInversed("maxfolders"));
+    unconstrained = unconstrained && GetAttribute(ATTRIBUTE_PROPERTIES).empty();
+    unconstrained = unconstrained && GetAttribute(ATTRIBUTE_FILEEXTENSIONS).empty();
+    unconstrained = unconstrained && GetAttribute(ATTRIBUTE_EXISTS).empty();
+    unconstrained = unconstrained && GetAttribute(ATTRIBUTE_CLASS).empty();
+    unconstrained = unconstrained && GetAttribute(ATTRIBUTE_PATTERN).empty();
+    unconstrained = unconstrained && mCustomAttributes.IsEmpty();
+    unconstrained = unconstrained && mPlugins.empty();
+
+    mAlwaysValid = (unconstrained &&
+                    mExprtkResult == CONSTANT_RESULT_VALID &&
+                    mIsTrueResult == CONSTANT_RESULT_VALID &&
+                    mIsFalseResult == CONSTANT_RESULT_VALID &&
+                    mIsEmptyResult == CONSTANT_RESULT_VALID);
+  }
+
+  bool Validator::IsAlwaysValid() const
+  {
+    UpdateConstants();
+    return mAlwaysValid;
+  }
+
+  bool Validator::IsSelectionDependent() const
+  {
+    if (HasAttribute(ATTRIBUTE_MAXFILES) ||
+        HasAttribute(ATTRIBUTE_MAXDIRECTORIES) ||
+        !GetAttribute(ATTRIBUTE_FILEEXTENSIONS).empty() ||
+        !GetAttribute(ATTRIBUTE_PATTERN).empty())
+      return true;
+    return false;
+  }
+
+  bool Validator::IsVolatile() const
+  {
+    if (!GetAttribute(ATTRIBUTE_EXISTS).empty() ||
+        !GetAttribute(ATTRIBUTE_CLASS).empty() ||
+        !mCustomAttributes.IsEmpty())
+      return true;
+    return false;
+  }
+
+  void Validator::UpdateConstants() const
+  {
+    //fold again if a stable property has changed since the last folding
+    PropertyManager& pmgr = PropertyManager::GetInstance();
+    if (!mFolded || mFoldedVersion != pmgr.GetStableVersion())
+      FoldConstants();
+  }
+
+  void Validator::InvalidateConstants()
+  {
+    mFolded = false;
+
+    //the cached state of the parent menu is also out of date
+    if (mParentMenu)
+      mParentMenu->InvalidateState();
+  }
+
+  const std::string& Validator::GetAttribute(const std::string& name) const
+  {
+    static const std::string EMPTY_VALUE;
+    AttributeMap::const_iterator it = mAttributes.find(name);
+    if (it == mAttributes.end())
+      return EMPTY_VALUE;
+    return it->second.Get();
+  }
+
+  void Validator::SetAttribute(const std::string& name, const std::string& value)
+  {
+    mAttributes[name] = value;
+  }
+
+  bool Validator::HasAttribute(const std::string& name) const
+  {
+    bool found = (mAttributes.find(name) != mAttributes.end());
+    return found;
+  }
+
   bool Validator::IsTrue(const std::string& value)
   {
-    std::string upper_case_value = ra::strings::Uppercase(value);
-    if (upper_case_value == "TRUE" ||
-        upper_case_value == "YES" ||
-        upper_case_value == "OK" ||
-        upper_case_value == "ON" ||
-        upper_case_value == "1")
+    if (EqualsCaseInsensitive(value, "TRUE") ||
+        EqualsCaseInsensitive(value, "YES") ||
+        EqualsCaseInsensitive(value, "OK") ||
+        EqualsCaseInsensitive(value, "ON") ||
+        value == "1")
       return true;
 
     //check with system true
     PropertyManager& pmgr = PropertyManager::GetInstance();
-    std::string system_true = pmgr.GetProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME);
-    std::string upper_case_system_true = ra::strings::Uppercase(system_true);
-    if (upper_case_value == upper_case_system_true)
+    const std::string& system_true = pmgr.GetProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME);
+    if (EqualsCaseInsensitive(value, system_true))
       return true;
 
     return false;
@@ -450,30 +630,28 @@ namespace shellanything
 
   bool Validator::IsFalse(const std::string& value)
   {
-    std::string upper_case_value = ra::strings::Uppercase(value);
-    if (upper_case_value == "FALSE" ||
-        upper_case_value == "NO" ||
-        upper_case_value == "FAIL" ||
-        upper_case_value == "OFF" ||
-        upper_case_value == "0")
+    if (EqualsCaseInsensitive(value, "FALSE") ||
+        EqualsCaseInsensitive(value, "NO") ||
+        EqualsCaseInsensitive(value, "FAIL") ||
+        EqualsCaseInsensitive(value, "OFF") ||
+        value == "0")
       return true;
 
     //check with system false
     PropertyManager& pmgr = PropertyManager::GetInstance();
-    std::string system_false = pmgr.GetProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME);
-    std::string upper_case_system_false = ra::strings::Uppercase(system_false);
-    if (upper_case_value == upper_case_system_false)
+    const std::string& system_false = pmgr.GetProperty(PropertyManager::SYSTEM_FALSE_PROPERTY_NAME);
+    if (EqualsCaseInsensitive(value, system_false))
       return true;
 
     return false;
   }
 
-  bool Validator::ValidateProperties(const SelectionContext& context, const std::string& properties, bool inversed) const
+  bool Validator::ValidateProperties(const EvaluationContext& context, const std::string& properties, bool inversed) const
   {
     if (properties.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    PropertyManager& pmgr = context.GetPropertyManager();
 
     //split
     ra::strings::StringVector property_list = ra::strings::Split(properties, SA_PROPERTIES_ATTR_SEPARATOR_STR);
@@ -506,26 +684,23 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateFileExtensions(const SelectionContext& context, const std::string& file_extensions, bool inversed) const
+  bool Validator::ValidateFileExtensions(const EvaluationContext& context, const std::string& file_extensions, bool inversed) const
   {
     if (file_extensions.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
     ra::strings::StringVector accepted_file_extensions = ra::strings::Split(file_extensions, SA_FILEEXTENSION_ATTR_SEPARATOR_STR);
-    Uppercase(accepted_file_extensions);
 
     //for each file selected
-    const StringList& context_elements = context.GetElements();
+    const StringList& context_elements = context.GetSelectionContext().GetElements();
     for (size_t i = 0; i < context_elements.size(); i++)
     {
       const std::string& path = context_elements[i];
-      std::string current_file_extension = ra::strings::Uppercase(ra::filesystem::GetFileExtention(path));
+      std::string current_file_extension = ra::filesystem::GetFileExtention(path);
 
       //each file extension must be part of accepted_file_extensions
-      bool found = HasValue(accepted_file_extensions, current_file_extension);
+      bool found = HasValueCaseInsensitive(accepted_file_extensions, current_file_extension);
       if (!inversed && !found)
         return false; //current file extension is not accepted
       if (inversed && found)
@@ -535,23 +710,22 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateExists(const SelectionContext& context, const std::string& file_exists, bool inversed) const
+  bool Validator::ValidateExists(const EvaluationContext& context, const std::string& file_exists, bool inversed) const
   {
     if (file_exists.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
     ra::strings::StringVector mandatory_files = ra::strings::Split(file_exists, SA_EXISTS_ATTR_SEPARATOR_STR);
 
+    //the same paths are usually tested by multiple menus
+    FileProbeCache& probes = context.GetFileProbeCache();
+
     //for each file
     for (size_t i = 0; i < mandatory_files.size(); i++)
     {
       const std::string& element = mandatory_files[i];
-      bool element_exists = false;
-      element_exists |= ra::filesystem::FileExistsUtf8(element.c_str());
-      element_exists |= ra::filesystem::DirectoryExistsUtf8(element.c_str());
+      bool element_exists = probes.Exists(element, context.GetFileProbePass());
       if (!inversed && !element_exists)
         return false; //mandatory file/directory not found
       if (inversed && element_exists)
@@ -561,14 +735,12 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateSingleFileSingleClass(const std::string& path, const std::string& class_, bool inversed) const
+  bool Validator::ValidateSingleFileSingleClass(const EvaluationContext& context, const std::string& path, const std::string& class_, bool inversed) const
   {
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     if (class_ == "file")
     {
       // Selected element must be a file
-      bool is_file = ra::filesystem::FileExistsUtf8(path.c_str());
+      bool is_file = context.GetFileProbeCache().FileExists(path, context.GetFileProbePass());
       if (!inversed && !is_file)
         return false;
       if (inversed && is_file)
@@ -577,7 +749,7 @@ namespace shellanything
     else if (class_ == "folder" || class_ == "directory")
     {
       // Selected elements must be a directory
-      bool is_directory = ra::filesystem::DirectoryExistsUtf8(path.c_str());
+      bool is_directory = context.GetFileProbeCache().DirectoryExists(path, context.GetFileProbePass());
       if (!inversed && !is_directory)
         return false;
       if (inversed && is_directory)
@@ -611,7 +783,7 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateSingleFileMultipleClasses(const std::string& path, const std::string& class_, bool inversed) const
+  bool Validator::ValidateSingleFileMultipleClasses(const EvaluationContext& context, const std::string& path, const std::string& class_, bool inversed) const
   {
     if (class_.empty())
       return true;
@@ -623,19 +795,17 @@ namespace shellanything
     for (size_t i = 0; i < classes.size(); i++)
     {
       const std::string& class_ = classes[i];
-      valid |= ValidateSingleFileSingleClass(path, class_, inversed);
+      valid |= ValidateSingleFileSingleClass(context, path, class_, inversed);
     }
 
     return valid;
   }
 
-  bool Validator::ValidateClass(const SelectionContext& context, const std::string& class_, bool inversed) const
+  bool Validator::ValidateClass(const EvaluationContext& context, const std::string& class_, bool inversed) const
   {
     if (class_.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
     ra::strings::StringVector classes = ra::strings::Split(class_, SA_CLASS_ATTR_SEPARATOR_STR);
 
@@ -697,13 +867,13 @@ namespace shellanything
       std::string classes_str = ra::strings::Join(classes, SA_CLASS_ATTR_SEPARATOR_STR);
 
       //for each file selected
-      const StringList& context_elements = context.GetElements();
+      const StringList& context_elements = context.GetSelectionContext().GetElements();
       for (size_t i = 0; i < context_elements.size(); i++)
       {
         const std::string& path = context_elements[i];
 
         //each element must match one of the classes
-        bool valid = ValidateSingleFileMultipleClasses(path, classes_str, inversed);
+        bool valid = ValidateSingleFileMultipleClasses(context, path, classes_str, inversed);
         if (!inversed && !valid)
           return false; //current file extension is not accepted
         if (inversed && valid)
@@ -714,38 +884,29 @@ namespace shellanything
     return true;
   }
 
-  bool WildcardMatch(const ra::strings::StringVector& patterns, const char* value)
-  {
-    for (size_t j = 0; j < patterns.size(); j++)
-    {
-      const std::string& pattern = patterns[j];
-      bool match = WildcardMatch(pattern.c_str(), value);
-      if (match)
-        return true;
-    }
-    return false;
-  }
-
-  bool Validator::ValidatePattern(const SelectionContext& context, const std::string& pattern, bool inversed) const
+  bool Validator::ValidatePattern(const EvaluationContext& context, const std::string& pattern, bool inversed) const
   {
     if (pattern.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    //compile the patterns once. They only need to be compiled again if the expanded attribute changes.
+    if (mPatternSet.IsEmpty() || pattern != mPatternSetSource)
+    {
+      //split
+      ra::strings::StringVector patterns = ra::strings::Split(pattern, SA_PATTERN_ATTR_SEPARATOR_STR);
 
-    //split
-    ra::strings::StringVector patterns = ra::strings::Split(pattern, SA_PATTERN_ATTR_SEPARATOR_STR);
-    Uppercase(patterns);
+      mPatternSet.Compile(patterns, WILDCARD_CASE_INSENSITIVE);
+      mPatternSetSource = pattern;
+    }
 
     //for each file selected
-    const StringList& context_elements = context.GetElements();
+    const StringList& context_elements = context.GetSelectionContext().GetElements();
     for (size_t i = 0; i < context_elements.size(); i++)
     {
       const std::string& path = context_elements[i];
-      std::string path_uppercase = ra::strings::Uppercase(path);
 
       //each element must match one of the patterns
-      bool match = WildcardMatch(patterns, path_uppercase.c_str());
+      bool match = mPatternSet.Match(path.c_str());
       if (!inversed && !match)
         return false; //current file does not match any patterns
       if (inversed && match)
@@ -755,22 +916,44 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateExprtk(const SelectionContext& context, const std::string& exprtk, bool inversed) const
+  bool Validator::ValidateExprtk(const EvaluationContext& context, const std::string& exprtk, bool inversed) const
   {
     if (exprtk.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
+    PropertyManager& pmgr = context.GetPropertyManager();
 
     static const size_t ERROR_SIZE = 10480;
     char error[ERROR_SIZE];
     error[0] = '\0';
 
+    //bind property references as variables. The bound expression is compiled once for all property values.
+    //if binding is not possible, expand the property references as text.
+    //the bound string variables points to property values. They must stay valid until the expression is evaluated.
+    pmgr.BeginRead();
+    std::string expression;
+    PropertyExpression::VARIABLES variables;
+    if (mExprtk->GetExpression() == exprtk && mExprtk->Bind(variables))
+    {
+      expression = mExprtk->GetBoundExpression();
+    }
+    else
+    {
+      expression = pmgr.Expand(exprtk);
+      if (expression.empty())
+      {
+        pmgr.EndRead();
+        return true;
+      }
+    }
+
     int result = false;
-    int evaluated = EvaluateBoolean(exprtk.c_str(), &result, error, ERROR_SIZE);
+    const EXPRTK_VARIABLE* variables_list = (variables.list.empty() ? NULL : &variables.list[0]);
+    int evaluated = EvaluateBooleanVariables(expression.c_str(), variables_list, (int)variables.list.size(), &result, error, ERROR_SIZE);
+    pmgr.EndRead();
     if (!evaluated)
     {
-      SA_LOG(WARNING) << "Failed evaluating exprtk expression '" << exprtk << "'.";
+      SA_LOG(WARNING) << "Failed evaluating exprtk expression '" << expression << "'.";
       SA_LOG(WARNING) << "Exprtk error: " << error << "'.";
       return false;
     }
@@ -781,13 +964,11 @@ namespace shellanything
     return result;
   }
 
-  bool Validator::ValidateIsTrue(const SelectionContext& context, const std::string& istrue, bool inversed) const
+  bool Validator::ValidateIsTrue(const EvaluationContext& context, const std::string& istrue, bool inversed) const
   {
     if (istrue.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
     ra::strings::StringVector statements = ra::strings::Split(istrue, SA_ISTRUE_ATTR_SEPARATOR_STR);
 
@@ -805,13 +986,11 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateIsFalse(const SelectionContext& context, const std::string& isfalse, bool inversed) const
+  bool Validator::ValidateIsFalse(const EvaluationContext& context, const std::string& isfalse, bool inversed) const
   {
     if (isfalse.empty())
       return true;
 
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     //split
     ra::strings::StringVector statements = ra::strings::Split(isfalse, SA_ISTRUE_ATTR_SEPARATOR_STR);
 
@@ -829,10 +1008,8 @@ namespace shellanything
     return true;
   }
 
-  bool Validator::ValidateIsEmpty(const SelectionContext& context, const std::string& isempty, bool inversed) const
+  bool Validator::ValidateIsEmpty(const EvaluationContext& context, const std::string& isempty, bool inversed) const
   {
-    PropertyManager& pmgr = PropertyManager::GetInstance();
-
     bool match = isempty.empty();
     if (!inversed && !match)
       return false; //current statement is not empty
@@ -855,67 +1032,75 @@ namespace shellanything
     return true;
   }
 
-  bool contains(IAttributeValidator::IAttributeValidationPtrList& validators, IAttributeValidator* validator)
+  void Validator::ResolvePluginValidators(const Plugin::PluginPtrList& plugins) const
   {
-    for (size_t i = 0; i < validators.size(); i++)
+    mPluginValidators.clear();
+    for (size_t i = 0; i < plugins.size(); i++)
     {
-      IAttributeValidator* element = validators[i];
-      if (element == validator)
-        return true;
+      Plugin* p = plugins[i];
+      FindPluginValidators(p, mPluginValidators);
     }
-    return false;
+
+    mPluginValidatorsSource = plugins;
+    mPluginValidatorsGeneration = Plugin::GetGeneration();
+    mPluginValidatorsResolved = true;
   }
 
-  bool Validator::ValidatePlugin(const SelectionContext& context, Plugin* plugin) const
+  void Validator::FindPluginValidators(Plugin* plugin, PluginValidatorList& plugin_validators) const
   {
+    if (plugin == NULL || mCustomAttributes.IsEmpty())
+      return;
+
     Registry& registry = plugin->GetRegistry();
 
     //get condition attributes supported by this plugin
     ra::strings::StringVector plugin_conditions;
     PropertyManager::SplitAndExpand(plugin->GetConditions(), SA_CONDITIONS_ATTR_SEPARATOR_STR, plugin_conditions);
 
-    //if there is no condition, it cannot be linked to a validator.
-    if (plugin_conditions.empty())
-      return true; // no validation required
-
     //Find which of this plugin's attributes match the one specified in the xml validator.
     //This is required if a plugin specify multiple optional attributes.
     //We should only remember the one that were specified in the xml.
-    ra::strings::StringVector matching_conditions;
     for (size_t i = 0; i < plugin_conditions.size(); i++)
     {
       const std::string& condition = plugin_conditions[i];
-      if (this->mCustomAttributes.HasProperty(condition))
-      {
-        matching_conditions.push_back(condition);
-      }
-    }
+      if (!this->mCustomAttributes.HasProperty(condition))
+        continue;
 
-    //if there is no matching condition, there is no need to link conditions to a validator.
-    if (matching_conditions.empty())
-      return true; // no validation required
-
-    //find attribute validators that support these matching conditions
-    IAttributeValidator::IAttributeValidationPtrList validators;
-    for (size_t i = 0; i < matching_conditions.size(); i++)
-    {
-      const std::string& condition = matching_conditions[i];
+      //find attribute validators that support this matching condition
       IAttributeValidator* attr_validator = registry.GetAttributeValidatorFromName(condition);
-      if (attr_validator != NULL)
+      if (attr_validator == NULL)
+        continue;
+
+      //if we did not already add this validator
+      bool found = false;
+      for (size_t j = 0; j < plugin_validators.size() && !found; j++)
       {
-        //if we did not already add this validator
-        if (!contains(validators, attr_validator))
-        {
-          validators.push_back(attr_validator);
-        }
+        found = (plugin_validators[j].validator == attr_validator);
+      }
+      if (!found)
+      {
+        PLUGIN_VALIDATOR plugin_validator;
+        plugin_validator.plugin = plugin;
+        plugin_validator.validator = attr_validator;
+        plugin_validators.push_back(plugin_validator);
       }
     }
+  }
 
+  bool Validator::ValidatePlugin(const EvaluationContext& context, Plugin* plugin) const
+  {
+    PluginValidatorList plugin_validators;
+    FindPluginValidators(plugin, plugin_validators);
+    return ValidatePluginValidators(context, plugin_validators);
+  }
+
+  bool Validator::ValidatePluginValidators(const EvaluationContext& context, const PluginValidatorList& plugin_validators) const
+  {
     //validate!
-    for (size_t i = 0; i < validators.size(); i++)
+    for (size_t i = 0; i < plugin_validators.size(); i++)
     {
-      IAttributeValidator* attr_validator = validators[i];
-      attr_validator->SetSelectionContext(&context);
+      IAttributeValidator* attr_validator = plugin_validators[i].validator;
+      attr_validator->SetSelectionContext(&context.GetSelectionContext());
       attr_validator->SetCustomAttributes(&mCustomAttributes);
       bool valid = attr_validator->Validate();
       attr_validator->SetSelectionContext(NULL);
@@ -924,7 +1109,6 @@ namespace shellanything
         return false;
     }
 
-
     return true;
   }
 
@@ -29,9 +29,14 @@
 #include "shellanything/config.h"
 #include "PropertyStore.h"
 #include "SelectionContext.h"
+#include "EvaluationContext.h"
 #include "Plugin.h"
+#include "WildcardPatternSet.h"
+#include "MemoryArena.h"
+#include "InternedString.h"
 #include <string>
 #include <vector>
+#include <map>
 
 #define SA_DEFAULT_ATTRIBUTE_SEPARATOR_CHAR   ';'
 #define SA_DEFAULT_ATTRIBUTE_SEPARATOR_STR    ";"
@@ -59,8 +64,9 @@
 namespace shellanything
 {
   class Menu; // For Get/SetParentMenu()
+  class PropertyExpression;
 
-  class SHELLANYTHING_EXPORT Validator
+  class SHELLANYTHING_EXPORT Validator : public ArenaObject
   {
   public:
     /// <summary>
@@ -250,6 +256,48 @@ namespace shellanything
     /// <returns>Returns true if the given context is valid against the set of constraints. Returns false otherwise.</returns>
     bool Validate(const SelectionContext& context) const;
 
+    /// <summary>
+    /// Validate the object against a set of constraints.
+    /// The selection, the properties and the services are read from the given evaluation context.
+    /// </summary>
+    /// <param name="context">The evaluation context used for validating.</param>
+    /// <returns>Returns true if the given context is valid against the set of constraints. Returns false otherwise.</returns>
+    bool Validate(const EvaluationContext& context) const;
+
+    /// <summary>
+    /// Pre-evaluates the 'istrue', 'isfalse', 'isempty' and 'exprtk' attributes which only depends on stable properties.
+    /// The results are reused by Validate() until a stable property is changed. See PropertyManager::GetStableVersion().
+    /// </summary>
+    void FoldConstants() const;
+
+    /// <summary>
+    /// Returns true if the validator is valid for any selection.
+    /// This is the case when the validator has no constraint or when all its constraints are constants that evaluates to true.
+    /// </summary>
+    /// <returns>Returns true if the validator is valid for any selection. Returns false otherwise.</returns>
+    bool IsAlwaysValid() const;
+
+    /// <summary>
+    /// Returns true if the result of the validator depends on the elements of the selection.
+    /// This is the case for the 'maxfiles', 'maxfolders', 'fileextensions' and 'pattern' attributes.
+    /// </summary>
+    /// <returns>Returns true if the result depends on the selection. Returns false otherwise.</returns>
+    bool IsSelectionDependent() const;
+
+    /// <summary>
+    /// Returns true if the result of the validator may change even if the selection and the properties did not change.
+    /// This is the case for the 'exists' and 'class' attributes which query the file system and for custom attributes validated by plugins.
+    /// </summary>
+    /// <returns>Returns true if the result must be evaluated for each update. Returns false otherwise.</returns>
+    bool IsVolatile() const;
+
+    /// <summary>
+    /// Resolve the attribute validators of the given plugins that are required by the custom attributes.
+    /// The resolved attribute validators are used by Validate() until the plugins are reloaded. See Plugin::GetGeneration().
+    /// </summary>
+    /// <param name="plugins">The plugins of the configuration file.</param>
+    void ResolvePluginValidators(const Plugin::PluginPtrList& plugins) const;
+
     /// <summary>
     /// Validates if a given string can be evaluated as logical true.
     /// </summary>
@@ -283,26 +331,71 @@ namespace shellanything
     static bool IsFalse(const std::string& value);
 
   private:
-    bool ValidateProperties(const SelectionContext& context, const std::string& properties, bool inversed) const;
-    bool ValidateFileExtensions(const SelectionContext& context, const std::string& file_extensions, bool inversed) const;
-    bool ValidateExists(const SelectionContext& context, const std::string& file_exists, bool inversed) const;
-    bool ValidateClass(const SelectionContext& context, const std::string& class_, bool inversed) const;
-    bool ValidateSingleFileMultipleClasses(const std::string& path, const std::string& class_, bool inversed) const;
-    bool ValidateSingleFileSingleClass(const std::string& path, const std::string& class_, bool inversed) const;
-    bool ValidatePattern(const SelectionContext& context, const std::string& pattern, bool inversed) const;
-    bool ValidateExprtk(const SelectionContext& context, const std::string& exprtk, bool inversed) const;
-    bool ValidateIsTrue(const SelectionContext& context, const std::string& istrue, bool inversed) const;
-    bool ValidateIsFalse(const SelectionContext& context, const std::string& isfalse, bool inversed) const;
-    bool ValidateIsEmpty(const SelectionContext& context, const std::string& isempty, bool inversed) const;
-    bool ValidatePlugin(const SelectionContext& context, Plugin* plugin) const;
+    bool ValidateProperties(const EvaluationContext& context, const std::string& properties, bool inversed) const;
+    bool ValidateFileExtensions(const EvaluationContext& context, const std::string& file_extensions, bool inversed) const;
+    bool ValidateExists(const EvaluationContext& context, const std::string& file_exists, bool inversed) const;
+    bool ValidateClass(const EvaluationContext& context, const std::string& class_, bool inversed) const;
+    bool ValidateSingleFileMultipleClasses(const EvaluationContext& context, const std::string& path, const std::string& class_, bool inversed) const;
+    bool ValidateSingleFileSingleClass(const EvaluationContext& context, const std::string& path, const std::string& class_, bool inversed) const;
+    bool ValidatePattern(const EvaluationContext& context, const std::string& pattern, bool inversed) const;
+    bool ValidateExprtk(const EvaluationContext& context, const std::string& exprtk, bool inversed) const;
+    bool ValidateIsTrue(const EvaluationContext& context, const std::string& istrue, bool inversed) const;
+    bool ValidateIsFalse(const EvaluationContext& context, const std::string& isfalse, bool inversed) const;
+    bool ValidateIsEmpty(const EvaluationContext& context, const std::string& isempty, bool inversed) const;
+    struct PLUGIN_VALIDATOR
+    {
+      Plugin* plugin;
+      IAttributeValidator* validator;
+    };
+    typedef std::vector<PLUGIN_VALIDATOR> PluginValidatorList;
+
+    bool ValidatePlugin(const EvaluationContext& context, Plugin* plugin) const;
+    bool ValidatePluginValidators(const EvaluationContext& context, const PluginValidatorList& plugin_validators) const;
+    void FindPluginValidators(Plugin* plugin, PluginValidatorList& plugin_validators) const;
+    void UpdateConstants() const;
+    void InvalidateConstants();
+    const std::string& GetAttribute(const std::string& name) const;
+    void SetAttribute(const std::string& name, const std::string& value);
+    bool HasAttribute(const std::string& name) const;
 
   private:
+    enum CONSTANT_RESULT
+    {
+      CONSTANT_RESULT_UNKNOWN, // the attribute must be evaluated for each selection
+      CONSTANT_RESULT_VALID,
+      CONSTANT_RESULT_INVALID,
+    };
+
     int mMaxFiles;
     int mMaxDirectories;
-    PropertyStore mAttributes;
+    // The values of the attributes are interned. Validators of a configuration often share the same values.
+    typedef std::map<std::string /*name*/, InternedString /*value*/> AttributeMap;
+    AttributeMap mAttributes;
     PropertyStore mCustomAttributes;
     Plugin::PluginPtrList mPlugins;
     Menu* mParentMenu;
+
+    // The 'exprtk' attribute with property references bound as variables.
+    PropertyExpression* mExprtk;
+
+    // Compiled form of the expanded 'pattern' attribute.
+    mutable std::string mPatternSetSource;
+    mutable WildcardPatternSet mPatternSet;
+
+    // Results of the attributes which only depends on stable properties. See FoldConstants().
+    mutable bool mFolded;
+    mutable size_t mFoldedVersion;
+    mutable bool mAlwaysValid;
+    mutable CONSTANT_RESULT mExprtkResult;
+    mutable CONSTANT_RESULT mIsTrueResult;
+    mutable CONSTANT_RESULT mIsFalseResult;
+    mutable CONSTANT_RESULT mIsEmptyResult;
+
+    // Attribute validators of the configuration's plugins required by the custom attributes. See ResolvePluginValidators().
+    mutable bool mPluginValidatorsResolved;
+    mutable size_t mPluginValidatorsGeneration;
+    mutable Plugin::PluginPtrList mPluginValidatorsSource;
+    mutable PluginValidatorList mPluginValidators;
   };
 
 } //namespace shellanything
@@ -26,28 +26,10 @@
 #include <vector>
 
 #include "Wildcard.h"
+#include "CaseFolding.h"
 
 namespace shellanything
 {
-  static const size_t INVALID_WILDCARD_POSITION = (size_t)-1;
-
-  size_t GetNextWildcardPosition(const size_t* positions, size_t num_wildcards, size_t current)
-  {
-    for (size_t i = 0; i < num_wildcards; i++)
-    {
-      const size_t& pos = positions[i];
-      if (pos == current)
-      {
-        if (i + 1 < num_wildcards)
-        {
-          return positions[i + 1];
-        }
-        return INVALID_WILDCARD_POSITION; //requested wildcard is the last one
-      }
-    }
-    return INVALID_WILDCARD_POSITION; //wildcard position not found
-  }
-
   size_t FindWildcardCharacters(const char* str, size_t* offsets, size_t offsets_size)
   {
     // Validate str
@@ -146,16 +128,50 @@ namespace shellanything
     return true;
   }
 
-  bool WildcardSolve(const char* pattern,
-                     const char* value,
-                     const size_t* positions,
-                     size_t num_wildcards,
-                     size_t pattern_offset,
-                     size_t value_offset,
-                     WildcardList& matches)
+  /// <summary>
+  /// Defines the portion of the value that is matched by a wildcard character.
+  /// The span is an offset and a length within the solved value.
+  /// </summary>
+  struct WILDCARD_SPAN
+  {
+    char character;
+    size_t index;
+    size_t offset;
+    size_t length;
+  };
+
+  /// <summary>
+  /// Defines the state shared by all recursive calls while solving a wildcard pattern.
+  /// </summary>
+  struct WILDCARD_SOLVER
+  {
+    const char* pattern;
+    size_t pattern_length;
+    const char* value;
+    size_t value_length;
+    WILDCARD_SPAN* spans; // one span per wildcard character of the pattern
+    size_t num_spans;
+  };
+
+  // Number of wildcard characters that can be solved without allocating memory
+  static const size_t WILDCARD_SPAN_BUFFER_SIZE = 32;
+
+  inline void PushWildcardSpan(WILDCARD_SOLVER& solver, char character, size_t index, size_t offset, size_t length)
   {
-    size_t pattern_length = strlen(pattern);
-    size_t value_length = strlen(value);
+    WILDCARD_SPAN& span = solver.spans[solver.num_spans];
+    span.character = character;
+    span.index = index;
+    span.offset = offset;
+    span.length = length;
+    solver.num_spans++;
+  }
+
+  bool WildcardSolve(WILDCARD_SOLVER& solver, size_t pattern_offset, size_t value_offset)
+  {
+    const char* pattern = solver.pattern;
+    const char* value = solver.value;
+    const size_t& pattern_length = solver.pattern_length;
+    const size_t& value_length = solver.value_length;
 
     // While pattern and value not fully solved
     while (pattern_offset < pattern_length || value_offset < value_length)
@@ -177,11 +193,12 @@ namespace shellanything
         if (pattern_char == '?')
         {
           // Save wildcard info
-          WILDCARD w;
-          w.character = pattern_char;
-          w.index = pattern_offset;
-          w.value = value_char;
-          matches.push_back(w);
+          PushWildcardSpan(solver, pattern_char, pattern_offset, value_offset, 1);
+
+          // If the value is fully consumed, '?' matched the string terminator.
+          // There is nothing left in the value for the rest of the pattern.
+          if (value_offset >= value_length)
+            return false;
 
           // Next characters
           pattern_offset++;
@@ -195,81 +212,60 @@ namespace shellanything
             // Automatically match the end of the string
 
             // Save wildcard info
-            WILDCARD w;
-            w.character = pattern_char;
-            w.index = pattern_offset;
-            w.value = &value_char;
-            matches.push_back(w);
-
-            // If we reached a '*' sequence, move forward to the last '*' character of the sequence
-            while (pattern[pattern_offset] == '*' && (pattern_offset + 1 < pattern_length) && pattern[pattern_offset + 1] == '*')
-            {
-              pattern_offset++;
-            }
+            size_t length = value_length - value_offset;
+            PushWildcardSpan(solver, pattern_char, pattern_offset, value_offset, length);
 
             // Next characters
             pattern_offset++;
-            value_offset += w.value.size();
+            value_offset += length;
           }
           else
           {
             // Wildcard character '*' is not the last one
 
-            // Compute all possibles candidates that can fit in '*' and then use recursion to check if it can be resolved.
-            // Compute the candidates from the longest to the shortest ("") for optimizing the replacement string.
+            // Try all possibles candidates that can fit in '*' and then use recursion to check if it can be resolved.
+            // Try the candidates from the longest to the shortest ("") for optimizing the replacement string.
             // Since all wildcard characters must be mapped, do not compute possibilities/candidates beyond the next wildcard character.
 
-            // Compute next character
-            const char& pattern_char_next = (&pattern_char)[1];
-
-            size_t next_wildcard_position = GetNextWildcardPosition(positions, num_wildcards, pattern_offset);
-
-            // Extract non-wildcard (fixed) characters between this wildcard and the next one (or the end of the string)
+            // Count non-wildcard (fixed) characters between this wildcard and the next one (or the end of the string)
             // In order to match the current '*' character, these non-wildcard characters in the pattern will also have to match.
-            // ie: Extract "fgh" in "abc*fgh?j" or "abc*fgh"
-            std::string pattern_fixed_characters = &pattern_char_next;
-            if (next_wildcard_position != INVALID_WILDCARD_POSITION)
+            // ie: Count "fgh" in "abc*fgh?j" or "abc*fgh"
+            // Note that the next wildcard character is also counted.
+            size_t num_fixed_characters = pattern_length - pattern_offset - 1;
+            for (size_t i = pattern_offset + 1; i < pattern_length; i++)
             {
-              // There is at least another wildcard character after this one
-              pattern_fixed_characters = &pattern_char_next;
-              size_t size = next_wildcard_position - pattern_offset;
-              pattern_fixed_characters.resize(size);
+              if (IsWildcard(pattern[i]))
+              {
+                num_fixed_characters = i - pattern_offset;
+                break;
+              }
             }
 
-            // Compute maximum length of candidate
+            // Is there enough characters left in value for the fixed characters?
             size_t remaining_characters_in_value = value_length - value_offset;
-            size_t candidate_max_length = remaining_characters_in_value - pattern_fixed_characters.size();
+            if (remaining_characters_in_value < num_fixed_characters)
+              return false;
+
+            // Compute maximum length of candidate
+            size_t candidate_max_length = remaining_characters_in_value - num_fixed_characters;
 
-            // Compute all possible candidates that can fit in '*' with a length in [0,candidate_max_length]
-            for (size_t length = candidate_max_length; length >= 0 && length != INVALID_WILDCARD_POSITION; length--)
+            // Try all possible candidates that can fit in '*' with a length in [0,candidate_max_length]
+            size_t num_spans = solver.num_spans;
+            for (size_t i = 0; i <= candidate_max_length; i++)
             {
               // Assuming replacement string is the right one
-
-              std::string candidate = &value_char;
-              candidate.resize(length);
-
-              WildcardList sub_matches = matches;
+              size_t length = candidate_max_length - i;
 
               // Save wildcard information
-              WILDCARD w;
-              w.character = pattern_char;
-              w.index = pattern_offset;
-              w.value = candidate;
-              sub_matches.push_back(w);
-
-              // Next characters
-              size_t sub_pattern_offset = pattern_offset + 1;
-              size_t sub_value_offset = value_offset + w.value.size();
-
-              // Execute recursive call
-              bool solved = WildcardSolve(pattern, value, positions, num_wildcards, sub_pattern_offset, sub_value_offset, sub_matches);
+              PushWildcardSpan(solver, pattern_char, pattern_offset, value_offset, length);
+
+              // Execute recursive call with the next characters
+              bool solved = WildcardSolve(solver, pattern_offset + 1, value_offset + length);
               if (solved)
-              {
-                // Solved!
-                // Keep the sub matches that we found
-                matches = sub_matches;
-                return true;
-              }
+                return true; // Solved! Keep the spans that we found.
+
+              // Forget about this candidate and the spans found by the recursive call
+              solver.num_spans = num_spans;
             }
 
             // All possibilities were checked
@@ -282,10 +278,7 @@ namespace shellanything
 
     if (pattern_offset == pattern_length && value_offset == value_length)
       return true; // Solved
-    if ((pattern_offset == pattern_length && value_offset < value_length) ||
-        (pattern_offset == pattern_length && value_offset < value_length))
-      return false; // Reached the end of pattern or the end of value
-    return false; //???
+    return false; // Reached the end of pattern or the end of value
   }
 
   bool WildcardSolve(const char* pattern, const char* value, WildcardList& matches)
@@ -295,35 +288,91 @@ namespace shellanything
 
     matches.clear();
 
-    // Force the pattern to its simplest form
-    std::string simplified_pattern = pattern;
-    WildcardSimplify(simplified_pattern);
+    // Force the pattern to its simplest form.
+    // Only make a copy of the pattern if it actually contains a '*' sequence.
+    std::string simplified_pattern;
+    if (strstr(pattern, "**") != NULL)
+    {
+      simplified_pattern = pattern;
+      WildcardSimplify(simplified_pattern);
+      pattern = simplified_pattern.c_str();
+    }
 
-    // Find all wildcard character positions
-    size_t num_wildcards = FindWildcardCharacters(simplified_pattern.c_str(), NULL, 0);
+    // Find all wildcard characters
+    size_t num_wildcards = FindWildcardCharacters(pattern, NULL, 0);
 
     // If no wildcard character found, the strings must be equal
     if (num_wildcards == 0)
-      return (std::string(pattern) == std::string(value));
-
-    // Allocate memory for all wildcard positions
-    size_t* positions = new size_t[num_wildcards];
-    FindWildcardCharacters(simplified_pattern.c_str(), positions, num_wildcards * sizeof(positions[0]));
+      return (strcmp(pattern, value) == 0);
+
+    // Each wildcard character is solved with at most one span.
+    // Use a local buffer for the spans unless the pattern has a lot of wildcard characters.
+    WILDCARD_SPAN local_spans[WILDCARD_SPAN_BUFFER_SIZE];
+    std::vector<WILDCARD_SPAN> heap_spans;
+    WILDCARD_SOLVER solver;
+    solver.pattern = pattern;
+    solver.pattern_length = strlen(pattern);
+    solver.value = value;
+    solver.value_length = strlen(value);
+    solver.spans = local_spans;
+    solver.num_spans = 0;
+    if (num_wildcards > WILDCARD_SPAN_BUFFER_SIZE)
+    {
+      heap_spans.resize(num_wildcards);
+      solver.spans = &heap_spans[0];
+    }
 
     //solve wildcards
-    bool solved = WildcardSolve(simplified_pattern.c_str(), value, positions, num_wildcards, 0, 0, matches);
+    bool solved = WildcardSolve(solver, 0, 0);
 
-    delete[] positions;
-    positions = NULL;
+    // Build the matches from the spans.
+    // On failure, the spans found before the failure are also returned.
+    matches.reserve(solver.num_spans);
+    for (size_t i = 0; i < solver.num_spans; i++)
+    {
+      const WILDCARD_SPAN& span = solver.spans[i];
+      matches.push_back(WILDCARD());
+      WILDCARD& w = matches.back();
+      w.character = span.character;
+      w.index = span.index;
+      w.value.assign(value + span.offset, span.length);
+    }
 
     return solved;
   }
 
-  bool WildcardMatch(const char* pattern, const char* value)
+  /// <summary>
+  /// Case sensitive character comparison for WildcardMatch().
+  /// </summary>
+  struct CASE_SENSITIVE_COMPARE
   {
-    if (pattern == NULL || value == NULL)
-      return false;
+    static inline size_t Match(const char* pattern, const char* value)
+    {
+      return (pattern[0] == value[0] ? 1 : 0);
+    }
+  };
+
+  /// <summary>
+  /// Case insensitive character comparison for WildcardMatch().
+  /// </summary>
+  struct CASE_INSENSITIVE_COMPARE
+  {
+    static inline size_t Match(const char* pattern, const char* value)
+    {
+      // Fast path for ASCII characters
+      unsigned char p = (unsigned char)pattern[0];
+      unsigned char v = (unsigned char)value[0];
+      if ((p | v) < 0x80)
+        return (FoldCaseAscii(p) == FoldCaseAscii(v) ? 1 : 0);
+
+      // Strings are NULL terminated. MatchCharacterCaseInsensitive() never reads beyond the terminating character.
+      return MatchCharacterCaseInsensitive(pattern, value, (size_t)-1);
+    }
+  };
 
+  template <class COMPARE>
+  bool WildcardMatchT(const char* pattern, const char* value)
+  {
     // Move forward in the pattern and the value as long as we have matching characters.
     bool matching_characters = true;
     while (matching_characters)
@@ -365,13 +414,24 @@ namespace shellanything
       }
 
       // If the pattern contains '?', if both pattern and value characters are equals, move forward
-      if (pattern[0] == '?' || pattern[0] == value[0])
+      if (pattern[0] == '?')
       {
         pattern++;
         value++;
 
         matching_characters = true;
       }
+      else
+      {
+        size_t length = COMPARE::Match(pattern, value);
+        if (length)
+        {
+          pattern += length;
+          value += length;
+
+          matching_characters = true;
+        }
+      }
     }
 
     // If we reached a '*' character in the pattern, there is two possibilities:
@@ -381,12 +441,12 @@ namespace shellanything
     if (pattern[0] == '*')
     {
       // 1) The '*' replaces the next value character.
-      bool match = WildcardMatch(pattern, value + 1);
+      bool match = WildcardMatchT<COMPARE>(pattern, value + 1);
       if (match)
         return true;
 
       // 2) The '*' does not replaces the next value character.
-      match = WildcardMatch(pattern + 1, value);
+      match = WildcardMatchT<COMPARE>(pattern + 1, value);
       if (match)
         return true;
     }
@@ -395,4 +455,20 @@ namespace shellanything
     return false;
   }
 
+  bool WildcardMatch(const char* pattern, const char* value)
+  {
+    if (pattern == NULL || value == NULL)
+      return false;
+    return WildcardMatchT<CASE_SENSITIVE_COMPARE>(pattern, value);
+  }
+
+  bool WildcardMatch(const char* pattern, const char* value, WILDCARD_FLAGS flags)
+  {
+    if (pattern == NULL || value == NULL)
+      return false;
+    if (flags & WILDCARD_CASE_INSENSITIVE)
+      return WildcardMatchT<CASE_INSENSITIVE_COMPARE>(pattern, value);
+    return WildcardMatchT<CASE_SENSITIVE_COMPARE>(pattern, value);
+  }
+
 } //namespace shellanything
@@ -27,6 +27,9 @@
 
 #include "shellanything/export.h"
 #include "shellanything/config.h"
+#include "Enums.h"
+#include <string>
+#include <vector>
 
 namespace shellanything
 {
@@ -68,6 +71,12 @@ namespace shellanything
   /// <param name="pattern">The wildcard pattern to simplify.</param>
   SHELLANYTHING_EXPORT void WildcardSimplify(char* pattern);
 
+  /// <summary>
+  /// Simplify a wildcard pattern. Remove sequences of '*' characters.
+  /// </summary>
+  /// <param name="pattern">The wildcard pattern to simplify.</param>
+  SHELLANYTHING_EXPORT void WildcardSimplify(std::string& pattern);
+
   /// <summary>
   /// Finds the position of each wildcard character in the given string.
   /// If the 'findings' array is too small, the functions stops looking for wildcard characters and returns immediately.
@@ -108,6 +117,16 @@ namespace shellanything
   /// <returns>Returns true if the given pattern with wildcard characters matches the given value. Returns false otherwise.</returns>
   SHELLANYTHING_EXPORT bool WildcardMatch(const char* pattern, const char* value);
 
+  /// <summary>
+  /// Returns true if the given pattern with wildcard characters matches the given value.
+  /// With the WILDCARD_CASE_INSENSITIVE flag, characters are compared ignoring case (see MatchCharacterCaseInsensitive()).
+  /// </summary>
+  /// <param name="pattern">The string with the wildcard pattern.</param>
+  /// <param name="value">The value to match.</param>
+  /// <param name="flags">The flags for matching the value.</param>
+  /// <returns>Returns true if the given pattern with wildcard characters matches the given value. Returns false otherwise.</returns>
+  SHELLANYTHING_EXPORT bool WildcardMatch(const char* pattern, const char* value, WILDCARD_FLAGS flags);
+
 } //namespace shellanything
 
 #endif //SA_WILDCARD_H
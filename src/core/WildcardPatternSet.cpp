@@ -0,0 +1,334 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "WildcardPatternSet.h"
+#include "Wildcard.h"
+#include "CaseFolding.h"
+
+#include <string.h>
+
+namespace shellanything
+{
+  static const int INVALID_STATE = -1;
+
+  WildcardPatternSet::WildcardPatternSet()
+  {
+    Clear();
+  }
+
+  WildcardPatternSet::WildcardPatternSet(const WildcardPatternSet& s)
+  {
+    (*this) = s;
+  }
+
+  WildcardPatternSet::~WildcardPatternSet()
+  {
+  }
+
+  const WildcardPatternSet& WildcardPatternSet::operator =(const WildcardPatternSet& s)
+  {
+    if (this != &s)
+    {
+      mFlags = s.mFlags;
+      mPatterns = s.mPatterns;
+      mUnanchored = s.mUnanchored;
+      memcpy(mClasses, s.mClasses, sizeof(mClasses));
+      mNumClasses = s.mNumClasses;
+      mTransitions = s.mTransitions;
+      mOutputOffsets = s.mOutputOffsets;
+      mOutputs = s.mOutputs;
+    }
+    return (*this);
+  }
+
+  void WildcardPatternSet::Clear()
+  {
+    mFlags = WILDCARD_NONE;
+    mPatterns.clear();
+    mUnanchored.clear();
+    memset(mClasses, 0, sizeof(mClasses));
+    mNumClasses = 1; // class 0 is reserved for characters that are not in any literal sequence
+    mTransitions.clear();
+    mOutputOffsets.clear();
+    mOutputs.clear();
+  }
+
+  size_t WildcardPatternSet::AddClass(unsigned char c)
+  {
+    if (mClasses[c] == 0)
+    {
+      mClasses[c] = (unsigned char)mNumClasses;
+      mNumClasses++;
+    }
+    return mClasses[c];
+  }
+
+  bool WildcardPatternSet::IsAnchorCharacter(char c) const
+  {
+    if (IsWildcard(c))
+      return false;
+
+    // When ignoring case, the automaton only folds ASCII characters.
+    if ((mFlags & WILDCARD_CASE_INSENSITIVE) && (unsigned char)c >= 0x80)
+      return false;
+
+    return true;
+  }
+
+  void WildcardPatternSet::Compile(const StringList& patterns, WILDCARD_FLAGS flags)
+  {
+    Clear();
+    mFlags = flags;
+
+    // Extract the literal sequences of each pattern.
+    // The longest literal sequence of a pattern is called the anchor of the pattern:
+    // a value can only match the pattern if it contains the anchor.
+    StringList anchors;
+    mPatterns.reserve(patterns.size());
+    anchors.reserve(patterns.size());
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+      PATTERN p;
+      p.pattern = patterns[i];
+      WildcardSimplify(p.pattern);
+      p.min_length = 0;
+      p.has_wildcards = false;
+      p.has_star = false;
+
+      std::string anchor;
+      size_t sequence_start = 0;
+      size_t anchor_start = 0;
+      const std::string& pattern = p.pattern;
+      for (size_t j = 0; j <= pattern.size(); j++)
+      {
+        bool end_of_pattern = (j == pattern.size());
+        bool wildcard = (!end_of_pattern && IsWildcard(pattern[j]));
+        if (end_of_pattern || !IsAnchorCharacter(pattern[j]))
+        {
+          // End of a sequence of characters that can be used as an anchor
+          size_t anchor_length = j - anchor_start;
+          if (anchor_length > anchor.size())
+            anchor.assign(pattern, anchor_start, anchor_length);
+          anchor_start = j + 1;
+        }
+        if (end_of_pattern || wildcard)
+        {
+          // End of a literal sequence
+          size_t sequence_length = j - sequence_start;
+          if (!p.has_wildcards)
+            p.prefix.assign(pattern, 0, j);
+          if (end_of_pattern)
+            p.suffix.assign(pattern, sequence_start, sequence_length);
+          sequence_start = j + 1;
+        }
+        if (wildcard)
+        {
+          p.has_wildcards = true;
+          if (pattern[j] == '*')
+            p.has_star = true;
+        }
+        if (!end_of_pattern && pattern[j] != '*')
+          p.min_length++;
+      }
+
+      if (anchor.empty())
+        mUnanchored.push_back(mPatterns.size());
+
+      mPatterns.push_back(p);
+      anchors.push_back(anchor);
+    }
+
+    // Assign a character class to each character found in the anchors.
+    for (size_t i = 0; i < anchors.size(); i++)
+    {
+      const std::string& anchor = anchors[i];
+      for (size_t j = 0; j < anchor.size(); j++)
+      {
+        const char& c = anchor[j];
+        if (mFlags & WILDCARD_CASE_INSENSITIVE)
+        {
+          // Lowercase and uppercase letters share the same class
+          unsigned char upper = (unsigned char)FoldCaseAscii(c);
+          unsigned char lower = (unsigned char)(upper >= 'A' && upper <= 'Z' ? upper + ('a' - 'A') : upper);
+          mClasses[lower] = (unsigned char)AddClass(upper);
+        }
+        else
+          AddClass((unsigned char)c);
+      }
+    }
+
+    // Build a trie of all anchors. State 0 is the root of the trie.
+    std::vector<IndexList> outputs;
+    mTransitions.assign(mNumClasses, INVALID_STATE);
+    outputs.resize(1);
+    for (size_t i = 0; i < anchors.size(); i++)
+    {
+      const std::string& anchor = anchors[i];
+      if (anchor.empty())
+        continue;
+
+      int state = 0;
+      for (size_t j = 0; j < anchor.size(); j++)
+      {
+        size_t transition = state * mNumClasses + mClasses[(unsigned char)anchor[j]];
+        int next = mTransitions[transition];
+        if (next == INVALID_STATE)
+        {
+          next = (int)outputs.size();
+          outputs.resize(outputs.size() + 1);
+          mTransitions.resize(mTransitions.size() + mNumClasses, INVALID_STATE);
+          mTransitions[transition] = next;
+        }
+        state = next;
+      }
+      outputs[state].push_back(i);
+    }
+
+    // Convert the trie into a deterministic automaton (Aho-Corasick).
+    // Missing transitions are resolved with the failure link of each state.
+    StateList failures(outputs.size(), 0);
+    StateList queue;
+    queue.reserve(outputs.size());
+    for (size_t c = 0; c < mNumClasses; c++)
+    {
+      int& next = mTransitions[c];
+      if (next == INVALID_STATE)
+        next = 0;
+      else
+        queue.push_back(next);
+    }
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+      int state = queue[i];
+      int failure = failures[state];
+      for (size_t c = 0; c < mNumClasses; c++)
+      {
+        int& next = mTransitions[state * mNumClasses + c];
+        int failure_next = mTransitions[failure * mNumClasses + c];
+        if (next == INVALID_STATE)
+        {
+          next = failure_next;
+        }
+        else
+        {
+          failures[next] = failure_next;
+
+          // An anchor that ends at the failure state also ends at this state.
+          const IndexList& inherited = outputs[failure_next];
+          outputs[next].insert(outputs[next].end(), inherited.begin(), inherited.end());
+
+          queue.push_back(next);
+        }
+      }
+    }
+
+    // Flatten the outputs of each state
+    mOutputOffsets.reserve(outputs.size() + 1);
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+      mOutputOffsets.push_back(mOutputs.size());
+      mOutputs.insert(mOutputs.end(), outputs[i].begin(), outputs[i].end());
+    }
+    mOutputOffsets.push_back(mOutputs.size());
+  }
+
+  size_t WildcardPatternSet::GetPatternCount() const
+  {
+    return mPatterns.size();
+  }
+
+  bool WildcardPatternSet::IsEmpty() const
+  {
+    return mPatterns.empty();
+  }
+
+  bool WildcardPatternSet::Confirm(const PATTERN& p, const char* value, size_t length) const
+  {
+    if (length < p.min_length)
+      return false;
+    if (!p.has_star && length != p.min_length)
+      return false;
+
+    if (mFlags & WILDCARD_CASE_INSENSITIVE)
+    {
+      // Case folding never changes the length of a character. The same offsets can be used.
+      if (!p.has_wildcards)
+        return EqualsCaseInsensitive(p.pattern.c_str(), value, length);
+      if (!EqualsCaseInsensitive(p.prefix.c_str(), value, p.prefix.size()))
+        return false;
+      if (!EqualsCaseInsensitive(p.suffix.c_str(), value + length - p.suffix.size(), p.suffix.size()))
+        return false;
+      return WildcardMatch(p.pattern.c_str(), value, mFlags);
+    }
+
+    // Without wildcard characters, the value must be identical to the pattern.
+    if (!p.has_wildcards)
+      return (memcmp(p.pattern.c_str(), value, length) == 0);
+
+    if (memcmp(p.prefix.c_str(), value, p.prefix.size()) != 0)
+      return false;
+    if (memcmp(p.suffix.c_str(), value + length - p.suffix.size(), p.suffix.size()) != 0)
+      return false;
+
+    return WildcardMatch(p.pattern.c_str(), value);
+  }
+
+  bool WildcardPatternSet::Match(const char* value) const
+  {
+    if (value == NULL)
+      return false;
+
+    size_t length = strlen(value);
+
+    // Patterns without anchors can not be filtered
+    for (size_t i = 0; i < mUnanchored.size(); i++)
+    {
+      const PATTERN& p = mPatterns[mUnanchored[i]];
+      if (Confirm(p, value, length))
+        return true;
+    }
+
+    if (mOutputs.empty())
+      return false;
+
+    // Run the automaton over the value. Each time an anchor is found, confirm the matching patterns.
+    int state = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+      state = mTransitions[state * mNumClasses + mClasses[(unsigned char)value[i]]];
+
+      size_t first = mOutputOffsets[state];
+      size_t last = mOutputOffsets[state + 1];
+      for (size_t j = first; j < last; j++)
+      {
+        const PATTERN& p = mPatterns[mOutputs[j]];
+        if (Confirm(p, value, length))
+          return true;
+      }
+    }
+
+    return false;
+  }
+
+} //namespace shellanything
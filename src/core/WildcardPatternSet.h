@@ -0,0 +1,119 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_WILDCARD_PATTERN_SET_H
+#define SA_WILDCARD_PATTERN_SET_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+#include "StringList.h"
+#include "Enums.h"
+#include <string>
+#include <vector>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A WildcardPatternSet is a list of wildcard patterns compiled once for matching many values.
+  /// A value matches the set if it matches at least one of the patterns (see WildcardMatch()).
+  /// </summary>
+  /// <remarks>
+  /// The longest literal sequence (without wildcard characters) of each pattern is compiled into a single automaton.
+  /// Matching a value against the set requires a single pass over the value to find which patterns are candidates.
+  /// Candidates are then confirmed individually with their prefix, suffix and WildcardMatch().
+  /// </remarks>
+  class SHELLANYTHING_EXPORT WildcardPatternSet
+  {
+  public:
+    WildcardPatternSet();
+    WildcardPatternSet(const WildcardPatternSet& s);
+    virtual ~WildcardPatternSet();
+
+    /// <summary>
+    /// Copy operator
+    /// </summary>
+    const WildcardPatternSet& operator =(const WildcardPatternSet& s);
+
+    /// <summary>
+    /// Clears all the compiled patterns.
+    /// </summary>
+    void Clear();
+
+    /// <summary>
+    /// Compile the given list of patterns. Previously compiled patterns are cleared.
+    /// </summary>
+    /// <param name="patterns">The list of wildcard patterns.</param>
+    /// <param name="flags">The flags for matching values. See WildcardMatch().</param>
+    void Compile(const StringList& patterns, WILDCARD_FLAGS flags = WILDCARD_NONE);
+
+    /// <summary>
+    /// Get the number of compiled patterns.
+    /// </summary>
+    size_t GetPatternCount() const;
+
+    /// <summary>
+    /// Returns whether the set contains no pattern.
+    /// </summary>
+    /// <returns>Returns true if the set is empty. Returns false otherwise.</returns>
+    bool IsEmpty() const;
+
+    /// <summary>
+    /// Returns true if the given value matches at least one of the compiled patterns.
+    /// </summary>
+    /// <param name="value">The value to match.</param>
+    /// <returns>Returns true if the given value matches at least one of the compiled patterns. Returns false otherwise.</returns>
+    bool Match(const char* value) const;
+
+  private:
+    struct PATTERN
+    {
+      std::string pattern;  // simplified pattern
+      std::string prefix;   // literal characters before the first wildcard character
+      std::string suffix;   // literal characters after the last wildcard character
+      size_t min_length;    // minimum length of a matching value
+      bool has_wildcards;
+      bool has_star;
+    };
+    typedef std::vector<PATTERN> PatternList;
+    typedef std::vector<int> StateList;
+    typedef std::vector<size_t> IndexList;
+
+    bool Confirm(const PATTERN& p, const char* value, size_t length) const;
+    size_t AddClass(unsigned char c);
+    bool IsAnchorCharacter(char c) const;
+
+  private:
+    WILDCARD_FLAGS mFlags;
+    PatternList mPatterns;
+    IndexList mUnanchored;    // patterns without literal characters. They must always be confirmed.
+    unsigned char mClasses[256]; // map each byte to a character class of the automaton
+    size_t mNumClasses;
+    StateList mTransitions;   // mNumClasses transitions per state
+    IndexList mOutputOffsets; // for each state, the offset of the first output in mOutputs
+    IndexList mOutputs;       // pattern indices whose literal sequence ends at a given state
+  };
+
+} //namespace shellanything
+
+#endif //SA_WILDCARD_PATTERN_SET_H
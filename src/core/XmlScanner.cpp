@@ -0,0 +1,282 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "XmlScanner.h"
+
+#include "rapidassist/strings.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace shellanything
+{
+  const size_t XmlScanner::INVALID_INDEX = (size_t)-1;
+
+  // An element which is not closed yet.
+  struct OPEN_ELEMENT
+  {
+    const char* name;
+    size_t name_length;
+    size_t line;
+    size_t index; //index in the output list. INVALID_INDEX if the element is not reported
+  };
+
+  inline bool IsXmlSpace(char c)
+  {
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  }
+
+  // Find the given text in [begin, end). Returns end if not found.
+  const char* FindText(const char* begin, const char* end, const char* text)
+  {
+    const char* found = std::search(begin, end, text, text + strlen(text));
+    return found;
+  }
+
+  XmlScanner::XmlScanner()
+  {
+  }
+
+  XmlScanner::~XmlScanner()
+  {
+  }
+
+  bool XmlScanner::Scan(const char* data, size_t size, size_t max_depth, ElementList& elements)
+  {
+    elements.clear();
+    mDeclaration.clear();
+    mError.clear();
+
+    const char* begin = data;
+    const char* end = data + size;
+    const char* p = begin;
+    size_t line = 1;
+    std::vector<OPEN_ELEMENT> open_elements;
+
+    //skip the utf-8 byte order mark
+    if (size >= 3 && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF)
+      p += 3;
+
+    bool first_node = true;
+    while (p < end)
+    {
+      //search the next markup
+      const char* markup = (const char*)memchr(p, '<', end - p);
+      if (markup == NULL)
+        markup = end;
+      for (const char* c = p; first_node && c < markup; c++)
+      {
+        if (!IsXmlSpace(*c))
+          first_node = false; //text
+      }
+      line += std::count(p, markup, '\n');
+      p = markup;
+      if (p == end)
+        break;
+
+      const size_t markup_line = line;
+      const char* markup_end = NULL;
+      if (end - p >= 2 && p[1] == '?')
+      {
+        //declaration or processing instruction
+        markup_end = FindText(p, end, "?>");
+        if (markup_end == end)
+          return SetError("Unterminated declaration", markup_line);
+        if (first_node)
+          mDeclaration.assign(p + 2, markup_end);
+        markup_end += 2;
+      }
+      else if (end - p >= 4 && strncmp(p, "<!--", 4) == 0)
+      {
+        markup_end = FindText(p + 4, end, "-->");
+        if (markup_end == end)
+          return SetError("Unterminated comment", markup_line);
+        markup_end += 3;
+      }
+      else if (end - p >= 9 && strncmp(p, "<![CDATA[", 9) == 0)
+      {
+        if (open_elements.empty())
+          return SetError("CDATA outside of an element", markup_line);
+        markup_end = FindText(p + 9, end, "]]>");
+        if (markup_end == end)
+          return SetError("Unterminated CDATA", markup_line);
+        markup_end += 3;
+      }
+      else if (end - p >= 2 && p[1] == '!')
+      {
+        //document type definition, skip internal subsets
+        int brackets = 0;
+        markup_end = p + 2;
+        while (markup_end < end && (*markup_end != '>' || brackets > 0))
+        {
+          if (*markup_end == '[')
+            brackets++;
+          else if (*markup_end == ']')
+            brackets--;
+          markup_end++;
+        }
+        if (markup_end == end)
+          return SetError("Unterminated document type", markup_line);
+        markup_end++;
+      }
+      else
+      {
+        //start or end tag
+        bool is_end_tag = (end - p >= 2 && p[1] == '/');
+        const char* name = p + (is_end_tag ? 2 : 1);
+        const char* name_end = name;
+        while (name_end < end && !IsXmlSpace(*name_end) && *name_end != '>' && *name_end != '/')
+          name_end++;
+        if (name_end == name)
+          return SetError("Element without a name", markup_line);
+
+        //search the end of the tag, skipping quoted attribute values
+        markup_end = name_end;
+        char quote = 0;
+        while (markup_end < end && (quote != 0 || *markup_end != '>'))
+        {
+          if (quote != 0 && *markup_end == quote)
+            quote = 0;
+          else if (quote == 0 && (*markup_end == '"' || *markup_end == '\''))
+            quote = *markup_end;
+          markup_end++;
+        }
+        if (markup_end == end)
+          return SetError("Unterminated element", markup_line);
+        bool is_empty_element = (!is_end_tag && markup_end[-1] == '/');
+        markup_end++;
+
+        const size_t name_length = name_end - name;
+        if (is_end_tag)
+        {
+          if (open_elements.empty())
+            return SetError("Unexpected end tag", markup_line);
+          const OPEN_ELEMENT& open = open_elements.back();
+          if (open.name_length != name_length || strncmp(open.name, name, name_length) != 0)
+            return SetError("Mismatched element", markup_line);
+          if (open.index != INVALID_INDEX)
+          {
+            ELEMENT& element = elements[open.index];
+            element.length = (markup_end - begin) - element.offset;
+          }
+          open_elements.pop_back();
+        }
+        else
+        {
+          OPEN_ELEMENT open;
+          open.name = name;
+          open.name_length = name_length;
+          open.line = markup_line;
+          open.index = INVALID_INDEX;
+
+          const size_t depth = open_elements.size();
+          if (depth <= max_depth)
+          {
+            ELEMENT element;
+            element.name.assign(name, name_length);
+            element.offset = p - begin;
+            element.length = markup_end - p;
+            element.line = markup_line;
+            element.depth = depth;
+            element.parent = (depth == 0 ? INVALID_INDEX : open_elements.back().index);
+            open.index = elements.size();
+            elements.push_back(element);
+          }
+
+          if (!is_empty_element)
+            open_elements.push_back(open);
+        }
+      }
+
+      line += std::count(p, markup_end, '\n');
+      p = markup_end;
+      first_node = false;
+    }
+
+    if (!open_elements.empty())
+      return SetError("Element is not closed", open_elements.back().line);
+    if (elements.empty())
+      return SetError("Empty document", line);
+
+    return true;
+  }
+
+  const std::string& XmlScanner::GetDeclaration() const
+  {
+    return mDeclaration;
+  }
+
+  const std::string& XmlScanner::GetError() const
+  {
+    return mError;
+  }
+
+  size_t XmlScanner::FindChild(const ElementList& elements, size_t parent, const char* name)
+  {
+    size_t first = (parent == INVALID_INDEX ? 0 : parent + 1);
+    for (size_t i = first; i < elements.size(); i++)
+    {
+      const ELEMENT& element = elements[i];
+      if (parent != INVALID_INDEX && element.depth <= elements[parent].depth)
+        break; //no more children
+      if (element.parent == parent && element.name == name)
+        return i;
+    }
+    return INVALID_INDEX;
+  }
+
+  size_t XmlScanner::FindNextSibling(const ElementList& elements, size_t index, const char* name)
+  {
+    const ELEMENT& sibling = elements[index];
+    for (size_t i = index + 1; i < elements.size(); i++)
+    {
+      const ELEMENT& element = elements[i];
+      if (element.depth < sibling.depth)
+        break; //no more siblings
+      if (element.parent == sibling.parent && element.name == name)
+        return i;
+    }
+    return INVALID_INDEX;
+  }
+
+  uint64_t XmlScanner::GetHash(const char* data, const ELEMENT& element)
+  {
+    //64 bits FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    const char* source = data + element.offset;
+    for (size_t i = 0; i < element.length; i++)
+    {
+      hash ^= (unsigned char)source[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  bool XmlScanner::SetError(const char* description, size_t line)
+  {
+    mError = std::string(description) + " at line " + ra::strings::ToString(line) + ".";
+    return false;
+  }
+
+} //namespace shellanything
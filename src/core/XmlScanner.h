@@ -0,0 +1,135 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef SA_XMLSCANNER_H
+#define SA_XMLSCANNER_H
+
+#include "shellanything/export.h"
+#include "shellanything/config.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace shellanything
+{
+  /// <summary>
+  /// A forward only scanner of the elements of a xml document in memory.
+  /// The scanner does not build a document. It validates that the elements are properly nested
+  /// and reports the position of the elements up to a given depth.
+  /// Each element can then be parsed alone. See ConfigFile::LoadFile().
+  /// </summary>
+  class SHELLANYTHING_EXPORT XmlScanner
+  {
+  public:
+    /// <summary>
+    /// The position of an element in the document.
+    /// </summary>
+    struct ELEMENT
+    {
+      std::string name;
+      size_t offset;  //offset of the start tag
+      size_t length;  //length of the element, including its end tag
+      size_t line;    //line number of the start tag, starting at 1
+      size_t depth;   //0 for the top level elements
+      size_t parent;  //index of the parent element. INVALID_INDEX for the top level elements
+    };
+
+    /// <summary>
+    /// A list of ELEMENT.
+    /// </summary>
+    typedef std::vector<ELEMENT> ElementList;
+
+    /// <summary>
+    /// The index of a missing element.
+    /// </summary>
+    static const size_t INVALID_INDEX;
+
+    XmlScanner();
+    virtual ~XmlScanner();
+
+  private:
+    // Disable copy constructor and copy operator
+    XmlScanner(const XmlScanner&);
+    XmlScanner& operator=(const XmlScanner&);
+  public:
+
+    /// <summary>
+    /// Scan a xml document.
+    /// </summary>
+    /// <param name="data">The content of the document.</param>
+    /// <param name="size">The size of the document in bytes.</param>
+    /// <param name="max_depth">The maximum depth of the elements to report. 0 only reports the top level elements.</param>
+    /// <param name="elements">The output list of elements, in document order.</param>
+    /// <returns>Returns true if the document is properly formed. Returns false otherwise. See GetError().</returns>
+    bool Scan(const char* data, size_t size, size_t max_depth, ElementList& elements);
+
+    /// <summary>
+    /// Get the value of the xml declaration of the last scanned document. For example: xml version="1.0" encoding="utf-8".
+    /// </summary>
+    /// <returns>Returns the value of the declaration. Returns an empty string if the document does not start with a declaration.</returns>
+    const std::string& GetDeclaration() const;
+
+    /// <summary>
+    /// Get the description of the error of the last scan.
+    /// </summary>
+    const std::string& GetError() const;
+
+    /// <summary>
+    /// Find the first child element with the given name.
+    /// </summary>
+    /// <param name="elements">The list of elements of a scanned document.</param>
+    /// <param name="parent">The index of the parent element. Set to INVALID_INDEX to search the top level elements.</param>
+    /// <param name="name">The name of the element to find.</param>
+    /// <returns>Returns the index of the element. Returns INVALID_INDEX if the element is not found.</returns>
+    static size_t FindChild(const ElementList& elements, size_t parent, const char* name);
+
+    /// <summary>
+    /// Find the next sibling element with the given name.
+    /// </summary>
+    /// <param name="elements">The list of elements of a scanned document.</param>
+    /// <param name="index">The index of the element whose next sibling is searched.</param>
+    /// <param name="name">The name of the element to find.</param>
+    /// <returns>Returns the index of the element. Returns INVALID_INDEX if the element is not found.</returns>
+    static size_t FindNextSibling(const ElementList& elements, size_t index, const char* name);
+
+    /// <summary>
+    /// Compute a hash of the source of an element, including its children.
+    /// Elements with different hashes have different sources.
+    /// </summary>
+    /// <param name="data">The content of the scanned document.</param>
+    /// <param name="element">The element of the document.</param>
+    /// <returns>Returns the hash of the source of the element.</returns>
+    static uint64_t GetHash(const char* data, const ELEMENT& element);
+
+  private:
+    bool SetError(const char* description, size_t line);
+
+    std::string mDeclaration;
+    std::string mError;
+  };
+
+} //namespace shellanything
+
+#endif //SA_XMLSCANNER_H
@@ -29,6 +29,13 @@
 
 #include <algorithm>    // std::min
 #include <stdio.h>      // snprintf
+#include <string>
+#include <list>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <chrono>
 
 #define _SCL_SECURE_NO_WARNINGS
 #include "exprtk.hpp"
@@ -66,40 +73,293 @@ __inline int c99_snprintf(char* outBuf, size_t size, const char* format, ...)
 #endif
 
 
-int EvaluateDouble(const char* expression_string, double* result, char* error_buffer, int error_size)
-{
-  if (error_buffer != NULL && error_size > 0)
-    error_buffer[0] = '\0';
+typedef exprtk::symbol_table<double> symbol_table_t;
+typedef exprtk::expression<double>   expression_t;
+typedef exprtk::parser<double>       parser_t;
 
-  typedef exprtk::expression<double> expression_t;
-  typedef exprtk::parser<double>         parser_t;
+static const size_t DEFAULT_EXPRESSION_CACHE_CAPACITY = 256;
 
+/// <summary>
+/// A compiled expression. The same compiled expression must not be evaluated by multiple threads at the same time.
+/// </summary>
+struct COMPILED_EXPRESSION
+{
+  std::mutex mutex;
+  symbol_table_t symbol_table;
+  std::vector<double> numeric_values;     // storage of numeric variables
+  std::vector<std::string> string_values; // storage of string variables
   expression_t expression;
-  parser_t parser;
+};
+typedef std::shared_ptr<COMPILED_EXPRESSION> CompiledExpressionPtr;
 
-  if (!parser.compile(expression_string, expression))
+/// <summary>
+/// A thread safe cache of compiled expressions. The least recently used expressions are removed first.
+/// </summary>
+class ExpressionCache
+{
+public:
+  ExpressionCache() : mCapacity(DEFAULT_EXPRESSION_CACHE_CAPACITY)
   {
-    //Output error description in output
-    if (error_buffer != NULL && error_size > 0)
+    Clear();
+  }
+
+  CompiledExpressionPtr Find(const std::string& expression_string)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    EntryMap::iterator it = mEntries.find(expression_string);
+    if (it == mEntries.end())
     {
-      std::string error_description = parser.error();
+      mStatistics.misses++;
+      return CompiledExpressionPtr();
+    }
+
+    // Move the expression at the front of the list of recently used expressions
+    mRecentlyUsed.splice(mRecentlyUsed.begin(), mRecentlyUsed, it->second.position);
+    mStatistics.hits++;
+    return it->second.compiled;
+  }
+
+  void AddCompileTime(double compile_time)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStatistics.compile_time += compile_time;
+  }
+
+  void Insert(const std::string& expression_string, const CompiledExpressionPtr& compiled)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mCapacity == 0)
+      return;
+
+    // Another thread may have compiled the same expression
+    EntryMap::iterator it = mEntries.find(expression_string);
+    if (it != mEntries.end())
+      return;
+
+    mRecentlyUsed.push_front(expression_string);
+    ENTRY& entry = mEntries[expression_string];
+    entry.compiled = compiled;
+    entry.position = mRecentlyUsed.begin();
+
+    Shrink();
+  }
+
+  void Clear()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mRecentlyUsed.clear();
+    memset(&mStatistics, 0, sizeof(mStatistics));
+  }
+
+  void SetCapacity(size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCapacity = capacity;
+    Shrink();
+  }
+
+  void GetStatistics(EXPRTK_CACHE_STATISTICS& statistics)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    statistics = mStatistics;
+    statistics.size = (int)mEntries.size();
+    statistics.capacity = (int)mCapacity;
+  }
 
-      size_t min_buffer_size = MIN(error_description.size() + 1, error_size); // +1 to include the last non-NULL character
-      snprintf(error_buffer, min_buffer_size, "%s", error_description.c_str());
+private:
+  // Remove the least recently used expressions until the cache fits its capacity.
+  // The mutex must be locked by the caller.
+  void Shrink()
+  {
+    while (mEntries.size() > mCapacity)
+    {
+      mEntries.erase(mRecentlyUsed.back());
+      mRecentlyUsed.pop_back();
+      mStatistics.evictions++;
     }
+  }
+
+  typedef std::list<std::string> ExpressionStringList;
+  struct ENTRY
+  {
+    CompiledExpressionPtr compiled;
+    ExpressionStringList::iterator position;
+  };
+  typedef std::map<std::string, ENTRY> EntryMap;
+
+  std::mutex mMutex;
+  size_t mCapacity;
+  EntryMap mEntries;
+  ExpressionStringList mRecentlyUsed; // most recently used first
+  EXPRTK_CACHE_STATISTICS mStatistics;
+};
+
+static ExpressionCache& GetExpressionCache()
+{
+  static ExpressionCache cache;
+  return cache;
+}
+
+/// <summary>
+/// Get the parser of the calling thread. Parsers are expensive to construct and are reused between compilations.
+/// </summary>
+static parser_t& GetThreadParser()
+{
+  static thread_local parser_t parser;
+  return parser;
+}
+
+void GetExpressionCacheStatistics(EXPRTK_CACHE_STATISTICS* statistics)
+{
+  if (statistics)
+    GetExpressionCache().GetStatistics(*statistics);
+}
+
+void ClearExpressionCache()
+{
+  GetExpressionCache().Clear();
+}
+
+void SetExpressionCacheCapacity(int capacity)
+{
+  GetExpressionCache().SetCapacity(capacity > 0 ? (size_t)capacity : 0);
+}
+
+static void SetError(char* error_buffer, int error_size, const std::string& error_description)
+{
+  //Output error description in output
+  if (error_buffer != NULL && error_size > 0)
+  {
+    size_t min_buffer_size = MIN(error_description.size() + 1, error_size); // +1 to include the last non-NULL character
+    snprintf(error_buffer, min_buffer_size, "%s", error_description.c_str());
+  }
+}
+
+/// <summary>
+/// Build the key of an expression in the cache.
+/// The same expression text with different variables must be compiled separately.
+/// </summary>
+static void GetExpressionKey(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, std::string& key)
+{
+  key = expression_string;
+  for (int i = 0; i < num_variables; i++)
+  {
+    const EXPRTK_VARIABLE& v = variables[i];
+
+    // Expressions never contains a NULL character. Use it as a separator.
+    key.append(1, '\0');
+    key.append(1, v.string_value != NULL ? '$' : '#');
+    key.append(v.name);
+  }
+}
+
+static int Compile(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, COMPILED_EXPRESSION& compiled, char* error_buffer, int error_size)
+{
+  // Define the variables. Storage must not be resized once a variable is bound to the symbol table.
+  int num_numeric_values = 0;
+  int num_string_values = 0;
+  for (int i = 0; i < num_variables; i++)
+  {
+    if (variables[i].string_value != NULL)
+      num_string_values++;
+    else
+      num_numeric_values++;
+  }
+  compiled.numeric_values.resize(num_numeric_values);
+  compiled.string_values.resize(num_string_values);
+  num_numeric_values = 0;
+  num_string_values = 0;
+  for (int i = 0; i < num_variables; i++)
+  {
+    const EXPRTK_VARIABLE& v = variables[i];
+    bool added = false;
+    if (v.name != NULL && v.string_value != NULL)
+      added = compiled.symbol_table.add_stringvar(v.name, compiled.string_values[num_string_values++]);
+    else if (v.name != NULL)
+      added = compiled.symbol_table.add_variable(v.name, compiled.numeric_values[num_numeric_values++]);
+    if (!added)
+    {
+      SetError(error_buffer, error_size, std::string("Invalid variable name '") + (v.name != NULL ? v.name : "") + "'.");
+      return 0;
+    }
+  }
+  compiled.expression.register_symbol_table(compiled.symbol_table);
+
+  parser_t& parser = GetThreadParser();
+  if (!parser.compile(expression_string, compiled.expression))
+  {
+    SetError(error_buffer, error_size, parser.error());
     return 0;
   }
 
+  return 1;
+}
+
+int EvaluateDouble(const char* expression_string, double* result, char* error_buffer, int error_size)
+{
+  return EvaluateDoubleVariables(expression_string, NULL, 0, result, error_buffer, error_size);
+}
+
+int EvaluateDoubleVariables(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, double* result, char* error_buffer, int error_size)
+{
+  if (error_buffer != NULL && error_size > 0)
+    error_buffer[0] = '\0';
+
+  if (expression_string == NULL || (variables == NULL && num_variables > 0))
+    return 0;
+
+  std::string key;
+  GetExpressionKey(expression_string, variables, num_variables, key);
+
+  ExpressionCache& cache = GetExpressionCache();
+  CompiledExpressionPtr compiled = cache.Find(key);
+  if (!compiled)
+  {
+    compiled.reset(new COMPILED_EXPRESSION());
+
+    std::chrono::steady_clock::time_point compile_start = std::chrono::steady_clock::now();
+    int success = Compile(expression_string, variables, num_variables, *compiled, error_buffer, error_size);
+    std::chrono::duration<double, std::milli> compile_time = std::chrono::steady_clock::now() - compile_start;
+    cache.AddCompileTime(compile_time.count());
+
+    if (!success)
+      return 0;
+
+    cache.Insert(key, compiled);
+  }
+
   if (result)
-    *result = expression.value();
+  {
+    std::lock_guard<std::mutex> lock(compiled->mutex);
+
+    // Update the value of each variable
+    size_t num_numeric_values = 0;
+    size_t num_string_values = 0;
+    for (int i = 0; i < num_variables; i++)
+    {
+      const EXPRTK_VARIABLE& v = variables[i];
+      if (v.string_value != NULL)
+        compiled->string_values[num_string_values++] = v.string_value;
+      else
+        compiled->numeric_values[num_numeric_values++] = v.numeric_value;
+    }
+
+    *result = compiled->expression.value();
+  }
 
   return 1;
 }
 
 int EvaluateBoolean(const char* expression_string, int* result, char* error, int error_size)
+{
+  return EvaluateBooleanVariables(expression_string, NULL, 0, result, error, error_size);
+}
+
+int EvaluateBooleanVariables(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, int* result, char* error, int error_size)
 {
   double tmp = 0.0;
-  bool success = EvaluateDouble(expression_string, &tmp, error, error_size);
+  bool success = EvaluateDoubleVariables(expression_string, variables, num_variables, &tmp, error, error_size);
   if (!success)
     return 0;
 
@@ -54,6 +54,88 @@ int EvaluateDouble(const char* expression_string, double* result, char* error_bu
 /// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
 int EvaluateBoolean(const char* expression_string, int* result, char* error_buffer, int error_size);
 
+/// <summary>
+/// Defines a variable of an expression.
+/// </summary>
+typedef struct EXPRTK_VARIABLE
+{
+  const char* name;         // the name of the variable in the expression
+  const char* string_value; // the value of a string variable. Set to NULL for a numeric variable.
+  double numeric_value;     // the value of a numeric variable
+} EXPRTK_VARIABLE;
+
+/// <summary>
+/// Evaluates a text expression with variables and calculates the result.
+/// The expression is compiled once for a given list of variable names and types. Only the values of the variables may change between evaluations.
+/// </summary>
+/// <param name="expression_string">The text expression to evaluate.</param>
+/// <param name="variables">The variables of the expression. Can be NULL if num_variables is 0.</param>
+/// <param name="num_variables">The number of elements in the variables array.</param>
+/// <param name="result">The output double value of the result expression.</param>
+/// <param name="error_buffer">The output error description, if compilation of expression fails.</param>
+/// <param name="error_size">The size in bytes of the error buffer.</param>
+/// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
+int EvaluateDoubleVariables(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, double* result, char* error_buffer, int error_size);
+
+/// <summary>
+/// Evaluates a boolean text expression with variables as a true or false value.
+/// The expression is compiled once for a given list of variable names and types. Only the values of the variables may change between evaluations.
+/// </summary>
+/// <param name="expression_string">The text expression to evaluate.</param>
+/// <param name="variables">The variables of the expression. Can be NULL if num_variables is 0.</param>
+/// <param name="num_variables">The number of elements in the variables array.</param>
+/// <param name="result">The output bool value of the result expression.</param>
+/// <param name="error_buffer">The output error description, if compilation of expression fails.</param>
+/// <param name="error_size">The size in bytes of the error buffer.</param>
+/// <returns>Returns 1 if the evaluation is successfull. Returns 0 otherwise.</returns>
+int EvaluateBooleanVariables(const char* expression_string, const EXPRTK_VARIABLE* variables, int num_variables, int* result, char* error_buffer, int error_size);
+
+/// <summary>
+/// Statistics of the compiled expressions cache.
+/// </summary>
+typedef struct EXPRTK_CACHE_STATISTICS
+{
+  unsigned long long hits;        // number of evaluations that reused a compiled expression
+  unsigned long long misses;      // number of evaluations that required compiling the expression
+  unsigned long long evictions;   // number of compiled expressions removed from the cache to make room for new ones
+  double compile_time;            // total time in milliseconds spent compiling expressions
+  int size;                       // number of compiled expressions in the cache
+  int capacity;                   // maximum number of compiled expressions in the cache
+} EXPRTK_CACHE_STATISTICS;
+
+/// <summary>
+/// Get the statistics of the compiled expressions cache.
+/// Compiled expressions are cached by EvaluateDouble() and EvaluateBoolean() and reused when the same expression is evaluated again.
+/// </summary>
+/// <param name="statistics">The output statistics.</param>
+void GetExpressionCacheStatistics(EXPRTK_CACHE_STATISTICS* statistics);
+
+/// <summary>
+/// Removes all compiled expressions from the cache and resets the cache statistics.
+/// </summary>
+void ClearExpressionCache();
+
+/// <summary>
+/// Set the maximum number of compiled expressions kept in the cache.
+/// The least recently used expressions are removed from the cache when the capacity is reached.
+/// Set to 0 to disable the cache.
+/// </summary>
+/// <param name="capacity">The maximum number of compiled expressions.</param>
+void SetExpressionCacheCapacity(int capacity);
+
+/// <summary>
+/// Calculate the ratio of evaluations that reused a compiled expression.
+/// </summary>
+/// <param name="statistics">The cache statistics.</param>
+/// <returns>Returns the hit rate of the cache, between 0.0 and 1.0.</returns>
+inline double GetExpressionCacheHitRate(const EXPRTK_CACHE_STATISTICS* statistics)
+{
+  unsigned long long total = statistics->hits + statistics->misses;
+  if (total == 0)
+    return 0.0;
+  return (double)statistics->hits / (double)total;
+}
+
 /// <summary>
 /// Evaluates a text expression and calculates the result.
 /// </summary>
@@ -186,7 +186,7 @@ sa_error_t terminate_process_by_pid(DWORD pid)
 sa_error_t killprocess_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -196,7 +196,7 @@ sa_error_t killprocess_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -285,7 +285,7 @@ sa_error_t killprocess_event(sa_action_event_t evnt)
 sa_error_t terminateprocess_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -295,7 +295,7 @@ sa_error_t terminateprocess_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -148,7 +148,7 @@ void string_replace(std::string& text, const std::string& token, const std::stri
 sa_error_t substr_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -158,7 +158,7 @@ sa_error_t substr_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -232,7 +232,7 @@ sa_error_t substr_event(sa_action_event_t evnt)
 sa_error_t strlen_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -242,7 +242,7 @@ sa_error_t strlen_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -304,7 +304,7 @@ sa_error_t strlen_event(sa_action_event_t evnt)
 sa_error_t strreplace_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -314,7 +314,7 @@ sa_error_t strreplace_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -375,7 +375,7 @@ sa_error_t strreplace_event(sa_action_event_t evnt)
 sa_error_t struppercase_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -385,7 +385,7 @@ sa_error_t struppercase_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -446,7 +446,7 @@ sa_error_t struppercase_event(sa_action_event_t evnt)
 sa_error_t strlowercase_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -456,7 +456,7 @@ sa_error_t strlowercase_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
@@ -517,7 +517,7 @@ sa_error_t strlowercase_event(sa_action_event_t evnt)
 sa_error_t strfind_event_create(sa_action_event_t evnt)
 {
   const char* name = sa_plugin_action_get_name();
-  const char* xml = sa_plugin_action_get_xml();
+  sa_property_store_immutable_t* attributes = sa_plugin_action_get_attributes();
   sa_property_store_t* store = sa_plugin_action_get_property_store();
 
   sa_property_store_immutable_t store_immutable = sa_property_store_to_immutable(store);
@@ -527,7 +527,7 @@ sa_error_t strfind_event_create(sa_action_event_t evnt)
   sa_logging_print_format(SA_LOG_LEVEL_INFO, PLUGIN_NAME_IDENTIFIER, "Creating action '%s'.", name);
 
   sa_xml_attr_list_init(attrs, count);
-  sa_error_t result = sa_xml_parse_attr_list_store(xml, attrs, count, store);
+  sa_error_t result = sa_xml_copy_attr_list_store(attributes, attrs, count, store);
   if (result != SA_ERROR_SUCCESS)
     return result;
 
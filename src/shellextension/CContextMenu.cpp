@@ -382,8 +382,10 @@ HRESULT STDMETHODCALLTYPE CContextMenu::QueryContextMenu(HMENU hMenu, UINT menu_
   //Assign unique command id to visible menus. Issue #5
   UINT next_command_id = cmgr.AssignCommandIds(first_command_id);
 
-  //Build the menus
+  //Build the menus. The state of the menus must not be updated by other threads while the menus are built.
+  cmgr.BeginRead();
   BuildMenuTree(hMenu);
+  cmgr.EndRead();
 
   //Log information about menu statistics.
   UINT menu_last_command_id = (UINT)-1; //confirmed last command id
@@ -35,6 +35,7 @@
 
 #include "LoggerGlog.h"
 #include "RegistryService.h"
+#include "PollingDirectoryWatchService.h"
 
 #include "rapidassist/undef_windows_macros.h"
 #include "rapidassist/strings.h"
@@ -371,6 +372,10 @@ extern "C" int APIENTRY DllMain(HINSTANCE hInstance, DWORD dwReason, LPVOID lpRe
       shellanything::IRegistryService* registry = new shellanything::RegistryService();
       app.SetRegistry(registry);
 
+      // Setup a directory watch service to detect modified configuration files.
+      shellanything::IDirectoryWatchService* watch_service = new shellanything::PollingDirectoryWatchService();
+      app.SetDirectoryWatchService(watch_service);
+
       // Setup and starting application
       app.Start();
 
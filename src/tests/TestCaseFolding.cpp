@@ -0,0 +1,246 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestCaseFolding.h"
+#include "CaseFolding.h"
+#include "Wildcard.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    const std::string school_lower = "\xC3\xA9" "cole";         //school in french, encoded in UTF-8
+    const std::string school_upper = "\xC3\x89" "COLE";
+    const std::string russian_lower = "\xD0\xBC\xD0\xB8\xD1\x80";  //world in russian, encoded in UTF-8
+    const std::string russian_upper = "\xD0\x9C\xD0\x98\xD0\xA0";
+    const std::string greek_lower = "\xCE\xB1\xCE\xB2\xCE\xB3";    //alpha beta gamma, encoded in UTF-8
+    const std::string greek_upper = "\xCE\x91\xCE\x92\xCE\x93";
+
+    //--------------------------------------------------------------------------------------------------
+    void TestCaseFolding::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestCaseFolding::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testFoldCaseCodePoint)
+    {
+      ASSERT_EQ('A', FoldCaseAscii('a'));
+      ASSERT_EQ('Z', FoldCaseAscii('z'));
+      ASSERT_EQ('A', FoldCaseAscii('A'));
+      ASSERT_EQ('@', FoldCaseAscii('@'));
+      ASSERT_EQ('{', FoldCaseAscii('{'));
+
+      ASSERT_EQ((uint32_t)'A', FoldCaseCodePoint('a'));
+      ASSERT_EQ(0xC9u, FoldCaseCodePoint(0xE9)); // e acute
+      ASSERT_EQ(0xC9u, FoldCaseCodePoint(0xC9));
+      ASSERT_EQ(0xF7u, FoldCaseCodePoint(0xF7)); // division sign
+      ASSERT_EQ(0xDFu, FoldCaseCodePoint(0xDF)); // sharp s
+      ASSERT_EQ(0x178u, FoldCaseCodePoint(0xFF)); // y with diaeresis
+      ASSERT_EQ(0x100u, FoldCaseCodePoint(0x101)); // a with macron
+      ASSERT_EQ(0x139u, FoldCaseCodePoint(0x13A)); // l with acute
+      ASSERT_EQ(0x131u, FoldCaseCodePoint(0x131)); // dotless i
+      ASSERT_EQ(0x391u, FoldCaseCodePoint(0x3B1)); // alpha
+      ASSERT_EQ(0x3A3u, FoldCaseCodePoint(0x3C2)); // final sigma
+      ASSERT_EQ(0x3A3u, FoldCaseCodePoint(0x3C3)); // sigma
+      ASSERT_EQ(0x38Fu, FoldCaseCodePoint(0x3CE)); // omega with tonos
+      ASSERT_EQ(0x410u, FoldCaseCodePoint(0x430)); // cyrillic a
+      ASSERT_EQ(0x400u, FoldCaseCodePoint(0x450)); // cyrillic ie with grave
+      ASSERT_EQ(0x4E2Du, FoldCaseCodePoint(0x4E2D)); // no case
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testMatchCharacterCaseInsensitive)
+    {
+      ASSERT_EQ(1, MatchCharacterCaseInsensitive("a", "A", 1));
+      ASSERT_EQ(1, MatchCharacterCaseInsensitive("1", "1", 1));
+      ASSERT_EQ(0, MatchCharacterCaseInsensitive("a", "b", 1));
+      ASSERT_EQ(0, MatchCharacterCaseInsensitive("a", "A", 0));
+      ASSERT_EQ(2, MatchCharacterCaseInsensitive(school_lower.c_str(), school_upper.c_str(), school_lower.size()));
+      ASSERT_EQ(0, MatchCharacterCaseInsensitive(school_lower.c_str(), "E", school_lower.size()));
+      ASSERT_EQ(2, MatchCharacterCaseInsensitive(russian_lower.c_str(), russian_upper.c_str(), russian_lower.size()));
+
+      // Incomplete or invalid sequences are compared byte per byte
+      ASSERT_EQ(1, MatchCharacterCaseInsensitive(school_lower.c_str(), school_lower.c_str(), 1));
+      ASSERT_EQ(0, MatchCharacterCaseInsensitive("\xC3\xBF", "\xC5\xB8", 1));
+      ASSERT_EQ(2, MatchCharacterCaseInsensitive("\xC3\xBF", "\xC5\xB8", 2)); // y with diaeresis
+      ASSERT_EQ(1, MatchCharacterCaseInsensitive("\xC2\xC2", "\xC2\xC2", 2));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testEqualsCaseInsensitive)
+    {
+      ASSERT_TRUE(EqualsCaseInsensitive(std::string(""), ""));
+      ASSERT_TRUE(EqualsCaseInsensitive(std::string("true"), "TRUE"));
+      ASSERT_TRUE(EqualsCaseInsensitive(std::string("TrUe"), "tRuE"));
+      ASSERT_FALSE(EqualsCaseInsensitive(std::string("true"), "TRUE "));
+      ASSERT_FALSE(EqualsCaseInsensitive(std::string("true"), "FALSE"));
+      ASSERT_FALSE(EqualsCaseInsensitive(std::string("true"), NULL));
+      ASSERT_FALSE(EqualsCaseInsensitive(std::string("@"), "`"));
+      ASSERT_FALSE(EqualsCaseInsensitive(std::string("["), "{"));
+
+      ASSERT_TRUE(EqualsCaseInsensitive(school_lower, school_upper));
+      ASSERT_TRUE(EqualsCaseInsensitive(russian_lower, russian_upper));
+      ASSERT_TRUE(EqualsCaseInsensitive(greek_lower, greek_upper));
+      ASSERT_FALSE(EqualsCaseInsensitive(greek_lower, russian_upper));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testFoldCase)
+    {
+      ASSERT_EQ(std::string(""), FoldCase(""));
+      ASSERT_EQ(std::string("TRUE"), FoldCase("tRuE"));
+      ASSERT_EQ(std::string("@[`{"), FoldCase("@[`{"));
+      ASSERT_EQ(FoldCase(school_upper), FoldCase(school_lower));
+      ASSERT_EQ(FoldCase(russian_upper), FoldCase(russian_lower));
+      ASSERT_EQ(FoldCase(greek_upper), FoldCase(greek_lower));
+      ASSERT_NE(FoldCase(greek_upper), FoldCase(russian_lower));
+      ASSERT_EQ(std::string("\xC5\xB8"), FoldCase("\xC3\xBF")); // y with diaeresis
+      ASSERT_EQ(std::string("\xC2\xC2"), FoldCase("\xC2\xC2")); // invalid utf-8 sequence
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testEqualsCaseInsensitiveLongStrings)
+    {
+      // Long strings are compared 8 characters at a time.
+      const std::string lower = "c:\\program files\\shellanything\\configurations\\default.xml";
+      const std::string upper = ra::strings::Uppercase(lower);
+      ASSERT_TRUE(EqualsCaseInsensitive(lower, upper));
+      ASSERT_TRUE(EqualsCaseInsensitive(lower, lower));
+
+      // A single different character at any position
+      for (size_t i = 0; i < lower.size(); i++)
+      {
+        std::string other = upper;
+        other[i] = '#';
+        ASSERT_FALSE(EqualsCaseInsensitive(lower, other)) << "i=" << i;
+      }
+
+      // Non ASCII characters at any position
+      for (size_t i = 0; i < lower.size(); i++)
+      {
+        std::string a = lower;
+        std::string b = upper;
+        a.insert(i, school_lower);
+        b.insert(i, school_upper);
+        ASSERT_TRUE(EqualsCaseInsensitive(a, b)) << "i=" << i;
+
+        b = upper;
+        b.insert(i, school_lower);
+        b[b.size() - 1] = '#';
+        ASSERT_FALSE(EqualsCaseInsensitive(a, b)) << "i=" << i;
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testWildcardMatchCaseInsensitive)
+    {
+      ASSERT_TRUE(WildcardMatch("*.TXT", "c:\\temp\\file.txt", WILDCARD_CASE_INSENSITIVE));
+      ASSERT_FALSE(WildcardMatch("*.TXT", "c:\\temp\\file.txt", WILDCARD_NONE));
+      ASSERT_TRUE(WildcardMatch("C:\\TEMP\\F?LE.*", "c:\\temp\\file.txt", WILDCARD_CASE_INSENSITIVE));
+      ASSERT_FALSE(WildcardMatch("C:\\TEMP\\F?LE.*", "c:\\temp\\fle.txt", WILDCARD_CASE_INSENSITIVE));
+
+      std::string pattern = "*\\" + school_upper + "\\*";
+      std::string value = "c:\\" + school_lower + "\\foo.txt";
+      ASSERT_TRUE(WildcardMatch(pattern.c_str(), value.c_str(), WILDCARD_CASE_INSENSITIVE));
+      ASSERT_FALSE(WildcardMatch(pattern.c_str(), value.c_str(), WILDCARD_NONE));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testBenchmarkShortStrings)
+    {
+      // Typical usage of Validator::IsTrue()
+      static const size_t NUM_LOOPS = 1000000;
+      const std::string value = "Yes";
+      const char* candidates[] = { "TRUE", "YES", "OK", "ON" };
+      static const size_t num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+
+      size_t expected_matches = 0;
+      double uppercase_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        std::string upper_case_value = ra::strings::Uppercase(value);
+        for (size_t j = 0; j < num_candidates; j++)
+        {
+          if (upper_case_value == candidates[j])
+            expected_matches++;
+        }
+      }
+      double uppercase_time = ra::timing::GetMillisecondsTimer() - uppercase_start;
+
+      size_t actual_matches = 0;
+      double folding_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        for (size_t j = 0; j < num_candidates; j++)
+        {
+          if (EqualsCaseInsensitive(value, candidates[j]))
+            actual_matches++;
+        }
+      }
+      double folding_time = ra::timing::GetMillisecondsTimer() - folding_start;
+
+      printf("Comparing %d short strings:\n", (int)(NUM_LOOPS * num_candidates));
+      printf("  ra::strings::Uppercase() copies: %.3f ms\n", uppercase_time);
+      printf("  EqualsCaseInsensitive():         %.3f ms\n", folding_time);
+
+      ASSERT_EQ(expected_matches, actual_matches);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestCaseFolding, testBenchmarkPaths)
+    {
+      // Typical usage of Validator::ValidatePattern()
+      static const size_t NUM_LOOPS = 200000;
+      const std::string path = "C:\\Users\\JohnSmith\\Documents\\Projects\\ShellAnything\\Reports\\Report_2020.docx";
+      const std::string pattern = "*\\projects\\*\\REPORT_????.DOC*";
+
+      size_t expected_matches = 0;
+      double uppercase_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        std::string pattern_uppercase = ra::strings::Uppercase(pattern);
+        std::string path_uppercase = ra::strings::Uppercase(path);
+        if (WildcardMatch(pattern_uppercase.c_str(), path_uppercase.c_str()))
+          expected_matches++;
+      }
+      double uppercase_time = ra::timing::GetMillisecondsTimer() - uppercase_start;
+
+      size_t actual_matches = 0;
+      double folding_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        if (WildcardMatch(pattern.c_str(), path.c_str(), WILDCARD_CASE_INSENSITIVE))
+          actual_matches++;
+      }
+      double folding_time = ra::timing::GetMillisecondsTimer() - folding_start;
+
+      printf("Matching %d paths:\n", (int)NUM_LOOPS);
+      printf("  ra::strings::Uppercase() copies: %.3f ms\n", uppercase_time);
+      printf("  WILDCARD_CASE_INSENSITIVE:       %.3f ms\n", folding_time);
+
+      ASSERT_EQ(NUM_LOOPS, expected_matches);
+      ASSERT_EQ(expected_matches, actual_matches);
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
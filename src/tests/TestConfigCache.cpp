@@ -0,0 +1,462 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestConfigCache.h"
+#include "Workspace.h"
+#include "ConfigCache.h"
+#include "ConfigFile.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestConfigCache::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestConfigCache::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void AssertSameValidator(const Validator* expected, const Validator* actual)
+    {
+      ASSERT_EQ(expected->GetMaxFiles(), actual->GetMaxFiles());
+      ASSERT_EQ(expected->GetMaxDirectories(), actual->GetMaxDirectories());
+      ASSERT_EQ(expected->GetClass(), actual->GetClass());
+      ASSERT_EQ(expected->GetPattern(), actual->GetPattern());
+      ASSERT_EQ(expected->GetExprtk(), actual->GetExprtk());
+      ASSERT_EQ(expected->GetFileExtensions(), actual->GetFileExtensions());
+      ASSERT_EQ(expected->GetFileExists(), actual->GetFileExists());
+      ASSERT_EQ(expected->GetProperties(), actual->GetProperties());
+      ASSERT_EQ(expected->GetInserve(), actual->GetInserve());
+      ASSERT_EQ(expected->GetIsTrue(), actual->GetIsTrue());
+      ASSERT_EQ(expected->GetIsFalse(), actual->GetIsFalse());
+      ASSERT_EQ(expected->GetIsEmpty(), actual->GetIsEmpty());
+      ASSERT_EQ(expected->GetCustomAttributes().GetPropertyCount(), actual->GetCustomAttributes().GetPropertyCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    void AssertSameMenus(const Menu::MenuPtrList& expected, const Menu::MenuPtrList& actual)
+    {
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); i++)
+      {
+        const Menu* expected_menu = expected[i];
+        const Menu* actual_menu = actual[i];
+        ASSERT_EQ(expected_menu->GetName(), actual_menu->GetName());
+        ASSERT_EQ(expected_menu->GetDescription(), actual_menu->GetDescription());
+        ASSERT_EQ(expected_menu->IsSeparator(), actual_menu->IsSeparator());
+        ASSERT_EQ(expected_menu->IsColumnSeparator(), actual_menu->IsColumnSeparator());
+        ASSERT_EQ(expected_menu->GetNameMaxLength(), actual_menu->GetNameMaxLength());
+        ASSERT_EQ(expected_menu->GetIcon().GetPath(), actual_menu->GetIcon().GetPath());
+        ASSERT_EQ(expected_menu->GetIcon().GetFileExtension(), actual_menu->GetIcon().GetFileExtension());
+        ASSERT_EQ(expected_menu->GetIcon().GetIndex(), actual_menu->GetIcon().GetIndex());
+        ASSERT_EQ(expected_menu->GetActions().size(), actual_menu->GetActions().size());
+
+        ASSERT_EQ(expected_menu->GetValidityCount(), actual_menu->GetValidityCount());
+        for (size_t j = 0; j < expected_menu->GetValidityCount(); j++)
+        {
+          AssertSameValidator(expected_menu->GetValidity(j), actual_menu->GetValidity(j));
+        }
+        ASSERT_EQ(expected_menu->GetVisibilityCount(), actual_menu->GetVisibilityCount());
+        for (size_t j = 0; j < expected_menu->GetVisibilityCount(); j++)
+        {
+          AssertSameValidator(expected_menu->GetVisibility(j), actual_menu->GetVisibility(j));
+        }
+
+        AssertSameMenus(expected_menu->GetSubMenus(), actual_menu->GetSubMenus());
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testLoadFile)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportFileUtf8("configurations/default.xml"));
+      const std::string path = workspace.GetFullPathUtf8("default.xml");
+
+      ConfigCache cache;
+      cache.SetDirectory(workspace.GetFullPathUtf8("cache"));
+
+      //the first load parses the xml file and compiles it
+      std::string error;
+      ConfigFile* parsed = cache.LoadFile(path, error);
+      ASSERT_TRUE(parsed != NULL) << "error=" << error;
+      ASSERT_EQ(0, cache.GetHitCount());
+      ASSERT_EQ(1, cache.GetMissCount());
+      ASSERT_TRUE(ra::filesystem::FileExistsUtf8(cache.GetCacheFilePath(path).c_str()));
+
+      //the next load reads the compiled file
+      ConfigFile* compiled = cache.LoadFile(path, error);
+      ASSERT_TRUE(compiled != NULL) << "error=" << error;
+      ASSERT_EQ(1, cache.GetHitCount());
+      ASSERT_EQ(1, cache.GetMissCount());
+
+      ASSERT_EQ(parsed->GetFilePath(), compiled->GetFilePath());
+      ASSERT_EQ(parsed->GetFileModifiedDate(), compiled->GetFileModifiedDate());
+      ASSERT_EQ(parsed->GetDefaultSettings() == NULL, compiled->GetDefaultSettings() == NULL);
+      AssertSameMenus(parsed->GetMenus(), compiled->GetMenus());
+
+      delete parsed;
+      delete compiled;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testFileModifications)
+    {
+      static const std::string XML_BEFORE = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"before\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+      static const std::string XML_AFTER = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"after\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      const std::string path = workspace.GetFullPathUtf8("tmp.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, XML_BEFORE));
+
+      ConfigCache cache;
+      cache.SetDirectory(workspace.GetFullPathUtf8("cache"));
+
+      std::string error;
+      ConfigFile* config = cache.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(std::string("before"), config->GetMenus()[0]->GetName());
+      delete config;
+
+      //Wait to make sure that the next file modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //a modified file is parsed again
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, XML_AFTER));
+      config = cache.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(std::string("after"), config->GetMenus()[0]->GetName());
+      ASSERT_EQ(0, cache.GetHitCount());
+      ASSERT_EQ(2, cache.GetMissCount());
+      delete config;
+
+      //and the new content is compiled
+      config = cache.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(std::string("after"), config->GetMenus()[0]->GetName());
+      ASSERT_EQ(1, cache.GetHitCount());
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testCorruptedFile)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportFileUtf8("configurations/default.xml"));
+      const std::string path = workspace.GetFullPathUtf8("default.xml");
+
+      ConfigCache cache;
+      cache.SetDirectory(workspace.GetFullPathUtf8("cache"));
+
+      std::string error;
+      ConfigFile* config = cache.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      size_t menu_count = config->GetMenus().size();
+      delete config;
+
+      //truncate the compiled file
+      const std::string cache_path = cache.GetCacheFilePath(path);
+      std::string data;
+      ASSERT_TRUE(ra::filesystem::ReadFileUtf8(cache_path, data));
+      ASSERT_TRUE(ra::filesystem::WriteFileUtf8(cache_path, data.substr(0, data.size() / 2)));
+
+      //the xml file is parsed again
+      config = cache.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(menu_count, config->GetMenus().size());
+      ASSERT_EQ(0, cache.GetHitCount());
+      ASSERT_EQ(2, cache.GetMissCount());
+      delete config;
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testLoadTime)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportDirectoryUtf8("configurations"));
+
+      //find all the sample configurations
+      ra::strings::StringVector files;
+      ASSERT_TRUE(ra::filesystem::FindFilesUtf8(files, workspace.GetBaseDirectory().c_str()));
+      StringList paths;
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        if (ConfigFile::IsValidConfigFile(files[i]))
+          paths.push_back(files[i]);
+      }
+      ASSERT_FALSE(paths.empty());
+
+      ConfigCache cache;
+      cache.SetDirectory(workspace.GetFullPathUtf8("cache"));
+
+      static const size_t NUM_LOADS = 10;
+      printf("Loading %d configuration files %d times:\n", (int)paths.size(), (int)NUM_LOADS);
+
+      //parse all configurations from xml
+      double start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < paths.size(); j++)
+        {
+          std::string error;
+          ConfigFile* config = ConfigFile::LoadFile(paths[j], error);
+          ASSERT_TRUE(config != NULL) << "path=" << paths[j] << ", error=" << error;
+          delete config;
+        }
+      }
+      double elapsed = ra::timing::GetMillisecondsTimer() - start;
+      printf("  from xml:           %.3f ms\n", elapsed);
+
+      //compile all configurations
+      for (size_t j = 0; j < paths.size(); j++)
+      {
+        std::string error;
+        ConfigFile* config = cache.LoadFile(paths[j], error);
+        ASSERT_TRUE(config != NULL) << "path=" << paths[j] << ", error=" << error;
+        delete config;
+      }
+
+      //load all configurations from their compiled file
+      start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < paths.size(); j++)
+        {
+          std::string error;
+          ConfigFile* config = cache.LoadFile(paths[j], error);
+          ASSERT_TRUE(config != NULL) << "path=" << paths[j] << ", error=" << error;
+          delete config;
+        }
+      }
+      elapsed = ra::timing::GetMillisecondsTimer() - start;
+      printf("  from compiled file: %.3f ms\n", elapsed);
+
+      ASSERT_EQ(paths.size(), cache.GetMissCount());
+      ASSERT_EQ(paths.size() * NUM_LOADS, cache.GetHitCount());
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testSharedMemory)
+    {
+      static const std::string XML_BEFORE = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"before\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+      static const std::string XML_AFTER = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"after\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      const std::string path = workspace.GetFullPathUtf8("tmp.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, XML_BEFORE));
+
+      //each cache plays the role of a different process
+      ConfigCache first;
+      ConfigCache second;
+      first.SetSharedMemoryName("ShellAnything.TestConfigCache");
+      second.SetSharedMemoryName("ShellAnything.TestConfigCache");
+      ASSERT_FALSE(first.GetSharedMemoryName(path).empty());
+      ASSERT_EQ(first.GetSharedMemoryName(path), second.GetSharedMemoryName(path));
+      first.RemoveSharedMemory(path);
+
+      //the first process parses the xml file and publishes the compiled configuration
+      std::string error;
+      ConfigFile* parsed = first.LoadFile(path, error);
+      ASSERT_TRUE(parsed != NULL) << "error=" << error;
+      ASSERT_EQ(0, first.GetSharedHitCount());
+      ASSERT_EQ(1, first.GetMissCount());
+
+      //the second process reads the configuration from shared memory
+      ConfigFile* shared = second.LoadFile(path, error);
+      ASSERT_TRUE(shared != NULL) << "error=" << error;
+      ASSERT_EQ(1, second.GetSharedHitCount());
+      ASSERT_EQ(0, second.GetMissCount());
+      ASSERT_EQ(parsed->GetFilePath(), shared->GetFilePath());
+      ASSERT_EQ(parsed->GetFileModifiedDate(), shared->GetFileModifiedDate());
+      AssertSameMenus(parsed->GetMenus(), shared->GetMenus());
+      delete parsed;
+      delete shared;
+
+      //Wait to make sure that the next file modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //a modified file is parsed again and published under a new generation
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, XML_AFTER));
+      ConfigFile* config = second.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(std::string("after"), config->GetMenus()[0]->GetName());
+      ASSERT_EQ(1, second.GetMissCount());
+      delete config;
+
+      //the first process reads the new generation
+      config = first.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(std::string("after"), config->GetMenus()[0]->GetName());
+      ASSERT_EQ(1, first.GetSharedHitCount());
+      ASSERT_EQ(1, first.GetMissCount());
+      delete config;
+
+      //Cleanup
+      first.RemoveSharedMemory(path);
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testSharedMemoryCleanup)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportFileUtf8("configurations/default.xml"));
+      const std::string path = workspace.GetFullPathUtf8("default.xml");
+      std::string error;
+
+      {
+        //the first process publishes the configuration
+        ConfigCache first;
+        first.SetSharedMemoryName("ShellAnything.TestConfigCache");
+        first.RemoveSharedMemory(path);
+        ConfigFile* parsed = first.LoadFile(path, error);
+        ASSERT_TRUE(parsed != NULL) << "error=" << error;
+        delete parsed;
+
+        //a process which unloads the configuration unmaps its segments
+        ConfigCache second;
+        second.SetSharedMemoryName("ShellAnything.TestConfigCache");
+        ConfigFile* shared = second.LoadFile(path, error);
+        ASSERT_TRUE(shared != NULL) << "error=" << error;
+        ASSERT_EQ(1, second.GetSharedHitCount());
+        delete shared;
+        second.ReleaseSharedMemory(path);
+
+        //the segments are still available while the first process maps them
+        shared = second.LoadFile(path, error);
+        ASSERT_TRUE(shared != NULL) << "error=" << error;
+        ASSERT_EQ(2, second.GetSharedHitCount());
+        delete shared;
+      }
+
+      //the segments published by a process are released with its cache
+      ConfigCache third;
+      third.SetSharedMemoryName("ShellAnything.TestConfigCache");
+      ConfigFile* config = third.LoadFile(path, error);
+      ASSERT_TRUE(config != NULL) << "error=" << error;
+      ASSERT_EQ(0, third.GetSharedHitCount());
+      ASSERT_EQ(1, third.GetMissCount());
+      delete config;
+
+      //Cleanup
+      third.RemoveSharedMemory(path);
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigCache, testSharedMemoryWithDirectory)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportFileUtf8("configurations/default.xml"));
+      const std::string path = workspace.GetFullPathUtf8("default.xml");
+
+      //compile the configuration without shared memory
+      ConfigCache first;
+      first.SetDirectory(workspace.GetFullPathUtf8("cache"));
+      std::string error;
+      ConfigFile* parsed = first.LoadFile(path, error);
+      ASSERT_TRUE(parsed != NULL) << "error=" << error;
+
+      //a process which reads the compiled file publishes it in shared memory
+      ConfigCache second;
+      second.SetDirectory(workspace.GetFullPathUtf8("cache"));
+      second.SetSharedMemoryName("ShellAnything.TestConfigCache");
+      second.RemoveSharedMemory(path);
+      ConfigFile* compiled = second.LoadFile(path, error);
+      ASSERT_TRUE(compiled != NULL) << "error=" << error;
+      ASSERT_EQ(1, second.GetHitCount());
+      ASSERT_EQ(0, second.GetSharedHitCount());
+
+      //the following processes read the configuration from shared memory
+      ConfigCache third;
+      third.SetDirectory(workspace.GetFullPathUtf8("cache"));
+      third.SetSharedMemoryName("ShellAnything.TestConfigCache");
+      ConfigFile* shared = third.LoadFile(path, error);
+      ASSERT_TRUE(shared != NULL) << "error=" << error;
+      ASSERT_EQ(0, third.GetHitCount());
+      ASSERT_EQ(1, third.GetSharedHitCount());
+      ASSERT_EQ(0, third.GetMissCount());
+      AssertSameMenus(parsed->GetMenus(), shared->GetMenus());
+
+      delete parsed;
+      delete compiled;
+      delete shared;
+
+      //Cleanup
+      second.RemoveSharedMemory(path);
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
@@ -26,13 +26,19 @@
 #include "Workspace.h"
 #include "QuickLoader.h"
 #include "ConfigManager.h"
+#include "App.h"
 #include "PropertyManager.h"
 #include "SelectionContext.h"
 
 #include "rapidassist/testing.h"
 #include "rapidassist/filesystem.h"
+#include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/environment.h"
 #include "rapidassist/timing.h"
+#include "rapidassist/strings.h"
+
+#include <thread>
+#include <atomic>
 
 namespace shellanything
 {
@@ -40,6 +46,37 @@ namespace shellanything
   {
     static const ConfigFile* INVALID_CONFIGURATION = NULL;
 
+    // A IDirectoryWatchService which reports the changes that are set by the test.
+    class FakeDirectoryWatchService : public virtual IDirectoryWatchService
+    {
+    public:
+      FakeDirectoryWatchService() : complete(true) {}
+      virtual ~FakeDirectoryWatchService() {}
+
+      virtual bool Watch(const std::string& path)
+      {
+        directories.push_back(path);
+        return true;
+      }
+
+      virtual void Clear()
+      {
+        directories.clear();
+        changes.clear();
+      }
+
+      virtual bool GetChanges(StringList& files)
+      {
+        files = changes;
+        changes.clear();
+        return complete;
+      }
+
+      StringList directories;
+      StringList changes;
+      bool complete;
+    };
+
     const char* ToBooleanString(bool value)
     {
       if (value)
@@ -47,6 +84,48 @@ namespace shellanything
       return "false";
     }
 
+    // Build a configuration file with parent_count top level menus. Each top level menu have children_count sub menus.
+    std::string BuildConfigurationFileWithMenus(size_t parent_count, size_t children_count)
+    {
+      std::string file;
+      file += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+      file += "<root>\n";
+      file += "  <shell>\n";
+      for (size_t i = 0; i < parent_count; i++)
+      {
+        file += "    <menu name=\"parent" + ra::strings::ToString(i) + "\">\n";
+        for (size_t j = 0; j < children_count; j++)
+        {
+          file += "      <menu name=\"child" + ra::strings::ToString(i) + "." + ra::strings::ToString(j) + "\" />\n";
+        }
+        file += "    </menu>\n";
+      }
+      file += "  </shell>\n";
+      file += "</root>\n";
+      return file;
+    }
+
+    // Build a configuration file with menu_count menus. Each menu is visible for a different file name pattern.
+    std::string BuildConfigurationFileWithPatterns(size_t menu_count)
+    {
+      std::string file;
+      file += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+      file += "<root>\n";
+      file += "  <shell>\n";
+      for (size_t i = 0; i < menu_count; i++)
+      {
+        std::string index = ra::strings::ToString(i);
+        std::string digit = ra::strings::ToString(i % 10);
+        file += "    <menu name=\"menu" + index + "\">\n";
+        file += "      <visibility pattern=\"*file" + digit + ".txt;*file" + digit + ".doc\" fileextensions=\"txt;doc\" />\n";
+        file += "      <visibility pattern=\"*folder" + digit + "\\*\" />\n";
+        file += "    </menu>\n";
+      }
+      file += "  </shell>\n";
+      file += "</root>\n";
+      return file;
+    }
+
     SelectionContext GetContextSingleFile()
     {
       SelectionContext c;
@@ -664,6 +743,584 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testFindMenuByCommandIdLookup)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_PARENTS = 100;
+      static const size_t NUM_CHILDREN = 49;
+      static const size_t NUM_MENUS = NUM_PARENTS * (1 + NUM_CHILDREN); // 5000 menus
+      static const uint32_t FIRST_COMMAND_ID = 101;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a large configuration file in the workspace
+      std::string path = workspace.GetFullPathUtf8("menus.xml");
+      std::string content = BuildConfigurationFileWithMenus(NUM_PARENTS, NUM_CHILDREN);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+
+      //ASSERT the file is loaded
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      ConfigFile* config = configs[0];
+      ASSERT_EQ(NUM_MENUS, config->GetMenuNodes().size());
+
+      //Assign unique command ids
+      uint32_t nextCommandId = cmgr.AssignCommandIds(FIRST_COMMAND_ID);
+      ASSERT_EQ(FIRST_COMMAND_ID + NUM_MENUS, nextCommandId);
+
+      //Assert out of range command ids
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(Menu::INVALID_COMMAND_ID));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(FIRST_COMMAND_ID - 1));
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(nextCommandId));
+
+      //Assert the lookup table matches the menus
+      for (uint32_t command_id = FIRST_COMMAND_ID; command_id < nextCommandId; command_id++)
+      {
+        Menu* menu = cmgr.FindMenuByCommandId(command_id);
+        ASSERT_TRUE(menu != NULL) << "Failed finding menu with command id " << command_id;
+        ASSERT_EQ(command_id, menu->GetCommandId());
+        ASSERT_EQ(config->FindMenuByCommandId(command_id), menu);
+      }
+
+      //Benchmark searching the menus against the lookup table
+      double search_start = ra::timing::GetMillisecondsTimer();
+      for (uint32_t command_id = FIRST_COMMAND_ID; command_id < nextCommandId; command_id++)
+      {
+        ASSERT_TRUE(config->FindMenuByCommandId(command_id) != NULL);
+      }
+      double search_time = ra::timing::GetMillisecondsTimer() - search_start;
+
+      double lookup_start = ra::timing::GetMillisecondsTimer();
+      for (uint32_t command_id = FIRST_COMMAND_ID; command_id < nextCommandId; command_id++)
+      {
+        ASSERT_TRUE(cmgr.FindMenuByCommandId(command_id) != NULL);
+      }
+      double lookup_time = ra::timing::GetMillisecondsTimer() - lookup_start;
+
+      printf("Finding %d menus by command id:\n", (int)NUM_MENUS);
+      printf("  searching menus:        %.3f ms\n", search_time);
+      printf("  lookup table:           %.3f ms\n", lookup_time);
+
+      //Refreshing the configurations must invalidate the lookup table
+      cmgr.Clear();
+      ASSERT_EQ((Menu*)NULL, cmgr.FindMenuByCommandId(FIRST_COMMAND_ID));
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testAssignCommandIdsWithReader)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_PARENTS = 10;
+      static const size_t NUM_CHILDREN = 4;
+      static const size_t NUM_MENUS = NUM_PARENTS * (1 + NUM_CHILDREN);
+      static const uint32_t FIRST_COMMAND_ID = 101;
+      static const uint32_t SECOND_COMMAND_ID = 1001;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate a configuration file in the workspace
+      std::string path = workspace.GetFullPathUtf8("menus.xml");
+      std::string content = BuildConfigurationFileWithMenus(NUM_PARENTS, NUM_CHILDREN);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+      ASSERT_EQ(FIRST_COMMAND_ID + NUM_MENUS, cmgr.AssignCommandIds(FIRST_COMMAND_ID));
+
+      //A reader holds the snapshot of the first command ids
+      ConfigSnapshotPtr snapshot = cmgr.GetSnapshot();
+      Menu* menu = snapshot->FindMenuByCommandId(FIRST_COMMAND_ID);
+      ASSERT_TRUE(menu != NULL);
+      ASSERT_EQ(FIRST_COMMAND_ID, menu->GetCommandId());
+      cmgr.BeginRead();
+
+      //Another thread assigns new command ids while the reader reads the menus
+      std::atomic<bool> assigned(false);
+      std::thread writer([&]()
+      {
+        cmgr.AssignCommandIds(SECOND_COMMAND_ID);
+        assigned = true;
+      });
+
+      //The command ids do not change until the end of the read scope
+      bool assigned_within_scope = false;
+      bool changed_within_scope = false;
+      for (size_t i = 0; i < 10; i++)
+      {
+        ra::timing::Millisleep(10);
+        if (assigned)
+          assigned_within_scope = true;
+        if (menu->GetCommandId() != FIRST_COMMAND_ID || cmgr.FindMenuByCommandId(FIRST_COMMAND_ID) != menu)
+          changed_within_scope = true;
+      }
+      cmgr.EndRead();
+      writer.join();
+      ASSERT_FALSE(assigned_within_scope);
+      ASSERT_FALSE(changed_within_scope);
+
+      //The new command ids are assigned once the read scope is ended
+      ASSERT_EQ(SECOND_COMMAND_ID, menu->GetCommandId());
+      ASSERT_EQ(menu, cmgr.FindMenuByCommandId(SECOND_COMMAND_ID));
+
+      //The previous snapshot keeps its own lookup table of command ids
+      ASSERT_EQ(menu, snapshot->FindMenuByCommandId(FIRST_COMMAND_ID));
+      ASSERT_EQ((Menu*)NULL, snapshot->FindMenuByCommandId(SECOND_COMMAND_ID));
+      snapshot.reset();
+
+      //Writers fail within a read scope of the same thread
+      cmgr.BeginRead();
+      ASSERT_EQ(FIRST_COMMAND_ID, cmgr.AssignCommandIds(FIRST_COMMAND_ID));
+      cmgr.EndRead();
+      ASSERT_EQ(SECOND_COMMAND_ID, menu->GetCommandId());
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testUpdateConcurrently)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_CONFIGS = 50;
+      static const size_t NUM_MENUS = 200;
+      static const size_t NUM_LOOPS = 20;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate the configuration files in the workspace
+      std::string content = BuildConfigurationFileWithPatterns(NUM_MENUS);
+      for (size_t i = 0; i < NUM_CONFIGS; i++)
+      {
+        std::string path = workspace.GetFullPathUtf8(("config" + ra::strings::ToString(i) + ".xml").c_str());
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      }
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(NUM_CONFIGS, configs.size());
+
+      //Each loop selects a different file. All menus depends on the selection and are evaluated again.
+      std::vector<SelectionContext> contexts;
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        SelectionContext context;
+        StringList elements;
+        elements.push_back("C:\\temp\\file" + ra::strings::ToString(i % 10) + ".txt");
+        context.SetElements(elements);
+        contexts.push_back(context);
+      }
+
+      //Get the expected results with a serial update
+      cmgr.SetUpdateThreadCount(1);
+      cmgr.Update(contexts[3]);
+      std::vector<bool> expected;
+      for (size_t i = 0; i < configs.size(); i++)
+      {
+        const ConfigFile::MenuNodeList& nodes = configs[i]->GetMenuNodes();
+        for (size_t j = 0; j < nodes.size(); j++)
+          expected.push_back(nodes[j].menu->IsVisible());
+      }
+      ASSERT_EQ(NUM_CONFIGS * NUM_MENUS, expected.size());
+      ASSERT_TRUE(expected[3]);
+      ASSERT_FALSE(expected[4]);
+
+      //Benchmark with an increasing number of threads
+      size_t max_threads = std::thread::hardware_concurrency();
+      if (max_threads < 1)
+        max_threads = 1;
+      printf("Updating %d configurations of %d menus, %d times:\n", (int)NUM_CONFIGS, (int)NUM_MENUS, (int)NUM_LOOPS);
+      for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+      {
+        cmgr.SetUpdateThreadCount(thread_count);
+
+        double start = ra::timing::GetMillisecondsTimer();
+        for (size_t i = 0; i < NUM_LOOPS; i++)
+        {
+          cmgr.Update(contexts[i]);
+        }
+        double elapsed = ra::timing::GetMillisecondsTimer() - start;
+        printf("  %2d thread(s):           %.3f ms\n", (int)thread_count, elapsed);
+
+        //all menus were evaluated by the last update
+        ASSERT_EQ(NUM_CONFIGS * NUM_MENUS, cmgr.GetEvaluatedMenuCount());
+
+        //assert the results matches the serial update
+        cmgr.Update(contexts[3]);
+        size_t offset = 0;
+        for (size_t i = 0; i < configs.size(); i++)
+        {
+          const ConfigFile::MenuNodeList& nodes = configs[i]->GetMenuNodes();
+          for (size_t j = 0; j < nodes.size(); j++)
+          {
+            ASSERT_EQ(expected[offset], nodes[j].menu->IsVisible()) << "thread_count=" << thread_count << " config=" << i << " menu=" << j;
+            offset++;
+          }
+        }
+      }
+      cmgr.SetUpdateThreadCount(1);
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testLoadConcurrently)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_CONFIGS = 50;
+      static const size_t NUM_MENUS = 200;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate the configuration files in the workspace
+      std::string content = BuildConfigurationFileWithPatterns(NUM_MENUS);
+      for (size_t i = 0; i < NUM_CONFIGS; i++)
+      {
+        std::string path = workspace.GetFullPathUtf8(("config" + ra::strings::ToString(i) + ".xml").c_str());
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      }
+
+      //Get the expected order with a serial load
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.SetLoadThreadCount(1);
+      cmgr.Refresh();
+      StringList expected;
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      for (size_t i = 0; i < configs.size(); i++)
+      {
+        expected.push_back(configs[i]->GetFilePath());
+      }
+      ASSERT_EQ(NUM_CONFIGS, expected.size());
+
+      //Benchmark with an increasing number of threads
+      size_t max_threads = std::thread::hardware_concurrency();
+      if (max_threads < 1)
+        max_threads = 1;
+      printf("Loading %d configurations of %d menus:\n", (int)NUM_CONFIGS, (int)NUM_MENUS);
+      for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+      {
+        cmgr.Clear();
+        cmgr.AddSearchPath(workspace.GetBaseDirectory());
+        cmgr.SetLoadThreadCount(thread_count);
+
+        double start = ra::timing::GetMillisecondsTimer();
+        cmgr.Refresh();
+        double elapsed = ra::timing::GetMillisecondsTimer() - start;
+        printf("  %2d thread(s):           %.3f ms\n", (int)thread_count, elapsed);
+
+        //assert the configurations are in the same order as a serial load
+        configs = cmgr.GetConfigFiles();
+        ASSERT_EQ(expected.size(), configs.size()) << "thread_count=" << thread_count;
+        for (size_t i = 0; i < configs.size(); i++)
+        {
+          ASSERT_EQ(expected[i], configs[i]->GetFilePath()) << "thread_count=" << thread_count << " config=" << i;
+          ASSERT_EQ(NUM_MENUS, configs[i]->GetMenus().size()) << "thread_count=" << thread_count << " config=" << i;
+        }
+      }
+      cmgr.SetLoadThreadCount(1);
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testDirectoryWatchService)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      App& app = App::GetInstance();
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      std::string content = BuildConfigurationFileWithMenus(1, 1);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("a.xml"), content));
+
+      FakeDirectoryWatchService service;
+      app.SetDirectoryWatchService(&service);
+
+      //ASSERT the first refresh searches the directory and starts watching it
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ConfigFile::ConfigFilePtrList configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      ASSERT_EQ(1, service.directories.size());
+      ASSERT_EQ(workspace.GetBaseDirectory(), service.directories[0]);
+      const std::string path_a = configs[0]->GetFilePath();
+
+      //ASSERT a refresh without changes does not look at the files
+      ASSERT_TRUE(ra::filesystem::DeleteFile(path_a.c_str()));
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      //ASSERT a reported deleted file is unloaded
+      service.changes.push_back(path_a);
+      cmgr.Refresh();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+
+      //ASSERT a reported new file is loaded
+      const std::string path_b = workspace.GetFullPathUtf8("b.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path_b, content));
+      service.changes.push_back(path_b);
+      cmgr.Refresh();
+      configs = cmgr.GetConfigFiles();
+      ASSERT_EQ(1, configs.size());
+      ASSERT_EQ(path_b, configs[0]->GetFilePath());
+
+      //ASSERT the directory is searched again if changes were missed
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(workspace.GetFullPathUtf8("c.xml"), content));
+      service.complete = false;
+      cmgr.Refresh();
+      ASSERT_EQ(2, cmgr.GetConfigFiles().size());
+
+      //Cleanup
+      app.SetDirectoryWatchService(NULL);
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testSnapshot)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_CONFIGS = 5;
+      static const size_t NUM_MENUS = 20;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate the configuration files in the workspace
+      std::string content = BuildConfigurationFileWithPatterns(NUM_MENUS);
+      for (size_t i = 0; i < NUM_CONFIGS; i++)
+      {
+        std::string path = workspace.GetFullPathUtf8(("config" + ra::strings::ToString(i) + ".xml").c_str());
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      }
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(NUM_CONFIGS, cmgr.GetConfigFiles().size());
+
+      //Pin the current snapshot
+      ConfigSnapshotPtr snapshot = cmgr.GetSnapshot();
+      ASSERT_TRUE(snapshot.get() != NULL);
+      ASSERT_EQ(NUM_CONFIGS, snapshot->GetConfigFiles().size());
+
+      //A refresh without changes does not publish a new snapshot
+      cmgr.Refresh();
+      ASSERT_EQ(snapshot.get(), cmgr.GetSnapshot().get());
+
+      //Delete a file. The manager publishes a new snapshot without the configuration.
+      const std::string deleted_path = workspace.GetFullPathUtf8("config0.xml");
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(deleted_path.c_str()));
+      cmgr.Refresh();
+      ASSERT_NE(snapshot.get(), cmgr.GetSnapshot().get());
+      ASSERT_EQ(NUM_CONFIGS - 1, cmgr.GetConfigFiles().size());
+      ASSERT_FALSE(cmgr.IsConfigFileLoaded(deleted_path));
+
+      //The pinned snapshot is unchanged and its configurations are still valid
+      ASSERT_EQ(NUM_CONFIGS, snapshot->GetConfigFiles().size());
+      ASSERT_TRUE(snapshot->IsConfigFileLoaded(deleted_path));
+      for (size_t i = 0; i < snapshot->GetConfigFiles().size(); i++)
+      {
+        const ConfigFile* config = snapshot->GetConfigFiles()[i];
+        ASSERT_EQ(NUM_MENUS, config->GetMenus().size());
+      }
+      Menu* menu = snapshot->FindMenuByName("menu3");
+      ASSERT_TRUE(menu != NULL);
+
+      //Clearing the manager does not release the pinned configurations
+      cmgr.Clear();
+      ASSERT_EQ(0, cmgr.GetConfigFiles().size());
+      ASSERT_EQ(NUM_CONFIGS, snapshot->GetConfigFiles().size());
+      ASSERT_EQ(std::string("menu3"), menu->GetName());
+      snapshot.reset();
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testRefreshReloadsModifiedMenus)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_MENUS = 20;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      std::string content = BuildConfigurationFileWithPatterns(NUM_MENUS);
+      const std::string path = workspace.GetFullPathUtf8("config.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      //Wait to make sure that the next file modification will not have the same timestamp
+      ra::timing::Millisleep(1500);
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+
+      //Pin the current snapshot
+      ConfigSnapshotPtr snapshot = cmgr.GetSnapshot();
+      ConfigFile* old_config = snapshot->GetConfigFiles()[0];
+      const Menu::MenuPtrList old_menus = old_config->GetMenus();
+      ASSERT_EQ(NUM_MENUS, old_menus.size());
+
+      //Modify a single menu
+      ra::strings::Replace(content, "name=\"menu3\"", "name=\"modified3\"");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      cmgr.Refresh();
+
+      //ASSERT only the modified menu is parsed again
+      ASSERT_EQ(1, cmgr.GetConfigFiles().size());
+      ConfigFile* new_config = cmgr.GetConfigFiles()[0];
+      ASSERT_NE(old_config, new_config);
+      ASSERT_EQ(1, new_config->GetReplacedMenuCount());
+      const Menu::MenuPtrList& new_menus = new_config->GetMenus();
+      ASSERT_EQ(NUM_MENUS, new_menus.size());
+      for (size_t i = 0; i < new_menus.size(); i++)
+      {
+        if (i == 3)
+          ASSERT_NE(old_menus[i], new_menus[i]);
+        else
+          ASSERT_EQ(old_menus[i], new_menus[i]);
+      }
+      ASSERT_TRUE(cmgr.FindMenuByName("modified3") != NULL);
+      ASSERT_TRUE(cmgr.FindMenuByName("menu3") == NULL);
+
+      //The pinned snapshot still reads the previous configuration
+      ASSERT_EQ(old_config, snapshot->GetConfigFiles()[0]);
+      ASSERT_TRUE(old_menus == old_config->GetMenus());
+      ASSERT_EQ(std::string("menu3"), old_config->GetMenus()[3]->GetName());
+      ASSERT_EQ(old_menus[3], snapshot->FindMenuByName("menu3"));
+
+      //The unchanged menus outlive the previous configuration
+      snapshot.reset();
+      ASSERT_EQ(std::string("menu4"), new_menus[4]->GetName());
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfigManager, testSnapshotConcurrentReaders)
+    {
+      ConfigManager& cmgr = ConfigManager::GetInstance();
+      static const size_t NUM_CONFIGS = 10;
+      static const size_t NUM_MENUS = 50;
+      static const size_t NUM_READERS = 4;
+      static const size_t NUM_REFRESH = 50;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.IsEmpty());
+
+      //Generate the configuration files in the workspace
+      std::string content = BuildConfigurationFileWithPatterns(NUM_MENUS);
+      for (size_t i = 0; i < NUM_CONFIGS; i++)
+      {
+        std::string path = workspace.GetFullPathUtf8(("config" + ra::strings::ToString(i) + ".xml").c_str());
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      }
+
+      //Setup ConfigManager to read files from workspace
+      cmgr.ClearSearchPath();
+      cmgr.AddSearchPath(workspace.GetBaseDirectory());
+      cmgr.Refresh();
+      ASSERT_EQ(NUM_CONFIGS, cmgr.GetConfigFiles().size());
+
+      //Readers query the configurations while the configurations are refreshed
+      std::atomic<bool> done(false);
+      std::atomic<size_t> errors(0);
+      std::atomic<size_t> reads(0);
+      std::vector<std::thread> readers;
+      for (size_t i = 0; i < NUM_READERS; i++)
+      {
+        readers.push_back(std::thread([&]()
+        {
+          while (!done)
+          {
+            //a file is either loaded or not
+            const ConfigFile::ConfigFilePtrList& configs = cmgr.GetConfigFiles();
+            if (configs.size() != NUM_CONFIGS && configs.size() != NUM_CONFIGS - 1)
+              errors++;
+            for (size_t j = 0; j < configs.size(); j++)
+            {
+              if (configs[j]->GetMenus().size() != NUM_MENUS)
+                errors++;
+            }
+
+            //the name indexes are searched by all readers at the same time
+            if (cmgr.FindMenuByName("menu3") == NULL)
+              errors++;
+            if (cmgr.FindMenuByName("menu3", FIND_BY_NAME_EXPANDS) == NULL)
+              errors++;
+            reads++;
+          }
+        }));
+      }
+
+      //Delete and restore a file
+      const std::string path = workspace.GetFullPathUtf8("config0.xml");
+      for (size_t i = 0; i < NUM_REFRESH; i++)
+      {
+        ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(path.c_str()));
+        cmgr.Refresh();
+        ASSERT_EQ(NUM_CONFIGS - 1, cmgr.GetConfigFiles().size());
+
+        ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+        cmgr.Refresh();
+        ASSERT_EQ(NUM_CONFIGS, cmgr.GetConfigFiles().size());
+      }
+
+      done = true;
+      for (size_t i = 0; i < readers.size(); i++)
+      {
+        readers[i].join();
+      }
+      ASSERT_EQ(0, errors);
+      ASSERT_GT(reads, 0);
+
+      //Cleanup
+      cmgr.Clear();
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
@@ -28,10 +28,21 @@
 #include "ConfigFile.h"
 #include "Menu.h"
 #include "ActionExecute.h"
+#include "Validator.h"
+#include "SelectionContext.h"
 
 #include "rapidassist/filesystem_utf8.h"
 #include "rapidassist/testing.h"
 #include "rapidassist/timing.h"
+#include "rapidassist/strings.h"
+
+#include <atomic>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
 
 #include "PropertyManager.h"
 
@@ -53,6 +64,50 @@ namespace shellanything
       return file;
     }
 
+    // Build a configuration file with menu_count menus. Each menu have a validator and an action.
+    std::string BuildConfigurationFileWithMenuCount(size_t menu_count)
+    {
+      std::string file;
+      file += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+      file += "<root>\n";
+      file += "  <shell>\n";
+      for (size_t i = 0; i < menu_count; i++)
+      {
+        std::string index = ra::strings::ToString(i);
+        file += "    <menu name=\"Menu " + index + "\" description=\"Open the selected file with the menu number " + index + " of the generated configuration.\">\n";
+        file += "      <icon path=\"C:\\Windows\\System32\\shell32.dll\" index=\"" + index + "\" />\n";
+        file += "      <visibility maxfiles=\"1\" maxfolders=\"0\" fileextensions=\"ext" + index + ";txt;xml;doc;docx\" properties=\"selection.path\" />\n";
+        file += "      <validity exists=\"${selection.path}\" pattern=\"*.ext" + index + "\" />\n";
+        file += "      <actions>\n";
+        file += "        <property name=\"menu.index\" value=\"" + index + "\" />\n";
+        file += "        <exec path=\"C:\\Windows\\notepad.exe\" arguments=\"&quot;${selection.path}&quot;\" basedir=\"${selection.dir}\" />\n";
+        file += "      </actions>\n";
+        file += "    </menu>\n";
+      }
+      file += "  </shell>\n";
+      file += "</root>\n";
+      return file;
+    }
+
+    // Get the peak memory usage of the process, in bytes. Returns 0 if not supported.
+    size_t GetPeakMemoryUsage()
+    {
+#ifdef _WIN32
+      PROCESS_MEMORY_COUNTERS counters = { 0 };
+      counters.cb = sizeof(counters);
+      if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+#endif
+      return 0;
+    }
+
+    Menu* NewConfigurationMenu(const std::string& name)
+    {
+      Menu* menu = new Menu();
+      menu->SetName(name);
+      return menu;
+    }
+
     //--------------------------------------------------------------------------------------------------
     void TestConfiguration::SetUp()
     {
@@ -266,6 +321,82 @@ namespace shellanything
 
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testLoadFileErrorLine)
+    {
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      //the third menu have an unknown action at line 13
+      std::string content;
+      content += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+      content += "<root>\n";
+      content += "  <shell>\n";
+      content += "    <menu name=\"first\" />\n";
+      content += "    <!-- a comment with a <menu> element -->\n";
+      content += "    <menu name=\"second\">\n";
+      content += "      <actions>\n";
+      content += "        <property name=\"foo\" value=\"bar\" />\n";
+      content += "      </actions>\n";
+      content += "    </menu>\n";
+      content += "    <menu name=\"third\">\n";
+      content += "      <actions>\n";
+      content += "        <unknown />\n";
+      content += "      </actions>\n";
+      content += "    </menu>\n";
+      content += "  </shell>\n";
+      content += "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      //ASSERT the error reports the line of the element in the file
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+      ASSERT_EQ(INVALID_CONFIGURATION, config);
+      ASSERT_NE(std::string::npos, error_message.find("at line 13")) << "error_message=" << error_message;
+
+      //ASSERT a malformed file is not loaded
+      ra::strings::Replace(content, "</actions>\n    </menu>\n  </shell>", "</actions>\n  </shell>");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      error_message.clear();
+      config = ConfigFile::LoadFile(path, error_message);
+      ASSERT_EQ(INVALID_CONFIGURATION, config);
+      ASSERT_FALSE(error_message.empty());
+
+      //cleanup
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testLoadFileLarge)
+    {
+      static const size_t NUM_MENUS = 100000;
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      std::string content = BuildConfigurationFileWithMenuCount(NUM_MENUS);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      const size_t file_size = content.size();
+      content.clear();
+
+      size_t peak_before = GetPeakMemoryUsage();
+      double start = ra::timing::GetMillisecondsTimer();
+
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+
+      double elapsed = ra::timing::GetMillisecondsTimer() - start;
+      size_t peak_after = GetPeakMemoryUsage();
+
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error_message=" << error_message;
+      ASSERT_EQ(NUM_MENUS, config->GetMenus().size());
+
+      printf("Loading a configuration of %d menus (%.1f MB):\n", (int)NUM_MENUS, file_size / (1024.0 * 1024.0));
+      printf("  load time:           %.3f ms\n", elapsed);
+      printf("  peak memory growth:  %.1f MB\n", (peak_after - peak_before) / (1024.0 * 1024.0));
+
+      //cleanup
+      delete config;
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestConfiguration, testLoadProperties)
     {
       ConfigManager& cmgr = ConfigManager::GetInstance();
@@ -308,6 +439,476 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testMenuNodes)
+    {
+      ConfigFile config;
+      Menu* menu1 = NewConfigurationMenu("1");
+      Menu* menu1_1 = NewConfigurationMenu("1.1");
+      Menu* menu1_2 = NewConfigurationMenu("1.2");
+      Menu* menu1_2_1 = NewConfigurationMenu("1.2.1");
+      Menu* menu2 = NewConfigurationMenu("2");
+
+      //build tree
+      config.AddMenu(menu1);
+      config.AddMenu(menu2);
+      menu1->AddMenu(menu1_1);
+      menu1->AddMenu(menu1_2);
+
+      //assert the menus are flattened in pre-order
+      const ConfigFile::MenuNodeList& nodes = config.GetMenuNodes();
+      ASSERT_EQ(4, nodes.size());
+      ASSERT_EQ(menu1, nodes[0].menu);
+      ASSERT_EQ(menu1_1, nodes[1].menu);
+      ASSERT_EQ(menu1_2, nodes[2].menu);
+      ASSERT_EQ(menu2, nodes[3].menu);
+
+      //assert the links between nodes
+      ASSERT_EQ(ConfigFile::INVALID_NODE_INDEX, nodes[0].parent);
+      ASSERT_EQ(1, nodes[0].first_child);
+      ASSERT_EQ(3, nodes[0].next_sibling);
+      ASSERT_EQ(0, nodes[1].parent);
+      ASSERT_EQ(2, nodes[1].next_sibling);
+      ASSERT_EQ(0, nodes[2].parent);
+      ASSERT_EQ(ConfigFile::INVALID_NODE_INDEX, nodes[2].next_sibling);
+      ASSERT_EQ(ConfigFile::INVALID_NODE_INDEX, nodes[3].first_child);
+      ASSERT_EQ(ConfigFile::INVALID_NODE_INDEX, nodes[3].next_sibling);
+
+      //adding a submenu to an existing menu must rebuild the nodes
+      menu1_2->AddMenu(menu1_2_1);
+      const ConfigFile::MenuNodeList& rebuilt = config.GetMenuNodes();
+      ASSERT_EQ(5, rebuilt.size());
+      ASSERT_EQ(menu1_2_1, rebuilt[3].menu);
+      ASSERT_EQ(2, rebuilt[3].parent);
+      ASSERT_EQ(3, rebuilt[2].first_child);
+      ASSERT_EQ(menu2, rebuilt[4].menu);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testMenuNodesUpdate)
+    {
+      ConfigFile config;
+      Menu* menu1 = NewConfigurationMenu("1");
+      Menu* menu1_1 = NewConfigurationMenu("1.1");
+      Menu* menu1_2 = NewConfigurationMenu("1.2");
+      Menu* menu2 = NewConfigurationMenu("2");
+      Menu* menu2_1 = NewConfigurationMenu("2.1");
+
+      //build tree
+      config.AddMenu(menu1);
+      config.AddMenu(menu2);
+      menu1->AddMenu(menu1_1);
+      menu1->AddMenu(menu1_2);
+      menu2->AddMenu(menu2_1);
+
+      //hide the only child of menu2 and one child of menu1
+      Validator* hidden1 = new Validator();
+      hidden1->SetProperties("test.menu.nodes.property.not.found");
+      menu1_2->AddVisibility(hidden1);
+      Validator* hidden2 = new Validator();
+      hidden2->SetProperties("test.menu.nodes.property.not.found");
+      menu2_1->AddVisibility(hidden2);
+
+      SelectionContext context;
+      config.Update(context);
+
+      //Issue #4 - a parent menu with all children invisible must also be invisible
+      ASSERT_TRUE(menu1->IsVisible());
+      ASSERT_TRUE(menu1_1->IsVisible());
+      ASSERT_FALSE(menu1_2->IsVisible());
+      ASSERT_FALSE(menu2->IsVisible());
+      ASSERT_FALSE(menu2_1->IsVisible());
+
+      //Issue #5 - invisible menus must not get a command id
+      uint32_t next_command_id = config.AssignCommandIds(101);
+      ASSERT_EQ(103, next_command_id);
+      ASSERT_EQ(101, menu1->GetCommandId());
+      ASSERT_EQ(102, menu1_1->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, menu1_2->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, menu2->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, menu2_1->GetCommandId());
+
+      //find by command id
+      ASSERT_EQ(menu1, config.FindMenuByCommandId(101));
+      ASSERT_EQ(menu1_1, config.FindMenuByCommandId(102));
+      ASSERT_EQ((Menu*)NULL, config.FindMenuByCommandId(103));
+
+      //the sub menus of an invisible menu must not get a command id
+      menu1->SetVisible(false);
+      next_command_id = config.AssignCommandIds(101);
+      ASSERT_EQ(101, next_command_id);
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, menu1->GetCommandId());
+      ASSERT_EQ(Menu::INVALID_COMMAND_ID, menu1_1->GetCommandId());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testFindMenuByName)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      ConfigFile config;
+      Menu* menu1 = NewConfigurationMenu("Lorem");
+      Menu* menu1_1 = NewConfigurationMenu("${test.find.menu.by.name}");
+      Menu* menu2 = NewConfigurationMenu("ipsum");
+      Menu* menu2_1 = NewConfigurationMenu("IPSUM");
+
+      //build tree
+      config.AddMenu(menu1);
+      config.AddMenu(menu2);
+      menu1->AddMenu(menu1_1);
+      menu2->AddMenu(menu2_1);
+
+      //exact names
+      ASSERT_EQ(menu1, config.FindMenuByName("Lorem"));
+      ASSERT_EQ(menu2_1, config.FindMenuByName("IPSUM"));
+      ASSERT_EQ((Menu*)NULL, config.FindMenuByName("lorem"));
+
+      //case insensitive names. the first menu in pre-order is returned.
+      ASSERT_EQ(menu1, config.FindMenuByName("LOREM", FIND_BY_NAME_CASE_INSENSITIVE));
+      ASSERT_EQ(menu2, config.FindMenuByName("IPSUM", FIND_BY_NAME_CASE_INSENSITIVE));
+
+      //renaming a menu updates the index
+      menu2->SetName("dolor");
+      ASSERT_EQ(menu2, config.FindMenuByName("dolor"));
+      ASSERT_EQ(menu2_1, config.FindMenuByName("ipsum", FIND_BY_NAME_CASE_INSENSITIVE));
+
+      //expanded names are refreshed when properties change
+      pmgr.SetProperty("test.find.menu.by.name", "sit");
+      ASSERT_EQ(menu1_1, config.FindMenuByName("sit", FIND_BY_NAME_EXPANDS));
+      ASSERT_EQ((Menu*)NULL, config.FindMenuByName("sit"));
+      pmgr.SetProperty("test.find.menu.by.name", "amet");
+      ASSERT_EQ((Menu*)NULL, config.FindMenuByName("sit", FIND_BY_NAME_EXPANDS));
+      ASSERT_EQ(menu1_1, config.FindMenuByName("AMET", FIND_BY_NAME_ALL));
+
+      pmgr.ClearProperty("test.find.menu.by.name");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testIncrementalUpdate)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("test.incremental.foo", "true");
+      pmgr.SetProperty("test.incremental.bar", "true");
+
+      ConfigFile config;
+      Menu* always = NewConfigurationMenu("always");
+      Menu* foo = NewConfigurationMenu("foo");
+      Menu* bar = NewConfigurationMenu("bar");
+      Menu* single = NewConfigurationMenu("single");
+
+      //build tree
+      config.AddMenu(always);
+      config.AddMenu(foo);
+      config.AddMenu(bar);
+      config.AddMenu(single);
+
+      Validator* foo_validator = new Validator();
+      foo_validator->SetIsTrue("${test.incremental.foo}");
+      foo->AddVisibility(foo_validator);
+      Validator* bar_validator = new Validator();
+      bar_validator->SetIsTrue("${test.incremental.bar}");
+      bar->AddVisibility(bar_validator);
+      Validator* single_validator = new Validator();
+      single_validator->SetMaxFiles(1);
+      single->AddVisibility(single_validator);
+
+      //the first update evaluates all menus
+      SelectionContext context;
+      config.Update(context);
+      ASSERT_EQ(4, config.GetEvaluatedMenuCount());
+      ASSERT_TRUE(foo->IsVisible());
+      ASSERT_TRUE(bar->IsVisible());
+
+      //nothing changed
+      config.Update(context);
+      ASSERT_EQ(0, config.GetEvaluatedMenuCount());
+      ASSERT_TRUE(foo->IsVisible());
+      ASSERT_TRUE(bar->IsVisible());
+
+      //only the menu that depends on the changed property is evaluated
+      pmgr.SetProperty("test.incremental.foo", "false");
+      config.Update(context);
+      ASSERT_EQ(1, config.GetEvaluatedMenuCount());
+      ASSERT_FALSE(foo->IsVisible());
+      ASSERT_TRUE(bar->IsVisible());
+
+      //only the menu that depends on the selection is evaluated
+      StringList elements;
+      elements.push_back("foo.txt");
+      elements.push_back("bar.txt");
+      context.SetElements(elements);
+      config.Update(context);
+      ASSERT_EQ(1, config.GetEvaluatedMenuCount());
+
+      //changing a validator invalidates its menu
+      bar_validator->SetIsTrue("${test.incremental.foo}");
+      config.Update(context);
+      ASSERT_EQ(1, config.GetEvaluatedMenuCount());
+      ASSERT_FALSE(bar->IsVisible());
+
+      pmgr.ClearProperty("test.incremental.foo");
+      pmgr.ClearProperty("test.incremental.bar");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testConcurrentUpdate)
+    {
+      static const size_t NUM_THREADS = 4;
+      static const size_t NUM_LOOPS = 200;
+
+      ConfigFile config;
+      Menu* single = NewConfigurationMenu("single");
+      Menu* pair = NewConfigurationMenu("pair");
+      config.AddMenu(single);
+      config.AddMenu(pair);
+
+      Validator* single_validator = new Validator();
+      single_validator->SetMaxDirectories(1);
+      single->AddVisibility(single_validator);
+      Validator* pair_validator = new Validator();
+      pair_validator->SetMaxDirectories(2);
+      pair->AddVisibility(pair_validator);
+
+      //both menus are visible with a single directory and invisible with three directories
+      std::string directory = ra::filesystem::GetTemporaryDirectory();
+      StringList single_elements;
+      single_elements.push_back(directory);
+      StringList many_elements;
+      many_elements.push_back(directory);
+      many_elements.push_back(directory);
+      many_elements.push_back(directory);
+
+      //threads update the same configuration with different selections.
+      //each update is completed before the next one starts. The menus never mix the states of two updates.
+      std::atomic<size_t> mixed_states(0);
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        const StringList& elements = (i % 2 == 0 ? single_elements : many_elements);
+        threads.push_back(std::thread([&config, &mixed_states, single, pair, elements]()
+        {
+          SelectionContext context;
+          context.SetElements(elements);
+          for (size_t j = 0; j < NUM_LOOPS; j++)
+          {
+            config.Update(context);
+
+            config.BeginRead();
+            if (single->IsVisible() != pair->IsVisible())
+              mixed_states++;
+            config.EndRead();
+          }
+        }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+      ASSERT_EQ(0, mixed_states.load());
+
+      //the menus have the state of the last update
+      SelectionContext context;
+      context.SetElements(single_elements);
+      config.Update(context);
+      ASSERT_TRUE(single->IsVisible());
+      ASSERT_TRUE(pair->IsVisible());
+      context.SetElements(many_elements);
+      config.Update(context);
+      ASSERT_FALSE(single->IsVisible());
+      ASSERT_FALSE(pair->IsVisible());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testReload)
+    {
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      std::string content = BuildConfigurationFileWithMenuCount(10);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error_message=" << error_message;
+      Menu::MenuPtrList before = config->GetMenus();
+      ASSERT_EQ(10, before.size());
+
+      //nothing changed
+      bool defaults_changed = true;
+      ASSERT_TRUE(config->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      ASSERT_FALSE(defaults_changed);
+      ASSERT_EQ(0, config->GetReplacedMenuCount());
+      ASSERT_TRUE(before == config->GetMenus());
+
+      //modify a single menu
+      ra::strings::Replace(content, "name=\"Menu 3\"", "name=\"Modified Menu 3\"");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      ASSERT_TRUE(config->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      ASSERT_EQ(1, config->GetReplacedMenuCount());
+
+      const Menu::MenuPtrList& after = config->GetMenus();
+      ASSERT_EQ(10, after.size());
+      for (size_t i = 0; i < after.size(); i++)
+      {
+        if (i == 3)
+          ASSERT_NE(before[i], after[i]);
+        else
+          ASSERT_EQ(before[i], after[i]);
+      }
+      ASSERT_EQ(std::string("Modified Menu 3"), after[3]->GetName());
+      ASSERT_EQ(after[3], config->FindMenuByName("Modified Menu 3"));
+      ASSERT_TRUE(config->FindMenuByName("Menu 3") == NULL);
+
+      //an invalid file does not change the configuration
+      before = config->GetMenus();
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content.substr(0, content.size() / 2))) << "Failed to create text file: " << path;
+      ASSERT_FALSE(config->Reload(error_message, defaults_changed));
+      ASSERT_TRUE(before == config->GetMenus());
+
+      //cleanup
+      delete config;
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testReloadSubMenus)
+    {
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      std::string content = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <default>\n"
+        "      <property name=\"test.reload.default\" value=\"1\" />\n"
+        "    </default>\n"
+        "    <menu name=\"parent\">\n"
+        "      <menu name=\"first\">\n"
+        "        <menu name=\"first.child\" />\n"
+        "      </menu>\n"
+        "      <menu name=\"second\" />\n"
+        "      <menu name=\"third\" />\n"
+        "    </menu>\n"
+        "    <menu name=\"other\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error_message=" << error_message;
+      Menu* parent = config->FindMenuByName("parent");
+      Menu* first = config->FindMenuByName("first");
+      Menu* other = config->FindMenuByName("other");
+      ASSERT_TRUE(parent != NULL);
+      ASSERT_TRUE(other != NULL);
+      ASSERT_NE(0, parent->GetSourceHash());
+      const DefaultSettings* defaults = config->GetDefaultSettings();
+      ASSERT_TRUE(defaults != NULL);
+
+      //modify a submenu. The top level menu of the submenu is parsed again with all its submenus.
+      ra::strings::Replace(content, "<menu name=\"second\" />", "<menu name=\"second\" description=\"modified\" />");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      bool defaults_changed = true;
+      ASSERT_TRUE(config->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      ASSERT_FALSE(defaults_changed);
+      ASSERT_EQ(defaults, config->GetDefaultSettings());
+      ASSERT_EQ(5, config->GetReplacedMenuCount());
+
+      ASSERT_NE(parent, config->FindMenuByName("parent"));
+      ASSERT_NE(first, config->FindMenuByName("first"));
+      ASSERT_EQ(other, config->FindMenuByName("other"));
+      ASSERT_EQ(config->FindMenuByName("parent"), config->FindMenuByName("first")->GetParentMenu());
+      ASSERT_EQ(std::string("modified"), config->FindMenuByName("second")->GetDescription());
+
+      //modify the default settings
+      first = config->FindMenuByName("first");
+      ra::strings::Replace(content, "value=\"1\"", "value=\"2\"");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      ASSERT_TRUE(config->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      ASSERT_TRUE(defaults_changed);
+      ASSERT_EQ(0, config->GetReplacedMenuCount());
+      ASSERT_EQ(first, config->FindMenuByName("first"));
+
+      //cleanup
+      delete config;
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testReloadClone)
+    {
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      std::string content = BuildConfigurationFileWithMenuCount(10);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error_message=" << error_message;
+      const Menu::MenuPtrList before = config->GetMenus();
+
+      ConfigFile* clone = config->Clone();
+      ASSERT_TRUE(clone != NULL);
+      ASSERT_TRUE(before == clone->GetMenus());
+      ASSERT_EQ(config->GetDefaultSettings(), clone->GetDefaultSettings());
+
+      //reload the clone. The original configuration is unchanged.
+      ra::strings::Replace(content, "name=\"Menu 3\"", "name=\"Modified Menu 3\"");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+      bool defaults_changed = true;
+      ASSERT_TRUE(clone->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      ASSERT_EQ(1, clone->GetReplacedMenuCount());
+      ASSERT_TRUE(before == config->GetMenus());
+      ASSERT_EQ(std::string("Menu 3"), config->GetMenus()[3]->GetName());
+      ASSERT_EQ(std::string("Modified Menu 3"), clone->GetMenus()[3]->GetName());
+
+      //the shared menus keep their parent. the new menus belong to the clone.
+      ASSERT_EQ(config, clone->GetMenus()[4]->GetParentConfigFile());
+      ASSERT_EQ(clone, clone->GetMenus()[3]->GetParentConfigFile());
+
+      //the unchanged menus are shared and outlive the original configuration
+      delete config;
+      const Menu::MenuPtrList& after = clone->GetMenus();
+      ASSERT_EQ(before.size(), after.size());
+      ASSERT_EQ(before[4], after[4]);
+      ASSERT_EQ(std::string("Menu 4"), after[4]->GetName());
+      ASSERT_TRUE(after[4]->GetParentConfigFile() == NULL);
+      ASSERT_EQ(after[4], clone->FindMenuByName("Menu 4"));
+
+      //cleanup
+      delete clone;
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestConfiguration, testReloadLarge)
+    {
+      static const size_t NUM_MENUS = 5000;
+      static const std::string separator = ra::filesystem::GetPathSeparatorStr();
+      std::string path = ra::filesystem::GetTemporaryDirectory() + separator + ra::testing::GetTestQualifiedName() + ".xml";
+
+      std::string content = BuildConfigurationFileWithMenuCount(NUM_MENUS);
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      double start = ra::timing::GetMillisecondsTimer();
+      std::string error_message;
+      ConfigFile* config = ConfigFile::LoadFile(path, error_message);
+      double load_time = ra::timing::GetMillisecondsTimer() - start;
+      ASSERT_NE(INVALID_CONFIGURATION, config) << "error_message=" << error_message;
+
+      //modify a single menu
+      ra::strings::Replace(content, "name=\"Menu 2500\"", "name=\"Modified Menu 2500\"");
+      ASSERT_TRUE(ra::filesystem::WriteTextFile(path, content)) << "Failed to create text file: " << path;
+
+      start = ra::timing::GetMillisecondsTimer();
+      bool defaults_changed = false;
+      ASSERT_TRUE(config->Reload(error_message, defaults_changed)) << "error_message=" << error_message;
+      double reload_time = ra::timing::GetMillisecondsTimer() - start;
+      ASSERT_EQ(1, config->GetReplacedMenuCount());
+      ASSERT_EQ(NUM_MENUS, config->GetMenus().size());
+
+      printf("Reloading a configuration of %d menus after modifying a single menu:\n", (int)NUM_MENUS);
+      printf("  load time:   %.3f ms\n", load_time);
+      printf("  reload time: %.3f ms\n", reload_time);
+
+      //cleanup
+      delete config;
+      ra::filesystem::DeleteFileUtf8(path.c_str());
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
@@ -0,0 +1,138 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestDirectoryWatchService.h"
+#include "Workspace.h"
+#include "PollingDirectoryWatchService.h"
+#ifdef __linux__
+#include "InotifyDirectoryWatchService.h"
+#endif
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+#include <algorithm>
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestDirectoryWatchService::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestDirectoryWatchService::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    bool IsFileChanged(const StringList& files, const std::string& path)
+    {
+      bool found = (std::find(files.begin(), files.end(), path) != files.end());
+      return found;
+    }
+    //--------------------------------------------------------------------------------------------------
+    void AssertFileChangesDetected(IDirectoryWatchService& service)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      const std::string path = workspace.GetFullPathUtf8("a.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, "<root/>"));
+
+      ASSERT_TRUE(service.Watch(workspace.GetBaseDirectory()));
+
+      //ASSERT no changes
+      StringList files;
+      ASSERT_TRUE(service.GetChanges(files));
+      ASSERT_EQ(0, files.size());
+
+      //wait to make sure the modified date is different
+      ra::timing::Millisleep(1500);
+
+      //modify the file and create another one
+      const std::string new_path = workspace.GetFullPathUtf8("b.xml");
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(path, "<root></root>"));
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(new_path, "<root/>"));
+
+      files.clear();
+      ASSERT_TRUE(service.GetChanges(files));
+      ASSERT_EQ(2, files.size());
+      ASSERT_TRUE(IsFileChanged(files, path));
+      ASSERT_TRUE(IsFileChanged(files, new_path));
+
+      //ASSERT the changes are reported once
+      files.clear();
+      ASSERT_TRUE(service.GetChanges(files));
+      ASSERT_EQ(0, files.size());
+
+      //delete a file
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(new_path.c_str()));
+
+      files.clear();
+      ASSERT_TRUE(service.GetChanges(files));
+      ASSERT_EQ(1, files.size());
+      ASSERT_TRUE(IsFileChanged(files, new_path));
+
+      //ASSERT the changes are forgotten when the service is cleared
+      service.Clear();
+      ASSERT_TRUE(ra::filesystem::WriteTextFileUtf8(new_path, "<root/>"));
+      files.clear();
+      ASSERT_TRUE(service.GetChanges(files));
+      ASSERT_EQ(0, files.size());
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestDirectoryWatchService, testPolling)
+    {
+      PollingDirectoryWatchService service;
+      AssertFileChangesDetected(service);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestDirectoryWatchService, testPollingMissingDirectory)
+    {
+      PollingDirectoryWatchService service;
+
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+
+      ASSERT_FALSE(service.Watch(workspace.GetFullPathUtf8("missing")));
+    }
+    //--------------------------------------------------------------------------------------------------
+#ifdef __linux__
+    TEST_F(TestDirectoryWatchService, testInotify)
+    {
+      InotifyDirectoryWatchService service;
+      AssertFileChangesDetected(service);
+    }
+#endif
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
@@ -0,0 +1,171 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestEvaluationContext.h"
+#include "EvaluationContext.h"
+#include "ConfigFile.h"
+#include "PropertyManager.h"
+#include "FileProbeCache.h"
+
+#include <thread>
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestEvaluationContext::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestEvaluationContext::TearDown()
+    {
+      EvaluationContext::SetCurrent(NULL);
+    }
+    //--------------------------------------------------------------------------------------------------
+    ConfigFile* NewPatternConfigFile(const std::string& pattern)
+    {
+      ConfigFile* config = new ConfigFile();
+
+      Validator* visibility = new Validator();
+      visibility->SetPattern(pattern);
+
+      Menu* menu = new Menu();
+      menu->SetName(pattern);
+      menu->AddVisibility(visibility);
+      config->AddMenu(menu);
+
+      return config;
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestEvaluationContext, testDefaults)
+    {
+      EvaluationContext context;
+
+      //the process-wide instances are used when no service is set
+      ASSERT_EQ(&PropertyManager::GetInstance(), &context.GetPropertyManager());
+      ASSERT_EQ(&FileProbeCache::GetInstance(), &context.GetFileProbeCache());
+      ASSERT_TRUE(context.GetSelectionContext().GetElements().empty());
+      ASSERT_TRUE(context.GetConfigFile() == NULL);
+
+      SelectionContext selection;
+      StringList elements;
+      elements.push_back("C:\\Windows\\System32\\notepad.exe");
+      selection.SetElements(elements);
+
+      ConfigFile config;
+      context.SetSelectionContext(&selection);
+      context.SetConfigFile(&config);
+      ASSERT_EQ(&selection, &context.GetSelectionContext());
+      ASSERT_EQ(&config, context.GetConfigFile());
+
+      //a copy refers to the same objects
+      EvaluationContext copy = context;
+      ASSERT_EQ(&selection, &copy.GetSelectionContext());
+      ASSERT_EQ(&config, copy.GetConfigFile());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestEvaluationContext, testCurrent)
+    {
+      ASSERT_TRUE(EvaluationContext::GetCurrent() == NULL);
+
+      EvaluationContext first;
+      EvaluationContext second;
+      ASSERT_TRUE(EvaluationContext::SetCurrent(&first) == NULL);
+      ASSERT_EQ(&first, EvaluationContext::SetCurrent(&second));
+      ASSERT_EQ(&second, EvaluationContext::GetCurrent());
+
+      //each thread has its own current context
+      const EvaluationContext* other_thread_context = &first;
+      std::thread other_thread([&other_thread_context]() { other_thread_context = EvaluationContext::GetCurrent(); });
+      other_thread.join();
+      ASSERT_TRUE(other_thread_context == NULL);
+
+      ASSERT_EQ(&second, EvaluationContext::SetCurrent(NULL));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestEvaluationContext, testConcurrentUpdates)
+    {
+      //two evaluations of different selections run at the same time
+      ConfigFile* text_config = NewPatternConfigFile("*.txt");
+      ConfigFile* image_config = NewPatternConfigFile("*.png");
+
+      SelectionContext text_selection;
+      SelectionContext image_selection;
+      StringList elements;
+      elements.push_back("C:\\Users\\foo\\Documents\\notes.txt");
+      text_selection.SetElements(elements);
+      elements.clear();
+      elements.push_back("C:\\Users\\foo\\Pictures\\photo.png");
+      image_selection.SetElements(elements);
+
+      static const size_t NUM_ITERATIONS = 500;
+      size_t text_failures = 0;
+      size_t image_failures = 0;
+
+      //each iteration alternates the selection to evaluate the menus again
+      std::thread text_thread([&]()
+      {
+        EvaluationContext text_context(text_selection);
+        EvaluationContext image_context(image_selection);
+        for (size_t i = 0; i < NUM_ITERATIONS; i++)
+        {
+          text_config->Update(text_context);
+          if (!text_config->GetMenus()[0]->IsVisible())
+            text_failures++;
+          text_config->Update(image_context);
+          if (text_config->GetMenus()[0]->IsVisible())
+            text_failures++;
+        }
+      });
+      std::thread image_thread([&]()
+      {
+        EvaluationContext text_context(text_selection);
+        EvaluationContext image_context(image_selection);
+        for (size_t i = 0; i < NUM_ITERATIONS; i++)
+        {
+          image_config->Update(image_context);
+          if (!image_config->GetMenus()[0]->IsVisible())
+            image_failures++;
+          image_config->Update(text_context);
+          if (image_config->GetMenus()[0]->IsVisible())
+            image_failures++;
+        }
+      });
+      text_thread.join();
+      image_thread.join();
+
+      ASSERT_EQ(0, text_failures);
+      ASSERT_EQ(0, image_failures);
+
+      //the current context is restored after each update
+      ASSERT_TRUE(EvaluationContext::GetCurrent() == NULL);
+
+      delete text_config;
+      delete image_config;
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
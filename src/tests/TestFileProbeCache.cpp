@@ -0,0 +1,194 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestFileProbeCache.h"
+#include "FileProbeCache.h"
+#include "Workspace.h"
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+
+    //--------------------------------------------------------------------------------------------------
+    void TestFileProbeCache::SetUp()
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+      probes.Clear();
+      probes.ResetStatistics();
+      probes.SetTimeToLive(FileProbeCache::DEFAULT_TIME_TO_LIVE);
+      probes.SetNetworkDeadline(FileProbeCache::DEFAULT_NETWORK_DEADLINE);
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestFileProbeCache::TearDown()
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+      probes.Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileProbeCache, testProbe)
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+
+      Workspace workspace;
+      std::string file_path = workspace.GetFullPathUtf8("file.txt");
+      std::string directory_path = workspace.GetBaseDirectory();
+      std::string missing_path = workspace.GetFullPathUtf8("missing.txt");
+      ASSERT_TRUE(ra::testing::CreateFile(file_path.c_str()));
+
+      size_t pass = probes.BeginPass();
+
+      ASSERT_TRUE(probes.FileExists(file_path, pass));
+      ASSERT_FALSE(probes.DirectoryExists(file_path, pass));
+      ASSERT_TRUE(probes.Exists(file_path, pass));
+
+      ASSERT_FALSE(probes.FileExists(directory_path, pass));
+      ASSERT_TRUE(probes.DirectoryExists(directory_path, pass));
+      ASSERT_TRUE(probes.Exists(directory_path, pass));
+
+      ASSERT_FALSE(probes.FileExists(missing_path, pass));
+      ASSERT_FALSE(probes.DirectoryExists(missing_path, pass));
+      ASSERT_FALSE(probes.Exists(missing_path, pass));
+
+      probes.EndPass(pass);
+
+      //each path is only probed once
+      ASSERT_EQ(3, probes.GetMissCount());
+      ASSERT_EQ(6, probes.GetHitCount());
+      ASSERT_EQ(0, probes.GetTimeoutCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileProbeCache, testPassScope)
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+
+      Workspace workspace;
+      std::string file_path = workspace.GetFullPathUtf8("file.txt");
+
+      //within a pass, the first probe is used
+      size_t pass = probes.BeginPass();
+      ASSERT_FALSE(probes.FileExists(file_path, pass));
+      ASSERT_TRUE(ra::testing::CreateFile(file_path.c_str()));
+      ASSERT_FALSE(probes.FileExists(file_path, pass));
+      probes.EndPass(pass);
+
+      //outside of a pass, the file system is probed directly
+      ASSERT_FALSE(probes.IsPassActive(pass));
+      ASSERT_TRUE(probes.FileExists(file_path, pass));
+      ASSERT_TRUE(ra::filesystem::DeleteFileUtf8(file_path.c_str()));
+      ASSERT_FALSE(probes.FileExists(file_path, FileProbeCache::INVALID_PASS));
+
+      //a new pass probes the file system again
+      ASSERT_TRUE(ra::testing::CreateFile(file_path.c_str()));
+      pass = probes.BeginPass();
+      ASSERT_TRUE(probes.FileExists(file_path, pass));
+      probes.EndPass(pass);
+
+      ASSERT_EQ(2, probes.GetMissCount());
+      ASSERT_EQ(1, probes.GetHitCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileProbeCache, testTimeToLive)
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+      probes.SetTimeToLive(60000.0);
+
+      Workspace workspace;
+      std::string file_path = workspace.GetFullPathUtf8("file.txt");
+
+      size_t pass = probes.BeginPass();
+      ASSERT_FALSE(probes.FileExists(file_path, pass));
+      probes.EndPass(pass);
+
+      //the entry is still valid in the next pass
+      ASSERT_TRUE(ra::testing::CreateFile(file_path.c_str()));
+      pass = probes.BeginPass();
+      ASSERT_FALSE(probes.FileExists(file_path, pass));
+      probes.EndPass(pass);
+
+      ASSERT_EQ(1, probes.GetMissCount());
+      ASSERT_EQ(1, probes.GetHitCount());
+
+      //expired entries are probed again
+      probes.SetTimeToLive(0.0);
+      pass = probes.BeginPass();
+      ASSERT_TRUE(probes.FileExists(file_path, pass));
+      probes.EndPass(pass);
+
+      ASSERT_EQ(2, probes.GetMissCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileProbeCache, testConcurrentPasses)
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+
+      Workspace workspace;
+      std::string file_path = workspace.GetFullPathUtf8("file.txt");
+
+      //two updates run at the same time
+      size_t first = probes.BeginPass();
+      size_t second = probes.BeginPass();
+      ASSERT_NE(first, second);
+      ASSERT_FALSE(probes.FileExists(file_path, first));
+      ASSERT_FALSE(probes.FileExists(file_path, second));
+      ASSERT_TRUE(ra::testing::CreateFile(file_path.c_str()));
+
+      //ending a pass does not end the other one
+      probes.EndPass(first);
+      ASSERT_FALSE(probes.IsPassActive(first));
+      ASSERT_TRUE(probes.IsPassActive(second));
+      ASSERT_FALSE(probes.FileExists(file_path, second));
+      ASSERT_TRUE(probes.FileExists(file_path, first));
+      probes.EndPass(second);
+
+      ASSERT_EQ(2, probes.GetMissCount());
+      ASSERT_EQ(1, probes.GetHitCount());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestFileProbeCache, testNetworkPath)
+    {
+      FileProbeCache& probes = FileProbeCache::GetInstance();
+      probes.SetNetworkDeadline(0.0);
+
+      const std::string path = "\\\\" + ra::testing::GetTestQualifiedName() + "\\shared\\file.txt";
+
+      //the probe does not block the pass
+      size_t pass = probes.BeginPass();
+      double start = ra::timing::GetMillisecondsTimer();
+      ASSERT_FALSE(probes.Exists(path, pass));
+      ASSERT_FALSE(probes.Exists(path, pass));
+      double elapsed = ra::timing::GetMillisecondsTimer() - start;
+      probes.EndPass(pass);
+
+      printf("Probed network path '%s' in %.3f ms.\n", path.c_str(), elapsed);
+      ASSERT_EQ(1, probes.GetMissCount());
+      ASSERT_GE(probes.GetHitCount() + probes.GetTimeoutCount(), 1);
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
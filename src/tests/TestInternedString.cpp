@@ -0,0 +1,208 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestInternedString.h"
+#include "Workspace.h"
+#include "InternedString.h"
+#include "ConfigFile.h"
+#include "Menu.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/strings.h"
+
+#include <thread>
+
+namespace shellanything
+{
+  namespace test
+  {
+    void CountMenuStrings(const Menu* menu, size_t& count, size_t& size)
+    {
+      const std::string* values[] = { &menu->GetName(), &menu->GetDescription(), &menu->GetIcon().GetPath(), &menu->GetIcon().GetFileExtension() };
+      for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+      {
+        if (!values[i]->empty())
+        {
+          count++;
+          size += values[i]->size();
+        }
+      }
+
+      const Menu::MenuPtrList& children = menu->GetSubMenus();
+      for (size_t i = 0; i < children.size(); i++)
+      {
+        CountMenuStrings(children[i], count, size);
+      }
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestInternedString::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestInternedString::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestInternedString, testIntern)
+    {
+      InternedString empty;
+      ASSERT_TRUE(empty.IsEmpty());
+      ASSERT_EQ(std::string(), empty.Get());
+      ASSERT_TRUE(empty == InternedString(std::string()));
+
+      InternedString a(std::string("TestInternedString.testIntern"));
+      InternedString b(std::string("TestInternedString.testIntern"));
+      InternedString c(std::string("TestInternedString.testIntern.other"));
+      ASSERT_FALSE(a.IsEmpty());
+      ASSERT_EQ(std::string("TestInternedString.testIntern"), a.Get());
+
+      //same values share the same pooled string
+      ASSERT_TRUE(a == b);
+      ASSERT_EQ(&a.Get(), &b.Get());
+      ASSERT_TRUE(a != c);
+
+      //assignments
+      c = a;
+      ASSERT_TRUE(a == c);
+      c = std::string("TestInternedString.testIntern.other");
+      ASSERT_TRUE(a != c);
+      ASSERT_EQ(std::string("TestInternedString.testIntern.other"), c.Get());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestInternedString, testFind)
+    {
+      const std::string value = "TestInternedString.testFind";
+      InternedString result;
+      ASSERT_FALSE(InternedString::Find(value, result));
+
+      size_t pool_size = InternedString::GetPoolSize();
+      {
+        InternedString interned(value);
+        ASSERT_EQ(pool_size + 1, InternedString::GetPoolSize());
+        ASSERT_TRUE(InternedString::Find(value, result));
+        ASSERT_TRUE(result == interned);
+      }
+
+      //the string is still referenced by result
+      ASSERT_EQ(pool_size + 1, InternedString::GetPoolSize());
+      result = InternedString();
+
+      //the string is released with its last handle
+      ASSERT_EQ(pool_size, InternedString::GetPoolSize());
+      ASSERT_FALSE(InternedString::Find(value, result));
+
+      //the empty string is always found
+      ASSERT_TRUE(InternedString::Find("", result));
+      ASSERT_TRUE(result.IsEmpty());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestInternedString, testThreads)
+    {
+      size_t pool_size = InternedString::GetPoolSize();
+
+      static const size_t NUM_THREADS = 8;
+      std::vector<std::thread> threads;
+      for (size_t i = 0; i < NUM_THREADS; i++)
+      {
+        threads.push_back(std::thread([]()
+        {
+          for (size_t j = 0; j < 10000; j++)
+          {
+            InternedString a(std::string("TestInternedString.testThreads.") + ra::strings::ToString(j % 10));
+            InternedString b = a;
+            InternedString c;
+            c = b;
+          }
+        }));
+      }
+      for (size_t i = 0; i < threads.size(); i++)
+      {
+        threads[i].join();
+      }
+
+      ASSERT_EQ(pool_size, InternedString::GetPoolSize());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestInternedString, testLoadConfigurations)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportDirectoryUtf8("configurations"));
+
+      //find all the sample configurations
+      ra::strings::StringVector files;
+      ASSERT_TRUE(ra::filesystem::FindFilesUtf8(files, workspace.GetBaseDirectory().c_str()));
+
+      size_t pool_size = InternedString::GetPoolSize();
+
+      //load all the sample configurations at the same time
+      ConfigFile::ConfigFilePtrList configs;
+      size_t count = 0;
+      size_t size = 0;
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        if (!ConfigFile::IsValidConfigFile(files[i]))
+          continue;
+
+        std::string error;
+        ConfigFile* config = ConfigFile::LoadFile(files[i], error);
+        ASSERT_TRUE(config != NULL) << "path=" << files[i] << ", error=" << error;
+        configs.push_back(config);
+
+        const Menu::MenuPtrList& menus = config->GetMenus();
+        for (size_t j = 0; j < menus.size(); j++)
+        {
+          CountMenuStrings(menus[j], count, size);
+        }
+      }
+      ASSERT_FALSE(configs.empty());
+
+      size_t interned_count = InternedString::GetPoolSize() - pool_size;
+      printf("Loaded %d configuration files:\n", (int)configs.size());
+      printf("  menu strings:     %d (%d bytes)\n", (int)count, (int)size);
+      printf("  interned strings: %d\n", (int)interned_count);
+
+      //menus can be found by their name
+      const Menu::MenuPtrList& menus = configs[0]->GetMenus();
+      ASSERT_FALSE(menus.empty());
+      ASSERT_EQ(menus[0], configs[0]->FindMenuByName(menus[0]->GetName()));
+
+      for (size_t i = 0; i < configs.size(); i++)
+      {
+        delete configs[i];
+      }
+
+      //all strings are released with their configuration
+      ASSERT_EQ(pool_size, InternedString::GetPoolSize());
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
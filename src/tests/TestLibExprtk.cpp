@@ -25,6 +25,7 @@
 #include "TestLibExprtk.h"
 #include "libexprtk.h"
 #include "PropertyManager.h"
+#include "rapidassist/timing.h"
 
 namespace shellanything
 {
@@ -35,6 +36,7 @@ namespace shellanything
     //--------------------------------------------------------------------------------------------------
     void TestLibExprtk::SetUp()
     {
+      ClearExpressionCache();
     }
     //--------------------------------------------------------------------------------------------------
     void TestLibExprtk::TearDown()
@@ -97,6 +99,130 @@ namespace shellanything
       ASSERT_NEAR(result, 5.7, epsilon);
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testCache)
+    {
+      double result = 0.0;
+      EXPRTK_CACHE_STATISTICS stats;
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(0, stats.hits);
+      ASSERT_EQ(0, stats.misses);
+      ASSERT_EQ(0, stats.size);
+
+      // First evaluation compiles the expression
+      ASSERT_EQ(1, EvaluateDoubleEx("if (10 > 3, 2.1, 5.7)", &result));
+      ASSERT_NEAR(result, 2.1, epsilon);
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(0, stats.hits);
+      ASSERT_EQ(1, stats.misses);
+      ASSERT_EQ(1, stats.size);
+
+      // Next evaluations reuse the compiled expression
+      for (int i = 0; i < 9; i++)
+      {
+        result = 0.0;
+        ASSERT_EQ(1, EvaluateDoubleEx("if (10 > 3, 2.1, 5.7)", &result));
+        ASSERT_NEAR(result, 2.1, epsilon);
+      }
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(9, stats.hits);
+      ASSERT_EQ(1, stats.misses);
+      ASSERT_EQ(1, stats.size);
+      ASSERT_NEAR(0.9, GetExpressionCacheHitRate(&stats), epsilon);
+
+      // Expressions that fails to compile are not cached and still report an error
+      static const size_t BUFFER_SIZE = 1024;
+      char buffer[BUFFER_SIZE] = { 0 };
+      ASSERT_EQ(0, EvaluateDouble("foobar;", &result, buffer, BUFFER_SIZE));
+      ASSERT_GT(strlen(buffer), 0);
+      buffer[0] = '\0';
+      ASSERT_EQ(0, EvaluateDouble("foobar;", &result, buffer, BUFFER_SIZE));
+      ASSERT_GT(strlen(buffer), 0);
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(1, stats.size);
+
+      // Least recently used expressions are evicted
+      SetExpressionCacheCapacity(2);
+      ASSERT_EQ(1, EvaluateDoubleEx("1+1", &result));
+      ASSERT_EQ(1, EvaluateDoubleEx("if (10 > 3, 2.1, 5.7)", &result));
+      ASSERT_EQ(1, EvaluateDoubleEx("2+2", &result)); // evicts "1+1"
+      ASSERT_NEAR(result, 4.0, epsilon);
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(2, stats.size);
+      ASSERT_EQ(2, stats.capacity);
+      ASSERT_EQ(1, stats.evictions);
+
+      unsigned long long misses = stats.misses;
+      ASSERT_EQ(1, EvaluateDoubleEx("if (10 > 3, 2.1, 5.7)", &result));
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(misses, stats.misses);
+      ASSERT_EQ(1, EvaluateDoubleEx("1+1", &result));
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(misses + 1, stats.misses);
+
+      // Disable the cache
+      SetExpressionCacheCapacity(0);
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(0, stats.size);
+      ASSERT_EQ(1, EvaluateDoubleEx("1+1", &result));
+      ASSERT_NEAR(result, 2.0, epsilon);
+      GetExpressionCacheStatistics(&stats);
+      ASSERT_EQ(0, stats.size);
+
+      ClearExpressionCache();
+      SetExpressionCacheCapacity(256);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestLibExprtk, testBenchmarkCache)
+    {
+      static const char* expressions[] = {
+        "5.3",
+        "if (10 > 3, 2.1, 5.7)",
+        "if (10 < 3, 2.1, 5.7)",
+      };
+      static const size_t num_expressions = sizeof(expressions) / sizeof(expressions[0]);
+      static const size_t NUM_LOOPS = 1000;
+
+      // Cold evaluations. Each expression is compiled.
+      double cold_sum = 0.0;
+      double cold_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        for (size_t j = 0; j < num_expressions; j++)
+        {
+          ClearExpressionCache();
+          double result = 0.0;
+          ASSERT_EQ(1, EvaluateDoubleEx(expressions[j], &result));
+          cold_sum += result;
+        }
+      }
+      double cold_time = ra::timing::GetMillisecondsTimer() - cold_start;
+
+      // Warm evaluations. Each expression is compiled once.
+      ClearExpressionCache();
+      double warm_sum = 0.0;
+      double warm_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        for (size_t j = 0; j < num_expressions; j++)
+        {
+          double result = 0.0;
+          ASSERT_EQ(1, EvaluateDoubleEx(expressions[j], &result));
+          warm_sum += result;
+        }
+      }
+      double warm_time = ra::timing::GetMillisecondsTimer() - warm_start;
+
+      EXPRTK_CACHE_STATISTICS stats;
+      GetExpressionCacheStatistics(&stats);
+
+      printf("Evaluating %d expressions:\n", (int)(NUM_LOOPS * num_expressions));
+      printf("  cold: %.3f ms\n", cold_time);
+      printf("  warm: %.3f ms (hit rate %.1f%%, compile time %.3f ms)\n", warm_time, GetExpressionCacheHitRate(&stats) * 100.0, stats.compile_time);
+
+      ASSERT_NEAR(cold_sum, warm_sum, epsilon);
+      ASSERT_EQ(num_expressions, stats.misses);
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
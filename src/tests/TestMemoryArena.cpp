@@ -0,0 +1,179 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestMemoryArena.h"
+#include "Workspace.h"
+#include "MemoryArena.h"
+#include "ConfigFile.h"
+#include "Menu.h"
+#include "ActionExecute.h"
+
+#include "rapidassist/testing.h"
+#include "rapidassist/filesystem_utf8.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestMemoryArena::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestMemoryArena::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMemoryArena, testAllocate)
+    {
+      MemoryArena arena;
+      ASSERT_EQ(0, arena.GetAllocationCount());
+      ASSERT_EQ(0, arena.GetChunkCount());
+
+      //small blocks share the same chunk
+      char* a = static_cast<char*>(arena.Allocate(3));
+      char* b = static_cast<char*>(arena.Allocate(20));
+      ASSERT_TRUE(a != NULL);
+      ASSERT_TRUE(b != NULL);
+      ASSERT_EQ(0, (size_t)a % MemoryArena::ALIGNMENT);
+      ASSERT_EQ(0, (size_t)b % MemoryArena::ALIGNMENT);
+      ASSERT_EQ(a + MemoryArena::ALIGNMENT, b);
+      ASSERT_EQ(2, arena.GetAllocationCount());
+      ASSERT_EQ(1, arena.GetChunkCount());
+      ASSERT_EQ(3 * MemoryArena::ALIGNMENT, arena.GetAllocatedSize());
+
+      //large blocks get their own chunk
+      void* c = arena.Allocate(MemoryArena::CHUNK_SIZE * 2);
+      ASSERT_TRUE(c != NULL);
+      ASSERT_EQ(3, arena.GetAllocationCount());
+      ASSERT_EQ(2, arena.GetChunkCount());
+      ASSERT_EQ(MemoryArena::CHUNK_SIZE * 3, arena.GetCapacity());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMemoryArena, testArenaObject)
+    {
+      ASSERT_TRUE(MemoryArena::GetCurrentArena() == NULL);
+
+      //objects are allocated on the heap when no arena is current
+      Menu* heap_menu = new Menu();
+      ASSERT_TRUE(ArenaObject::GetObjectArena(heap_menu) == NULL);
+
+      MemoryArena arena;
+      MemoryArena* previous = MemoryArena::SetCurrentArena(&arena);
+      ASSERT_TRUE(previous == NULL);
+      ASSERT_EQ(&arena, MemoryArena::GetCurrentArena());
+
+      Menu* menu = new Menu();
+      Validator* validator = new Validator();
+      ActionExecute* action = new ActionExecute();
+      menu->AddValidity(validator);
+      menu->AddAction(action);
+
+      MemoryArena::SetCurrentArena(previous);
+      ASSERT_TRUE(MemoryArena::GetCurrentArena() == NULL);
+
+      ASSERT_EQ(&arena, ArenaObject::GetObjectArena(menu));
+      ASSERT_EQ(&arena, ArenaObject::GetObjectArena(validator));
+      ASSERT_EQ(&arena, ArenaObject::GetObjectArena(action));
+      ASSERT_EQ(3, arena.GetAllocationCount());
+
+      //heap and arena objects can be mixed in the same tree
+      heap_menu->AddMenu(menu);
+      delete heap_menu;
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestMemoryArena, testLoadConfigurations)
+    {
+      //Creating a temporary workspace for the test execution.
+      Workspace workspace;
+      ASSERT_FALSE(workspace.GetBaseDirectory().empty());
+      ASSERT_TRUE(workspace.ImportDirectoryUtf8("configurations"));
+
+      //find all the sample configurations
+      ra::strings::StringVector files;
+      ASSERT_TRUE(ra::filesystem::FindFilesUtf8(files, workspace.GetBaseDirectory().c_str()));
+      StringList paths;
+      for (size_t i = 0; i < files.size(); i++)
+      {
+        if (ConfigFile::IsValidConfigFile(files[i]))
+          paths.push_back(files[i]);
+      }
+      ASSERT_FALSE(paths.empty());
+
+      static const size_t NUM_LOADS = 10;
+      printf("Loading %d configuration files %d times:\n", (int)paths.size(), (int)NUM_LOADS);
+
+      double load_time = 0.0;
+      double unload_time = 0.0;
+      size_t allocations = 0;
+      size_t allocated_size = 0;
+      size_t capacity = 0;
+      for (size_t i = 0; i < NUM_LOADS; i++)
+      {
+        for (size_t j = 0; j < paths.size(); j++)
+        {
+          double start = ra::timing::GetMillisecondsTimer();
+          std::string error;
+          ConfigFile* config = ConfigFile::LoadFile(paths[j], error);
+          load_time += ra::timing::GetMillisecondsTimer() - start;
+          ASSERT_TRUE(config != NULL) << "path=" << paths[j] << ", error=" << error;
+
+          //all menus must be allocated from the arena of their configuration
+          const MemoryArena& arena = config->GetArena();
+          const Menu::MenuPtrList& menus = config->GetMenus();
+          for (size_t k = 0; k < menus.size(); k++)
+          {
+            ASSERT_EQ(&arena, ArenaObject::GetObjectArena(menus[k])) << "path=" << paths[j];
+          }
+
+          if (i == 0)
+          {
+            printf("  %-30s %6d allocations, %8d bytes, %3d chunks\n",
+              ra::filesystem::GetFilename(paths[j].c_str()).c_str(),
+              (int)arena.GetAllocationCount(),
+              (int)arena.GetAllocatedSize(),
+              (int)arena.GetChunkCount());
+            allocations += arena.GetAllocationCount();
+            allocated_size += arena.GetAllocatedSize();
+            capacity += arena.GetCapacity();
+          }
+
+          start = ra::timing::GetMillisecondsTimer();
+          delete config;
+          unload_time += ra::timing::GetMillisecondsTimer() - start;
+        }
+      }
+
+      printf("  total: %d allocations, %d bytes allocated, %d bytes reserved\n", (int)allocations, (int)allocated_size, (int)capacity);
+      printf("  load time:   %.3f ms\n", load_time);
+      printf("  unload time: %.3f ms\n", unload_time);
+
+      //Cleanup
+      ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
@@ -32,6 +32,8 @@
 #include "ActionPrompt.h"
 #include "ActionMessage.h"
 #include "ActionProperty.h"
+#include "ObjectFactory.h"
+#include "IActionFactory.h"
 
 #include "rapidassist/testing.h"
 #include "rapidassist/filesystem.h"
@@ -813,6 +815,61 @@ namespace shellanything
       ASSERT_TRUE(workspace.Cleanup()) << "Failed deleting workspace directory '" << workspace.GetBaseDirectory() << "'.";
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestObjectFactory, testParseActionFromXml)
+    {
+      ObjectFactory& factory = ObjectFactory::GetInstance();
+      std::string error;
+
+      //ASSERT an action can be parsed from its xml text
+      IAction* action = factory.ParseAction("message", "<message caption=\"foo\" title=\"bar\" />", error);
+      ActionMessage* message = dynamic_cast<ActionMessage*>(action);
+      ASSERT_TRUE(message != NULL) << error;
+      ASSERT_EQ("foo", message->GetCaption());
+      ASSERT_EQ("bar", message->GetTitle());
+      delete action;
+
+      //ASSERT invalid xml is reported
+      error.clear();
+      action = factory.ParseAction("message", "<message caption=\"foo\"", error);
+      ASSERT_TRUE(action == NULL);
+      ASSERT_FALSE(error.empty());
+
+      //ASSERT an element of another type is reported
+      error.clear();
+      action = factory.ParseAction("message", "<exec path=\"foo.exe\" />", error);
+      ASSERT_TRUE(action == NULL);
+      ASSERT_FALSE(error.empty());
+    }
+    //--------------------------------------------------------------------------------------------------
+    // An action factory which does not override ParseFromElement() or ParseFromXml().
+    class IncompleteActionFactory : public virtual IActionFactory
+    {
+    public:
+      virtual const std::string& GetName() const
+      {
+        static const std::string NAME = "incomplete";
+        return NAME;
+      }
+    };
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestObjectFactory, testParseActionWithoutOverride)
+    {
+      IncompleteActionFactory factory;
+      std::string error;
+
+      //ASSERT the default implementations do not call each other forever
+      IAction* action = factory.ParseFromXml("<incomplete />", error);
+      ASSERT_TRUE(action == NULL);
+      ASSERT_FALSE(error.empty());
+
+      tinyxml2::XMLDocument doc;
+      ASSERT_EQ(tinyxml2::XML_SUCCESS, doc.Parse("<incomplete />"));
+      error.clear();
+      action = factory.ParseFromElement(doc.FirstChildElement(), error);
+      ASSERT_TRUE(action == NULL);
+      ASSERT_FALSE(error.empty());
+    }
+    //--------------------------------------------------------------------------------------------------
     TEST_F(TestObjectFactory, testParseDefaults)
     {
       ConfigManager& cmgr = ConfigManager::GetInstance();
@@ -0,0 +1,227 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestPropertyExpression.h"
+#include "PropertyExpression.h"
+#include "PropertyManager.h"
+#include "libexprtk.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    const double epsilon = 0.000001;
+
+    bool EvaluateBound(const PropertyExpression& e, double& result)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.BeginRead();
+      PropertyExpression::VARIABLES variables;
+      bool bound = e.Bind(variables);
+      int evaluated = 0;
+      if (bound)
+      {
+        const EXPRTK_VARIABLE* variables_list = (variables.list.empty() ? NULL : &variables.list[0]);
+        evaluated = EvaluateDoubleVariables(e.GetBoundExpression().c_str(), variables_list, (int)variables.list.size(), &result, NULL, 0);
+      }
+      pmgr.EndRead();
+      return (evaluated == 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestPropertyExpression::SetUp()
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestPropertyExpression::TearDown()
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.Clear();
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyExpression, testSetExpression)
+    {
+      PropertyExpression e;
+
+      // Without property references
+      e.SetExpression("5 > 1");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("5 > 1"), e.GetBoundExpression());
+
+      // Numeric operands
+      e.SetExpression("${selection.count} > 3");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("sa_property_0 > 3"), e.GetBoundExpression());
+      e.SetExpression("(${foo}+${bar})*${foo}");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("(sa_property_0+sa_property_1)*sa_property_0"), e.GetBoundExpression());
+
+      // String literals
+      e.SetExpression("'${foo}'=='bar'");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("sa_property_0=='bar'"), e.GetBoundExpression());
+      e.SetExpression("'${foo}' == '${foo}' and ${foo} > 1");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("sa_property_0 == sa_property_0 and sa_property_1 > 1"), e.GetBoundExpression());
+
+      // Property references that are part of a larger token
+      e.SetExpression("${foo}${bar} > 3");
+      ASSERT_FALSE(e.IsBindable());
+      e.SetExpression("1${foo} > 3");
+      ASSERT_FALSE(e.IsBindable());
+      e.SetExpression("'prefix ${foo}'=='bar'");
+      ASSERT_FALSE(e.IsBindable());
+      e.SetExpression("'${foo} suffix'=='bar'");
+      ASSERT_FALSE(e.IsBindable());
+      e.SetExpression("${foo${bar}} > 3");
+      ASSERT_FALSE(e.IsBindable());
+      ASSERT_TRUE(e.GetBoundExpression().empty());
+
+      // Not a property reference
+      e.SetExpression("'${' == '${'");
+      ASSERT_TRUE(e.IsBindable());
+      ASSERT_EQ(std::string("'${' == '${'"), e.GetBoundExpression());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyExpression, testBind)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      PropertyExpression e;
+      double result = 0.0;
+
+      e.SetExpression("${selection.count} > 3");
+
+      // Missing property. The expression must be expanded as text.
+      ASSERT_FALSE(EvaluateBound(e, result));
+
+      pmgr.SetProperty("selection.count", "5");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(1.0, result, epsilon);
+
+      pmgr.SetProperty("selection.count", "2");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(0.0, result, epsilon);
+
+      // Values which are not simple numbers can not be bound as numeric variables
+      pmgr.SetProperty("selection.count", "-5");
+      ASSERT_FALSE(EvaluateBound(e, result));
+      pmgr.SetProperty("selection.count", "abc");
+      ASSERT_FALSE(EvaluateBound(e, result));
+      pmgr.SetProperty("selection.count", "");
+      ASSERT_FALSE(EvaluateBound(e, result));
+
+      // Property values with property references are expanded
+      pmgr.SetProperty("count", "7");
+      pmgr.SetProperty("selection.count", "${count}");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(1.0, result, epsilon);
+
+      // String variables
+      e.SetExpression("'${foo}'=='bar'");
+      pmgr.SetProperty("foo", "bar");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(1.0, result, epsilon);
+      pmgr.SetProperty("foo", "it's not bar");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(0.0, result, epsilon);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyExpression, testBindWindowsPath)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      PropertyExpression e;
+      double result = 0.0;
+
+      // exprtk handles backslashes of string literals as escape characters.
+      // Values with backslashes are not bound as variables to keep the same result as when the expression is expanded as text.
+      const std::string expression = "'${selection.path}' == 'C:\\Program Files\\foo.txt'";
+      e.SetExpression(expression);
+      ASSERT_TRUE(e.IsBindable());
+      pmgr.SetProperty("selection.path", "C:\\Program Files\\foo.txt");
+      ASSERT_FALSE(EvaluateBound(e, result));
+
+      std::string expanded = pmgr.Expand(expression);
+      int expanded_result = 0;
+      ASSERT_EQ(1, EvaluateBooleanEx(expanded.c_str(), &expanded_result));
+      ASSERT_EQ(1, expanded_result);
+
+      // Values without backslashes are still bound
+      pmgr.SetProperty("selection.path", "C:/Program Files/foo.txt");
+      ASSERT_TRUE(EvaluateBound(e, result));
+      ASSERT_NEAR(0.0, result, epsilon);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyExpression, testBenchmark)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      static const size_t NUM_LOOPS = 1000;
+      const std::string expression = "${selection.count} > 3 and '${selection.filename.extension}' == 'txt'";
+      pmgr.SetProperty("selection.filename.extension", "txt");
+
+      ClearExpressionCache();
+
+      // Expanding property references as text. Each selection produces a different expression.
+      size_t expected_matches = 0;
+      double expand_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        pmgr.SetProperty("selection.count", ra::strings::ToString(i));
+        std::string expanded = pmgr.Expand(expression);
+        int result = 0;
+        ASSERT_EQ(1, EvaluateBooleanEx(expanded.c_str(), &result));
+        if (result)
+          expected_matches++;
+      }
+      double expand_time = ra::timing::GetMillisecondsTimer() - expand_start;
+
+      // Binding property references as variables. The expression is compiled once.
+      PropertyExpression e;
+      e.SetExpression(expression);
+      ASSERT_TRUE(e.IsBindable());
+      size_t actual_matches = 0;
+      double bind_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < NUM_LOOPS; i++)
+      {
+        pmgr.SetProperty("selection.count", ra::strings::ToString(i));
+        double result = 0.0;
+        ASSERT_TRUE(EvaluateBound(e, result));
+        if (result != 0.0)
+          actual_matches++;
+      }
+      double bind_time = ra::timing::GetMillisecondsTimer() - bind_start;
+
+      printf("Evaluating '%s' with %d selections:\n", expression.c_str(), (int)NUM_LOOPS);
+      printf("  expanded as text:       %.3f ms\n", expand_time);
+      printf("  bound as variables:     %.3f ms\n", bind_time);
+
+      ASSERT_EQ(expected_matches, actual_matches);
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
@@ -25,6 +25,13 @@
 #include "TestPropertyManager.h"
 #include "PropertyManager.h"
 
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+#include <atomic>
+#include <thread>
+#include <cstdlib>
+
 namespace shellanything
 {
   namespace test
@@ -329,6 +336,319 @@ namespace shellanything
       ASSERT_TRUE(pmgr.HasProperty(env_var_name));
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testStableProperties)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      // Default properties are stable
+      ASSERT_TRUE(pmgr.IsStableProperty("line.separator"));
+      ASSERT_TRUE(pmgr.IsStableProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME));
+
+      // Other properties are not
+      pmgr.SetProperty("foo", "bar");
+      ASSERT_FALSE(pmgr.IsStableProperty("foo"));
+      ASSERT_FALSE(pmgr.IsStableProperty("property-that-does-not-exist"));
+
+      size_t version = pmgr.GetStableVersion();
+      pmgr.SetStableProperty("foo", true);
+      ASSERT_TRUE(pmgr.IsStableProperty("foo"));
+      ASSERT_NE(version, pmgr.GetStableVersion());
+
+      // Setting the same value does not change the version
+      version = pmgr.GetStableVersion();
+      pmgr.SetProperty("foo", "bar");
+      ASSERT_EQ(version, pmgr.GetStableVersion());
+
+      // Changing a stable property changes the version
+      pmgr.SetProperty("foo", "baz");
+      ASSERT_NE(version, pmgr.GetStableVersion());
+
+      // Changing another property does not
+      version = pmgr.GetStableVersion();
+      pmgr.SetProperty("selection.path", "C:\\foo\\bar.txt");
+      ASSERT_EQ(version, pmgr.GetStableVersion());
+
+      // Clearing a stable property changes the version
+      pmgr.ClearProperty("foo");
+      ASSERT_FALSE(pmgr.IsStableProperty("foo"));
+      ASSERT_NE(version, pmgr.GetStableVersion());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testVersion)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+
+      // Setting a new property changes the version
+      size_t version = pmgr.GetVersion();
+      pmgr.SetProperty("test.version", "foo");
+      ASSERT_NE(version, pmgr.GetVersion());
+
+      // Setting the same value does not change the version
+      version = pmgr.GetVersion();
+      pmgr.SetProperty("test.version", "foo");
+      ASSERT_EQ(version, pmgr.GetVersion());
+
+      // Changing the value changes the version
+      pmgr.SetProperty("test.version", "bar");
+      ASSERT_NE(version, pmgr.GetVersion());
+
+      // Clearing the property changes the version
+      version = pmgr.GetVersion();
+      pmgr.ClearProperty("test.version");
+      ASSERT_NE(version, pmgr.GetVersion());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testDependencyRecorder)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("test.recorder.foo", "bar");
+      pmgr.SetProperty("test.recorder.name", "${test.recorder.foo}");
+
+      // Record the properties read by an expansion
+      PropertyDependencies dependencies;
+      PropertyDependencies* previous = pmgr.SetDependencyRecorder(&dependencies);
+      std::string expanded = pmgr.Expand("${test.recorder.name} ${test.recorder.missing}");
+      ASSERT_EQ(&dependencies, pmgr.SetDependencyRecorder(previous));
+      ASSERT_EQ(std::string("bar ${test.recorder.missing}"), expanded);
+      ASSERT_TRUE(dependencies.Contains("test.recorder.foo"));
+      ASSERT_TRUE(dependencies.Contains("test.recorder.name"));
+      ASSERT_TRUE(dependencies.Contains("test.recorder.missing"));
+      ASSERT_FALSE(dependencies.IsChanged());
+
+      // Reading outside of the recording is ignored
+      pmgr.GetProperty("test.recorder.other");
+      ASSERT_FALSE(dependencies.Contains("test.recorder.other"));
+
+      // Setting the same value is not a change
+      pmgr.SetProperty("test.recorder.foo", "bar");
+      ASSERT_FALSE(dependencies.IsChanged());
+
+      // Changing an unrelated property is not a change
+      pmgr.SetProperty("test.recorder.other", "baz");
+      ASSERT_FALSE(dependencies.IsChanged());
+
+      // Defining a missing property is a change
+      size_t version = pmgr.GetPropertyVersion("test.recorder.missing");
+      pmgr.SetProperty("test.recorder.missing", "baz");
+      ASSERT_NE(version, pmgr.GetPropertyVersion("test.recorder.missing"));
+      ASSERT_TRUE(dependencies.IsChanged());
+
+      pmgr.ClearProperty("test.recorder.foo");
+      pmgr.ClearProperty("test.recorder.name");
+      pmgr.ClearProperty("test.recorder.missing");
+      pmgr.ClearProperty("test.recorder.other");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testIsStableValue)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("foo", "bar");
+      pmgr.SetProperty("selection.path", "C:\\foo\\bar.txt");
+      pmgr.SetProperty("stable.constant", "abc");
+      pmgr.SetProperty("stable.indirect", "${stable.constant}");
+      pmgr.SetProperty("stable.selection", "${selection.path}");
+      pmgr.SetProperty("stable.circular", "${stable.circular}");
+      pmgr.SetStableProperty("stable.constant", true);
+      pmgr.SetStableProperty("stable.indirect", true);
+      pmgr.SetStableProperty("stable.selection", true);
+      pmgr.SetStableProperty("stable.circular", true);
+
+      ASSERT_TRUE(pmgr.IsStableValue(""));
+      ASSERT_TRUE(pmgr.IsStableValue("true"));
+      ASSERT_TRUE(pmgr.IsStableValue("${line.separator}"));
+      ASSERT_TRUE(pmgr.IsStableValue("${stable.constant} and ${stable.indirect}"));
+      ASSERT_TRUE(pmgr.IsStableValue("${stable.circular}"));
+      ASSERT_TRUE(pmgr.IsStableValue("${}"));
+      ASSERT_TRUE(pmgr.IsStableValue("${malformed"));
+
+      ASSERT_FALSE(pmgr.IsStableValue("${foo}"));
+      ASSERT_FALSE(pmgr.IsStableValue("${stable.constant}${selection.path}"));
+      ASSERT_FALSE(pmgr.IsStableValue("${stable.selection}"));
+      ASSERT_FALSE(pmgr.IsStableValue("${property-that-does-not-exist}"));
+      ASSERT_FALSE(pmgr.IsStableValue("${stable.${foo}}"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testSnapshot)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("foo", "bar");
+
+      // A snapshot does not change
+      PropertySnapshotPtr snapshot = pmgr.GetSnapshot();
+      ASSERT_EQ(std::string("bar"), snapshot->GetProperty("foo"));
+      pmgr.SetProperty("foo", "baz");
+      ASSERT_EQ(std::string("bar"), snapshot->GetProperty("foo"));
+      ASSERT_EQ(std::string("baz"), pmgr.GetProperty("foo"));
+      ASSERT_EQ(pmgr.GetVersion(), pmgr.GetSnapshot()->GetVersion());
+
+      // The changes of a batch are published when the batch ends
+      snapshot = pmgr.GetSnapshot();
+      pmgr.BeginBatch();
+      pmgr.SetProperty("foo", "batch");
+      pmgr.SetProperty("bar", "batch");
+      ASSERT_EQ(std::string("batch"), pmgr.GetProperty("foo")); // the writer reads its own changes
+      ASSERT_TRUE(pmgr.GetSnapshot() == snapshot);
+      pmgr.EndBatch();
+      ASSERT_TRUE(pmgr.GetSnapshot() != snapshot);
+      ASSERT_EQ(std::string("batch"), pmgr.GetSnapshot()->GetProperty("bar"));
+
+      // Within a read scope, the references stay valid even if the thread changes the properties
+      pmgr.BeginRead();
+      const std::string& value = pmgr.GetProperty("foo");
+      pmgr.SetProperty("foo", "changed");
+      ASSERT_EQ(std::string("changed"), pmgr.GetProperty("foo"));
+      ASSERT_EQ(std::string("batch"), value);
+      pmgr.EndRead();
+
+      pmgr.ClearProperty("foo");
+      pmgr.ClearProperty("bar");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testReadScope)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("foo", "before");
+
+      // Within a read scope, the changes of other threads are not visible
+      pmgr.BeginRead();
+      ASSERT_EQ(std::string("before"), pmgr.GetProperty("foo"));
+      std::thread writer([&pmgr]() { pmgr.SetProperty("foo", "after"); });
+      writer.join();
+      ASSERT_EQ(std::string("before"), pmgr.GetProperty("foo"));
+      pmgr.EndRead();
+
+      // They are visible after the scope
+      ASSERT_EQ(std::string("after"), pmgr.GetProperty("foo"));
+
+      pmgr.ClearProperty("foo");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testConcurrentReadWrite)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("stress.a", "0");
+      pmgr.SetProperty("stress.b", "0");
+
+      static const size_t NUM_WRITES = 20000;
+      static const size_t NUM_READERS = 4;
+      std::atomic<bool> writing(true);
+      std::atomic<size_t> failures(0);
+      std::atomic<size_t> reads(0);
+
+      // Each batch changes both properties. The readers must never see one without the other.
+      std::thread writer([&]()
+      {
+        for (size_t i = 1; i <= NUM_WRITES; i++)
+        {
+          std::string value = ra::strings::ToString(i);
+          pmgr.BeginBatch();
+          pmgr.SetProperty("stress.a", value);
+          pmgr.SetProperty("stress.b", value);
+          pmgr.EndBatch();
+        }
+        writing = false;
+      });
+
+      std::vector<std::thread> readers;
+      for (size_t i = 0; i < NUM_READERS; i++)
+      {
+        readers.push_back(std::thread([&]()
+        {
+          size_t previous = 0;
+          size_t count = 0;
+          while (writing)
+          {
+            pmgr.BeginRead();
+            const std::string& a = pmgr.GetProperty("stress.a");
+            const std::string& b = pmgr.GetProperty("stress.b");
+            size_t value = (size_t)atol(a.c_str());
+            if (a != b || value < previous)
+              failures++;
+            previous = value;
+            pmgr.EndRead();
+
+            PropertySnapshotPtr snapshot = pmgr.GetSnapshot();
+            if (snapshot->GetProperty("stress.a") != snapshot->GetProperty("stress.b"))
+              failures++;
+            count++;
+          }
+          reads += count;
+        }));
+      }
+
+      writer.join();
+      for (size_t i = 0; i < readers.size(); i++)
+      {
+        readers[i].join();
+      }
+
+      ASSERT_EQ(0, failures);
+      ASSERT_GT(reads, 0);
+      ASSERT_EQ(ra::strings::ToString(NUM_WRITES), pmgr.GetProperty("stress.a"));
+
+      pmgr.ClearProperty("stress.a");
+      pmgr.ClearProperty("stress.b");
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestPropertyManager, testReadThroughput)
+    {
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("throughput.foo", "bar");
+
+      static const size_t NUM_READS = 1000000;
+
+      // A writer publishes changes while the readers look up a property
+      size_t max_threads = std::thread::hardware_concurrency();
+      if (max_threads < 1)
+        max_threads = 1;
+      printf("Reading a property %d times per thread:\n", (int)NUM_READS);
+      for (size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+      {
+        std::atomic<bool> reading(true);
+        std::atomic<size_t> publications(0);
+        std::thread writer([&]()
+        {
+          size_t i = 0;
+          while (reading)
+          {
+            pmgr.SetProperty("throughput.other", ra::strings::ToString(i++));
+            std::this_thread::yield();
+          }
+          publications = i;
+        });
+
+        double start = ra::timing::GetMillisecondsTimer();
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < thread_count; i++)
+        {
+          readers.push_back(std::thread([&pmgr]()
+          {
+            size_t found = 0;
+            for (size_t j = 0; j < NUM_READS; j++)
+            {
+              if (pmgr.GetProperty("throughput.foo").size() == 3)
+                found++;
+            }
+            ASSERT_EQ(NUM_READS, found);
+          }));
+        }
+        for (size_t i = 0; i < readers.size(); i++)
+        {
+          readers[i].join();
+        }
+        double elapsed = ra::timing::GetMillisecondsTimer() - start;
+
+        reading = false;
+        writer.join();
+
+        double reads_per_second = (double)(NUM_READS * thread_count) / (elapsed / 1000.0);
+        printf("  %2d thread(s):           %.3f ms, %.0f reads/s, %d publications\n", (int)thread_count, elapsed, reads_per_second, (int)publications);
+      }
+
+      pmgr.ClearProperty("throughput.foo");
+      pmgr.ClearProperty("throughput.other");
+    }
+    //--------------------------------------------------------------------------------------------------
 
   } //namespace test
 } //namespace shellanything
@@ -0,0 +1,124 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestSharedMemory.h"
+#include "SharedMemory.h"
+
+#include <string.h>
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestSharedMemory::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestSharedMemory::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSharedMemory, testCreateOpen)
+    {
+      const std::string name = "ShellAnything.TestSharedMemory.testCreateOpen";
+      SharedMemory::Remove(name);
+
+      //create a new segment
+      SharedMemory writer;
+      ASSERT_TRUE(writer.Create(name, 100));
+      ASSERT_TRUE(writer.IsOpen());
+      ASSERT_FALSE(writer.IsReadOnly());
+      ASSERT_EQ(name, writer.GetName());
+      ASSERT_EQ(100, writer.GetSize());
+      const char* data = static_cast<const char*>(writer.GetData());
+      for (size_t i = 0; i < writer.GetSize(); i++)
+      {
+        ASSERT_EQ(0, data[i]) << "i=" << i;
+      }
+      strcpy(static_cast<char*>(writer.GetData()), "foobar");
+
+      //an existing segment is not created again
+      SharedMemory duplicate;
+      ASSERT_FALSE(duplicate.Create(name, 100));
+      ASSERT_FALSE(duplicate.IsOpen());
+
+      //other mappings of the segment share the same content
+      SharedMemory reader;
+      ASSERT_TRUE(reader.Open(name, true));
+      ASSERT_TRUE(reader.IsReadOnly());
+      ASSERT_GE(reader.GetSize(), 100);
+      ASSERT_NE(writer.GetData(), reader.GetData());
+      ASSERT_EQ(std::string("foobar"), static_cast<const char*>(reader.GetData()));
+
+      strcpy(static_cast<char*>(writer.GetData()), "hello");
+      ASSERT_EQ(std::string("hello"), static_cast<const char*>(reader.GetData()));
+
+      reader.Close();
+      ASSERT_FALSE(reader.IsOpen());
+      ASSERT_TRUE(reader.GetData() == NULL);
+
+      writer.Close();
+      SharedMemory::Remove(name);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestSharedMemory, testOpenMissing)
+    {
+      const std::string name = "ShellAnything.TestSharedMemory.testOpenMissing";
+      SharedMemory::Remove(name);
+
+      SharedMemory segment;
+      ASSERT_FALSE(segment.Open(name, true));
+      ASSERT_FALSE(segment.IsOpen());
+      ASSERT_FALSE(segment.Open("", true));
+      ASSERT_FALSE(segment.Create("", 100));
+    }
+    //--------------------------------------------------------------------------------------------------
+#ifndef _WIN32
+    TEST_F(TestSharedMemory, testRemove)
+    {
+      const std::string name = "ShellAnything.TestSharedMemory.testRemove";
+      SharedMemory::Remove(name);
+
+      SharedMemory writer;
+      ASSERT_TRUE(writer.Create(name, 100));
+      strcpy(static_cast<char*>(writer.GetData()), "foobar");
+
+      //a removed segment can not be opened but existing mappings are still valid
+      ASSERT_TRUE(SharedMemory::Remove(name));
+      SharedMemory reader;
+      ASSERT_FALSE(reader.Open(name, true));
+      ASSERT_EQ(std::string("foobar"), static_cast<const char*>(writer.GetData()));
+
+      //the name can be used again
+      SharedMemory other;
+      ASSERT_TRUE(other.Create(name, 50));
+      other.Close();
+      ASSERT_TRUE(SharedMemory::Remove(name));
+    }
+#endif
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
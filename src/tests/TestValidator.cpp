@@ -27,6 +27,7 @@
 #include "Menu.h"
 #include "SelectionContext.h"
 #include "PropertyManager.h"
+#include "ConfigFile.h"
 #include "rapidassist/testing.h"
 #include "rapidassist/process.h"
 
@@ -34,6 +35,60 @@ namespace shellanything
 {
   namespace test
   {
+    class CountingAttributeValidator : public IAttributeValidator
+    {
+    public:
+      CountingAttributeValidator(const std::string& name) :
+        mContext(NULL),
+        mAttributes(NULL),
+        mName(name),
+        mCount(0)
+      {
+        mNames.push_back(name);
+      }
+      virtual ~CountingAttributeValidator()
+      {
+      }
+      virtual bool IsAttributesSupported(const StringList& names) const
+      {
+        return (names.size() == 1 && names[0] == mName);
+      }
+      virtual const StringList& GetAttributeNames() const
+      {
+        return mNames;
+      }
+      virtual void SetSelectionContext(const SelectionContext* context)
+      {
+        mContext = context;
+      }
+      virtual const SelectionContext* GetSelectionContext() const
+      {
+        return mContext;
+      }
+      virtual void SetCustomAttributes(const PropertyStore* store)
+      {
+        mAttributes = store;
+      }
+      virtual const PropertyStore* GetCustomAttributes() const
+      {
+        return mAttributes;
+      }
+      virtual bool Validate() const
+      {
+        mCount++;
+        return (mAttributes != NULL && mAttributes->GetProperty(mName) == "true");
+      }
+      size_t GetCount() const
+      {
+        return mCount;
+      }
+    private:
+      const SelectionContext* mContext;
+      const PropertyStore* mAttributes;
+      std::string mName;
+      StringList mNames;
+      mutable size_t mCount;
+    };
 
     //--------------------------------------------------------------------------------------------------
     void TestValidator::SetUp()
@@ -1266,5 +1321,122 @@ namespace shellanything
       ASSERT_FALSE(v.Validate(c));
     }
     //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testFoldConstants)
+    {
+      SelectionContext c;
+      StringList elements;
+      elements.push_back(ra::process::GetCurrentProcessPath());
+      c.SetElements(elements);
+
+      PropertyManager& pmgr = PropertyManager::GetInstance();
+      pmgr.SetProperty("stable.enabled", "true");
+      pmgr.SetStableProperty("stable.enabled", true);
+      pmgr.SetProperty("foo", "true");
+
+      Validator v;
+      ASSERT_TRUE(v.IsAlwaysValid());
+
+      //constant attributes
+      v.SetIsTrue("${stable.enabled}");
+      v.SetExprtk("'${stable.enabled}' == 'true'");
+      v.FoldConstants();
+      ASSERT_TRUE(v.IsAlwaysValid());
+      ASSERT_TRUE(v.Validate(c));
+
+      //attributes which depends on other properties
+      v.SetIsFalse("${foo}");
+      ASSERT_FALSE(v.IsAlwaysValid());
+      ASSERT_FALSE(v.Validate(c));
+      pmgr.SetProperty("foo", "false");
+      ASSERT_TRUE(v.Validate(c));
+      v.SetIsFalse("");
+
+      //attributes which depends on the selection
+      v.SetPattern("*.foo");
+      ASSERT_FALSE(v.IsAlwaysValid());
+      ASSERT_FALSE(v.Validate(c));
+      v.SetPattern("");
+      ASSERT_TRUE(v.IsAlwaysValid());
+
+      //changing a stable property invalidates the constants
+      pmgr.SetProperty("stable.enabled", "false");
+      ASSERT_FALSE(v.IsAlwaysValid());
+      ASSERT_FALSE(v.Validate(c));
+      pmgr.SetProperty("stable.enabled", "true");
+      ASSERT_TRUE(v.Validate(c));
+
+      //changing the system true property invalidates the constants
+      pmgr.SetProperty("stable.enabled", "yes");
+      ASSERT_FALSE(v.IsAlwaysValid()); // exprtk is false
+      v.SetExprtk("");
+      ASSERT_TRUE(v.Validate(c));
+      pmgr.SetProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME, "yes");
+      ASSERT_TRUE(v.Validate(c));
+      pmgr.SetProperty("stable.enabled", "si");
+      ASSERT_FALSE(v.Validate(c));
+      pmgr.SetProperty(PropertyManager::SYSTEM_TRUE_PROPERTY_NAME, "si");
+      ASSERT_TRUE(v.Validate(c));
+
+      //inversing an attribute invalidates the constants
+      v.SetInserve("istrue");
+      ASSERT_FALSE(v.IsAlwaysValid());
+      ASSERT_FALSE(v.Validate(c));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestValidator, testPluginValidators)
+    {
+      SelectionContext c;
+
+      //create a plugin with two conditions
+      Plugin* plugin = new Plugin();
+      plugin->SetConditions("foo;bar");
+      CountingAttributeValidator* foo = new CountingAttributeValidator("foo");
+      CountingAttributeValidator* bar = new CountingAttributeValidator("bar");
+      plugin->GetRegistry().AddAttributeValidator(foo);
+      plugin->GetRegistry().AddAttributeValidator(bar);
+
+      ConfigFile config;
+      config.AddPlugin(plugin);
+
+      //a validator with a custom attribute of the plugin
+      Validator v1;
+      PropertyStore attributes;
+      attributes.SetProperty("foo", "true");
+      v1.SetCustomAttributes(attributes);
+      v1.ResolvePluginValidators(config.GetPlugins());
+
+      //a validator without custom attributes
+      Validator v2;
+      v2.ResolvePluginValidators(config.GetPlugins());
+
+      ConfigFile::SetUpdatingConfigFile(&config);
+
+      //only the attribute validators required by the custom attributes are called
+      ASSERT_TRUE(v1.Validate(c));
+      ASSERT_TRUE(v2.Validate(c));
+      ASSERT_EQ(1, foo->GetCount());
+      ASSERT_EQ(0, bar->GetCount());
+
+      //changing the custom attributes resolves the attribute validators again
+      attributes.SetProperty("foo", "false");
+      attributes.SetProperty("bar", "true");
+      v1.SetCustomAttributes(attributes);
+      ASSERT_FALSE(v1.Validate(c));
+      ASSERT_EQ(2, foo->GetCount());
+      ASSERT_EQ(0, bar->GetCount()); // not called since foo is invalid
+
+      attributes.ClearProperty("foo");
+      v1.SetCustomAttributes(attributes);
+      ASSERT_TRUE(v1.Validate(c));
+      ASSERT_EQ(2, foo->GetCount());
+      ASSERT_EQ(1, bar->GetCount());
+
+      ConfigFile::SetUpdatingConfigFile(NULL);
+
+      //outside of an update, the plugins of the configuration are not used
+      ASSERT_TRUE(v1.Validate(c));
+      ASSERT_EQ(1, bar->GetCount());
+    }
+    //--------------------------------------------------------------------------------------------------
   } //namespace test
 } //namespace shellanything
@@ -621,6 +621,49 @@ namespace shellanything
         success = WildcardMatch(wildcard, value);
         ASSERT_TRUE(success);
       }
+
+      // Test a candidate that leaves less characters than required by the rest of the pattern.
+      // The next candidates must still be tried.
+      {
+        WildcardList matches;
+        const char* wildcard = "?*a*aa?";
+        const char* value = "aaaaa";
+        bool success = WildcardSolve(wildcard, value, matches);
+        ASSERT_TRUE(success);
+
+        // Try rebuilding the value from the pattern and the matches
+        std::string rebuild = WildcardRebuild(wildcard, matches);
+        ASSERT_EQ(rebuild, value);
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcard, testManyWildcards)
+    {
+      // Build a pattern with more '?' characters than what can be solved without allocating memory.
+      std::string wildcard = "C:\\*\\";
+      std::string value = "C:\\Program Files\\";
+      for (size_t i = 0; i < 100; i++)
+      {
+        wildcard += "?";
+        value += (char)('a' + (i % 26));
+      }
+      wildcard += ".*";
+      value += ".txt";
+
+      WildcardList matches;
+      bool success = WildcardSolve(wildcard.c_str(), value.c_str(), matches);
+      ASSERT_TRUE(success);
+      ASSERT_EQ(102, matches.size());
+      ASSERT_EQ(std::string("Program Files"), matches[0].value);
+      ASSERT_EQ(std::string("txt"), matches[101].value);
+
+      // Try rebuilding the value from the pattern and the matches
+      std::string rebuild = WildcardRebuild(wildcard.c_str(), matches);
+      ASSERT_EQ(rebuild, value);
+
+      // Validate WildcardMatch() as well.
+      success = WildcardMatch(wildcard.c_str(), value.c_str());
+      ASSERT_TRUE(success);
     }
     //--------------------------------------------------------------------------------------------------
 
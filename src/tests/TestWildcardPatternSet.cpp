@@ -0,0 +1,352 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestWildcardPatternSet.h"
+#include "WildcardPatternSet.h"
+#include "Wildcard.h"
+#include "rapidassist/strings.h"
+#include "rapidassist/timing.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    bool WildcardMatchAny(const StringList& patterns, const char* value)
+    {
+      for (size_t i = 0; i < patterns.size(); i++)
+      {
+        const std::string& pattern = patterns[i];
+        if (WildcardMatch(pattern.c_str(), value))
+          return true;
+      }
+      return false;
+    }
+
+    // Simple deterministic pseudo random number generator.
+    // Tests are not expected to change from one run to another.
+    class PseudoRandom
+    {
+    public:
+      PseudoRandom(uint32_t seed) : mState(seed) {}
+      uint32_t Next(uint32_t max)
+      {
+        mState = mState * 1103515245 + 12345;
+        return ((mState >> 8) % max);
+      }
+    private:
+      uint32_t mState;
+    };
+
+    void BuildBenchmarkPatterns(size_t count, StringList& patterns)
+    {
+      static const char* extensions[] = { "TXT", "DOC", "DOCX", "XLS", "PDF", "EXE", "DLL", "CPP", "H", "PNG", "JPG", "ZIP", "7Z", "MP3", "XML", "INI" };
+      static const size_t num_extensions = sizeof(extensions) / sizeof(extensions[0]);
+
+      PseudoRandom r(42);
+      patterns.clear();
+      for (size_t i = 0; i < count; i++)
+      {
+        std::string id = ra::strings::ToString(i);
+        const char* ext = extensions[r.Next(num_extensions)];
+        switch (i % 5)
+        {
+        case 0:
+          patterns.push_back(std::string("*.") + ext + id);
+          break;
+        case 1:
+          patterns.push_back("C:\\PROGRAM FILES\\VENDOR" + id + "\\*");
+          break;
+        case 2:
+          patterns.push_back("*\\PROJECT" + id + "\\*." + ext);
+          break;
+        case 3:
+          patterns.push_back("*\\REPORT" + id + "_??." + ext);
+          break;
+        default:
+          patterns.push_back("D:\\DATA\\?" + id + "*\\*.BAK");
+          break;
+        };
+      }
+    }
+
+    void BuildBenchmarkPaths(size_t count, size_t num_patterns, StringList& paths)
+    {
+      static const char* extensions[] = { "TXT", "DOC", "DOCX", "XLS", "PDF", "EXE", "DLL", "CPP", "H", "PNG", "JPG", "ZIP", "7Z", "MP3", "XML", "INI" };
+      static const size_t num_extensions = sizeof(extensions) / sizeof(extensions[0]);
+
+      PseudoRandom r(1234);
+      paths.clear();
+      for (size_t i = 0; i < count; i++)
+      {
+        std::string id = ra::strings::ToString(r.Next((uint32_t)num_patterns * 2));
+        const char* ext = extensions[r.Next(num_extensions)];
+        switch (r.Next(6))
+        {
+        case 0:
+          paths.push_back("C:\\USERS\\JOHN\\DOCUMENTS\\NOTES." + std::string(ext) + id);
+          break;
+        case 1:
+          paths.push_back("C:\\PROGRAM FILES\\VENDOR" + id + "\\BIN\\APP." + ext);
+          break;
+        case 2:
+          paths.push_back("C:\\SOURCES\\PROJECT" + id + "\\SRC\\MAIN." + ext);
+          break;
+        case 3:
+          paths.push_back("C:\\USERS\\JOHN\\DESKTOP\\REPORT" + id + "_01." + ext);
+          break;
+        case 4:
+          paths.push_back("D:\\DATA\\X" + id + "\\ARCHIVE\\FILE.BAK");
+          break;
+        default:
+          paths.push_back("E:\\MISC\\FOLDER" + id + "\\UNRELATED FILE WITH A LONG NAME." + ext);
+          break;
+        };
+      }
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    void TestWildcardPatternSet::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestWildcardPatternSet::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testEmpty)
+    {
+      WildcardPatternSet s;
+      ASSERT_TRUE(s.IsEmpty());
+      ASSERT_EQ(0, s.GetPatternCount());
+      ASSERT_FALSE(s.Match("foo"));
+      ASSERT_FALSE(s.Match(""));
+      ASSERT_FALSE(s.Match(NULL));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testMatch)
+    {
+      StringList patterns;
+      patterns.push_back("*.TXT");
+      patterns.push_back("C:\\WINDOWS\\*");
+      patterns.push_back("*REPORT_??.DOC");
+      patterns.push_back("README");
+
+      WildcardPatternSet s;
+      s.Compile(patterns);
+      ASSERT_FALSE(s.IsEmpty());
+      ASSERT_EQ(4, s.GetPatternCount());
+
+      ASSERT_TRUE(s.Match("C:\\TEMP\\FOO.TXT"));
+      ASSERT_TRUE(s.Match(".TXT"));
+      ASSERT_TRUE(s.Match("C:\\WINDOWS\\NOTEPAD.EXE"));
+      ASSERT_TRUE(s.Match("C:\\WINDOWS\\"));
+      ASSERT_TRUE(s.Match("C:\\DOCS\\REPORT_01.DOC"));
+      ASSERT_TRUE(s.Match("README"));
+
+      ASSERT_FALSE(s.Match("C:\\TEMP\\FOO.TXT2"));
+      ASSERT_FALSE(s.Match("C:\\WINDOWS"));
+      ASSERT_FALSE(s.Match("C:\\DOCS\\REPORT_1.DOC"));
+      ASSERT_FALSE(s.Match("README.MD"));
+      ASSERT_FALSE(s.Match(""));
+
+      // Compiling again replaces the previous patterns
+      patterns.clear();
+      patterns.push_back("*.DOC");
+      s.Compile(patterns);
+      ASSERT_EQ(1, s.GetPatternCount());
+      ASSERT_FALSE(s.Match("C:\\TEMP\\FOO.TXT"));
+      ASSERT_TRUE(s.Match("C:\\DOCS\\REPORT_01.DOC"));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testUnanchoredPatterns)
+    {
+      // Patterns without literal characters
+      {
+        StringList patterns;
+        patterns.push_back("*");
+        WildcardPatternSet s;
+        s.Compile(patterns);
+        ASSERT_TRUE(s.Match(""));
+        ASSERT_TRUE(s.Match("foo"));
+      }
+      {
+        StringList patterns;
+        patterns.push_back("???");
+        patterns.push_back("?*?");
+        WildcardPatternSet s;
+        s.Compile(patterns);
+        ASSERT_FALSE(s.Match(""));
+        ASSERT_FALSE(s.Match("a"));
+        ASSERT_TRUE(s.Match("ab"));
+        ASSERT_TRUE(s.Match("abcdef"));
+      }
+      {
+        StringList patterns;
+        patterns.push_back("");
+        WildcardPatternSet s;
+        s.Compile(patterns);
+        ASSERT_TRUE(s.Match(""));
+        ASSERT_FALSE(s.Match("a"));
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testOverlappingLiterals)
+    {
+      // Literal sequences that are suffixes or prefixes of each other
+      StringList patterns;
+      patterns.push_back("*ABCD*");
+      patterns.push_back("*BC");
+      patterns.push_back("X*CDE");
+      patterns.push_back("**C****");
+
+      WildcardPatternSet s;
+      s.Compile(patterns);
+
+      static const char* values[] = { "", "A", "C", "ABC", "ABCD", "XABCD", "ZZABCDZZ", "XCDE", "YCDE", "XXBC", "BCX", "XBCDE", "ABABABCD" };
+      static const size_t num_values = sizeof(values) / sizeof(values[0]);
+      for (size_t i = 0; i < num_values; i++)
+      {
+        const char* value = values[i];
+        bool expected = WildcardMatchAny(patterns, value);
+        bool actual = s.Match(value);
+        ASSERT_EQ(expected, actual) << "value=" << value;
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testSameResultsAsWildcardMatch)
+    {
+      StringList patterns;
+      StringList paths;
+      BuildBenchmarkPatterns(50, patterns);
+      BuildBenchmarkPaths(2000, 50, paths);
+
+      WildcardPatternSet s;
+      s.Compile(patterns);
+
+      size_t num_matches = 0;
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        const std::string& path = paths[i];
+        bool expected = WildcardMatchAny(patterns, path.c_str());
+        bool actual = s.Match(path.c_str());
+        ASSERT_EQ(expected, actual) << "path=" << path;
+        if (actual)
+          num_matches++;
+      }
+
+      // Make sure the test is meaningful
+      ASSERT_GT(num_matches, 0);
+      ASSERT_LT(num_matches, paths.size());
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testCaseInsensitive)
+    {
+      StringList patterns;
+      StringList paths;
+      BuildBenchmarkPatterns(50, patterns);
+      BuildBenchmarkPaths(2000, 50, paths);
+
+      // Use lowercase paths and a few non ASCII characters
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        std::string& path = paths[i];
+        path = ra::strings::Lowercase(path);
+        if (i % 3 == 0)
+          path.insert(path.size() / 2, "\xC3\xA9");
+      }
+      patterns.push_back("*\\" "\xC3\x89" "COLE\\*");
+      paths.push_back("c:\\" "\xC3\xA9" "cole\\file.txt");
+
+      WildcardPatternSet s;
+      s.Compile(patterns, WILDCARD_CASE_INSENSITIVE);
+
+      size_t num_matches = 0;
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        const std::string& path = paths[i];
+        bool expected = false;
+        for (size_t j = 0; j < patterns.size() && !expected; j++)
+          expected = WildcardMatch(patterns[j].c_str(), path.c_str(), WILDCARD_CASE_INSENSITIVE);
+        bool actual = s.Match(path.c_str());
+        ASSERT_EQ(expected, actual) << "path=" << path;
+        if (actual)
+          num_matches++;
+      }
+
+      // Make sure the test is meaningful
+      ASSERT_GT(num_matches, 0);
+      ASSERT_LT(num_matches, paths.size());
+      ASSERT_TRUE(s.Match(paths[paths.size() - 1].c_str()));
+
+      // The same set is case sensitive by default
+      s.Compile(patterns);
+      ASSERT_FALSE(s.Match(paths[paths.size() - 1].c_str()));
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestWildcardPatternSet, testBenchmark)
+    {
+      static const size_t NUM_PATTERNS = 200;
+      static const size_t NUM_PATHS = 10000;
+
+      StringList patterns;
+      StringList paths;
+      BuildBenchmarkPatterns(NUM_PATTERNS, patterns);
+      BuildBenchmarkPaths(NUM_PATHS, NUM_PATTERNS, paths);
+
+      // Matching each pattern individually
+      size_t expected_matches = 0;
+      double naive_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        if (WildcardMatchAny(patterns, paths[i].c_str()))
+          expected_matches++;
+      }
+      double naive_time = ra::timing::GetMillisecondsTimer() - naive_start;
+
+      // Matching with a compiled set
+      double compile_start = ra::timing::GetMillisecondsTimer();
+      WildcardPatternSet s;
+      s.Compile(patterns);
+      double compile_time = ra::timing::GetMillisecondsTimer() - compile_start;
+
+      size_t actual_matches = 0;
+      double compiled_start = ra::timing::GetMillisecondsTimer();
+      for (size_t i = 0; i < paths.size(); i++)
+      {
+        if (s.Match(paths[i].c_str()))
+          actual_matches++;
+      }
+      double compiled_time = ra::timing::GetMillisecondsTimer() - compiled_start;
+
+      printf("Matching %d paths against %d patterns:\n", (int)NUM_PATHS, (int)NUM_PATTERNS);
+      printf("  WildcardMatch() on each pattern: %.3f ms\n", naive_time);
+      printf("  WildcardPatternSet::Compile():   %.3f ms\n", compile_time);
+      printf("  WildcardPatternSet::Match():     %.3f ms\n", compiled_time);
+
+      ASSERT_EQ(expected_matches, actual_matches);
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything
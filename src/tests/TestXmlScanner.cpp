@@ -0,0 +1,133 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestXmlScanner.h"
+#include "XmlScanner.h"
+
+namespace shellanything
+{
+  namespace test
+  {
+    //--------------------------------------------------------------------------------------------------
+    void TestXmlScanner::SetUp()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    void TestXmlScanner::TearDown()
+    {
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestXmlScanner, testScan)
+    {
+      static const std::string xml = ""
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<!-- a <comment> -->\n"
+        "<root>\n"
+        "  <shell>\n"
+        "    <menu name=\"a>b\">\n"
+        "      <menu name='c' />\n"
+        "      <![CDATA[ </menu> ]]>\n"
+        "    </menu>\n"
+        "    <menu name=\"d\" />\n"
+        "  </shell>\n"
+        "</root>\n";
+
+      XmlScanner scanner;
+      XmlScanner::ElementList elements;
+      ASSERT_TRUE(scanner.Scan(xml.c_str(), xml.size(), 2, elements)) << scanner.GetError();
+      ASSERT_EQ(std::string("xml version=\"1.0\" encoding=\"utf-8\""), scanner.GetDeclaration());
+
+      //ASSERT the elements deeper than the maximum depth are not reported
+      ASSERT_EQ(4, elements.size());
+      ASSERT_EQ(std::string("root"), elements[0].name);
+      ASSERT_EQ(std::string("shell"), elements[1].name);
+      ASSERT_EQ(std::string("menu"), elements[2].name);
+      ASSERT_EQ(std::string("menu"), elements[3].name);
+
+      //ASSERT the position of the elements
+      const XmlScanner::ELEMENT& first = elements[2];
+      ASSERT_EQ(5, first.line);
+      ASSERT_EQ(2, first.depth);
+      ASSERT_EQ(1, first.parent);
+      std::string text = xml.substr(first.offset, first.length);
+      ASSERT_EQ(0, text.find("<menu name=\"a>b\">"));
+      ASSERT_EQ(text.size() - 7, text.rfind("</menu>"));
+      ASSERT_EQ(std::string("<menu name=\"d\" />"), xml.substr(elements[3].offset, elements[3].length));
+      ASSERT_EQ(9, elements[3].line);
+
+      //ASSERT the elements can be found by name
+      size_t root = XmlScanner::FindChild(elements, XmlScanner::INVALID_INDEX, "root");
+      ASSERT_EQ(0, root);
+      size_t shell = XmlScanner::FindChild(elements, root, "shell");
+      ASSERT_EQ(1, shell);
+      ASSERT_EQ(XmlScanner::INVALID_INDEX, XmlScanner::FindChild(elements, root, "menu"));
+      size_t menu = XmlScanner::FindChild(elements, shell, "menu");
+      ASSERT_EQ(2, menu);
+      menu = XmlScanner::FindNextSibling(elements, menu, "menu");
+      ASSERT_EQ(3, menu);
+      menu = XmlScanner::FindNextSibling(elements, menu, "menu");
+      ASSERT_EQ(XmlScanner::INVALID_INDEX, menu);
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestXmlScanner, testMalformed)
+    {
+      static const char* documents[] = {
+        "",
+        "<root><shell></root></shell>",
+        "<root>\n<shell>",
+        "<root><!-- comment </root>",
+        "<root attr=\"value></root>",
+        "</root>",
+      };
+      const size_t num_documents = sizeof(documents) / sizeof(documents[0]);
+
+      for (size_t i = 0; i < num_documents; i++)
+      {
+        const char* xml = documents[i];
+        XmlScanner scanner;
+        XmlScanner::ElementList elements;
+        ASSERT_FALSE(scanner.Scan(xml, strlen(xml), 2, elements)) << "xml=" << xml;
+        ASSERT_FALSE(scanner.GetError().empty()) << "xml=" << xml;
+      }
+    }
+    //--------------------------------------------------------------------------------------------------
+    TEST_F(TestXmlScanner, testDeclaration)
+    {
+      XmlScanner scanner;
+      XmlScanner::ElementList elements;
+
+      //ASSERT a byte order mark is skipped
+      std::string xml = "\xEF\xBB\xBF<?xml version=\"1.0\"?><root/>";
+      ASSERT_TRUE(scanner.Scan(xml.c_str(), xml.size(), 0, elements)) << scanner.GetError();
+      ASSERT_EQ(std::string("xml version=\"1.0\""), scanner.GetDeclaration());
+
+      //ASSERT the declaration must be the first node
+      xml = "<!-- comment --><?xml version=\"1.0\"?><root/>";
+      ASSERT_TRUE(scanner.Scan(xml.c_str(), xml.size(), 0, elements)) << scanner.GetError();
+      ASSERT_TRUE(scanner.GetDeclaration().empty());
+    }
+    //--------------------------------------------------------------------------------------------------
+
+  } //namespace test
+} //namespace shellanything